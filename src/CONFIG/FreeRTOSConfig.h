@@ -92,6 +92,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelay                  1
 #define INCLUDE_xTaskGetCurrentTaskHandle   1
 #define INCLUDE_xTaskGetSchedulerState      0
+#define INCLUDE_xTaskGetIdleTaskHandle      1
 
 /* configTICK_USE_TC is a boolean indicating whether to use a Timer Counter or
    the CPU Cycle Counter for the tick generation.
@@ -101,9 +102,57 @@ to exclude the API function. */
 #define configTICK_USE_TC             0
 #define configTICK_TC_CHANNEL         2
 
+/* configUSE_TICKLESS_IDLE is a boolean indicating whether the idle task stops
+   the tick and puts the MCU to sleep until the next delayed task is due.
+   Requires configTICK_USE_TC 0: the tick count is corrected from the CPU Cycle
+   Counter on wake-up.
+   configEXPECTED_IDLE_TIME_BEFORE_SLEEP is the minimum number of idle ticks
+   worth suppressing the tick for.
+   configTICKLESS_SLEEP_MODE is the pm.h sleep mode entered; it must leave the
+   Cycle Counter and the peripherals' interrupts able to wake the CPU.
+   Off until the COMPARE wake-up from that sleep mode is checked on the board:
+   were COUNT to stop, every delayed task would hang. */
+#define configUSE_TICKLESS_IDLE                 0
+#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP   2
+#define configTICKLESS_SLEEP_MODE               AVR32_PM_SMODE_IDLE
+
+/* configGENERATE_RUN_TIME_STATS is a boolean indicating whether the CPU time
+   used by each task is accounted, in CPU Cycle Counter cycles.
+   configRUN_TIME_STATS_WINDOW_SHIFT sets the length of the sliding window used
+   for the per task CPU percentage: 2^25 cycles is about 0.7s at 48MHz. */
+#define configGENERATE_RUN_TIME_STATS           1
+#define configRUN_TIME_STATS_WINDOW_SHIFT       25
+
+/* configUSE_LATENCY_PROFILER is a boolean indicating whether the length of
+   the critical sections and of the scheduler suspensions is measured, see
+   vTaskGetLatencyStats(). Requires configGENERATE_RUN_TIME_STATS 1.
+   The histograms have configLATENCY_HISTOGRAM_BUCKETS logarithmic buckets,
+   the first one counting windows under 2^configLATENCY_HISTOGRAM_SHIFT cycles. */
+#define configUSE_LATENCY_PROFILER              1
+#define configLATENCY_HISTOGRAM_BUCKETS         12
+#define configLATENCY_HISTOGRAM_SHIFT           6
+
+/* configSUPPORT_STATIC_ALLOCATION is a boolean indicating whether tasks,
+   queues and semaphores can be created in buffers provided by the application
+   (xTaskCreateStatic(), xQueueCreateStatic(), ...). The long-lived objects of
+   the bridge then use static memory and show in the link map instead of the
+   heap. */
+#define configSUPPORT_STATIC_ALLOCATION         1
+
 /* configHEAP_INIT is a boolean indicating whether to initialize the heap with
    0xA5 in order to be able to determine the maximal heap consumption. */
 #define configHEAP_INIT               0
 
+/* configUSE_TRACE_RECORDER is a boolean indicating whether the trace macros
+   record the scheduler events into a RAM ring of configTRACE_RECORDER_SIZE
+   records (8 bytes each, power of 2), streamed out on TCP port 24.
+   Requires configUSE_TRACE_FACILITY 1 and configGENERATE_RUN_TIME_STATS 1.
+   Off in the production build: the server takes a task, a listening pcb and
+   two netconns. Turn it on to capture a trace. */
+#define configUSE_TRACE_RECORDER      0
+#define configTRACE_RECORDER_SIZE     256
+
+#include "trace_recorder.h"
+
 
 #endif /* FREERTOS_CONFIG_H */
@@ -59,6 +59,42 @@
 /*! define stack size for SMTP Client task */
 #define lwipBASIC_SMTP_CLIENT_STACK_SIZE  256
 
+/*! define stack size for Z-Wave server task */
+#define lwipZWAVE_SERVER_STACK_SIZE       512
+
+/*! Z-Wave bridge implementation, zwaveBRIDGE_API is one of:
+    zwaveBRIDGE_NETCONN: its own task on the netconn API, one controller
+    (ZWaveTCP.c);
+    zwaveBRIDGE_RAW: run by the lwIP task on the raw API, one controller
+    (ZWaveRaw.c);
+    zwaveBRIDGE_SELECT: its own task on the sockets API, one select() waiting
+    for the listener, one controller and the serial port (ZWaveSelect.c);
+    zwaveBRIDGE_UDP: run by the lwIP task on the raw UDP API, one Serial API
+    frame per datagram (ZWaveUDP.c). */
+#define zwaveBRIDGE_NETCONN               0
+#define zwaveBRIDGE_RAW                   1
+#define zwaveBRIDGE_SELECT                2
+#define zwaveBRIDGE_UDP                   3
+#define zwaveBRIDGE_API                   zwaveBRIDGE_NETCONN
+
+/*! 1: the unsolicited frames of the Z-Wave module are also published to a
+    multicast group, with a replay service over TCP (ZWaveEvent.c). */
+#define zwaveEVENT_MULTICAST              1
+
+/*! 1: the bridge takes control requests on UDP port zwaveCONTROL_PORT
+    (ZWaveControl.c), from the subnet of the board only. The requests are
+    not authenticated and one of them switches the baud rate of the Z-Wave
+    serial port: only for a trusted network. */
+#define zwaveCONTROL                      0
+
+/*! 1: RTS/CTS handshaking on the Z-Wave serial port. RTS is deasserted while
+    the RX ring of the serial task is 3/4 full, no byte is sent while CTS is
+    deasserted. Needs both lines wired to the module. */
+#define zwaveSERIAL_RTSCTS                0
+
+/*! define stack size for trace server task */
+#define lwipTRACE_SERVER_STACK_SIZE       256
+
 /*! define stack size for lwIP task */
 #define lwipINTERFACE_STACK_SIZE          512
 
@@ -74,6 +110,9 @@
 /*! define SMTP Client priority */
 #define lwipBASIC_SMTP_CLIENT_PRIORITY    ( tskIDLE_PRIORITY + 5 )
 
+/*! define trace server priority */
+#define lwipTRACE_SERVER_PRIORITY         ( tskIDLE_PRIORITY + 1 )
+
 /*! define lwIP task priority */
 #define lwipINTERFACE_TASK_PRIORITY       ( configMAX_PRIORITIES - 1 )
 
@@ -83,6 +122,21 @@
 /*! Number of threads that can be started with sys_thread_new() */
 #define SYS_THREAD_MAX                    6
 
+/*! Size, in stack words, of the static arena the sys_thread_new() stacks are
+    carved from when configSUPPORT_STATIC_ALLOCATION is 1: the tcpip, netif,
+    Z-Wave (unless run by the lwIP task) and trace threads. Threads that do
+    not fit fall back to the heap. */
+#if zwaveBRIDGE_API == zwaveBRIDGE_RAW || zwaveBRIDGE_API == zwaveBRIDGE_UDP
+#define SYS_THREAD_STACK_POOL_SIZE        ( lwipINTERFACE_STACK_SIZE \
+                                          + netifINTERFACE_TASK_STACK_SIZE \
+                                          + lwipTRACE_SERVER_STACK_SIZE )
+#else
+#define SYS_THREAD_STACK_POOL_SIZE        ( lwipINTERFACE_STACK_SIZE \
+                                          + netifINTERFACE_TASK_STACK_SIZE \
+                                          + lwipZWAVE_SERVER_STACK_SIZE \
+                                          + lwipTRACE_SERVER_STACK_SIZE )
+#endif
+
 /*! LED used by the ethernet task, toggled on each activation */
 #define webCONN_LED                       7
 
@@ -52,6 +52,7 @@
 /* Include user defined options first */
 // #include "conf_eth.h"
 #include "conf_lwip_threads.h"
+#include "FreeRTOSConfig.h"
 
 #include "lwip/debug.h"
 
@@ -81,9 +82,17 @@
 #define MEM_ALIGNMENT           4
 
 /* MEM_SIZE: the size of the heap memory. If the application will send
-a lot of data that needs to be copied, this should be set high. */
+a lot of data that needs to be copied, this should be set high.
+Not allocated when MEM_USE_POOLS is 1. */
 #define MEM_SIZE                3 * 1024
 
+/* MEM_USE_POOLS: mem_malloc() takes its blocks from the size classes of
+   lwippools.h instead of the MEM_SIZE heap. When a class is exhausted, the
+   next bigger one is tried (MEM_USE_POOLS_TRY_BIGGER_POOL). */
+#define MEM_USE_POOLS                   1
+#define MEMP_USE_CUSTOM_POOLS           1
+#define MEM_USE_POOLS_TRY_BIGGER_POOL   1
+
 
 /* MEMP_NUM_PBUF: the number of memp struct pbufs. If the application
    sends a lot of data out of ROM (or other static memory), this
@@ -93,14 +102,15 @@ a lot of data that needs to be copied, this should be set high. */
 /* Number of raw connection PCBs */
 #define MEMP_NUM_RAW_PCB                1
 
-#if (TFTP_USED == 1)
+#if (TFTP_USED == 1) || (zwaveBRIDGE_API == zwaveBRIDGE_UDP) || (zwaveEVENT_MULTICAST == 1) || (zwaveCONTROL == 1)
   /* ---------- UDP options ---------- */
   #define LWIP_UDP                1
   #define UDP_TTL                 255
   /* MEMP_NUM_UDP_PCB: the number of UDP protocol control blocks. One
-     per active UDP "connection". */
+     per active UDP "connection": TFTP, the UDP Z-Wave bridge, the
+     Z-Wave events and the bridge control. */
 
-  #define MEMP_NUM_UDP_PCB        1
+  #define MEMP_NUM_UDP_PCB        4
 #else
   /* ---------- UDP options ---------- */
   #define LWIP_UDP                0
@@ -111,31 +121,62 @@ a lot of data that needs to be copied, this should be set high. */
   #define MEMP_NUM_UDP_PCB        0
 #endif
 
+/* ---------- IGMP options ---------- */
+/* The multicast group of the Z-Wave events, and the all systems group. */
+#define LWIP_IGMP               zwaveEVENT_MULTICAST
+#define MEMP_NUM_IGMP_GROUP     2
+
 /* MEMP_NUM_TCP_PCB: the number of simultaneously active TCP connections. */
-#define MEMP_NUM_TCP_PCB        2
 /* MEMP_NUM_TCP_PCB_LISTEN: the number of listening TCP connections. */
-#define MEMP_NUM_TCP_PCB_LISTEN 1
+/* One more of each for the replay service of the Z-Wave events. */
+#if (configUSE_TRACE_RECORDER == 1)
+  /* One more of each for the trace server. */
+  #define MEMP_NUM_TCP_PCB        ( 3 + zwaveEVENT_MULTICAST )
+  #define MEMP_NUM_TCP_PCB_LISTEN ( 2 + zwaveEVENT_MULTICAST )
+#else
+  #define MEMP_NUM_TCP_PCB        ( 2 + zwaveEVENT_MULTICAST )
+  #define MEMP_NUM_TCP_PCB_LISTEN ( 1 + zwaveEVENT_MULTICAST )
+#endif
 /* MEMP_NUM_TCP_SEG: the number of simultaneously queued TCP segments. */
 #define MEMP_NUM_TCP_SEG        9
-/* MEMP_NUM_SYS_TIMEOUT: the number of simulateously active timeouts. */
-#define MEMP_NUM_SYS_TIMEOUT    6
+/* MEMP_NUM_SYS_TIMEOUT: the number of simulateously active timeouts.
+   One more for the TCP retransmission timer when LWIP_TCP_HIRES_RTO is 1,
+   one for the retransmission timer of the UDP Z-Wave bridge and one for the
+   IGMP timer. */
+#define MEMP_NUM_SYS_TIMEOUT    ( 7 + (zwaveBRIDGE_API == zwaveBRIDGE_UDP) + LWIP_IGMP )
 
 /* The following four are used only with the sequential API and can be
    set to 0 if the application only will use the raw API. */
 /* MEMP_NUM_NETBUF: the number of struct netbufs. */
 #define MEMP_NUM_NETBUF         3
 /* MEMP_NUM_NETCONN: the number of struct netconns. */
-#define MEMP_NUM_NETCONN        4
+#if (configUSE_TRACE_RECORDER == 1)
+  #define MEMP_NUM_NETCONN        6
+#else
+  #define MEMP_NUM_NETCONN        4
+#endif
 
 
 /* ---------- Pbuf options ---------- */
-/* PBUF_POOL_SIZE: the number of buffers in the pbuf pool. */
+/* PBUF_POOL_SIZE: the number of buffers in the pbuf pool.
+   Two full-size frames of 12 pbufs each: a second frame is taken in while
+   the stack still holds the first one. */
 
-#define PBUF_POOL_SIZE          6
+#define PBUF_POOL_SIZE          24
 
-/* PBUF_POOL_BUFSIZE: the size of each pbuf in the pbuf pool. */
+/* PBUF_POOL_BUFSIZE: the size of each pbuf in the pbuf pool.
+   One MACB receive buffer (MACB_RX_BUFFER_SIZE): the Ethernet input then
+   moves whole receive buffers into the pbufs of the chain. */
 
-#define PBUF_POOL_BUFSIZE       500
+#define PBUF_POOL_BUFSIZE       128
+
+/* PBUF_POOL_ALIGNMENT: the pbuf payloads start on 128 bytes boundaries, like
+   the MACB receive buffers. The pool takes 256 bytes per pbuf, in its own
+   .pbuf_pool linker section. */
+#define PBUF_POOL_ALIGNMENT     128
+#if defined(__GNUC__)
+#define PBUF_POOL_MEMORY_ATTRIBUTE  __attribute__ ((section (".pbuf_pool")))
+#endif
 
 /* PBUF_LINK_HLEN: the number of bytes that should be allocated for a
    link level header. */
@@ -160,6 +201,42 @@ a lot of data that needs to be copied, this should be set high. */
    TCP_SND_BUF/TCP_MSS for things to work. */
 #define TCP_SND_QUEUELEN        6 * TCP_SND_BUF/TCP_MSS
 
+/* Room (bytes) allocated ahead in the last segment of a copied write, so that
+   the following small Z-Wave frames are appended to it instead of each using
+   a segment, a pbuf and a header. */
+#define TCP_OVERSIZE            128
+
+/* Retransmission timer run every TCP_RTO_TMR_INTERVAL ms with RTTs measured
+   in milliseconds, instead of the 500 ms slow timer: on the LAN a lost
+   segment is resent after TCP_MIN_RTO ms instead of about a second. */
+#define LWIP_TCP_HIRES_RTO      1
+#define TCP_RTO_TMR_INTERVAL    10
+#define TCP_MIN_RTO             40
+#define TCP_INITIAL_RTO         1000
+
+/* Fast path in tcp_input() for the ACKs of the frames sent and for the frames
+   received in sequence: most segments of a bridge session skip the state
+   machine. */
+#define TCP_HEADER_PREDICTION   1
+
+/* With only MEMP_NUM_TCP_PCB pcbs, a controller reconnecting after a restart
+   must not find them all held by TIME-WAIT, half-open or closing connections:
+   reuse them, oldest first, and let a SYN reopen a TIME-WAIT connection. */
+#define TCP_PCB_RECYCLE         1
+
+#if (configUSE_TRACE_RECORDER == 1)
+/* Every data segment handed to IP is traced with its local port: the trace
+   analyzer ends the latency of the serial bytes at the first Z-Wave one, so
+   that Nagle and tcp_output() are counted in. */
+#define LWIP_TCP_OUTPUT_HOOK(pcb, seg) \
+  do { if ((seg)->len > 0) traceAPP_EVENT(traceEVT_TCP_SEGMENT, (pcb)->local_port); } while (0)
+#endif
+
+/* At most one connection waiting to be accepted per listener, next to the
+   one being served: further SYNs are dropped and retried by the peer. */
+#define TCP_LISTEN_BACKLOG          1
+#define TCP_DEFAULT_LISTEN_BACKLOG  1
+
 
 
 /* Maximum number of retransmissions of data segments. */
@@ -168,6 +245,20 @@ a lot of data that needs to be copied, this should be set high. */
 /* Maximum number of retransmissions of SYN segments. */
 #define TCP_SYNMAXRTX           4
 
+/* Per connection keepalive idle time, interval and probe count
+   (netconn_set_keepalive()), used to detect a controller that vanished
+   without closing its connection. */
+#define LWIP_TCP_KEEPALIVE      1
+
+/* netconn_recv() timeout (netconn_set_recvtimeout()): lets the Z-Wave session
+   forward serial data and check its idle timeout while the controller is
+   silent. */
+#define LWIP_SO_RCVTIMEO        1
+
+/* Channel sockets (lwip_channel()): the select Z-Wave bridge waits for the
+   serial queues in the same lwip_select() as its sockets. */
+#define LWIP_SOCKET_CHANNELS    1
+
 
 /**
  * DEFAULT_RAW_RECVMBOX_SIZE: The mailbox size for the incoming packets on a
@@ -0,0 +1,32 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief lwIP custom memory pools.
+ *
+ * Included by lwip/memp_std.h (MEMP_USE_CUSTOM_POOLS 1). With MEM_USE_POOLS 1,
+ * mem_malloc(), that is every PBUF_RAM pbuf, takes an element of the smallest
+ * of these pools that is large enough, instead of a block of a first-fit heap:
+ * no fragmentation and a short critical section instead of the heap
+ * semaphore. Each class shows in the MEMP statistics as MALLOC_<size>.
+ *
+ * A TCP segment pbuf needs 72 bytes for the pbuf structure and the TCP, IP and
+ * link headers (PBUF_LINK_HLEN 16) before its data, so the classes are sized
+ * for 16, 64 and 256 bytes of Z-Wave frame and for a full Ethernet frame:
+ * - 88:   ACKs, RSTs, ARP packets and frames up to 16 bytes;
+ * - 136:  frames up to 64 bytes;
+ * - 328:  frames up to 256 bytes, including the TCP_OVERSIZE room of the
+ *         small Serial API frames;
+ * - 1536: full sized segments, DHCP messages, the trace server chunks.
+ *
+ * This file is included several times by memp.h: it has no include guard.
+ *
+ *****************************************************************************/
+
+#if MEM_USE_POOLS
+LWIP_MALLOC_MEMPOOL_START
+LWIP_MALLOC_MEMPOOL( 8, 88 )
+LWIP_MALLOC_MEMPOOL( 4, 136 )
+LWIP_MALLOC_MEMPOOL( 4, 328 )
+LWIP_MALLOC_MEMPOOL( 2, 1536 )
+LWIP_MALLOC_MEMPOOL_END
+#endif /* MEM_USE_POOLS */
@@ -0,0 +1,199 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Decides when the bytes of the Z-Wave module, held by a connection on
+ *        their way to the network, are sent.
+ *
+ *****************************************************************************/
+
+#include <avr32/io.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "tc.h"
+
+#include "ZWaveCoalesce.h"
+
+
+#if ( configTICK_USE_TC == 1 ) && ( zwaveCOALESCE_TC_CHANNEL == configTICK_TC_CHANNEL )
+#error zwaveCOALESCE_TC_CHANNEL is the tick channel
+#endif
+
+/*! Ticks the counter surely did not wrap in, with a tick of margin for the
+    rounding of xTaskGetTickCount(). */
+#define zwaveCOALESCE_TC_WRAP	( ( 0x10000UL * zwaveCOALESCE_TC_DIVIDER ) / ( configPBA_CLOCK_HZ / 1000 ) / portTICK_RATE_MS - 1 )
+
+/*! Counter value and tick count at the last byte: written together by the
+    USART interrupt, read together in a critical section. */
+static volatile unsigned portSHORT usZwaveLastCount = 0;
+static volatile portTickType xZwaveLastTick = 0;
+
+
+void vZwaveCoalesceTimerInit( void )
+{
+	volatile avr32_tc_t *tc = &AVR32_TC;
+
+	/* Free running: up to 0xFFFF, then wraps. */
+	tc_waveform_opt_t waveform_opt =
+	{
+	.channel  = zwaveCOALESCE_TC_CHANNEL,
+
+	.bswtrg   = TC_EVT_EFFECT_NOOP,
+	.beevt    = TC_EVT_EFFECT_NOOP,
+	.bcpc     = TC_EVT_EFFECT_NOOP,
+	.bcpb     = TC_EVT_EFFECT_NOOP,
+
+	.aswtrg   = TC_EVT_EFFECT_NOOP,
+	.aeevt    = TC_EVT_EFFECT_NOOP,
+	.acpc     = TC_EVT_EFFECT_NOOP,
+	.acpa     = TC_EVT_EFFECT_NOOP,
+
+	.wavsel   = TC_WAVEFORM_SEL_UP_MODE,
+	.enetrg   = FALSE,
+	.eevt     = 0,
+	.eevtedg  = TC_SEL_NO_EDGE,
+	.cpcdis   = FALSE,
+	.cpcstop  = FALSE,
+
+	.burst    = FALSE,
+	.clki     = FALSE,
+	.tcclks   = TC_CLOCK_SOURCE_TC4                /* PBA / zwaveCOALESCE_TC_DIVIDER. */
+	};
+
+	tc_init_waveform(tc, &waveform_opt);
+	tc_start(tc, zwaveCOALESCE_TC_CHANNEL);
+}
+
+
+void vZwaveCoalesceStampFromISR( void )
+{
+	/* No critical section: the tick interrupt (INT0) cannot come between the
+	two reads, and the tasks read both with the interrupts masked. */
+	usZwaveLastCount = AVR32_TC.channel[zwaveCOALESCE_TC_CHANNEL].cv;
+	xZwaveLastTick = xTaskGetTickCount();
+}
+
+
+unsigned portLONG ulZwaveCoalesceIdle( void )
+{
+	unsigned portSHORT usCount;
+	portTickType xTicks;
+
+	portENTER_CRITICAL();
+	usCount = AVR32_TC.channel[zwaveCOALESCE_TC_CHANNEL].cv - usZwaveLastCount;
+	xTicks = xTaskGetTickCount() - xZwaveLastTick;
+	portEXIT_CRITICAL();
+
+	/* The counter may have wrapped, maybe more than once. */
+	if (xTicks >= zwaveCOALESCE_TC_WRAP)
+		return 0xFFFFFFFF;
+	return ((unsigned portLONG)usCount * zwaveCOALESCE_TC_DIVIDER) / (configPBA_CLOCK_HZ / 1000000);
+}
+
+
+void vZwaveCoalesceInit( xZwaveCoalesce *pxCoalesce, unsigned portCHAR ucPolicy, unsigned portSHORT usParam )
+{
+	pxCoalesce->ucPolicy = ucPolicy;
+	pxCoalesce->usParam = usParam;
+	vZwaveFrameReset(&pxCoalesce->xParser);
+	pxCoalesce->usHeld = 0;
+	pxCoalesce->usComplete = 0;
+	pxCoalesce->usDue = 0;
+	pxCoalesce->xOldest = 0;
+}
+
+
+void vZwaveCoalesceSetPolicy( xZwaveCoalesce *pxCoalesce, unsigned portCHAR ucPolicy, unsigned portSHORT usParam )
+{
+	pxCoalesce->ucPolicy = ucPolicy;
+	pxCoalesce->usParam = usParam;
+}
+
+
+void vZwaveCoalesceAdd( xZwaveCoalesce *pxCoalesce, unsigned portCHAR ucByte )
+{
+	if (pxCoalesce->usHeld == 0)
+		pxCoalesce->xOldest = xTaskGetTickCount();
+	pxCoalesce->usHeld++;
+	/* Whatever the policy: a switch to FRAME finds the parser in step. */
+	if (xZwaveFrameByte(&pxCoalesce->xParser, ucByte))
+		pxCoalesce->usComplete = pxCoalesce->usHeld;
+}
+
+
+unsigned portSHORT usZwaveCoalesceReady( xZwaveCoalesce *pxCoalesce, unsigned portSHORT usSize )
+{
+	unsigned portSHORT usReady = 0;
+
+	if (pxCoalesce->usHeld == 0)
+		return 0;
+
+	if (pxCoalesce->usHeld >= usSize
+			|| (xTaskGetTickCount() - pxCoalesce->xOldest) >= zwaveCOALESCE_MAX_DELAY){
+		usReady = pxCoalesce->usHeld;
+	}else{
+		switch (pxCoalesce->ucPolicy)
+		{
+		case zwaveCOALESCE_FRAME:
+			usReady = pxCoalesce->usComplete;
+			break;
+		case zwaveCOALESCE_SIZE:
+			if (pxCoalesce->usHeld >= pxCoalesce->usParam)
+				usReady = pxCoalesce->usHeld;
+			break;
+		case zwaveCOALESCE_GAP:
+			if (ulZwaveCoalesceIdle() >= pxCoalesce->usParam)
+				usReady = pxCoalesce->usHeld;
+			break;
+		default:
+			usReady = pxCoalesce->usHeld;
+			break;
+		}
+	}
+
+	/* Once released, bytes stay due until sent: a partial write does not
+	put a SIZE or GAP flush back on hold. */
+	if (usReady > pxCoalesce->usDue)
+		pxCoalesce->usDue = usReady;
+	return pxCoalesce->usDue;
+}
+
+
+void vZwaveCoalesceSent( xZwaveCoalesce *pxCoalesce, unsigned portSHORT usLength )
+{
+	if (usLength > pxCoalesce->usHeld)
+		usLength = pxCoalesce->usHeld;
+	pxCoalesce->usHeld -= usLength;
+	pxCoalesce->usDue = (pxCoalesce->usDue > usLength) ? pxCoalesce->usDue - usLength : 0;
+	pxCoalesce->usComplete = (pxCoalesce->usComplete > usLength) ? pxCoalesce->usComplete - usLength : 0;
+	/* xOldest is kept for what is left: at worst sent a bit early. */
+}
+
+
+portTickType xZwaveCoalesceWait( const xZwaveCoalesce *pxCoalesce )
+{
+	portTickType xElapsed, xWait, xGap;
+	unsigned portLONG ulIdle;
+
+	if (pxCoalesce->usHeld == 0)
+		return portMAX_DELAY;
+	if (pxCoalesce->usDue > 0)
+		return 1;
+
+	xElapsed = xTaskGetTickCount() - pxCoalesce->xOldest;
+	if (xElapsed >= zwaveCOALESCE_MAX_DELAY)
+		return 1;
+	xWait = zwaveCOALESCE_MAX_DELAY - xElapsed;
+
+	if (pxCoalesce->ucPolicy == zwaveCOALESCE_GAP){
+		ulIdle = ulZwaveCoalesceIdle();
+		xGap = (ulIdle < pxCoalesce->usParam)
+			? (pxCoalesce->usParam - ulIdle + 1000 * portTICK_RATE_MS - 1) / (1000 * portTICK_RATE_MS)
+			: 1;
+		if (xGap < xWait)
+			xWait = xGap;
+	}
+	return (xWait > 0) ? xWait : 1;
+}
@@ -0,0 +1,138 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Decides when the bytes of the Z-Wave module, held by a connection on
+ *        their way to the network, are sent.
+ *
+ * One xZwaveCoalesce per connection, with its own policy, which may change
+ * while bytes are held (vZwaveCoalesceSetPolicy()):
+ * - zwaveCOALESCE_NONE: as soon as they are there (one segment per read of
+ *   usart_recv_queue).
+ * - zwaveCOALESCE_FRAME: up to the end of the last complete Serial API frame,
+ *   a frame is never split across segments. For interactive use.
+ * - zwaveCOALESCE_SIZE: once usParam bytes are held. For bulk transfers.
+ * - zwaveCOALESCE_GAP: once the serial line was idle for usParam us, the end
+ *   of a burst of the module.
+ * Whatever the policy, the bytes are sent once the buffer of the connection
+ * is full or the oldest one waited zwaveCOALESCE_MAX_DELAY.
+ *
+ * The idle time of the serial line is measured with TC channel
+ * zwaveCOALESCE_TC_CHANNEL, from the time stamp the USART interrupt takes
+ * for every byte it receives: the end of its stop bit, however late the
+ * serial task drains it.
+ *
+ *****************************************************************************/
+
+#ifndef ZWAVE_COALESCE_H
+#define ZWAVE_COALESCE_H
+
+#include "portmacro.h"
+
+#include "ZWaveFrame.h"
+
+
+/*! \name Coalescing policies
+ */
+//! @{
+#define zwaveCOALESCE_NONE	( 0 )
+#define zwaveCOALESCE_FRAME	( 1 )
+#define zwaveCOALESCE_SIZE	( 2 )
+#define zwaveCOALESCE_GAP	( 3 )
+//! @}
+
+/*! Longest time a byte is held, in ticks: the Serial API byte timeout. */
+#define zwaveCOALESCE_MAX_DELAY	( 150 / portTICK_RATE_MS )
+
+/*! TC channel counting the idle time of the serial line. Channel
+    configTICK_TC_CHANNEL is the tick when configTICK_USE_TC is 1. */
+#define zwaveCOALESCE_TC_CHANNEL	( 0 )
+
+/*! The channel counts PBA / zwaveCOALESCE_TC_DIVIDER (TIMER_CLOCK4): 0.75 MHz
+    at 24 MHz, 87 ms before the 16 bit counter wraps. */
+#define zwaveCOALESCE_TC_DIVIDER	( 32 )
+
+/*! Coalescing state of a connection. */
+typedef struct
+{
+	unsigned portCHAR ucPolicy;	/*!< zwaveCOALESCE_NONE, FRAME, SIZE or GAP. */
+	unsigned portSHORT usParam;	/*!< Bytes for SIZE, us for GAP. */
+	xZwaveFrameParser xParser;	/*!< Frame boundaries of the held bytes, whatever the policy. */
+	unsigned portSHORT usHeld;	/*!< Bytes added and not sent yet. */
+	unsigned portSHORT usComplete;	/*!< Of the held bytes, those up to the last frame end. */
+	unsigned portSHORT usDue;	/*!< Of the held bytes, those already released. */
+	portTickType xOldest;		/*!< Time the oldest held byte was added. */
+} xZwaveCoalesce;
+
+
+/*! \brief Starts the TC channel: to be called once by the serial task before
+ *         enables the USART interrupt.
+ *
+ */
+void vZwaveCoalesceTimerInit( void );
+
+/*! \brief Takes the time stamp of a byte received from the Z-Wave module: to
+ *         be called by the USART interrupt (INT2, above the tick) on RXRDY.
+ *
+ */
+void vZwaveCoalesceStampFromISR( void );
+
+/*! \brief Time since the last byte received from the Z-Wave module.
+ *
+ *  \return The idle time in us, 0xFFFFFFFF if more than the counter can tell.
+ */
+unsigned portLONG ulZwaveCoalesceIdle( void );
+
+/*! \brief Sets the policy of a connection, nothing held.
+ *
+ *  \param pxCoalesce   Output. The coalescing state.
+ *  \param ucPolicy     Input. zwaveCOALESCE_NONE, FRAME, SIZE or GAP.
+ *  \param usParam      Input. Bytes for SIZE, us for GAP, not used otherwise.
+ *
+ */
+void vZwaveCoalesceInit( xZwaveCoalesce *pxCoalesce, unsigned portCHAR ucPolicy, unsigned portSHORT usParam );
+
+/*! \brief Changes the policy of a connection. The held bytes stay, the ones
+ *         already released stay due.
+ *
+ *  \param pxCoalesce   Input/Output. The coalescing state.
+ *  \param ucPolicy     Input. zwaveCOALESCE_NONE, FRAME, SIZE or GAP.
+ *  \param usParam      Input. Bytes for SIZE, us for GAP, not used otherwise.
+ *
+ */
+void vZwaveCoalesceSetPolicy( xZwaveCoalesce *pxCoalesce, unsigned portCHAR ucPolicy, unsigned portSHORT usParam );
+
+/*! \brief Accounts for a byte put after the held ones.
+ *
+ *  \param pxCoalesce   Input/Output. The coalescing state.
+ *  \param ucByte       Input. The byte.
+ *
+ */
+void vZwaveCoalesceAdd( xZwaveCoalesce *pxCoalesce, unsigned portCHAR ucByte );
+
+/*! \brief How many of the held bytes are to be sent now.
+ *
+ *  \param pxCoalesce   Input/Output. The coalescing state.
+ *  \param usSize       Input. Size of the buffer of the held bytes: they are
+ *                      all released once it is full.
+ *
+ *  \return The number of bytes, from the oldest, 0 to keep holding them.
+ */
+unsigned portSHORT usZwaveCoalesceReady( xZwaveCoalesce *pxCoalesce, unsigned portSHORT usSize );
+
+/*! \brief Accounts for held bytes sent, from the oldest.
+ *
+ *  \param pxCoalesce   Input/Output. The coalescing state.
+ *  \param usLength     Input. The number of bytes.
+ *
+ */
+void vZwaveCoalesceSent( xZwaveCoalesce *pxCoalesce, unsigned portSHORT usLength );
+
+/*! \brief Time after which the held bytes may be due, to bound a wait.
+ *
+ *  \param pxCoalesce   Input. The coalescing state.
+ *
+ *  \return The time in ticks, at least 1; portMAX_DELAY if nothing is held.
+ */
+portTickType xZwaveCoalesceWait( const xZwaveCoalesce *pxCoalesce );
+
+#endif
@@ -0,0 +1,199 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Control of the Z-Wave bridge over UDP, run by the lwIP task.
+ *
+ * Every request is answered at once from the lwIP task, on the raw UDP API:
+ * what belongs to a task of its own (the session of the netconn bridge) is
+ * only posted to it. The requests carry no credentials: those from outside
+ * the subnet of the board are dropped unanswered.
+ *
+ *****************************************************************************/
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* lwIP includes. */
+#include "lwip/udp.h"
+#include "lwip/pbuf.h"
+#include "lwip/netif.h"
+
+#include "conf_lwip_threads.h"
+#include "SERIAL/uart_task.h"
+#include "ZWaveTCP.h"
+#include "ZWaveCoalesce.h"
+#include "ZWaveControl.h"
+
+
+#if ( zwaveCONTROL == 1 )
+
+#if !LWIP_UDP
+#error zwaveCONTROL requires LWIP_UDP
+#endif
+
+/*! Longest request and answer. */
+#define zwaveCONTROL_MAX_SIZE	( 18 )
+
+static struct udp_pcb *pxZwaveControlPcb = NULL;
+
+static void prvZwaveControlRecv( void *pvArg, struct udp_pcb *pxPcb, struct pbuf *pxP, struct ip_addr *pxAddr, u16_t usPort );
+
+
+void vZwaveControlInit( void *pvParameters )
+{
+	( void ) pvParameters;
+
+	pxZwaveControlPcb = udp_new();
+	if (pxZwaveControlPcb == NULL)
+		return;
+	if (udp_bind(pxZwaveControlPcb, IP_ADDR_ANY, zwaveCONTROL_PORT) != ERR_OK){
+		udp_remove(pxZwaveControlPcb);
+		pxZwaveControlPcb = NULL;
+		return;
+	}
+	udp_recv(pxZwaveControlPcb, prvZwaveControlRecv, NULL);
+}
+
+
+/*! \brief zwaveCONTROL_COALESCE.
+ *
+ *  \return The status of the answer.
+ */
+static u8_t prvZwaveControlCoalesce( const u8_t *pucRequest, u16_t usLength )
+{
+	if (usLength != 4 || pucRequest[1] > zwaveCOALESCE_GAP)
+		return zwaveCONTROL_BAD_REQUEST;
+#if ( zwaveBRIDGE_API == zwaveBRIDGE_NETCONN )
+	if (!xZwaveSetCoalescing(pucRequest[1], (pucRequest[2] << 8) | pucRequest[3]))
+		return zwaveCONTROL_NO_SESSION;
+	return zwaveCONTROL_OK;
+#else
+	return zwaveCONTROL_UNSUPPORTED;
+#endif
+}
+
+
+/*! \brief Writes a big endian 32 bit value. */
+static void prvZwaveControlPut32( u8_t *pucAnswer, u32_t ulValue )
+{
+	pucAnswer[0] = (u8_t)(ulValue >> 24);
+	pucAnswer[1] = (u8_t)(ulValue >> 16);
+	pucAnswer[2] = (u8_t)(ulValue >> 8);
+	pucAnswer[3] = (u8_t)ulValue;
+}
+
+
+/*! \brief zwaveCONTROL_LOAD. Run by the lwIP task: the counters of the other
+ *         tasks are up to date, they were switched out.
+ *
+ *  \param pusAnswer   Input/Output. The length of the answer.
+ *
+ *  \return The status of the answer.
+ */
+static u8_t prvZwaveControlLoad( u16_t usLength, u8_t *pucAnswer, u16_t *pusAnswer )
+{
+	if (usLength != 1)
+		return zwaveCONTROL_BAD_REQUEST;
+#if ( configGENERATE_RUN_TIME_STATS == 1 ) && ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+	{
+		unsigned long long ullTask, ullInterrupt;
+
+		prvZwaveControlPut32(pucAnswer + *pusAnswer, portGET_RUN_TIME_COUNTER_VALUE());
+		prvZwaveControlPut32(pucAnswer + *pusAnswer + 4, (u32_t)ullTaskGetRunTimeCounter(xTaskGetIdleTaskHandle()));
+		vSerialGetRunTime(&ullTask, &ullInterrupt);
+		prvZwaveControlPut32(pucAnswer + *pusAnswer + 8, (u32_t)ullTask);
+		prvZwaveControlPut32(pucAnswer + *pusAnswer + 12, (u32_t)ullInterrupt);
+		*pusAnswer += 16;
+		return zwaveCONTROL_OK;
+	}
+#else
+	( void ) pucAnswer;
+	( void ) pusAnswer;
+	return zwaveCONTROL_UNSUPPORTED;
+#endif
+}
+
+
+/*! \brief zwaveCONTROL_BAUD.
+ *
+ *  \param pusAnswer   Input/Output. The length of the answer.
+ *
+ *  \return The status of the answer.
+ */
+static u8_t prvZwaveControlBaud( const u8_t *pucRequest, u16_t usLength, u8_t *pucAnswer, u16_t *pusAnswer )
+{
+	u32_t ulBaudrate;
+	signed portSHORT sError;
+
+	if (usLength != 1 && usLength != 5)
+		return zwaveCONTROL_BAD_REQUEST;
+	if (usLength == 5){
+		ulBaudrate = ((u32_t)pucRequest[1] << 24) | ((u32_t)pucRequest[2] << 16) | ((u32_t)pucRequest[3] << 8) | pucRequest[4];
+		if (ulSerialBaudrateFor(ulBaudrate, &sError) == 0
+				|| sError > serialBAUDRATE_TOLERANCE || sError < -serialBAUDRATE_TOLERANCE)
+			return zwaveCONTROL_BAD_REQUEST;
+		// Not waiting for the transmitter: it only fails if it is busy.
+		if (xSerialSetBaudrate(ulBaudrate, 0) != pdPASS)
+			return zwaveCONTROL_BUSY;
+	}
+
+	prvZwaveControlPut32(pucAnswer + *pusAnswer, ulSerialGetBaudrateSetPoint());
+	prvZwaveControlPut32(pucAnswer + *pusAnswer + 4, ulSerialGetBaudrate(&sError));
+	pucAnswer[*pusAnswer + 8] = (u8_t)((u16_t)sError >> 8);
+	pucAnswer[*pusAnswer + 9] = (u8_t)sError;
+	*pusAnswer += 10;
+	return zwaveCONTROL_OK;
+}
+
+
+static void prvZwaveControlRecv( void *pvArg, struct udp_pcb *pxPcb, struct pbuf *pxP, struct ip_addr *pxAddr, u16_t usPort )
+{
+	u8_t pucRequest[ zwaveCONTROL_MAX_SIZE ];
+	u8_t pucAnswer[ zwaveCONTROL_MAX_SIZE ];
+	u16_t usLength, usAnswer = 2;
+	struct pbuf *pxAnswer;
+
+	( void ) pvArg;
+
+	/* Not from the subnet: dropped, the sender learns nothing. */
+	if (netif_default == NULL || !ip_addr_netcmp(pxAddr, &netif_default->ip_addr, &netif_default->netmask)){
+		pbuf_free(pxP);
+		return;
+	}
+
+	usLength = pxP->tot_len;
+	if (usLength > sizeof(pucRequest))
+		usLength = 0;
+	else
+		pbuf_copy_partial(pxP, pucRequest, usLength, 0);
+	pbuf_free(pxP);
+	if (usLength == 0)
+		return;
+
+	pucAnswer[0] = pucRequest[0];
+	switch (pucRequest[0])
+	{
+	case zwaveCONTROL_COALESCE:
+		pucAnswer[1] = prvZwaveControlCoalesce(pucRequest, usLength);
+		break;
+	case zwaveCONTROL_LOAD:
+		pucAnswer[1] = prvZwaveControlLoad(usLength, pucAnswer, &usAnswer);
+		break;
+	case zwaveCONTROL_BAUD:
+		pucAnswer[1] = prvZwaveControlBaud(pucRequest, usLength, pucAnswer, &usAnswer);
+		break;
+	default:
+		pucAnswer[1] = zwaveCONTROL_BAD_REQUEST;
+		break;
+	}
+
+	pxAnswer = pbuf_alloc(PBUF_TRANSPORT, usAnswer, PBUF_RAM);
+	if (pxAnswer == NULL)
+		return;
+	pbuf_take(pxAnswer, pucAnswer, usAnswer);
+	udp_sendto(pxPcb, pxAnswer, pxAddr, usPort);
+	pbuf_free(pxAnswer);
+}
+
+#endif /* zwaveCONTROL */
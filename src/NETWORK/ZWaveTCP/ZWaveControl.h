@@ -0,0 +1,64 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Control of the Z-Wave bridge over UDP, run by the lwIP task.
+ *
+ * A request is one datagram to zwaveCONTROL_PORT: a command, then its
+ * arguments (big endian). The answer goes back to the sender: the command,
+ * a status, then the results (big endian). There is no authentication: only
+ * the requests from the subnet of the board are taken, the others are
+ * dropped unanswered. The service is off by default (zwaveCONTROL).
+ * - zwaveCONTROL_COALESCE, policy (8 bits), parameter (16 bits): sets the
+ *   coalescing policy of the open Z-Wave connection (ZWaveCoalesce.h) until
+ *   it ends; the next one starts with zwaveCOALESCE_POLICY again. No
+ *   results. Only for zwaveBRIDGE_NETCONN, the one bridge that coalesces.
+ * - zwaveCONTROL_LOAD, no arguments: the run time counter now, then the run
+ *   time of the idle task, of the serial task and of the USART interrupt,
+ *   32 bits each, in run time counter increments (CPU cycles), modulo 2^32.
+ *   Two answers give the CPU load in between: 1 - delta idle / delta now,
+ *   and the share of the serial path. Needs configGENERATE_RUN_TIME_STATS.
+ * - zwaveCONTROL_BAUD, optionally a baud rate (32 bits): switches the serial
+ *   port of the Z-Wave module to that rate (xSerialSetBaudrate()), the
+ *   module being switched too by the controller. Results, whether a rate is
+ *   given or not: the set point (32 bits), the rate the USART generates for
+ *   it (32 bits) and its error (signed 16 bits, 0.01 %). A rate out of range
+ *   or beyond serialBAUDRATE_TOLERANCE is zwaveCONTROL_BAD_REQUEST; while the
+ *   USART still sends, zwaveCONTROL_BUSY: the lwIP task never waits for it.
+ *
+ *****************************************************************************/
+
+#ifndef ZWAVE_CONTROL_H
+#define ZWAVE_CONTROL_H
+
+
+/*! UDP port of the requests. */
+#define zwaveCONTROL_PORT	( 4124 )
+
+/*! \name Commands
+ */
+//! @{
+#define zwaveCONTROL_COALESCE	( 0x01 )
+#define zwaveCONTROL_LOAD	( 0x02 )
+#define zwaveCONTROL_BAUD	( 0x03 )
+//! @}
+
+/*! \name Status of an answer
+ */
+//! @{
+#define zwaveCONTROL_OK			( 0x00 )
+#define zwaveCONTROL_BAD_REQUEST	( 0x01 )	/*!< Unknown command, bad length or bad argument. */
+#define zwaveCONTROL_NO_SESSION		( 0x02 )	/*!< No Z-Wave connection open. */
+#define zwaveCONTROL_UNSUPPORTED	( 0x03 )	/*!< Not with this zwaveBRIDGE_API or configuration. */
+#define zwaveCONTROL_BUSY		( 0x04 )	/*!< Not now, to be sent again. */
+//! @}
+
+
+/*! \brief Sets up the control pcb. Must run in the lwIP task: started with
+ *         tcpip_callback().
+ *
+ *  \param pvParameters   Input. Not Used.
+ *
+ */
+void vZwaveControlInit( void *pvParameters );
+
+#endif
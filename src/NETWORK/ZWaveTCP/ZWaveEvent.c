@@ -0,0 +1,396 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Publishes the unsolicited frames of the Z-Wave module to a multicast
+ *        group, with a replay service over TCP.
+ *
+ * The serial task hands every received byte to vZwaveEventByte(), which cuts
+ * the stream into frames and stores the unsolicited ones in the replay ring.
+ * The lwIP task does the rest on the raw API, through tcpip_callback(): one
+ * datagram per event, whatever the number of listeners, and the replays.
+ * The ring is shared by the two tasks under vTaskSuspendAll().
+ *
+ *****************************************************************************/
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* lwIP includes. */
+#include "lwip/udp.h"
+#include "lwip/tcp.h"
+#include "lwip/igmp.h"
+#include "lwip/tcpip.h"
+#include "lwip/pbuf.h"
+
+#include "conf_lwip_threads.h"
+#include "ZWaveFrame.h"
+#include "ZWaveEvent.h"
+
+
+#if ( zwaveEVENT_MULTICAST == 1 )
+
+#if !LWIP_UDP || !LWIP_IGMP
+#error zwaveEVENT_MULTICAST requires LWIP_UDP and LWIP_IGMP
+#endif
+
+#if ( zwaveEVENT_RING_SIZE & ( zwaveEVENT_RING_SIZE - 1 ) )
+#error zwaveEVENT_RING_SIZE must be a power of 2
+#endif
+
+/*! Ring record: sequence number (32 bits), frame length (16 bits), frame. */
+#define zwaveEVENT_RECORD_HEADER	( 6 )
+
+/*! \name Unsolicited requests of the Z-Wave module
+ */
+//! @{
+#define zwaveEVENT_TYPE_REQUEST		( 0x00 )
+#define zwaveEVENT_FUNC_APPLICATION_COMMAND	( 0x04 )	/*!< ApplicationCommandHandler. */
+#define zwaveEVENT_FUNC_APPLICATION_UPDATE	( 0x49 )	/*!< Node information, node added or removed. */
+#define zwaveEVENT_FUNC_APPLICATION_COMMAND_BRIDGE	( 0xA8 )	/*!< ApplicationCommandHandler of a bridge controller. */
+//! @}
+
+/*! Replay poll callback period, in TCP coarse timer periods (500ms). */
+#define zwaveEVENT_REPLAY_POLL		( 4 )
+
+/*! Poll periods after which a replay connection is closed, done or not. */
+#define zwaveEVENT_REPLAY_POLLS		( 5 )
+
+/*! The events, from ulZwaveEventTail to ulZwaveEventHead. Both count bytes
+    since the start and only grow: the ring index is their low bits. */
+static unsigned portCHAR pucZwaveEventRing[ zwaveEVENT_RING_SIZE ];
+static unsigned portLONG ulZwaveEventHead = 0;
+static unsigned portLONG ulZwaveEventTail = 0;
+
+/*! Sequence number of the next event. */
+static unsigned portLONG ulZwaveEventNextSeq = 0;
+
+/*! Frame being received, serial task side. */
+static unsigned portCHAR pucZwaveEventFrame[ zwaveFRAME_MAX_SIZE ];
+static unsigned portSHORT usZwaveEventFrameLength = 0;
+static xZwaveFrameParser xZwaveEventParser;
+
+/*! A record copied out of the ring, lwIP task side. */
+static unsigned portCHAR pucZwaveEventRecord[ zwaveEVENT_RECORD_HEADER + zwaveFRAME_MAX_SIZE ];
+
+/*! Ring position of the next event to publish. */
+static unsigned portLONG ulZwaveEventPublished = 0;
+
+static struct udp_pcb *pxZwaveEventPcb = NULL;
+static struct ip_addr xZwaveEventGroup;
+
+/*! Replay service: the listener and the one replay served at a time. */
+static struct tcp_pcb *pxZwaveEventListener = NULL;
+static struct tcp_pcb *pxZwaveEventReplayPcb = NULL;
+
+/*! First sequence number asked for, as received so far. */
+static unsigned portCHAR pucZwaveEventRequest[ 4 ];
+static unsigned portSHORT usZwaveEventRequestLength;
+
+/*! Ring position of the next event of the replay. */
+static unsigned portLONG ulZwaveEventReplayIndex;
+
+/*! Poll periods the replay connection has been open for. */
+static unsigned portCHAR ucZwaveEventReplayPolls;
+
+/*! pdTRUE while a prvZwaveEventService() call is queued to the lwIP task. */
+static volatile portBASE_TYPE xZwaveEventKickPending = pdFALSE;
+
+static err_t prvZwaveEventAccept( void *pvArg, struct tcp_pcb *pxPcb, err_t xErr );
+
+
+/*! \brief Copies bytes out of the ring. */
+static void prvZwaveEventRingRead( unsigned portLONG ulIndex, unsigned portCHAR *pucTo, unsigned portSHORT usLength )
+{
+	while (usLength-- > 0)
+		*pucTo++ = pucZwaveEventRing[ulIndex++ & (zwaveEVENT_RING_SIZE - 1)];
+}
+
+
+/*! \brief Copies bytes into the ring. */
+static void prvZwaveEventRingWrite( unsigned portLONG ulIndex, const unsigned portCHAR *pucFrom, unsigned portSHORT usLength )
+{
+	while (usLength-- > 0)
+		pucZwaveEventRing[ulIndex++ & (zwaveEVENT_RING_SIZE - 1)] = *pucFrom++;
+}
+
+
+/*! \brief Copies the event at *pulIndex to pucZwaveEventRecord, or the oldest
+ *         one if it was overwritten meanwhile, and moves *pulIndex past it.
+ *
+ *  \return Length of the record, 0 if there is no event there yet.
+ */
+static unsigned portSHORT prvZwaveEventFetch( unsigned portLONG *pulIndex )
+{
+	unsigned portSHORT usLength = 0;
+
+	vTaskSuspendAll();
+	if ((portLONG)(*pulIndex - ulZwaveEventTail) < 0)
+		*pulIndex = ulZwaveEventTail;
+	if (*pulIndex != ulZwaveEventHead){
+		prvZwaveEventRingRead(*pulIndex, pucZwaveEventRecord, zwaveEVENT_RECORD_HEADER);
+		usLength = (pucZwaveEventRecord[4] << 8) | pucZwaveEventRecord[5];
+		prvZwaveEventRingRead(*pulIndex + zwaveEVENT_RECORD_HEADER, pucZwaveEventRecord + zwaveEVENT_RECORD_HEADER, usLength);
+		usLength += zwaveEVENT_RECORD_HEADER;
+		*pulIndex += usLength;
+	}
+	xTaskResumeAll();
+
+	return usLength;
+}
+
+
+/*! \brief Sends the events not published yet to the group.
+ */
+static void prvZwaveEventPublish( void )
+{
+	struct pbuf *pxP;
+	unsigned portSHORT usLength;
+
+	while ((usLength = prvZwaveEventFetch(&ulZwaveEventPublished)) > 0){
+		/* Sequence number and frame: the length is the datagram's. */
+		pxP = pbuf_alloc(PBUF_TRANSPORT, usLength - 2, PBUF_RAM);
+		if (pxP == NULL)
+			continue;
+		memcpy(pxP->payload, pucZwaveEventRecord, 4);
+		memcpy((unsigned portCHAR *)pxP->payload + 4, pucZwaveEventRecord + zwaveEVENT_RECORD_HEADER,
+				usLength - zwaveEVENT_RECORD_HEADER);
+		udp_sendto(pxZwaveEventPcb, pxP, &xZwaveEventGroup, zwaveEVENT_PORT);
+		pbuf_free(pxP);
+	}
+}
+
+
+/*! \brief Closes the replay connection.
+ *
+ *  \return ERR_ABRT if the pcb had to be aborted.
+ */
+static err_t prvZwaveEventReplayClose( struct tcp_pcb *pxPcb )
+{
+	tcp_recv(pxPcb, NULL);
+	tcp_sent(pxPcb, NULL);
+	tcp_poll(pxPcb, NULL, 0);
+	tcp_err(pxPcb, NULL);
+	pxZwaveEventReplayPcb = NULL;
+
+	if (tcp_close(pxPcb) != ERR_OK){
+		tcp_abort(pxPcb);
+		return ERR_ABRT;
+	}
+	return ERR_OK;
+}
+
+
+/*! \brief Writes the events asked for, as far as the send buffer takes them,
+ *         and closes the connection after the last one.
+ */
+static err_t prvZwaveEventReplay( struct tcp_pcb *pxPcb )
+{
+	unsigned portLONG ulFirst, ulNext;
+	unsigned portSHORT usLength;
+
+	ulFirst = ((unsigned portLONG)pucZwaveEventRequest[0] << 24) | ((unsigned portLONG)pucZwaveEventRequest[1] << 16)
+			| ((unsigned portLONG)pucZwaveEventRequest[2] << 8) | pucZwaveEventRequest[3];
+
+	for (;;){
+		ulNext = ulZwaveEventReplayIndex;
+		usLength = prvZwaveEventFetch(&ulNext);
+		if (usLength == 0){
+			tcp_output(pxPcb);
+			return prvZwaveEventReplayClose(pxPcb);
+		}
+		/* Older than asked for: skipped. */
+		if ((portLONG)((((unsigned portLONG)pucZwaveEventRecord[0] << 24) | ((unsigned portLONG)pucZwaveEventRecord[1] << 16)
+				| ((unsigned portLONG)pucZwaveEventRecord[2] << 8) | pucZwaveEventRecord[3]) - ulFirst) >= 0){
+			/* Not taken: sent again by prvZwaveEventSent(). */
+			if (usLength > tcp_sndbuf(pxPcb) || tcp_write(pxPcb, pucZwaveEventRecord, usLength, TCP_WRITE_FLAG_COPY) != ERR_OK)
+				break;
+		}
+		ulZwaveEventReplayIndex = ulNext;
+	}
+	tcp_output(pxPcb);
+	return ERR_OK;
+}
+
+
+static err_t prvZwaveEventRecv( void *pvArg, struct tcp_pcb *pxPcb, struct pbuf *pxP, err_t xErr )
+{
+	unsigned portSHORT usCopied;
+
+	( void ) pvArg;
+	( void ) xErr;
+
+	if (pxP == NULL)
+		return prvZwaveEventReplayClose(pxPcb);
+
+	/* Only the 4 bytes of the request count, the rest is ignored. */
+	if (usZwaveEventRequestLength < sizeof(pucZwaveEventRequest)){
+		usCopied = pbuf_copy_partial(pxP, pucZwaveEventRequest + usZwaveEventRequestLength,
+				sizeof(pucZwaveEventRequest) - usZwaveEventRequestLength, 0);
+		usZwaveEventRequestLength += usCopied;
+		if (usZwaveEventRequestLength == sizeof(pucZwaveEventRequest)){
+			tcp_recved(pxPcb, pxP->tot_len);
+			pbuf_free(pxP);
+			return prvZwaveEventReplay(pxPcb);
+		}
+	}
+	tcp_recved(pxPcb, pxP->tot_len);
+	pbuf_free(pxP);
+	return ERR_OK;
+}
+
+
+static err_t prvZwaveEventSent( void *pvArg, struct tcp_pcb *pxPcb, u16_t usLength )
+{
+	( void ) pvArg;
+	( void ) usLength;
+
+	if (usZwaveEventRequestLength < sizeof(pucZwaveEventRequest))
+		return ERR_OK;
+	return prvZwaveEventReplay(pxPcb);
+}
+
+
+static err_t prvZwaveEventPoll( void *pvArg, struct tcp_pcb *pxPcb )
+{
+	( void ) pvArg;
+
+	/* Silent, or not reading what it asked for. */
+	if (++ucZwaveEventReplayPolls >= zwaveEVENT_REPLAY_POLLS)
+		return prvZwaveEventReplayClose(pxPcb);
+	return ERR_OK;
+}
+
+
+static void prvZwaveEventError( void *pvArg, err_t xErr )
+{
+	( void ) pvArg;
+	( void ) xErr;
+
+	/* The pcb is already freed. */
+	pxZwaveEventReplayPcb = NULL;
+}
+
+
+static err_t prvZwaveEventAccept( void *pvArg, struct tcp_pcb *pxPcb, err_t xErr )
+{
+	( void ) pvArg;
+	( void ) xErr;
+
+	tcp_accepted(pxZwaveEventListener);
+
+	/* One replay at a time: the stack aborts the refused pcb. */
+	if (pxZwaveEventReplayPcb != NULL)
+		return ERR_MEM;
+
+	pxZwaveEventReplayPcb = pxPcb;
+	usZwaveEventRequestLength = 0;
+	ucZwaveEventReplayPolls = 0;
+	ulZwaveEventReplayIndex = ulZwaveEventTail;
+	tcp_arg(pxPcb, NULL);
+	tcp_recv(pxPcb, prvZwaveEventRecv);
+	tcp_sent(pxPcb, prvZwaveEventSent);
+	tcp_poll(pxPcb, prvZwaveEventPoll, zwaveEVENT_REPLAY_POLL);
+	tcp_err(pxPcb, prvZwaveEventError);
+	return ERR_OK;
+}
+
+
+void vZwaveEventInit( void *pvParameters )
+{
+	struct tcp_pcb *pxPcb;
+
+	( void ) pvParameters;
+
+	IP4_ADDR(&xZwaveEventGroup, zwaveEVENT_GROUP_ADDR0, zwaveEVENT_GROUP_ADDR1,
+			zwaveEVENT_GROUP_ADDR2, zwaveEVENT_GROUP_ADDR3);
+
+	/* Joined so that IGMP snooping switches and routers know the group. */
+	igmp_joingroup(IP_ADDR_ANY, &xZwaveEventGroup);
+
+	pxZwaveEventPcb = udp_new();
+	if (pxZwaveEventPcb != NULL)
+		pxZwaveEventPcb->ttl = zwaveEVENT_TTL;
+
+	pxPcb = tcp_new();
+	if (pxPcb == NULL)
+		return;
+	if (tcp_bind(pxPcb, IP_ADDR_ANY, zwaveEVENT_PORT) != ERR_OK){
+		tcp_close(pxPcb);
+		return;
+	}
+	pxZwaveEventListener = tcp_listen(pxPcb);
+	if (pxZwaveEventListener != NULL)
+		tcp_accept(pxZwaveEventListener, prvZwaveEventAccept);
+}
+
+
+/*! \brief tcpip_callback() function queued by prvZwaveEventStore().
+ */
+static void prvZwaveEventService( void *pvArg )
+{
+	( void ) pvArg;
+
+	xZwaveEventKickPending = pdFALSE;
+	if (pxZwaveEventPcb != NULL)
+		prvZwaveEventPublish();
+}
+
+
+/*! \brief Stores the frame just received as the next event and has the lwIP
+ *         task publish it.
+ */
+static void prvZwaveEventStore( void )
+{
+	unsigned portCHAR pucHeader[ zwaveEVENT_RECORD_HEADER ];
+	unsigned portLONG ulRecord = zwaveEVENT_RECORD_HEADER + usZwaveEventFrameLength;
+
+	vTaskSuspendAll();
+	/* Room made by dropping the oldest events. */
+	while (ulZwaveEventHead - ulZwaveEventTail + ulRecord > zwaveEVENT_RING_SIZE){
+		prvZwaveEventRingRead(ulZwaveEventTail, pucHeader, zwaveEVENT_RECORD_HEADER);
+		ulZwaveEventTail += zwaveEVENT_RECORD_HEADER + ((pucHeader[4] << 8) | pucHeader[5]);
+	}
+	pucHeader[0] = (unsigned portCHAR)(ulZwaveEventNextSeq >> 24);
+	pucHeader[1] = (unsigned portCHAR)(ulZwaveEventNextSeq >> 16);
+	pucHeader[2] = (unsigned portCHAR)(ulZwaveEventNextSeq >> 8);
+	pucHeader[3] = (unsigned portCHAR)ulZwaveEventNextSeq;
+	pucHeader[4] = (unsigned portCHAR)(usZwaveEventFrameLength >> 8);
+	pucHeader[5] = (unsigned portCHAR)usZwaveEventFrameLength;
+	prvZwaveEventRingWrite(ulZwaveEventHead, pucHeader, zwaveEVENT_RECORD_HEADER);
+	prvZwaveEventRingWrite(ulZwaveEventHead + zwaveEVENT_RECORD_HEADER, pucZwaveEventFrame, usZwaveEventFrameLength);
+	ulZwaveEventHead += ulRecord;
+	ulZwaveEventNextSeq++;
+	xTaskResumeAll();
+
+	/* One call queued at a time. If the mbox is full, this event goes with
+	the next one. */
+	if (!xZwaveEventKickPending){
+		xZwaveEventKickPending = pdTRUE;
+		if (tcpip_callback_with_block(prvZwaveEventService, NULL, 0) != ERR_OK)
+			xZwaveEventKickPending = pdFALSE;
+	}
+}
+
+
+void vZwaveEventByte( unsigned portCHAR ucByte )
+{
+	pucZwaveEventFrame[usZwaveEventFrameLength++] = ucByte;
+	if (!xZwaveFrameByte(&xZwaveEventParser, ucByte) && usZwaveEventFrameLength < zwaveFRAME_MAX_SIZE)
+		return;
+
+	/* SOF, LEN, type, function: an unsolicited request of the module. */
+	if (usZwaveEventFrameLength > 4 && pucZwaveEventFrame[0] == zwaveFRAME_SOF
+			&& pucZwaveEventFrame[2] == zwaveEVENT_TYPE_REQUEST
+			&& (pucZwaveEventFrame[3] == zwaveEVENT_FUNC_APPLICATION_COMMAND
+				|| pucZwaveEventFrame[3] == zwaveEVENT_FUNC_APPLICATION_UPDATE
+				|| pucZwaveEventFrame[3] == zwaveEVENT_FUNC_APPLICATION_COMMAND_BRIDGE))
+		prvZwaveEventStore();
+
+	usZwaveEventFrameLength = 0;
+}
+
+#endif /* zwaveEVENT_MULTICAST */
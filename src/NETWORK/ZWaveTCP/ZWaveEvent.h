@@ -0,0 +1,64 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Publishes the unsolicited frames of the Z-Wave module to a multicast
+ *        group, with a replay service over TCP.
+ *
+ * Every ApplicationCommandHandler and ApplicationUpdate request of the module
+ * gets a sequence number and is sent once to zwaveEVENT_GROUP, port
+ * zwaveEVENT_PORT, whatever the number of listeners: a UDP datagram of the
+ * sequence number (32 bits, big endian) followed by the frame.
+ * The last zwaveEVENT_RING_SIZE bytes of events are kept: a listener that
+ * sees a gap connects to zwaveEVENT_PORT over TCP and sends the first
+ * sequence number it wants (32 bits, big endian). It receives every event
+ * still kept from that one on, each as the sequence number (32 bits), the
+ * frame length (16 bits) and the frame, then the connection is closed.
+ *
+ *****************************************************************************/
+
+#ifndef ZWAVE_EVENT_H
+#define ZWAVE_EVENT_H
+
+#include "portmacro.h"
+
+
+/*! \name Event publishing parameters
+ */
+//! @{
+
+/*! The multicast group, 239.255.90.87 (organization local scope). */
+#define zwaveEVENT_GROUP_ADDR0	( 239 )
+#define zwaveEVENT_GROUP_ADDR1	( 255 )
+#define zwaveEVENT_GROUP_ADDR2	( 90 )
+#define zwaveEVENT_GROUP_ADDR3	( 87 )
+
+/*! UDP port of the events and TCP port of the replay service. */
+#define zwaveEVENT_PORT		( 4123 )
+
+/*! Bytes of events kept for replay, power of 2. Each event takes 6 bytes
+    more than its frame. */
+#define zwaveEVENT_RING_SIZE	( 1024 )
+
+/*! Multicast TTL: the events do not leave the site. */
+#define zwaveEVENT_TTL		( 4 )
+
+//! @}
+
+
+/*! \brief Sets up the multicast pcb, joins the group and starts the replay
+ *         service. Must run in the lwIP task: started with tcpip_callback().
+ *
+ *  \param pvParameters   Input. Not Used.
+ *
+ */
+void vZwaveEventInit( void *pvParameters );
+
+/*! \brief Feeds a byte received from the Z-Wave module: to be called by the
+ *         serial task for every byte, in order. Never blocks.
+ *
+ *  \param ucByte   Input. The byte.
+ *
+ */
+void vZwaveEventByte( unsigned portCHAR ucByte );
+
+#endif
@@ -0,0 +1,59 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Finds the Serial API frame boundaries in the byte stream of the
+ *        Z-Wave module.
+ *
+ *****************************************************************************/
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+
+#include "ZWaveFrame.h"
+
+
+/*! \name Delimiter states
+ */
+//! @{
+#define zwaveFRAME_STATE_IDLE	( 0 )	/*!< Between frames. */
+#define zwaveFRAME_STATE_LEN	( 1 )	/*!< SOF seen, LEN is next. */
+#define zwaveFRAME_STATE_BODY	( 2 )	/*!< ucRemaining bytes to come. */
+//! @}
+
+
+void vZwaveFrameReset( xZwaveFrameParser *pxParser )
+{
+	pxParser->ucState = zwaveFRAME_STATE_IDLE;
+	pxParser->ucRemaining = 0;
+}
+
+
+portBASE_TYPE xZwaveFrameByte( xZwaveFrameParser *pxParser, unsigned portCHAR ucByte )
+{
+	switch (pxParser->ucState)
+	{
+	case zwaveFRAME_STATE_LEN:
+		if (ucByte == 0){
+			/* Nothing can follow: a broken frame, ends here. */
+			pxParser->ucState = zwaveFRAME_STATE_IDLE;
+			return pdTRUE;
+		}
+		pxParser->ucRemaining = ucByte;
+		pxParser->ucState = zwaveFRAME_STATE_BODY;
+		return pdFALSE;
+
+	case zwaveFRAME_STATE_BODY:
+		if (--pxParser->ucRemaining > 0)
+			return pdFALSE;
+		pxParser->ucState = zwaveFRAME_STATE_IDLE;
+		return pdTRUE;
+
+	default:
+		if (ucByte == zwaveFRAME_SOF){
+			pxParser->ucState = zwaveFRAME_STATE_LEN;
+			return pdFALSE;
+		}
+		/* ACK, NAK, CAN, or a stray byte. */
+		return pdTRUE;
+	}
+}
@@ -0,0 +1,55 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Finds the Serial API frame boundaries in the byte stream of the
+ *        Z-Wave module.
+ *
+ * A data frame is SOF, LEN, then LEN bytes (type, function, data, checksum).
+ * ACK, NAK and CAN are one byte frames. Any other byte outside a data frame
+ * is taken as a one byte frame too, so that nothing is held back.
+ *
+ *****************************************************************************/
+
+#ifndef ZWAVE_FRAME_H
+#define ZWAVE_FRAME_H
+
+#include "portmacro.h"
+
+
+/*! \name Serial API frame bytes
+ */
+//! @{
+#define zwaveFRAME_SOF		( 0x01 )
+#define zwaveFRAME_ACK		( 0x06 )
+#define zwaveFRAME_NAK		( 0x15 )
+#define zwaveFRAME_CAN		( 0x18 )
+//! @}
+
+/*! Longest frame: SOF, LEN and 255 bytes. */
+#define zwaveFRAME_MAX_SIZE	( 257 )
+
+/*! Delimiter state, one per byte stream. */
+typedef struct
+{
+	unsigned portCHAR ucState;	/*!< Where in the frame the next byte is. */
+	unsigned portCHAR ucRemaining;	/*!< Bytes left in the data frame. */
+} xZwaveFrameParser;
+
+
+/*! \brief Starts over, the next byte begins a frame.
+ *
+ *  \param pxParser   Output. The delimiter state.
+ *
+ */
+void vZwaveFrameReset( xZwaveFrameParser *pxParser );
+
+/*! \brief Feeds a byte of the stream.
+ *
+ *  \param pxParser   Input/Output. The delimiter state.
+ *  \param ucByte     Input. The next byte of the stream.
+ *
+ *  \return pdTRUE if the byte ends a frame.
+ */
+portBASE_TYPE xZwaveFrameByte( xZwaveFrameParser *pxParser, unsigned portCHAR ucByte );
+
+#endif
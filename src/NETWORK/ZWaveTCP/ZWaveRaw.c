@@ -0,0 +1,325 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Z-Wave bridge server on the lwIP raw API, run by the lwIP task.
+ *
+ * Alternative to the netconn server of ZWaveTCP.c, selected by zwaveBRIDGE_API
+ * in conf_lwip_threads.h. The bridge is a set of tcp_* callbacks: no task of
+ * its own, no mbox message, semaphore and context switches per operation.
+ * - TCP to serial: prvZwaveRawRecv() puts the received bytes in
+ *   zw_tcp_recv_queue and opens the window for what the queue took; the rest
+ *   waits on the pcb side.
+ * - serial to TCP: the serial task calls vZwaveRawKick(), which has
+ *   prvZwaveRawService() run by the lwIP task through tcpip_callback(), to
+ *   move usart_recv_queue to the send buffer.
+ * The sent and poll callbacks resume both directions when room comes back.
+ *
+ *****************************************************************************/
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* lwIP includes. */
+#include "lwip/tcp.h"
+#include "lwip/tcpip.h"
+#include "lwip/pbuf.h"
+
+#include "ipc.h"
+#include "conf_lwip_threads.h"
+#include "ZWaveTCP.h"
+#include "ZWaveRaw.h"
+
+
+#if ( zwaveBRIDGE_API == zwaveBRIDGE_RAW )
+
+/*! Poll callback period, in TCP coarse timer periods (500ms). */
+#define zwaveRAW_POLL_INTERVAL	( 1 )
+
+/*! Serial bytes moved to the send buffer per tcp_write(). */
+#define zwaveRAW_SEND_CHUNK	( 100 )
+
+/*! The listening pcb. */
+static struct tcp_pcb *pxZwaveRawListener = NULL;
+
+/*! The pcb of the session, NULL when no controller is connected. */
+static struct tcp_pcb *pxZwaveRawPcb = NULL;
+
+/*! Received data zw_tcp_recv_queue did not take yet, from usZwaveRawRxOffset
+    in its first pbuf. */
+static struct pbuf *pxZwaveRawRx = NULL;
+static u16_t usZwaveRawRxOffset = 0;
+
+/*! Serial bytes taken from usart_recv_queue that the send buffer did not take
+    yet. */
+static portCHAR pcZwaveRawTx[ zwaveRAW_SEND_CHUNK ];
+static u16_t usZwaveRawTxLength = 0;
+
+/*! Time of the last byte in either direction. */
+static portTickType xZwaveRawLastActivity;
+
+/*! pdTRUE while a prvZwaveRawService() call is queued to the lwIP task. */
+static volatile portBASE_TYPE xZwaveRawKickPending = pdFALSE;
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+/*! Storage of the TCP to serial queue. */
+static unsigned char ucRawRecvQueueStorage[ queueSTATIC_STORAGE_SIZE( zwaveRECV_QUEUE_LENGTH, 1 ) ];
+static xStaticQueue xRawRecvQueueBuffer;
+#endif
+
+static err_t prvZwaveRawAccept( void *pvArg, struct tcp_pcb *pxPcb, err_t xErr );
+static err_t prvZwaveRawRecv( void *pvArg, struct tcp_pcb *pxPcb, struct pbuf *pxP, err_t xErr );
+static err_t prvZwaveRawSent( void *pvArg, struct tcp_pcb *pxPcb, u16_t usLength );
+static err_t prvZwaveRawPoll( void *pvArg, struct tcp_pcb *pxPcb );
+static void prvZwaveRawError( void *pvArg, err_t xErr );
+
+
+void vZwaveRawInit( void *pvParameters )
+{
+	struct tcp_pcb *pxPcb;
+
+	( void ) pvParameters;
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	zw_tcp_recv_queue = xQueueCreateStatic(zwaveRECV_QUEUE_LENGTH, 1, ucRawRecvQueueStorage, &xRawRecvQueueBuffer);
+#else
+	zw_tcp_recv_queue = xQueueCreate(zwaveRECV_QUEUE_LENGTH, 1);
+#endif
+
+	pxPcb = tcp_new();
+	if (pxPcb == NULL)
+		return;
+	if (tcp_bind(pxPcb, IP_ADDR_ANY, zwavePORT) != ERR_OK){
+		tcp_close(pxPcb);
+		return;
+	}
+	pxZwaveRawListener = tcp_listen(pxPcb);
+	if (pxZwaveRawListener != NULL)
+		tcp_accept(pxZwaveRawListener, prvZwaveRawAccept);
+}
+
+
+/*! \brief Forgets the session: its pcb is closed or already freed.
+ */
+static void prvZwaveRawForget( void )
+{
+	if (pxZwaveRawRx != NULL){
+		pbuf_free(pxZwaveRawRx);
+		pxZwaveRawRx = NULL;
+	}
+	usZwaveRawRxOffset = 0;
+	usZwaveRawTxLength = 0;
+	pxZwaveRawPcb = NULL;
+}
+
+
+/*! \brief Closes the session.
+ *
+ *  \return ERR_ABRT if the pcb had to be aborted: to be returned by the
+ *          callback the close is done from.
+ */
+static err_t prvZwaveRawClose( struct tcp_pcb *pxPcb )
+{
+	tcp_recv(pxPcb, NULL);
+	tcp_sent(pxPcb, NULL);
+	tcp_poll(pxPcb, NULL, 0);
+	tcp_err(pxPcb, NULL);
+	prvZwaveRawForget();
+
+	if (tcp_close(pxPcb) != ERR_OK){
+		tcp_abort(pxPcb);
+		return ERR_ABRT;
+	}
+	return ERR_OK;
+}
+
+
+/*! \brief Moves the received data to zw_tcp_recv_queue, as far as it goes,
+ *         and opens the window for it.
+ */
+static void prvZwaveRawToSerial( struct tcp_pcb *pxPcb )
+{
+	struct pbuf *pxP, *pxNext;
+	u16_t usTaken = 0;
+
+	while ((pxP = pxZwaveRawRx) != NULL){
+		while (usZwaveRawRxOffset < pxP->len){
+			if (xQueueSend(zw_tcp_recv_queue, (portCHAR *)pxP->payload + usZwaveRawRxOffset, 0) != pdPASS){
+				/* Left in the pbuf, not tcp_recved(): the window closes. */
+				zw_tcp_recv_queue_stalls++;
+				goto queue_full;
+			}
+			usZwaveRawRxOffset++;
+			usTaken++;
+		}
+		/* Free this pbuf only, keep the rest of the chain. */
+		pxNext = pxP->next;
+		if (pxNext != NULL)
+			pbuf_ref(pxNext);
+		pbuf_free(pxP);
+		pxZwaveRawRx = pxNext;
+		usZwaveRawRxOffset = 0;
+	}
+
+queue_full:
+	if (usTaken > 0){
+		tcp_recved(pxPcb, usTaken);
+		xZwaveRawLastActivity = xTaskGetTickCount();
+	}
+}
+
+
+/*! \brief Moves usart_recv_queue to the send buffer, as far as it goes.
+ */
+static void prvZwaveRawFromSerial( struct tcp_pcb *pxPcb )
+{
+	u8_t ucWriteFlags;
+	portBASE_TYPE xWritten = pdFALSE;
+
+	if (usart_recv_queue == NULL)
+		return;
+
+	for (;;){
+		if (usZwaveRawTxLength == 0){
+			while (usZwaveRawTxLength < sizeof(pcZwaveRawTx)
+					&& xQueueReceive(usart_recv_queue, &pcZwaveRawTx[usZwaveRawTxLength], 0) == pdPASS)
+				usZwaveRawTxLength++;
+			if (usZwaveRawTxLength == 0)
+				break;
+		}
+		/* Serial queue drained: end of frame, flush it now. */
+		ucWriteFlags = TCP_WRITE_FLAG_COPY;
+		if (uxQueueMessagesWaiting(usart_recv_queue) == 0)
+			ucWriteFlags |= TCP_WRITE_FLAG_PUSH;
+		/* Not taken (send buffer full): kept for prvZwaveRawSent(). */
+		if (usZwaveRawTxLength > tcp_sndbuf(pxPcb)
+				|| tcp_write(pxPcb, pcZwaveRawTx, usZwaveRawTxLength, ucWriteFlags) != ERR_OK)
+			break;
+		traceAPP_EVENT(traceEVT_TCP_WRITE, usZwaveRawTxLength);
+		usZwaveRawTxLength = 0;
+		xWritten = pdTRUE;
+	}
+
+	if (xWritten){
+		tcp_output(pxPcb);
+		xZwaveRawLastActivity = xTaskGetTickCount();
+	}
+}
+
+
+/*! \brief tcpip_callback() function queued by vZwaveRawKick().
+ */
+static void prvZwaveRawService( void *pvArg )
+{
+	( void ) pvArg;
+
+	xZwaveRawKickPending = pdFALSE;
+	if (pxZwaveRawPcb != NULL){
+		prvZwaveRawToSerial(pxZwaveRawPcb);
+		prvZwaveRawFromSerial(pxZwaveRawPcb);
+	}
+}
+
+
+void vZwaveRawKick( void )
+{
+	/* One call queued at a time: the mbox of the lwIP task is short. If it is
+	full, the poll callback moves the data. */
+	if (!xZwaveRawKickPending){
+		xZwaveRawKickPending = pdTRUE;
+		if (tcpip_callback_with_block(prvZwaveRawService, NULL, 0) != ERR_OK)
+			xZwaveRawKickPending = pdFALSE;
+	}
+}
+
+
+static err_t prvZwaveRawAccept( void *pvArg, struct tcp_pcb *pxPcb, err_t xErr )
+{
+	( void ) pvArg;
+	( void ) xErr;
+
+	tcp_accepted(pxZwaveRawListener);
+
+	/* One controller at a time: the stack aborts the refused pcb. */
+	if (pxZwaveRawPcb != NULL)
+		return ERR_MEM;
+
+	pxZwaveRawPcb = pxPcb;
+	tcp_arg(pxPcb, NULL);
+	tcp_recv(pxPcb, prvZwaveRawRecv);
+	tcp_sent(pxPcb, prvZwaveRawSent);
+	tcp_poll(pxPcb, prvZwaveRawPoll, zwaveRAW_POLL_INTERVAL);
+	tcp_err(pxPcb, prvZwaveRawError);
+
+	if (zwaveNODELAY)
+		tcp_nagle_disable(pxPcb);
+	pxPcb->so_options |= SOF_KEEPALIVE;
+	pxPcb->keep_idle = zwaveKEEPALIVE_IDLE;
+#if LWIP_TCP_KEEPALIVE
+	pxPcb->keep_intvl = zwaveKEEPALIVE_INTVL;
+	pxPcb->keep_cnt = zwaveKEEPALIVE_COUNT;
+#endif
+
+	xZwaveRawLastActivity = xTaskGetTickCount();
+
+	/* Serial bytes that arrived while no controller was connected. */
+	prvZwaveRawFromSerial(pxPcb);
+	return ERR_OK;
+}
+
+
+static err_t prvZwaveRawRecv( void *pvArg, struct tcp_pcb *pxPcb, struct pbuf *pxP, err_t xErr )
+{
+	( void ) pvArg;
+	( void ) xErr;
+
+	/* Closed by the controller. */
+	if (pxP == NULL)
+		return prvZwaveRawClose(pxPcb);
+
+	if (pxZwaveRawRx == NULL){
+		pxZwaveRawRx = pxP;
+		usZwaveRawRxOffset = 0;
+	}else{
+		pbuf_cat(pxZwaveRawRx, pxP);
+	}
+	prvZwaveRawToSerial(pxPcb);
+	return ERR_OK;
+}
+
+
+static err_t prvZwaveRawSent( void *pvArg, struct tcp_pcb *pxPcb, u16_t usLength )
+{
+	( void ) pvArg;
+	( void ) usLength;
+
+	prvZwaveRawFromSerial(pxPcb);
+	return ERR_OK;
+}
+
+
+static err_t prvZwaveRawPoll( void *pvArg, struct tcp_pcb *pxPcb )
+{
+	( void ) pvArg;
+
+	if ((zwaveIDLE_TIMEOUT != 0) && ((xTaskGetTickCount() - xZwaveRawLastActivity) >= zwaveIDLE_TIMEOUT))
+		return prvZwaveRawClose(pxPcb);
+
+	/* Kicks lost to a full mbox, and zw_tcp_recv_queue drained meanwhile. */
+	prvZwaveRawToSerial(pxPcb);
+	prvZwaveRawFromSerial(pxPcb);
+	return ERR_OK;
+}
+
+
+static void prvZwaveRawError( void *pvArg, err_t xErr )
+{
+	( void ) pvArg;
+	( void ) xErr;
+
+	/* Reset or aborted (keepalive): the pcb is already freed. */
+	prvZwaveRawForget();
+}
+
+#endif /* zwaveBRIDGE_API */
@@ -0,0 +1,27 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Z-Wave bridge server on the lwIP raw API, run by the lwIP task.
+ *
+ *****************************************************************************/
+
+#ifndef ZWAVE_RAW_H
+#define ZWAVE_RAW_H
+
+
+/*! \brief Sets up the bridge listener. Must run in the lwIP task: started with
+ *         tcpip_callback().
+ *
+ *  \param pvParameters   Input. Not Used.
+ *
+ */
+void vZwaveRawInit( void *pvParameters );
+
+/*! \brief Has the lwIP task move the bridge data: to be called by the serial
+ *         task after it put bytes in usart_recv_queue or took bytes from
+ *         zw_tcp_recv_queue. Never blocks.
+ *
+ */
+void vZwaveRawKick( void );
+
+#endif
@@ -0,0 +1,408 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Z-Wave bridge server on the lwIP sockets API: one task, one select().
+ *
+ * Alternative to the netconn (ZWaveTCP.c) and raw API (ZWaveRaw.c) servers,
+ * selected by zwaveBRIDGE_API in conf_lwip_threads.h. A single task waits in
+ * lwip_select() for the listener, the controller and the serial port, which
+ * is seen through a channel socket (see lwip_channel()) whose events the
+ * serial task sets with vZwaveSelectKick().
+ * - TCP to serial: the controller is read one chunk at a time, the next
+ *   one only once zw_tcp_recv_queue took the previous one; meanwhile the
+ *   data waits on the pcb side and the window closes.
+ * - serial to TCP: usart_recv_queue is read one chunk at a time, sent to
+ *   the controller, the next one only once it took it.
+ * No socket call blocks but lwip_select().
+ *
+ * One controller at a time, as with the other bridges: the Serial API link
+ * is one request/response stream, the frames of two controllers would
+ * interleave on it and nothing tells whose request a response answers.
+ *
+ *****************************************************************************/
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* lwIP includes. */
+#include "lwip/sockets.h"
+
+#include "ipc.h"
+#include "conf_lwip_threads.h"
+#include "ZWaveTCP.h"
+#include "ZWaveSelect.h"
+
+
+#if ( zwaveBRIDGE_API == zwaveBRIDGE_SELECT )
+
+#if !LWIP_SOCKET || !LWIP_SOCKET_CHANNELS
+#error zwaveBRIDGE_SELECT requires LWIP_SOCKET and LWIP_SOCKET_CHANNELS
+#endif
+
+/*! Controllers served at the same time: one Serial API link, one controller.
+    Each takes a socket and a netconn. */
+#define zwaveSELECT_MAX_CLIENTS	( 1 )
+
+/*! Bytes moved per read, in either direction. */
+#define zwaveSELECT_CHUNK	( 100 )
+
+/*! lwip_select() timeout, in seconds: the idle timeouts are checked at least
+    that often. */
+#define zwaveSELECT_TIMEOUT	( 1 )
+
+/*! A controller connection. */
+typedef struct
+{
+	int lSocket;			/*!< -1 for a free slot. */
+	u16_t usTxOffset;		/*!< Bytes of pcZwaveFromSerial sent to it. */
+	portTickType xLastActivity;	/*!< Time of its last byte in either direction. */
+} xZwaveClient;
+
+static xZwaveClient xZwaveClients[ zwaveSELECT_MAX_CLIENTS ];
+
+/*! Channel socket standing for the serial queues, -1 until created. */
+static volatile int lZwaveSerialChannel = -1;
+
+/*! Bytes read from a controller that zw_tcp_recv_queue did not take yet, from
+    usZwaveToSerialOffset. */
+static portCHAR pcZwaveToSerial[ zwaveSELECT_CHUNK ];
+static u16_t usZwaveToSerialLength = 0;
+static u16_t usZwaveToSerialOffset = 0;
+
+/*! Bytes taken from usart_recv_queue, until the controller took them. */
+static portCHAR pcZwaveFromSerial[ zwaveSELECT_CHUNK ];
+static u16_t usZwaveFromSerialLength = 0;
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+/*! Storage of the TCP to serial queue. */
+static unsigned char ucSelectRecvQueueStorage[ queueSTATIC_STORAGE_SIZE( zwaveRECV_QUEUE_LENGTH, 1 ) ];
+static xStaticQueue xSelectRecvQueueBuffer;
+#endif
+
+static portBASE_TYPE prvZwaveSelectOpen( int *plListener, int *plChannel );
+static void prvZwaveSelectPoll( int lListener, int lChannel );
+static void prvZwaveSelectAccept( int lListener );
+static void prvZwaveSelectClose( xZwaveClient *pxClient );
+static void prvZwaveSelectRecv( xZwaveClient *pxClient );
+static void prvZwaveSelectSend( xZwaveClient *pxClient );
+static void prvZwaveSelectToSerial( void );
+static void prvZwaveSelectFromSerial( void );
+
+
+portTASK_FUNCTION( vZwaveSelectServer, pvParameters )
+{
+	int lListener, lChannel;
+
+	( void ) pvParameters;
+
+	if (prvZwaveSelectOpen(&lListener, &lChannel) != pdPASS)
+		vTaskDelete(NULL);
+
+	for (;;)
+		prvZwaveSelectPoll(lListener, lChannel);
+}
+
+
+/*! \brief Creates the TCP to serial queue, the listener and the serial
+ *         channel, no controller connected.
+ *
+ *  \return pdPASS, or pdFAIL if the listener or the channel could not be
+ *          created.
+ */
+static portBASE_TYPE prvZwaveSelectOpen( int *plListener, int *plChannel )
+{
+	struct sockaddr_in xAddress;
+	xZwaveClient *pxClient;
+	int lListener, lChannel;
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	zw_tcp_recv_queue = xQueueCreateStatic(zwaveRECV_QUEUE_LENGTH, 1, ucSelectRecvQueueStorage, &xSelectRecvQueueBuffer);
+#else
+	zw_tcp_recv_queue = xQueueCreate(zwaveRECV_QUEUE_LENGTH, 1);
+#endif
+
+	for (pxClient = xZwaveClients; pxClient < &xZwaveClients[zwaveSELECT_MAX_CLIENTS]; pxClient++)
+		pxClient->lSocket = -1;
+
+	lListener = lwip_socket(AF_INET, SOCK_STREAM, 0);
+	memset(&xAddress, 0, sizeof(xAddress));
+	xAddress.sin_len = sizeof(xAddress);
+	xAddress.sin_family = AF_INET;
+	xAddress.sin_port = htons(zwavePORT);
+	xAddress.sin_addr.s_addr = htonl(INADDR_ANY);
+	if (lwip_bind(lListener, (struct sockaddr *)&xAddress, sizeof(xAddress)) != 0
+			|| lwip_listen(lListener, zwaveSELECT_MAX_CLIENTS) != 0){
+		lwip_close(lListener);
+		return pdFAIL;
+	}
+
+	/* Both events set: the serial task may have kicked before the channel
+	existed. */
+	lChannel = lwip_channel();
+	if (lChannel < 0){
+		lwip_close(lListener);
+		return pdFAIL;
+	}
+	lwip_channel_event(lChannel, 1, 1);
+	lZwaveSerialChannel = lChannel;
+
+	*plListener = lListener;
+	*plChannel = lChannel;
+	return pdPASS;
+}
+
+
+/*! \brief One turn of the bridge: waits in lwip_select(), at most
+ *         zwaveSELECT_TIMEOUT, then serves what is ready.
+ */
+static void prvZwaveSelectPoll( int lListener, int lChannel )
+{
+	struct timeval xTimeout;
+	fd_set xReadSet, xWriteSet, xExceptSet;
+	xZwaveClient *pxClient;
+	portBASE_TYPE xConnected, xAllSent;
+	int lMax;
+
+	FD_ZERO(&xReadSet);
+	FD_ZERO(&xWriteSet);
+	FD_ZERO(&xExceptSet);
+	FD_SET(lListener, &xReadSet);
+	lMax = (lListener > lChannel) ? lListener : lChannel;
+
+	/* zw_tcp_recv_queue full: wait for the serial task to drain it, the
+	controller is not read meanwhile. */
+	if (usZwaveToSerialLength > 0)
+		FD_SET(lChannel, &xWriteSet);
+
+	xConnected = pdFALSE;
+	xAllSent = pdTRUE;
+	for (pxClient = xZwaveClients; pxClient < &xZwaveClients[zwaveSELECT_MAX_CLIENTS]; pxClient++){
+		if (pxClient->lSocket < 0)
+			continue;
+		xConnected = pdTRUE;
+		if (usZwaveToSerialLength == 0)
+			FD_SET(pxClient->lSocket, &xReadSet);
+		if (pxClient->usTxOffset < usZwaveFromSerialLength){
+			FD_SET(pxClient->lSocket, &xWriteSet);
+			xAllSent = pdFALSE;
+		}
+		if (pxClient->lSocket > lMax)
+			lMax = pxClient->lSocket;
+	}
+
+	/* No controller: the serial bytes wait in usart_recv_queue for the
+	next one. */
+	if (xConnected && xAllSent)
+		FD_SET(lChannel, &xReadSet);
+
+	xTimeout.tv_sec = zwaveSELECT_TIMEOUT;
+	xTimeout.tv_usec = 0;
+	if (lwip_select(lMax + 1, &xReadSet, &xWriteSet, &xExceptSet, &xTimeout) < 0){
+		FD_ZERO(&xReadSet);
+		FD_ZERO(&xWriteSet);
+	}
+
+	if (FD_ISSET(lListener, &xReadSet))
+		prvZwaveSelectAccept(lListener);
+
+	/* Retried on the timeout too: a kick of the serial task is only a
+	hint. */
+	if (usZwaveToSerialLength > 0)
+		prvZwaveSelectToSerial();
+
+	for (pxClient = xZwaveClients; pxClient < &xZwaveClients[zwaveSELECT_MAX_CLIENTS]; pxClient++){
+		if (pxClient->lSocket >= 0 && FD_ISSET(pxClient->lSocket, &xReadSet)
+				&& usZwaveToSerialLength == 0)
+			prvZwaveSelectRecv(pxClient);
+	}
+
+	if (FD_ISSET(lChannel, &xReadSet))
+		prvZwaveSelectFromSerial();
+
+	for (pxClient = xZwaveClients; pxClient < &xZwaveClients[zwaveSELECT_MAX_CLIENTS]; pxClient++){
+		if (pxClient->lSocket < 0)
+			continue;
+		if (pxClient->usTxOffset < usZwaveFromSerialLength)
+			prvZwaveSelectSend(pxClient);
+		if ((pxClient->lSocket >= 0) && (zwaveIDLE_TIMEOUT != 0)
+				&& ((xTaskGetTickCount() - pxClient->xLastActivity) >= zwaveIDLE_TIMEOUT))
+			prvZwaveSelectClose(pxClient);
+	}
+
+	/* The controller took the chunk: the next one can be read. */
+	xAllSent = pdTRUE;
+	for (pxClient = xZwaveClients; pxClient < &xZwaveClients[zwaveSELECT_MAX_CLIENTS]; pxClient++){
+		if (pxClient->lSocket >= 0 && pxClient->usTxOffset < usZwaveFromSerialLength)
+			xAllSent = pdFALSE;
+	}
+	if (xAllSent){
+		usZwaveFromSerialLength = 0;
+		for (pxClient = xZwaveClients; pxClient < &xZwaveClients[zwaveSELECT_MAX_CLIENTS]; pxClient++)
+			pxClient->usTxOffset = 0;
+	}
+}
+
+
+void vZwaveSelectKick( void )
+{
+	int lChannel = lZwaveSerialChannel;
+
+	/* The bridge clears the events before it looks at the queues: setting
+	them after the serial task did loses nothing. */
+	if (lChannel >= 0)
+		lwip_channel_event(lChannel, 1, 1);
+}
+
+
+/*! \brief Accepts a controller, or refuses it when one is connected: the
+ *         stack closes the refused connection.
+ */
+static void prvZwaveSelectAccept( int lListener )
+{
+	struct sockaddr_in xAddress;
+	socklen_t xLength = sizeof(xAddress);
+	xZwaveClient *pxClient;
+	int lSocket, lValue;
+
+	lSocket = lwip_accept(lListener, (struct sockaddr *)&xAddress, &xLength);
+	if (lSocket < 0)
+		return;
+
+	for (pxClient = xZwaveClients; pxClient < &xZwaveClients[zwaveSELECT_MAX_CLIENTS]; pxClient++){
+		if (pxClient->lSocket < 0)
+			break;
+	}
+	if (pxClient == &xZwaveClients[zwaveSELECT_MAX_CLIENTS]){
+		lwip_close(lSocket);
+		return;
+	}
+
+	lValue = zwaveNODELAY;
+	lwip_setsockopt(lSocket, IPPROTO_TCP, TCP_NODELAY, &lValue, sizeof(lValue));
+	lValue = 1;
+	lwip_setsockopt(lSocket, SOL_SOCKET, SO_KEEPALIVE, &lValue, sizeof(lValue));
+#if LWIP_TCP_KEEPALIVE
+	/* In seconds here. */
+	lValue = zwaveKEEPALIVE_IDLE / 1000;
+	lwip_setsockopt(lSocket, IPPROTO_TCP, TCP_KEEPIDLE, &lValue, sizeof(lValue));
+	lValue = zwaveKEEPALIVE_INTVL / 1000;
+	lwip_setsockopt(lSocket, IPPROTO_TCP, TCP_KEEPINTVL, &lValue, sizeof(lValue));
+	lValue = zwaveKEEPALIVE_COUNT;
+	lwip_setsockopt(lSocket, IPPROTO_TCP, TCP_KEEPCNT, &lValue, sizeof(lValue));
+#endif
+
+	pxClient->lSocket = lSocket;
+	/* A chunk read for a controller gone is not for this one. */
+	pxClient->usTxOffset = usZwaveFromSerialLength;
+	pxClient->xLastActivity = xTaskGetTickCount();
+}
+
+
+/*! \brief Closes a controller connection and frees its slot.
+ */
+static void prvZwaveSelectClose( xZwaveClient *pxClient )
+{
+	lwip_close(pxClient->lSocket);
+	pxClient->lSocket = -1;
+	pxClient->usTxOffset = 0;
+}
+
+
+/*! \brief Tells a socket call that found nothing to do (EWOULDBLOCK) from one
+ *         that failed.
+ *
+ *  \return pdTRUE if the connection failed.
+ */
+static portBASE_TYPE prvZwaveSelectFailed( int lSocket )
+{
+	int lError = 0;
+	socklen_t xLength = sizeof(lError);
+
+	lwip_getsockopt(lSocket, SOL_SOCKET, SO_ERROR, &lError, &xLength);
+	return (lError != EWOULDBLOCK) ? pdTRUE : pdFALSE;
+}
+
+
+/*! \brief Reads a chunk from a controller and moves it to zw_tcp_recv_queue.
+ */
+static void prvZwaveSelectRecv( xZwaveClient *pxClient )
+{
+	int lLength;
+
+	lLength = lwip_recv(pxClient->lSocket, pcZwaveToSerial, sizeof(pcZwaveToSerial), MSG_DONTWAIT);
+	if (lLength > 0){
+		usZwaveToSerialLength = lLength;
+		usZwaveToSerialOffset = 0;
+		pxClient->xLastActivity = xTaskGetTickCount();
+		prvZwaveSelectToSerial();
+	}else if (lLength == 0 || prvZwaveSelectFailed(pxClient->lSocket)){
+		/* Closed, reset or aborted (keepalive). */
+		prvZwaveSelectClose(pxClient);
+	}
+}
+
+
+/*! \brief Sends a controller what it did not take yet of the serial chunk.
+ */
+static void prvZwaveSelectSend( xZwaveClient *pxClient )
+{
+	int lLength;
+
+	lLength = lwip_send(pxClient->lSocket, pcZwaveFromSerial + pxClient->usTxOffset,
+			usZwaveFromSerialLength - pxClient->usTxOffset, MSG_DONTWAIT);
+	if (lLength > 0){
+		traceAPP_EVENT(traceEVT_TCP_WRITE, lLength);
+		pxClient->usTxOffset += lLength;
+		pxClient->xLastActivity = xTaskGetTickCount();
+	}else if (prvZwaveSelectFailed(pxClient->lSocket)){
+		prvZwaveSelectClose(pxClient);
+	}
+}
+
+
+/*! \brief Moves the pending controller bytes to zw_tcp_recv_queue, as far as
+ *         it goes.
+ */
+static void prvZwaveSelectToSerial( void )
+{
+	/* Cleared before the queue is filled: a drain by the serial task from
+	now on sets it again. */
+	lwip_channel_event(lZwaveSerialChannel, -1, 0);
+	while (usZwaveToSerialOffset < usZwaveToSerialLength
+			&& xQueueSend(zw_tcp_recv_queue, &pcZwaveToSerial[usZwaveToSerialOffset], 0) == pdPASS)
+		usZwaveToSerialOffset++;
+	if (usZwaveToSerialOffset == usZwaveToSerialLength){
+		usZwaveToSerialLength = 0;
+		usZwaveToSerialOffset = 0;
+	}else{
+		/* The controller is not read meanwhile: its window closes. */
+		zw_tcp_recv_queue_stalls++;
+	}
+}
+
+
+/*! \brief Takes the next chunk of usart_recv_queue, for the controller.
+ */
+static void prvZwaveSelectFromSerial( void )
+{
+	/* Cleared before the queue is read: bytes queued by the serial task from
+	now on set it again. */
+	lwip_channel_event(lZwaveSerialChannel, 0, -1);
+	if (usart_recv_queue == NULL)
+		return;
+
+	while (usZwaveFromSerialLength < sizeof(pcZwaveFromSerial)
+			&& xQueueReceive(usart_recv_queue, &pcZwaveFromSerial[usZwaveFromSerialLength], 0) == pdPASS)
+		usZwaveFromSerialLength++;
+
+	/* More than a chunk waiting: come back for it. */
+	if (uxQueueMessagesWaiting(usart_recv_queue) > 0)
+		lwip_channel_event(lZwaveSerialChannel, 1, -1);
+}
+
+#endif /* zwaveBRIDGE_API */
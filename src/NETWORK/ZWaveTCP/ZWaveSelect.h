@@ -0,0 +1,29 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Z-Wave bridge server on the lwIP sockets API: one task, one select().
+ *
+ *****************************************************************************/
+
+#ifndef ZWAVE_SELECT_H
+#define ZWAVE_SELECT_H
+
+#include "portmacro.h"
+
+
+/*! \brief Bridge task: serves the listener, the controllers and the serial
+ *         queues from one lwip_select() loop.
+ *
+ *  \param pvParameters   Input. Not Used.
+ *
+ */
+portTASK_FUNCTION_PROTO( vZwaveSelectServer, pvParameters );
+
+/*! \brief Wakes the bridge task up: to be called by the serial task after it
+ *         put bytes in usart_recv_queue or took bytes from zw_tcp_recv_queue.
+ *         Not to be called from an interrupt.
+ *
+ */
+void vZwaveSelectKick( void );
+
+#endif
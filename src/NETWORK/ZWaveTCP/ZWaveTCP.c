@@ -86,18 +86,58 @@
 #include "usart.h"
 
 #include "ipc.h"
+#include "conf_lwip_threads.h"
+#include "ZWaveTCP.h"
+#include "ZWaveCoalesce.h"
 
 
-/*! The port on which we listen. */
-#define zwavePORT		( 23 )
+#if ( zwaveBRIDGE_API == zwaveBRIDGE_NETCONN )
+
+/*! Time netconn_recv() waits for the controller, in ms: the serial queue is
+    polled at least that often, as often as the serial task fills it. Shorter
+    while serial bytes are held and the send buffer has room for them, see
+    xZwaveCoalesceWait(). */
+#define zwaveRECV_TIMEOUT	( 10 )
+
+/*! Bytes read from the controller per netconn_recv_into() call. */
+#define zwaveRECV_CHUNK		( 64 )
+
+/*! Serial to TCP buffer: the bytes held by the coalescing policy and what
+    the send buffer did not take wait here. Takes the longest frame. */
+#define zwaveSEND_BUFFER_SIZE	( zwaveFRAME_MAX_SIZE )
+
+/*! Time to wait for the serial task to drain a full zw_tcp_recv_queue: it
+    looks at it every 10ms. */
+#define zwaveFLOW_DELAY		( 10 / portTICK_RATE_MS )
 
 
-struct netbuf * pxRxBuffer;
 xSemaphoreHandle xRxSem;
 
+/*! pdFALSE while the send buffer of the session has no room for the pending
+    serial bytes: set back by prvZwaveNetconnEvent() on NETCONN_EVT_SENDPLUS. */
+static volatile portBASE_TYPE xZwaveSendSpace = pdTRUE;
+
+/*! pdTRUE while a session runs. The policy posted by xZwaveSetCoalescing()
+    waits in ucZwaveNextPolicy and usZwaveNextParam while xZwaveNextPolicy is
+    pdTRUE. All in critical sections. */
+static portBASE_TYPE xZwaveSessionOpen = pdFALSE;
+static volatile portBASE_TYPE xZwaveNextPolicy = pdFALSE;
+static unsigned portCHAR ucZwaveNextPolicy;
+static unsigned portSHORT usZwaveNextParam;
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+/*! Storage of the TCP to serial queue and of the rx mutex. */
+static unsigned char ucRecvQueueStorage[ queueSTATIC_STORAGE_SIZE( zwaveRECV_QUEUE_LENGTH, 1 ) ];
+static xStaticQueue xRecvQueueBuffer;
+static xStaticQueue xRxSemBuffer;
+#endif
+
 /*! Function to process the current connection */
 static void prvweb_HandleZwaveSession( struct netconn *pxNetCon );
 
+/*! netconn callback of the Z-Wave connections, called by the TCP/IP task. */
+static void prvZwaveNetconnEvent( struct netconn *pxNetCon, enum netconn_evt xEvent, u16_t usLength );
+
 
 /*! \brief WEB server main task
  *         check for incoming connection and process it
@@ -110,14 +150,19 @@ portTASK_FUNCTION( vBasicZwaveServer, pvParameters )
 	struct netconn *pxZwaveListener, *pxNewConnection;
 
 	/*We create FreeRTOS tools for ipc and locking*/
-	zw_tcp_recv_queue = xQueueCreate(100, 1);
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	zw_tcp_recv_queue = xQueueCreateStatic(zwaveRECV_QUEUE_LENGTH, 1, ucRecvQueueStorage, &xRecvQueueBuffer);
+	xRxSem = xSemaphoreCreateMutexStatic(&xRxSemBuffer);
+#else
+	zw_tcp_recv_queue = xQueueCreate(zwaveRECV_QUEUE_LENGTH, 1);
 	xRxSem = xSemaphoreCreateMutex();
+#endif
 
 	/* Create a new tcp connection handle */
 	vParTestToggleLED(1);
 	vTaskDelay(500*portTICK_RATE_MS);
 	vParTestToggleLED(1);
-	pxZwaveListener = netconn_new( NETCONN_TCP );
+	pxZwaveListener = netconn_new_with_callback( NETCONN_TCP, prvZwaveNetconnEvent );
 	netconn_bind(pxZwaveListener, NULL, zwavePORT );
 	netconn_listen( pxZwaveListener );
 	vTaskDelay(500*portTICK_RATE_MS);
@@ -140,6 +185,25 @@ portTASK_FUNCTION( vBasicZwaveServer, pvParameters )
 }
 
 
+/*! \brief netconn callback: the accepted connections inherit it from the
+ *         listener. Only used to know when the send buffer has room again.
+ *
+ *  \param pxNetCon   Input. The netconn the event is for.
+ *  \param xEvent     Input. The event.
+ *  \param usLength   Input. Not Used.
+ *
+ */
+static void prvZwaveNetconnEvent( struct netconn *pxNetCon, enum netconn_evt xEvent, u16_t usLength )
+{
+	( void ) pxNetCon;
+	( void ) usLength;
+
+	if (xEvent == NETCONN_EVT_SENDPLUS){
+		xZwaveSendSpace = pdTRUE;
+	}
+}
+
+
 /*! \brief parse the incoming request
  *         parse the HTML request and send file
  *
@@ -148,42 +212,136 @@ portTASK_FUNCTION( vBasicZwaveServer, pvParameters )
  */
 static void prvweb_HandleZwaveSession( struct netconn *pxNetCon )
 {
-	portCHAR *pcRxString;
+	portCHAR pcRxString[ zwaveRECV_CHUNK ];
 	unsigned portSHORT usLength;
-	char to_send[100];
+	char to_send[zwaveSEND_BUFFER_SIZE];
 	size_t to_send_idx = 0;
-	unsigned short i;
-
-
-	while((pxNetCon->err & ERR_CLSD) == 0){
-		pxRxBuffer = netconn_recv(pxNetCon);
-		if (pxRxBuffer != NULL){
-			netbuf_data(pxRxBuffer, (void*)&pcRxString, &usLength);
+	size_t xWritten;
+	unsigned short i, usRoom;
+	u8_t ucWriteFlags;
+	unsigned short usReady;
+	portTickType xLastActivity, xWait;
+	portBASE_TYPE xStalled = pdFALSE;
+	xZwaveCoalesce xCoalesce;
+
+
+	netconn_set_nodelay(pxNetCon, zwaveNODELAY);
+	netconn_set_keepalive(pxNetCon, zwaveKEEPALIVE_IDLE, zwaveKEEPALIVE_INTVL, zwaveKEEPALIVE_COUNT);
+	vZwaveCoalesceInit(&xCoalesce, zwaveCOALESCE_POLICY, zwaveCOALESCE_PARAM);
+	xLastActivity = xTaskGetTickCount();
+	xZwaveSendSpace = pdTRUE;
+	portENTER_CRITICAL();
+	xZwaveSessionOpen = pdTRUE;
+	xZwaveNextPolicy = pdFALSE;
+	portEXIT_CRITICAL();
+
+	/* ERR_TIMEOUT only means the controller was silent for zwaveRECV_TIMEOUT;
+	a reset, an abort (keepalive) or a close ends the session. */
+	while(!ERR_IS_FATAL(pxNetCon->err)){
+		if (xZwaveNextPolicy){
+			portENTER_CRITICAL();
+			vZwaveCoalesceSetPolicy(&xCoalesce, ucZwaveNextPolicy, usZwaveNextParam);
+			xZwaveNextPolicy = pdFALSE;
+			portEXIT_CRITICAL();
+		}
+#if LWIP_SO_RCVTIMEO
+		/* Back in time for the held serial bytes. With the send buffer full
+		they can only wait for NETCONN_EVT_SENDPLUS, which does not end the
+		wait: zwaveRECV_TIMEOUT then, not a poll every tick. */
+		xWait = xZwaveSendSpace ? xZwaveCoalesceWait(&xCoalesce) : portMAX_DELAY;
+		netconn_set_recvtimeout(pxNetCon, (xWait < zwaveRECV_TIMEOUT / portTICK_RATE_MS)
+				? xWait * portTICK_RATE_MS : zwaveRECV_TIMEOUT);
+#endif
+		/* Only what zw_tcp_recv_queue has room for: the rest stays on the
+		netconn, not taken from the stack (netconn_recv_into() reports a pbuf
+		once it is used up), so the TCP window closes while the serial port
+		is behind. */
+		usRoom = zwaveRECV_QUEUE_LENGTH - uxQueueMessagesWaiting(zw_tcp_recv_queue);
+		if (usRoom > sizeof(pcRxString))
+			usRoom = sizeof(pcRxString);
+		if (usRoom == 0){
+			if (!xStalled){
+				xStalled = pdTRUE;
+				zw_tcp_recv_queue_stalls++;
+			}
+			usLength = 0;
+			vTaskDelay(zwaveFLOW_DELAY);
+		}else{
+			xStalled = pdFALSE;
+			/* Straight into pcRxString: no netbuf per segment. */
+			usLength = netconn_recv_into(pxNetCon, pcRxString, usRoom);
+		}
+		if (usLength > 0){
 			vParTestToggleLED(5);
 			for(i = 0; i < usLength; i++){
-				xQueueSend(zw_tcp_recv_queue, pcRxString+i, 100);
+				/* Room checked above, this task is the only writer. */
+				if (xQueueSend(zw_tcp_recv_queue, pcRxString+i, 0) != pdPASS)
+					zw_tcp_recv_queue_spoiled++;
 			}
-			netbuf_delete(pxRxBuffer);
+			xLastActivity = xTaskGetTickCount();
 		}
 		if (usart_recv_queue && uxQueueMessagesWaiting(usart_recv_queue)){
 			vParTestToggleLED(4);
-			while(uxQueueMessagesWaiting(usart_recv_queue)>0 && to_send_idx < 100){
+			while(uxQueueMessagesWaiting(usart_recv_queue)>0 && to_send_idx < sizeof(to_send)){
 				vParTestToggleLED(3);
 				xQueueReceive(usart_recv_queue, (to_send+to_send_idx), 100);
+				vZwaveCoalesceAdd(&xCoalesce, (unsigned char)to_send[to_send_idx]);
 				to_send_idx++;
 			}
-			if (to_send_idx>0){
-				netconn_write(pxNetCon, to_send, to_send_idx, NETCONN_COPY);
-				to_send_idx = 0;
+		}
+		/* Held by the coalescing policy, or never waiting for the
+		controller's window: while the send buffer is full, the serial bytes
+		stay in to_send and usart_recv_queue. */
+		usReady = usZwaveCoalesceReady(&xCoalesce, sizeof(to_send));
+		if (usReady>0 && xZwaveSendSpace){
+			/* Nothing held behind: the unit the policy made is complete,
+			flush it now. */
+			ucWriteFlags = NETCONN_COPY | NETCONN_DONTBLOCK;
+			if (usReady == to_send_idx)
+				ucWriteFlags |= NETCONN_PUSH;
+			/* Cleared before the write: a NETCONN_EVT_SENDPLUS coming
+			meanwhile is not lost. */
+			xZwaveSendSpace = pdFALSE;
+			traceAPP_EVENT(traceEVT_TCP_WRITE, usReady);
+			netconn_write_partly(pxNetCon, to_send, usReady, ucWriteFlags, &xWritten);
+			if (xWritten == usReady){
+				xZwaveSendSpace = pdTRUE;
+			}
+			if (xWritten > 0){
+				vZwaveCoalesceSent(&xCoalesce, xWritten);
+				to_send_idx -= xWritten;
+				memmove(to_send, to_send + xWritten, to_send_idx);
+				xLastActivity = xTaskGetTickCount();
 			}
 		}
-		vTaskDelay(100/portTICK_RATE_MS);
+		if ((zwaveIDLE_TIMEOUT != 0) && ((xTaskGetTickCount() - xLastActivity) >= zwaveIDLE_TIMEOUT)){
+			break;
+		}
 	}
 
+	portENTER_CRITICAL();
+	xZwaveSessionOpen = pdFALSE;
+	portEXIT_CRITICAL();
 	netconn_close( pxNetCon );
 	netconn_delete( pxNetCon );
 }
 
+
+portBASE_TYPE xZwaveSetCoalescing( unsigned portCHAR ucPolicy, unsigned portSHORT usParam )
+{
+	portBASE_TYPE xOpen;
+
+	portENTER_CRITICAL();
+	xOpen = xZwaveSessionOpen;
+	if (xOpen){
+		ucZwaveNextPolicy = ucPolicy;
+		usZwaveNextParam = usParam;
+		xZwaveNextPolicy = pdTRUE;
+	}
+	portEXIT_CRITICAL();
+	return xOpen;
+}
+
 portTASK_FUNCTION( vWaitDataTask , pvParameters ){
 	struct netcon * pxNetCon;
 
@@ -193,3 +351,5 @@ portTASK_FUNCTION( vWaitDataTask , pvParameters ){
 
 	}
 }
+
+#endif /* zwaveBRIDGE_API */
@@ -51,6 +51,44 @@
 #include "portmacro.h"
 
 
+/*! \name Bridge parameters, shared by the netconn (ZWaveTCP.c), raw API
+ *         (ZWaveRaw.c), select (ZWaveSelect.c) and UDP (ZWaveUDP.c) servers.
+ */
+//! @{
+
+/*! The port on which we listen. */
+#define zwavePORT		( 23 )
+
+/*! Disable the Nagle algorithm on the Z-Wave connections: the Serial API
+    frames are small and each one waits for an answer. */
+#define zwaveNODELAY		( 1 )
+
+/*! Keepalive probes on the Z-Wave connections: the first one after
+    zwaveKEEPALIVE_IDLE ms without any segment from the controller, then one
+    every zwaveKEEPALIVE_INTVL ms. The connection is aborted after
+    zwaveKEEPALIVE_COUNT unanswered probes: a controller gone without a FIN
+    frees the session within 8s. */
+#define zwaveKEEPALIVE_IDLE	( 5000 )
+#define zwaveKEEPALIVE_INTVL	( 1000 )
+#define zwaveKEEPALIVE_COUNT	( 3 )
+
+/*! The session is closed after this many ticks without a byte in either
+    direction, 0 to never close it. */
+#define zwaveIDLE_TIMEOUT	( 600000 / portTICK_RATE_MS )
+
+/*! Length of the TCP to serial queue. */
+#define zwaveRECV_QUEUE_LENGTH	( 100 )
+
+/*! Coalescing of the serial bytes sent to a new connection (ZWaveCoalesce.h):
+    whole Serial API frames by default. zwaveCOALESCE_PARAM is the byte count
+    of zwaveCOALESCE_SIZE or the idle gap in us of zwaveCOALESCE_GAP. The
+    connection may then change it (zwaveCONTROL_COALESCE, ZWaveControl.h). */
+#define zwaveCOALESCE_POLICY	zwaveCOALESCE_FRAME
+#define zwaveCOALESCE_PARAM	( 0 )
+
+//! @}
+
+
 /*! \brief WEB server main task
  *
  *  \param pvParameters   Input. Not Used.
@@ -58,5 +96,15 @@
  */
 portTASK_FUNCTION_PROTO( vBasicZwaveServer, pvParameters );
 
+/*! \brief Sets the coalescing policy of the open connection, until it ends.
+ *         Taken by the session at the next turn of its loop. Never blocks.
+ *
+ *  \param ucPolicy   Input. zwaveCOALESCE_NONE, FRAME, SIZE or GAP.
+ *  \param usParam    Input. Bytes for SIZE, us for GAP, not used otherwise.
+ *
+ *  \return pdTRUE, pdFALSE if no connection is open.
+ */
+portBASE_TYPE xZwaveSetCoalescing( unsigned portCHAR ucPolicy, unsigned portSHORT usParam );
+
 #endif
 
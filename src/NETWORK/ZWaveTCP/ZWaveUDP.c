@@ -0,0 +1,372 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Z-Wave bridge over UDP, one Serial API frame per datagram, run by
+ *        the lwIP task.
+ *
+ * Alternative to the TCP servers, selected by zwaveBRIDGE_API in
+ * conf_lwip_threads.h, for LAN controllers: no head of line blocking and no
+ * TCP retransmission timers on the way of a frame. Every datagram starts
+ * with a type and a sequence number (ZWaveUDP.h):
+ * - controller to bridge: DATA carries one frame for the Z-Wave module. It is
+ *   acknowledged once zw_tcp_recv_queue took the whole frame; when the queue
+ *   has no room it is dropped unacknowledged, for the controller to send it
+ *   again. Frames are taken in sequence; a repeated one is acknowledged
+ *   again but not queued twice. A DATA from another address or port starts
+ *   a new session: the controller registers with any DATA, even empty. So
+ *   does a DATA of sequence number 0 from the same address and port, past
+ *   the first zwaveUDP_WINDOW frames: the controller was restarted.
+ * - bridge to controller: the bytes of usart_recv_queue are cut into frames
+ *   (ZWaveFrame.h), each one sent as a DATA with the next sequence number.
+ *   Up to zwaveUDP_WINDOW frames wait for their ACK; the retransmission timer
+ *   sends again those that were not acknowledged within zwaveUDP_RTO, only
+ *   them, and gives up on a frame after zwaveUDP_MAX_RETRIES (counted in
+ *   zw_udp_frames_given_up). With the window full, the bytes wait in
+ *   usart_recv_queue.
+ *
+ *****************************************************************************/
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/* lwIP includes. */
+#include "lwip/udp.h"
+#include "lwip/tcpip.h"
+#include "lwip/pbuf.h"
+#include "lwip/sys.h"
+
+#include "ipc.h"
+#include "conf_lwip_threads.h"
+#include "ZWaveTCP.h"
+#include "ZWaveFrame.h"
+#include "ZWaveUDP.h"
+
+
+#if ( zwaveBRIDGE_API == zwaveBRIDGE_UDP )
+
+#if !LWIP_UDP
+#error zwaveBRIDGE_UDP requires LWIP_UDP
+#endif
+
+/*! Frames sent and not acknowledged yet, at most. A controller keeps to the
+    same window: a DATA repeated for a lost ACK is at most zwaveUDP_WINDOW
+    behind the expected one. */
+#define zwaveUDP_WINDOW		( 4 )
+
+/*! Time after which a frame not acknowledged is sent again, in ms. A LAN
+    round trip is well under it, the serial link is not in the way. */
+#define zwaveUDP_RTO		( 20 )
+
+/*! Retransmissions of a frame before it is given up. */
+#define zwaveUDP_MAX_RETRIES	( 5 )
+
+/*! \name Window slot states
+ */
+//! @{
+#define zwaveUDP_SLOT_FREE	( 0 )
+#define zwaveUDP_SLOT_FILLING	( 1 )	/*!< Frame being read from usart_recv_queue. */
+#define zwaveUDP_SLOT_SENT	( 2 )	/*!< Waiting for its ACK. */
+//! @}
+
+/*! A frame of the bridge to controller direction. */
+typedef struct
+{
+	u8_t ucState;
+	u8_t ucSeq;
+	u8_t ucRetries;
+	u16_t usLength;
+	portTickType xSentTime;
+	u8_t pucFrame[ zwaveFRAME_MAX_SIZE ];
+} xZwaveUdpSlot;
+
+static xZwaveUdpSlot xZwaveUdpWindow[ zwaveUDP_WINDOW ];
+
+/*! The slot the serial bytes go to, NULL when none is filling. */
+static xZwaveUdpSlot *pxZwaveUdpFilling = NULL;
+
+/*! Frame boundaries in usart_recv_queue. */
+static xZwaveFrameParser xZwaveUdpParser;
+
+/*! Sequence number of the next frame to the controller. */
+static u8_t ucZwaveUdpNextSeq = 0;
+
+/*! Sequence number of the next frame expected from the controller. */
+static u8_t ucZwaveUdpExpectedSeq = 0;
+
+static struct udp_pcb *pxZwaveUdpPcb = NULL;
+
+/*! Address and port of the controller, valid if xZwaveUdpHasPeer. */
+static struct ip_addr xZwaveUdpPeer;
+static u16_t usZwaveUdpPeerPort;
+static portBASE_TYPE xZwaveUdpHasPeer = pdFALSE;
+
+/*! pdTRUE while the retransmission timer is armed. */
+static portBASE_TYPE xZwaveUdpTimerArmed = pdFALSE;
+
+/*! pdTRUE while a prvZwaveUdpService() call is queued to the lwIP task. */
+static volatile portBASE_TYPE xZwaveUdpKickPending = pdFALSE;
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+/*! Storage of the TCP to serial queue. */
+static unsigned char ucUdpRecvQueueStorage[ queueSTATIC_STORAGE_SIZE( zwaveRECV_QUEUE_LENGTH, 1 ) ];
+static xStaticQueue xUdpRecvQueueBuffer;
+#endif
+
+static void prvZwaveUdpRecv( void *pvArg, struct udp_pcb *pxPcb, struct pbuf *pxP, struct ip_addr *pxAddr, u16_t usPort );
+static void prvZwaveUdpTimer( void *pvArg );
+
+
+void vZwaveUdpInit( void *pvParameters )
+{
+	( void ) pvParameters;
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	zw_tcp_recv_queue = xQueueCreateStatic(zwaveRECV_QUEUE_LENGTH, 1, ucUdpRecvQueueStorage, &xUdpRecvQueueBuffer);
+#else
+	zw_tcp_recv_queue = xQueueCreate(zwaveRECV_QUEUE_LENGTH, 1);
+#endif
+	vZwaveFrameReset(&xZwaveUdpParser);
+
+	pxZwaveUdpPcb = udp_new();
+	if (pxZwaveUdpPcb == NULL)
+		return;
+	if (udp_bind(pxZwaveUdpPcb, IP_ADDR_ANY, zwavePORT) != ERR_OK){
+		udp_remove(pxZwaveUdpPcb);
+		pxZwaveUdpPcb = NULL;
+		return;
+	}
+	udp_recv(pxZwaveUdpPcb, prvZwaveUdpRecv, NULL);
+}
+
+
+/*! \brief Sends a datagram of header and payload to the controller.
+ *
+ *  \return ERR_OK, or the error of the allocation or of the send.
+ */
+static err_t prvZwaveUdpSend( u8_t ucType, u8_t ucSeq, const u8_t *pucPayload, u16_t usLength )
+{
+	struct pbuf *pxP;
+	err_t xErr;
+
+	pxP = pbuf_alloc(PBUF_TRANSPORT, zwaveUDP_HEADER_SIZE + usLength, PBUF_RAM);
+	if (pxP == NULL)
+		return ERR_MEM;
+	((u8_t *)pxP->payload)[0] = ucType;
+	((u8_t *)pxP->payload)[1] = ucSeq;
+	if (usLength > 0)
+		memcpy((u8_t *)pxP->payload + zwaveUDP_HEADER_SIZE, pucPayload, usLength);
+	xErr = udp_sendto(pxZwaveUdpPcb, pxP, &xZwaveUdpPeer, usZwaveUdpPeerPort);
+	pbuf_free(pxP);
+	return xErr;
+}
+
+
+/*! \brief Sends a frame of the window, first time or again.
+ */
+static void prvZwaveUdpSendSlot( xZwaveUdpSlot *pxSlot )
+{
+	/* A send that failed (no pbuf) counts as sent: the timer retries it. */
+	if (prvZwaveUdpSend(zwaveUDP_DATA, pxSlot->ucSeq, pxSlot->pucFrame, pxSlot->usLength) == ERR_OK)
+		traceAPP_EVENT(traceEVT_TCP_WRITE, pxSlot->usLength);
+	pxSlot->xSentTime = xTaskGetTickCount();
+
+	if (!xZwaveUdpTimerArmed){
+		xZwaveUdpTimerArmed = pdTRUE;
+		sys_timeout(zwaveUDP_RTO, prvZwaveUdpTimer, NULL);
+	}
+}
+
+
+/*! \brief Cuts usart_recv_queue into frames and sends them, as long as the
+ *         window has room.
+ */
+static void prvZwaveUdpFromSerial( void )
+{
+	xZwaveUdpSlot *pxSlot;
+	u8_t ucByte;
+
+	/* No controller yet: the bytes wait in usart_recv_queue. */
+	if (!xZwaveUdpHasPeer || usart_recv_queue == NULL)
+		return;
+
+	for (;;){
+		if (pxZwaveUdpFilling == NULL){
+			for (pxSlot = xZwaveUdpWindow; pxSlot < &xZwaveUdpWindow[zwaveUDP_WINDOW]; pxSlot++){
+				if (pxSlot->ucState == zwaveUDP_SLOT_FREE)
+					break;
+			}
+			if (pxSlot == &xZwaveUdpWindow[zwaveUDP_WINDOW])
+				return;
+			pxSlot->ucState = zwaveUDP_SLOT_FILLING;
+			pxSlot->usLength = 0;
+			pxZwaveUdpFilling = pxSlot;
+		}
+
+		if (xQueueReceive(usart_recv_queue, &ucByte, 0) != pdPASS)
+			return;
+		pxSlot = pxZwaveUdpFilling;
+		pxSlot->pucFrame[pxSlot->usLength++] = ucByte;
+
+		if (xZwaveFrameByte(&xZwaveUdpParser, ucByte) || pxSlot->usLength == zwaveFRAME_MAX_SIZE){
+			pxSlot->ucSeq = ucZwaveUdpNextSeq++;
+			pxSlot->ucRetries = 0;
+			pxSlot->ucState = zwaveUDP_SLOT_SENT;
+			pxZwaveUdpFilling = NULL;
+			prvZwaveUdpSendSlot(pxSlot);
+		}
+	}
+}
+
+
+/*! \brief Takes the frame of a DATA datagram to zw_tcp_recv_queue, whole or
+ *         not at all.
+ *
+ *  \return pdTRUE if the frame was queued.
+ */
+static portBASE_TYPE prvZwaveUdpToSerial( struct pbuf *pxP )
+{
+	struct pbuf *pxQ;
+	u16_t usOffset = zwaveUDP_HEADER_SIZE, i;
+
+	if (zwaveRECV_QUEUE_LENGTH - uxQueueMessagesWaiting(zw_tcp_recv_queue) < (unsigned portBASE_TYPE)(pxP->tot_len - zwaveUDP_HEADER_SIZE)){
+		zw_tcp_recv_queue_stalls++;
+		return pdFALSE;
+	}
+
+	for (pxQ = pxP; pxQ != NULL; pxQ = pxQ->next){
+		for (i = usOffset; i < pxQ->len; i++)
+			xQueueSend(zw_tcp_recv_queue, (u8_t *)pxQ->payload + i, 0);
+		usOffset = (usOffset > pxQ->len) ? usOffset - pxQ->len : 0;
+	}
+	return pdTRUE;
+}
+
+
+/*! \brief Forgets the frames sent to the previous controller.
+ */
+static void prvZwaveUdpNewPeer( struct ip_addr *pxAddr, u16_t usPort, u8_t ucSeq )
+{
+	xZwaveUdpSlot *pxSlot;
+
+	for (pxSlot = xZwaveUdpWindow; pxSlot < &xZwaveUdpWindow[zwaveUDP_WINDOW]; pxSlot++){
+		if (pxSlot->ucState == zwaveUDP_SLOT_SENT)
+			pxSlot->ucState = zwaveUDP_SLOT_FREE;
+	}
+	ip_addr_set(&xZwaveUdpPeer, pxAddr);
+	usZwaveUdpPeerPort = usPort;
+	xZwaveUdpHasPeer = pdTRUE;
+	ucZwaveUdpExpectedSeq = ucSeq;
+}
+
+
+static void prvZwaveUdpRecv( void *pvArg, struct udp_pcb *pxPcb, struct pbuf *pxP, struct ip_addr *pxAddr, u16_t usPort )
+{
+	u8_t pucHeader[ zwaveUDP_HEADER_SIZE ];
+	xZwaveUdpSlot *pxSlot;
+
+	( void ) pvArg;
+	( void ) pxPcb;
+
+	if (pbuf_copy_partial(pxP, pucHeader, zwaveUDP_HEADER_SIZE, 0) != zwaveUDP_HEADER_SIZE){
+		pbuf_free(pxP);
+		return;
+	}
+
+	if (pucHeader[0] == zwaveUDP_DATA){
+		if (!xZwaveUdpHasPeer || !ip_addr_cmp(&xZwaveUdpPeer, pxAddr) || usZwaveUdpPeerPort != usPort)
+			prvZwaveUdpNewPeer(pxAddr, usPort, pucHeader[1]);
+		else if (pucHeader[1] == 0 && (u8_t)(ucZwaveUdpExpectedSeq + zwaveUDP_WINDOW) > 2 * zwaveUDP_WINDOW)
+			/* Neither a repeat nor within the window ahead of the expected
+			one: the controller starts over. */
+			prvZwaveUdpNewPeer(pxAddr, usPort, pucHeader[1]);
+
+		if (pucHeader[1] == ucZwaveUdpExpectedSeq){
+			/* No room: not acknowledged, the controller sends it again. */
+			if (prvZwaveUdpToSerial(pxP)){
+				ucZwaveUdpExpectedSeq++;
+				prvZwaveUdpSend(zwaveUDP_ACK, pucHeader[1], NULL, 0);
+			}
+		}else if ((s8_t)(pucHeader[1] - ucZwaveUdpExpectedSeq) < 0){
+			/* Already queued, the ACK was lost. */
+			prvZwaveUdpSend(zwaveUDP_ACK, pucHeader[1], NULL, 0);
+		}
+		/* Ahead of the expected one: dropped, sent again after it. */
+	}else if (pucHeader[0] == zwaveUDP_ACK && xZwaveUdpHasPeer
+			&& ip_addr_cmp(&xZwaveUdpPeer, pxAddr) && usZwaveUdpPeerPort == usPort){
+		for (pxSlot = xZwaveUdpWindow; pxSlot < &xZwaveUdpWindow[zwaveUDP_WINDOW]; pxSlot++){
+			if (pxSlot->ucState == zwaveUDP_SLOT_SENT && pxSlot->ucSeq == pucHeader[1])
+				pxSlot->ucState = zwaveUDP_SLOT_FREE;
+		}
+	}
+	pbuf_free(pxP);
+
+	/* A new controller, or room in the window. */
+	prvZwaveUdpFromSerial();
+}
+
+
+/*! \brief Retransmission timer: sends again the frames not acknowledged in
+ *         time, only them.
+ */
+static void prvZwaveUdpTimer( void *pvArg )
+{
+	xZwaveUdpSlot *pxSlot;
+	portBASE_TYPE xPending = pdFALSE;
+	portTickType xNow = xTaskGetTickCount();
+
+	( void ) pvArg;
+
+	xZwaveUdpTimerArmed = pdFALSE;
+	for (pxSlot = xZwaveUdpWindow; pxSlot < &xZwaveUdpWindow[zwaveUDP_WINDOW]; pxSlot++){
+		if (pxSlot->ucState != zwaveUDP_SLOT_SENT)
+			continue;
+		if ((xNow - pxSlot->xSentTime) >= (zwaveUDP_RTO / portTICK_RATE_MS)){
+			if (pxSlot->ucRetries >= zwaveUDP_MAX_RETRIES){
+				pxSlot->ucState = zwaveUDP_SLOT_FREE;
+				zw_udp_frames_given_up++;
+				continue;
+			}
+			pxSlot->ucRetries++;
+			prvZwaveUdpSendSlot(pxSlot);
+		}
+		xPending = pdTRUE;
+	}
+
+	if (xPending && !xZwaveUdpTimerArmed){
+		xZwaveUdpTimerArmed = pdTRUE;
+		sys_timeout(zwaveUDP_RTO, prvZwaveUdpTimer, NULL);
+	}
+
+	/* Frames given up: room in the window. */
+	prvZwaveUdpFromSerial();
+}
+
+
+/*! \brief tcpip_callback() function queued by vZwaveUdpKick().
+ */
+static void prvZwaveUdpService( void *pvArg )
+{
+	( void ) pvArg;
+
+	xZwaveUdpKickPending = pdFALSE;
+	if (pxZwaveUdpPcb != NULL)
+		prvZwaveUdpFromSerial();
+}
+
+
+void vZwaveUdpKick( void )
+{
+	/* One call queued at a time: the mbox of the lwIP task is short. */
+	if (!xZwaveUdpKickPending){
+		xZwaveUdpKickPending = pdTRUE;
+		if (tcpip_callback_with_block(prvZwaveUdpService, NULL, 0) != ERR_OK)
+			xZwaveUdpKickPending = pdFALSE;
+	}
+}
+
+#endif /* zwaveBRIDGE_API */
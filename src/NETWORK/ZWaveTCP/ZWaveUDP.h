@@ -0,0 +1,36 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Z-Wave bridge over UDP, one Serial API frame per datagram, run by
+ *        the lwIP task.
+ *
+ *****************************************************************************/
+
+#ifndef ZWAVE_UDP_H
+#define ZWAVE_UDP_H
+
+
+/*! \name Datagram header: type, then sequence number
+ */
+//! @{
+#define zwaveUDP_HEADER_SIZE	( 2 )
+#define zwaveUDP_DATA		( 0x00 )	/*!< Followed by one Serial API frame. */
+#define zwaveUDP_ACK		( 0x01 )	/*!< Acknowledges the DATA of that sequence number. */
+//! @}
+
+
+/*! \brief Sets up the bridge pcb. Must run in the lwIP task: started with
+ *         tcpip_callback().
+ *
+ *  \param pvParameters   Input. Not Used.
+ *
+ */
+void vZwaveUdpInit( void *pvParameters );
+
+/*! \brief Has the lwIP task move the bridge data: to be called by the serial
+ *         task after it put bytes in usart_recv_queue. Never blocks.
+ *
+ */
+void vZwaveUdpKick( void );
+
+#endif
@@ -0,0 +1,253 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Host tool: sends the requests of the control service of the bridge
+ *        (ZWaveControl.h) and prints the answers.
+ *
+ *   zwave_control <board> load [seconds]
+ *   zwave_control <board> baud [rate]
+ *
+ * load: the CPU load of the board, once a second for the given time (10 s by
+ * default), from two zwaveCONTROL_LOAD answers a second apart: the busy
+ * share of the CPU (all but the idle task), the share of the serial task and
+ * that of the USART interrupt, which is charged to the tasks it interrupts as
+ * well. Run it while the controller forwards a sustained stream.
+ *
+ * baud: switches the serial port of the Z-Wave module to the given rate,
+ * then prints the set point, the rate the USART generates and its error.
+ *
+ * The board answers when built with zwaveCONTROL 1, and only to a host on
+ * its subnet.
+ *
+ * Built with the host compiler: cc -O2 -o zwave_control zwave_control.c
+ * src/TEST/test_zwave_control.c checks the decoding of the answers.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ZWaveControl.h"
+
+
+//! A zwaveCONTROL_LOAD answer.
+typedef struct
+{
+  unsigned long ulNow;                            //!< Run time counter.
+  unsigned long ulIdle;                           //!< Run time of the idle task.
+  unsigned long ulSerialTask;                     //!< Run time of the serial task.
+  unsigned long ulSerialInterrupt;                //!< Run time of the USART interrupt.
+} xZwaveLoad;
+
+//! Length of a zwaveCONTROL_LOAD answer.
+#define zwaveCONTROL_LOAD_SIZE  18
+
+//! A zwaveCONTROL_BAUD answer.
+typedef struct
+{
+  unsigned long ulSetPoint;                       //!< Baud rate set point.
+  unsigned long ulActual;                         //!< Baud rate generated.
+  int iError;                                     //!< Its error, in 0.01 %.
+} xZwaveBaud;
+
+//! Length of a zwaveCONTROL_BAUD answer.
+#define zwaveCONTROL_BAUD_SIZE  12
+
+
+/*! \brief Reads a big endian 32 bit value. */
+static unsigned long prvGet32( const unsigned char *p )
+{
+  return ( ( unsigned long ) p[ 0 ] << 24 ) | ( ( unsigned long ) p[ 1 ] << 16 ) | ( ( unsigned long ) p[ 2 ] << 8 ) | p[ 3 ];
+}
+
+
+/*! \brief Decodes a zwaveCONTROL_LOAD answer.
+ *
+ *  \return Its status, zwaveCONTROL_BAD_REQUEST if it is not one.
+ */
+static int iZwaveLoadDecode( xZwaveLoad *pxLoad, const unsigned char *pucAnswer, size_t xLength )
+{
+  if( xLength < 2 || pucAnswer[ 0 ] != zwaveCONTROL_LOAD )
+    return zwaveCONTROL_BAD_REQUEST;
+  if( pucAnswer[ 1 ] != zwaveCONTROL_OK )
+    return pucAnswer[ 1 ];
+  if( xLength != zwaveCONTROL_LOAD_SIZE )
+    return zwaveCONTROL_BAD_REQUEST;
+
+  pxLoad->ulNow = prvGet32( pucAnswer + 2 );
+  pxLoad->ulIdle = prvGet32( pucAnswer + 6 );
+  pxLoad->ulSerialTask = prvGet32( pucAnswer + 10 );
+  pxLoad->ulSerialInterrupt = prvGet32( pucAnswer + 14 );
+  return zwaveCONTROL_OK;
+}
+
+
+/*! \brief Decodes a zwaveCONTROL_BAUD answer.
+ *
+ *  \return Its status, zwaveCONTROL_BAD_REQUEST if it is not one.
+ */
+static int iZwaveBaudDecode( xZwaveBaud *pxBaud, const unsigned char *pucAnswer, size_t xLength )
+{
+  if( xLength < 2 || pucAnswer[ 0 ] != zwaveCONTROL_BAUD )
+    return zwaveCONTROL_BAD_REQUEST;
+  if( pucAnswer[ 1 ] != zwaveCONTROL_OK )
+    return pucAnswer[ 1 ];
+  if( xLength != zwaveCONTROL_BAUD_SIZE )
+    return zwaveCONTROL_BAD_REQUEST;
+
+  pxBaud->ulSetPoint = prvGet32( pucAnswer + 2 );
+  pxBaud->ulActual = prvGet32( pucAnswer + 6 );
+  pxBaud->iError = ( short ) ( ( pucAnswer[ 10 ] << 8 ) | pucAnswer[ 11 ] );
+  return zwaveCONTROL_OK;
+}
+
+
+/*! \brief Shares of the CPU between two answers, in %. The counters are
+ *         modulo 2^32: the answers must be less than 2^32 counts apart (89 s
+ *         at 48 MHz).
+ *
+ *  \return 0 if no time passed in between.
+ */
+static int iZwaveLoadShare( const xZwaveLoad *pxFrom, const xZwaveLoad *pxTo,
+                            double *pdBusy, double *pdSerialTask, double *pdSerialInterrupt )
+{
+  double dNow = ( double ) ( ( pxTo->ulNow - pxFrom->ulNow ) & 0xFFFFFFFFUL );
+
+  if( dNow == 0 )
+    return 0;
+  *pdBusy = 100.0 - 100.0 * ( double ) ( ( pxTo->ulIdle - pxFrom->ulIdle ) & 0xFFFFFFFFUL ) / dNow;
+  *pdSerialTask = 100.0 * ( double ) ( ( pxTo->ulSerialTask - pxFrom->ulSerialTask ) & 0xFFFFFFFFUL ) / dNow;
+  *pdSerialInterrupt = 100.0 * ( double ) ( ( pxTo->ulSerialInterrupt - pxFrom->ulSerialInterrupt ) & 0xFFFFFFFFUL ) / dNow;
+  return 1;
+}
+
+
+#ifndef ZWAVE_CONTROL_NO_MAIN
+
+#include <netdb.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+/*! \brief Sends a request, waits 1 s at most for its answer.
+ *
+ *  \return The length of the answer, -1 on error or timeout.
+ */
+static int prvRequest( int iSocket, const unsigned char *pucRequest, size_t xLength,
+                       unsigned char *pucAnswer, size_t xSize )
+{
+  if( send( iSocket, pucRequest, xLength, 0 ) < 0 )
+  {
+    perror( "send" );
+    return -1;
+  }
+  return ( int ) recv( iSocket, pucAnswer, xSize, 0 );
+}
+
+static int prvLoad( int iSocket, int iSeconds )
+{
+  unsigned char ucRequest = zwaveCONTROL_LOAD, aucAnswer[ 64 ];
+  xZwaveLoad xFrom = { 0, 0, 0, 0 }, xTo;
+  double dBusy, dTask, dInterrupt;
+  int iLength, iStatus, i;
+
+  for( i = 0; i <= iSeconds; i++ )
+  {
+    if( i > 0 )
+      sleep( 1 );
+    iLength = prvRequest( iSocket, &ucRequest, 1, aucAnswer, sizeof( aucAnswer ) );
+    if( iLength < 0 )
+    {
+      fprintf( stderr, "no answer\n" );
+      return 1;
+    }
+    iStatus = iZwaveLoadDecode( &xTo, aucAnswer, ( size_t ) iLength );
+    if( iStatus != zwaveCONTROL_OK )
+    {
+      fprintf( stderr, "status %d%s\n", iStatus,
+               iStatus == zwaveCONTROL_UNSUPPORTED ? ": built without run time stats" : "" );
+      return 1;
+    }
+    if( i == 0 )
+      printf( "%8s %8s %8s\n", "cpu %", "task %", "isr %" );
+    else if( iZwaveLoadShare( &xFrom, &xTo, &dBusy, &dTask, &dInterrupt ) )
+      printf( "%8.2f %8.2f %8.2f\n", dBusy, dTask, dInterrupt );
+    fflush( stdout );
+    xFrom = xTo;
+  }
+  return 0;
+}
+
+static int prvBaud( int iSocket, unsigned long ulBaudrate )
+{
+  unsigned char aucRequest[ 5 ], aucAnswer[ 64 ];
+  xZwaveBaud xBaud;
+  int iLength, iStatus;
+
+  aucRequest[ 0 ] = zwaveCONTROL_BAUD;
+  aucRequest[ 1 ] = ( unsigned char ) ( ulBaudrate >> 24 );
+  aucRequest[ 2 ] = ( unsigned char ) ( ulBaudrate >> 16 );
+  aucRequest[ 3 ] = ( unsigned char ) ( ulBaudrate >> 8 );
+  aucRequest[ 4 ] = ( unsigned char ) ulBaudrate;
+  iLength = prvRequest( iSocket, aucRequest, ulBaudrate ? 5 : 1, aucAnswer, sizeof( aucAnswer ) );
+  if( iLength < 0 )
+  {
+    fprintf( stderr, "no answer\n" );
+    return 1;
+  }
+  iStatus = iZwaveBaudDecode( &xBaud, aucAnswer, ( size_t ) iLength );
+  if( iStatus != zwaveCONTROL_OK )
+  {
+    fprintf( stderr, "status %d%s\n", iStatus,
+             iStatus == zwaveCONTROL_BAD_REQUEST ? ": rate out of range or tolerance" :
+             iStatus == zwaveCONTROL_BUSY ? ": the USART is sending, try again" : "" );
+    return 1;
+  }
+  printf( "set point %lu, actual %lu bit/s, error %+.2f %%\n",
+          xBaud.ulSetPoint, xBaud.ulActual, xBaud.iError / 100.0 );
+  return 0;
+}
+
+int main( int argc, char **argv )
+{
+  struct addrinfo xHints, *pxAddress;
+  struct timeval xTimeout = { 1, 0 };
+  char acPort[ 8 ];
+  int iSocket, iLoad;
+  long lArgument = 0;
+
+  iLoad = argc >= 3 && strcmp( argv[ 2 ], "load" ) == 0;
+  if( argc < 3 || argc > 4 || ( !iLoad && strcmp( argv[ 2 ], "baud" ) != 0 ) )
+  {
+    fprintf( stderr, "usage: %s <board> load [seconds]\n"
+                     "       %s <board> baud [rate]\n", argv[ 0 ], argv[ 0 ] );
+    return 2;
+  }
+  if( argc == 4 )
+    lArgument = atol( argv[ 3 ] );
+  else if( iLoad )
+    lArgument = 10;
+
+  memset( &xHints, 0, sizeof( xHints ) );
+  xHints.ai_family = AF_INET;
+  xHints.ai_socktype = SOCK_DGRAM;
+  snprintf( acPort, sizeof( acPort ), "%d", zwaveCONTROL_PORT );
+  if( getaddrinfo( argv[ 1 ], acPort, &xHints, &pxAddress ) != 0 )
+  {
+    fprintf( stderr, "%s: unknown host\n", argv[ 1 ] );
+    return 1;
+  }
+  iSocket = socket( pxAddress->ai_family, pxAddress->ai_socktype, pxAddress->ai_protocol );
+  if( iSocket < 0 || connect( iSocket, pxAddress->ai_addr, pxAddress->ai_addrlen ) < 0 )
+  {
+    perror( argv[ 1 ] );
+    return 1;
+  }
+  freeaddrinfo( pxAddress );
+  setsockopt( iSocket, SOL_SOCKET, SO_RCVTIMEO, &xTimeout, sizeof( xTimeout ) );
+
+  return iLoad ? prvLoad( iSocket, ( int ) lArgument ) : prvBaud( iSocket, ( unsigned long ) lArgument );
+}
+
+#endif
@@ -76,6 +76,16 @@
 
 /*ZWave TCP server includes */
 #include "ZWaveTCP.h"
+#include "ZWaveRaw.h"
+#include "ZWaveSelect.h"
+#include "ZWaveUDP.h"
+#include "ZWaveEvent.h"
+#include "ZWaveControl.h"
+
+#if (configUSE_TRACE_RECORDER == 1)
+/* Trace server includes */
+#include "TraceTCP.h"
+#endif
 
 
 //_____ M A C R O S ________________________________________________________
@@ -149,7 +159,32 @@ portTASK_FUNCTION( vStartEthernetTask, pvParameters )
 //                   lwipBASIC_SMTP_CLIENT_STACK_SIZE,
 //                   lwipBASIC_SMTP_CLIENT_PRIORITY );
 //#endif
-   sys_thread_new("ZWave", vBasicZwaveServer, ( void *) NULL, 512, 1);
+#if zwaveBRIDGE_API == zwaveBRIDGE_RAW
+   /* The raw API bridge is set up in the lwIP task, it has no task of its own. */
+   tcpip_callback( vZwaveRawInit, NULL );
+#elif zwaveBRIDGE_API == zwaveBRIDGE_UDP
+   /* So is the UDP bridge. */
+   tcpip_callback( vZwaveUdpInit, NULL );
+#elif zwaveBRIDGE_API == zwaveBRIDGE_SELECT
+   sys_thread_new("ZWave", vZwaveSelectServer, ( void *) NULL, lwipZWAVE_SERVER_STACK_SIZE, 1);
+#else
+   sys_thread_new("ZWave", vBasicZwaveServer, ( void *) NULL, lwipZWAVE_SERVER_STACK_SIZE, 1);
+#endif
+#if zwaveEVENT_MULTICAST == 1
+   /* Multicast of the unsolicited frames, run by the lwIP task as well. */
+   tcpip_callback( vZwaveEventInit, NULL );
+#endif
+#if zwaveCONTROL == 1
+   /* So is the control of the bridge. */
+   tcpip_callback( vZwaveControlInit, NULL );
+#endif
+
+#if (configUSE_TRACE_RECORDER == 1)
+   /* Create the trace server task.  This uses the lwIP RTOS abstraction layer.*/
+   sys_thread_new( "TRACE", vTraceTCPServer, ( void * ) NULL,
+                   lwipTRACE_SERVER_STACK_SIZE,
+                   lwipTRACE_SERVER_PRIORITY );
+#endif
   // Kill this task.
   vTaskDelete(NULL);
 }
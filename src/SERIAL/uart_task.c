@@ -108,11 +108,27 @@
 #include "partest.h"
 #include "task.h"
 #include "queue.h"
+#include "semphr.h"
+#include "intc.h"
 #include "lwip/api.h"
 
 #include <stdio.h>
 #include <string.h>
 #include "ipc.h"
+#include "uart_task.h"
+#include "conf_lwip_threads.h"
+#if zwaveBRIDGE_API == zwaveBRIDGE_NETCONN
+#include "ZWaveCoalesce.h"
+#elif zwaveBRIDGE_API == zwaveBRIDGE_RAW
+#include "ZWaveRaw.h"
+#elif zwaveBRIDGE_API == zwaveBRIDGE_SELECT
+#include "ZWaveSelect.h"
+#elif zwaveBRIDGE_API == zwaveBRIDGE_UDP
+#include "ZWaveUDP.h"
+#endif
+#if zwaveEVENT_MULTICAST == 1
+#include "ZWaveEvent.h"
+#endif
 /*! \name USART Settings
  */
 //! @{
@@ -126,6 +142,11 @@
 #  define EXAMPLE_USART_TX_PIN        AVR32_USART1_TXD_0_0_PIN
 #  define EXAMPLE_USART_TX_FUNCTION   AVR32_USART1_TXD_0_0_FUNCTION
 #  define EXAMPLE_USART_CLOCK_MASK    AVR32_USART1_CLK_PBA
+#  define EXAMPLE_USART_IRQ           AVR32_USART1_IRQ
+#  define EXAMPLE_USART_RTS_PIN       AVR32_USART1_RTS_0_0_PIN
+#  define EXAMPLE_USART_RTS_FUNCTION  AVR32_USART1_RTS_0_0_FUNCTION
+#  define EXAMPLE_USART_CTS_PIN       AVR32_USART1_CTS_0_0_PIN
+#  define EXAMPLE_USART_CTS_FUNCTION  AVR32_USART1_CTS_0_0_FUNCTION
 #  define EXAMPLE_PDCA_CLOCK_HSB      AVR32_PDCA_CLK_HSB
 #  define EXAMPLE_PDCA_CLOCK_PB       AVR32_PDCA_CLK_PBA
 #elif BOARD == EVK1101
@@ -135,6 +156,7 @@
 #  define EXAMPLE_USART_TX_PIN        AVR32_USART1_TXD_0_0_PIN
 #  define EXAMPLE_USART_TX_FUNCTION   AVR32_USART1_TXD_0_0_FUNCTION
 #  define EXAMPLE_USART_CLOCK_MASK    AVR32_USART1_CLK_PBA
+#  define EXAMPLE_USART_IRQ           AVR32_USART1_IRQ
 #  define EXAMPLE_PDCA_CLOCK_HSB      AVR32_PDCA_CLK_HSB
 #  define EXAMPLE_PDCA_CLOCK_PB       AVR32_PDCA_CLK_PBA
 #elif BOARD == UC3C_EK
@@ -144,6 +166,7 @@
 #  define EXAMPLE_USART_TX_PIN        AVR32_USART2_TXD_0_1_PIN
 #  define EXAMPLE_USART_TX_FUNCTION   AVR32_USART2_TXD_0_1_FUNCTION
 #  define EXAMPLE_USART_CLOCK_MASK    AVR32_USART2_CLK_PBA
+#  define EXAMPLE_USART_IRQ           AVR32_USART2_IRQ
 #  define EXAMPLE_PDCA_CLOCK_HSB      AVR32_PDCA_CLK_HSB
 #  define EXAMPLE_PDCA_CLOCK_PB       AVR32_PDCA_CLK_PBB
 #elif BOARD == EVK1104
@@ -153,6 +176,7 @@
 #  define EXAMPLE_USART_TX_PIN        AVR32_USART1_TXD_0_0_PIN
 #  define EXAMPLE_USART_TX_FUNCTION   AVR32_USART1_TXD_0_0_FUNCTION
 #  define EXAMPLE_USART_CLOCK_MASK    AVR32_USART1_CLK_PBA
+#  define EXAMPLE_USART_IRQ           AVR32_USART1_IRQ
 #  define EXAMPLE_PDCA_CLOCK_HSB      AVR32_PDCA_CLK_HSB
 #  define EXAMPLE_PDCA_CLOCK_PB       AVR32_PDCA_CLK_PBA
 #elif BOARD == EVK1105
@@ -162,6 +186,7 @@
 #  define EXAMPLE_USART_TX_PIN        AVR32_USART0_TXD_0_0_PIN
 #  define EXAMPLE_USART_TX_FUNCTION   AVR32_USART0_TXD_0_0_FUNCTION
 #  define EXAMPLE_USART_CLOCK_MASK    AVR32_USART0_CLK_PBA
+#  define EXAMPLE_USART_IRQ           AVR32_USART0_IRQ
 #  define EXAMPLE_PDCA_CLOCK_HSB      AVR32_PDCA_CLK_HSB
 #  define EXAMPLE_PDCA_CLOCK_PB       AVR32_PDCA_CLK_PBA
 #elif BOARD == STK600_RCUC3L0
@@ -173,6 +198,7 @@
 #  define EXAMPLE_USART_TX_FUNCTION   AVR32_USART1_TXD_0_1_FUNCTION
 // For the TX pin, connect STK600.PORTE.PE2 to STK600.RS232 SPARE.TXD
 #  define EXAMPLE_USART_CLOCK_MASK    AVR32_USART1_CLK_PBA
+#  define EXAMPLE_USART_IRQ           AVR32_USART1_IRQ
 #  define EXAMPLE_PDCA_CLOCK_HSB      AVR32_PDCA_CLK_HSB
 #  define EXAMPLE_PDCA_CLOCK_PB       AVR32_PDCA_CLK_PBA
 #elif BOARD == UC3L_EK
@@ -182,6 +208,7 @@
 #  define EXAMPLE_USART_TX_PIN          AVR32_USART3_TXD_0_0_PIN
 #  define EXAMPLE_USART_TX_FUNCTION     AVR32_USART3_TXD_0_0_FUNCTION
 #  define EXAMPLE_USART_CLOCK_MASK      AVR32_USART3_CLK_PBA
+#  define EXAMPLE_USART_IRQ             AVR32_USART3_IRQ
 #  define EXAMPLE_TARGET_DFLL_FREQ_HZ   96000000  // DFLL target frequency, in Hz
 #  define EXAMPLE_TARGET_MCUCLK_FREQ_HZ 12000000  // MCU clock target frequency, in Hz
 #  undef  EXAMPLE_TARGET_PBACLK_FREQ_HZ
@@ -198,6 +225,11 @@
 #  error The USART configuration to use in this example is missing.
 #endif
 
+#if zwaveSERIAL_RTSCTS == 1 && \
+		(!defined(EXAMPLE_USART_RTS_PIN) || !defined(EXAMPLE_USART_CTS_PIN))
+#  error The RTS and CTS pins of the Z-Wave serial port are missing.
+#endif
+
 //! @}
 
 
@@ -223,12 +255,20 @@ static const gpio_map_t USART_GPIO_MAP =
 {
 		{EXAMPLE_USART_RX_PIN, EXAMPLE_USART_RX_FUNCTION},
 		{EXAMPLE_USART_TX_PIN, EXAMPLE_USART_TX_FUNCTION}
+#if zwaveSERIAL_RTSCTS == 1
+		,
+		{EXAMPLE_USART_RTS_PIN, EXAMPLE_USART_RTS_FUNCTION},
+		{EXAMPLE_USART_CTS_PIN, EXAMPLE_USART_CTS_FUNCTION}
+#endif
 };
 
+//! Baud rate of the Z-Wave module at start up, see xSerialSetBaudrate().
+#define USART_BAUDRATE           57600
+
 // USART options.
 static const usart_options_t USART_OPTIONS =
 {
-		.baudrate     = 57600,
+		.baudrate     = USART_BAUDRATE,
 		.charlength   = 8,
 		.paritytype   = USART_NO_PARITY,
 		.stopbits     = USART_1_STOPBIT,
@@ -236,11 +276,97 @@ static const usart_options_t USART_OPTIONS =
 };
 
 
+//! Length of the serial to TCP queue.
+#define USART_RECV_QUEUE_LENGTH  1000
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+//! Storage of the serial to TCP queue.
+static unsigned char usart_recv_queue_storage[queueSTATIC_STORAGE_SIZE(USART_RECV_QUEUE_LENGTH, 1)];
+static xStaticQueue usart_recv_queue_buffer;
+#endif
+
+//! Receiver time-out, in bit periods: the RX line idle for 3 characters ends
+//! a burst of the Z-Wave module.
+#define USART_RX_TIMEOUT_BITS    30
+
+//! Bytes the USART interrupt keeps for the serial task, power of 2.
+#define USART_RX_RING_SIZE       256
+
+//! Filled by the USART interrupt at usart_rx_head, drained by the serial task
+//! at usart_rx_tail: free running indexes, masked on access.
+static volatile unsigned char usart_rx_ring[USART_RX_RING_SIZE];
+static volatile unsigned short usart_rx_head = 0;
+static volatile unsigned short usart_rx_tail = 0;
+
+#if zwaveSERIAL_RTSCTS == 1
+//! RX ring fill levels at which RTS is deasserted, then asserted again: a
+//! quarter of the ring left for the bytes the module sends before it stops.
+#define USART_RX_RTS_OFF         (USART_RX_RING_SIZE * 3 / 4)
+#define USART_RX_RTS_ON          (USART_RX_RING_SIZE / 4)
+
+//! pdTRUE while RTS is deasserted.
+static volatile portBASE_TYPE usart_rx_throttled = pdFALSE;
+#endif
+
+//! Given by the USART interrupt at the end of a burst, or once the ring is
+//! half full.
+static xSemaphoreHandle usart_rx_burst = NULL;
+#if configSUPPORT_STATIC_ALLOCATION == 1
+static xStaticQueue usart_rx_burst_buffer;
+#endif
+
+//! Bytes waiting for the USART transmitter, power of 2.
+#define USART_TX_RING_SIZE       256
+
+//! Filled by usSerialTxWrite() at usart_tx_head, drained by the USART
+//! interrupt at usart_tx_tail.
+static volatile unsigned char usart_tx_ring[USART_TX_RING_SIZE];
+static volatile unsigned short usart_tx_head = 0;
+static volatile unsigned short usart_tx_tail = 0;
+
+//! pdTRUE from a write until its last byte left the shift register.
+static volatile portBASE_TYPE usart_tx_busy = pdFALSE;
+
+//! Given by the USART interrupt once the transmitter is idle.
+static xSemaphoreHandle usart_tx_done = NULL;
+#if configSUPPORT_STATIC_ALLOCATION == 1
+static xStaticQueue usart_tx_done_buffer;
+#endif
+
+//! Baud rate set point of the USART.
+static volatile unsigned long usart_baudrate = USART_BAUDRATE;
+
+//! The serial task, once started.
+static xTaskHandle usart_task = NULL;
+
+#if configGENERATE_RUN_TIME_STATS == 1
+//! Run time of the USART interrupt, in run time counter increments: charged
+//! to the task it interrupted as well.
+static unsigned long long usart_isr_run_time = 0;
+#endif
+
+/*
+ * The USART interrupt: takes the received bytes, ends the bursts.
+ */
+#if defined(__GNUC__)
+__attribute__((__naked__))
+#elif defined(__ICCAVR32__)
+#pragma shadow_registers = full   // Naked.
+#endif
+static void usart_isr(void);
+static long usart_isr_non_naked_behaviour(void);
+
+static void usart_rx_drain(void);
+static signed short usart_baudrate_error(unsigned long baudrate, unsigned long *actual);
+
+
 portTASK_FUNCTION(vBasicSerialServer, pvParameters)
 {
-	int recieved;
-	char tcp_char;
-	char debug[100];
+	char tx_chunk[32];
+	unsigned short tx_length, tx_room;
+
+	usart_task = xTaskGetCurrentTaskHandle();
+
 	// Configure Osc0 in crystal mode (i.e. use of an external crystal source, with
 	// frequency FOSC0) with an appropriate startup time then switch the main clock
 	// source to Osc0.
@@ -252,39 +378,82 @@ portTASK_FUNCTION(vBasicSerialServer, pvParameters)
 	// Initialize USART in RS232 mode.
 	usart_init_rs232(EXAMPLE_USART, &USART_OPTIONS, EXAMPLE_TARGET_PBACLK_FREQ_HZ);
 
-	usart_recv_queue = (xQueueHandle)xQueueCreate(1000, 1);
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	usart_recv_queue = xQueueCreateStatic(USART_RECV_QUEUE_LENGTH, 1, usart_recv_queue_storage, &usart_recv_queue_buffer);
+#else
+	usart_recv_queue = (xQueueHandle)xQueueCreate(USART_RECV_QUEUE_LENGTH, 1);
+#endif
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	vSemaphoreCreateBinaryStatic(usart_rx_burst, &usart_rx_burst_buffer);
+#else
+	vSemaphoreCreateBinary(usart_rx_burst);
+#endif
+	// Created given: no burst yet.
+	xSemaphoreTake(usart_rx_burst, 0);
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	vSemaphoreCreateBinaryStatic(usart_tx_done, &usart_tx_done_buffer);
+#else
+	vSemaphoreCreateBinary(usart_tx_done);
+#endif
+
+	// Receive under interrupt, the receiver time-out marks the end of each
+	// burst: no polling of the USART.
+	usart_set_rx_timeout(EXAMPLE_USART, USART_RX_TIMEOUT_BITS);
+#if zwaveBRIDGE_API == zwaveBRIDGE_NETCONN
+	// Times the idle gaps of the serial line for the coalescing policy:
+	// started before the interrupt stamps the first byte.
+	vZwaveCoalesceTimerInit();
+#endif
+	INTC_register_interrupt((__int_handler)&usart_isr, EXAMPLE_USART_IRQ, AVR32_INTC_INT2);
+	EXAMPLE_USART->ier = AVR32_USART_IER_RXRDY_MASK | AVR32_USART_IER_TIMEOUT_MASK |
+			AVR32_USART_IER_OVRE_MASK | AVR32_USART_IER_FRAME_MASK | AVR32_USART_IER_PARE_MASK;
+#if zwaveSERIAL_RTSCTS == 1
+	// Handshaking done here rather than in the USART hardware handshaking
+	// mode: there, RTS only follows the receiver enable and the PDCA buffer.
+	EXAMPLE_USART->cr = AVR32_USART_CR_RTSEN_MASK;
+#endif
 
 	// Hello world!
 	for(;;)
 	{
-		usart_write_line(EXAMPLE_USART, "W\n");
-
-
 		// Press enter to continue.
 		vParTestToggleLED(0);
-		while (!usart_test_hit(EXAMPLE_USART)){
+		// Until the end of a burst: the interrupt takes the bytes meanwhile,
+		// the TCP to serial side is polled.
+		while (xSemaphoreTake(usart_rx_burst, 10/portTICK_RATE_MS) != pdTRUE){
 			if(zw_tcp_recv_queue && uxQueueMessagesWaiting(zw_tcp_recv_queue)){
-				sprintf(debug, "%d\n", (int)uxQueueMessagesWaiting(zw_tcp_recv_queue));
-				usart_write_line(EXAMPLE_USART, debug);
-				while(uxQueueMessagesWaiting(zw_tcp_recv_queue)>0){
+				// Only what the TX ring has room for: the rest waits in
+				// zw_tcp_recv_queue, the TCP window closing meanwhile. The
+				// interrupt sends the bytes, nothing waits for the USART.
+				do{
 					vParTestToggleLED(1);
-					xQueueReceive(zw_tcp_recv_queue, &tcp_char, 100);
-					usart_putchar(EXAMPLE_USART, tcp_char);
-				}
-				usart_putchar(EXAMPLE_USART, '\n');
-				usart_write_line(EXAMPLE_USART, "F1\n");
+					tx_length = 0;
+					tx_room = usSerialTxRoom();
+					while(tx_length < sizeof(tx_chunk) && tx_length < tx_room
+							&& xQueueReceive(zw_tcp_recv_queue, &tx_chunk[tx_length], 0) == pdPASS){
+						traceAPP_EVENT(traceEVT_USART_TX, (unsigned char)tx_chunk[tx_length]);
+						tx_length++;
+					}
+					usSerialTxWrite(tx_chunk, tx_length);
+				}while(tx_length == sizeof(tx_chunk));
+#if zwaveBRIDGE_API == zwaveBRIDGE_RAW
+				// Room in zw_tcp_recv_queue: the bridge takes the data it kept.
+				vZwaveRawKick();
+#elif zwaveBRIDGE_API == zwaveBRIDGE_SELECT
+				vZwaveSelectKick();
+#endif
 			}
-			vTaskDelay(10/portTICK_RATE_MS);// Block while there is nothing to .
+			// A long burst: its first bytes are passed on before its end.
+			usart_rx_drain();
+#if zwaveBRIDGE_API == zwaveBRIDGE_UDP
+			// Retries a kick lost to a full mbox of the lwIP task.
+			if(uxQueueMessagesWaiting(usart_recv_queue)>0)
+				vZwaveUdpKick();
+#endif
 		}
 		vParTestToggleLED(0);
 
-		while(usart_test_hit(EXAMPLE_USART)){
-			recieved = usart_getchar(EXAMPLE_USART);
-			usart_recv_queue_spoiled = xQueueSend(usart_recv_queue, &recieved, 100);
-		}
-		sprintf(debug, "urq: %d ", (int)uxQueueMessagesWaiting(usart_recv_queue));
-		usart_write_line(EXAMPLE_USART, debug);
-		usart_write_line(EXAMPLE_USART, "F2.\n");
+		usart_rx_drain();
 	}
 
 	//*** Sleep mode
@@ -293,7 +462,328 @@ portTASK_FUNCTION(vBasicSerialServer, pvParameters)
 	// Modules communicating with external circuits should normally be disabled
 	// before entering a sleep mode that will stop the module operation.
 	// Make sure the USART dumps the last message completely before turning it off.
-	while(!usart_tx_empty(EXAMPLE_USART));
+	xSerialTxWaitDone(portMAX_DELAY);
 	vTaskDelete(NULL);
 }
 
+
+unsigned portSHORT usSerialTxWrite( const portCHAR *pcBuffer, unsigned portSHORT usLength )
+{
+	unsigned short head, room, i;
+
+	if (usart_tx_done == NULL)
+		return 0;
+
+	portENTER_CRITICAL();
+	head = usart_tx_head;
+	room = USART_TX_RING_SIZE - (unsigned short)(head - usart_tx_tail);
+	if (usLength > room)
+		usLength = room;
+	for (i = 0; i < usLength; i++)
+		usart_tx_ring[(unsigned short)(head + i) & (USART_TX_RING_SIZE - 1)] = pcBuffer[i];
+	usart_tx_head = head + usLength;
+	if (usLength > 0){
+		// The interrupt sends from the ring until it is empty.
+		usart_tx_busy = pdTRUE;
+		EXAMPLE_USART->ier = AVR32_USART_IER_TXRDY_MASK;
+	}
+	portEXIT_CRITICAL();
+
+	return usLength;
+}
+
+
+unsigned portSHORT usSerialTxRoom( void )
+{
+	return USART_TX_RING_SIZE - (unsigned short)(usart_tx_head - usart_tx_tail);
+}
+
+
+portBASE_TYPE xSerialTxWaitDone( portTickType xTicksToWait )
+{
+	portTickType xStart = xTaskGetTickCount(), xElapsed;
+
+	// usart_tx_done may be stale, given for an earlier write: usart_tx_busy
+	// tells.
+	while (usart_tx_busy){
+		xElapsed = xTaskGetTickCount() - xStart;
+		if (xElapsed >= xTicksToWait)
+			return pdFALSE;
+		xSemaphoreTake(usart_tx_done, xTicksToWait - xElapsed);
+	}
+	return pdTRUE;
+}
+
+
+unsigned portLONG ulSerialBaudrateFor( unsigned portLONG ulBaudrate, signed portSHORT *psError )
+{
+	unsigned long actual;
+	signed short error = usart_baudrate_error(ulBaudrate, &actual);
+
+	if (psError != NULL)
+		*psError = error;
+	return actual;
+}
+
+
+unsigned portLONG ulSerialGetBaudrate( signed portSHORT *psError )
+{
+	return ulSerialBaudrateFor(usart_baudrate, psError);
+}
+
+
+unsigned portLONG ulSerialGetBaudrateSetPoint( void )
+{
+	return usart_baudrate;
+}
+
+
+#if configGENERATE_RUN_TIME_STATS == 1
+void vSerialGetRunTime( unsigned long long *pullTask, unsigned long long *pullInterrupt )
+{
+	*pullTask = (usart_task != NULL) ? ullTaskGetRunTimeCounter(usart_task) : 0;
+	// 64 bits, written by the interrupt.
+	portENTER_CRITICAL();
+	*pullInterrupt = usart_isr_run_time;
+	portEXIT_CRITICAL();
+}
+#endif
+
+
+portBASE_TYPE xSerialSetBaudrate( unsigned portLONG ulBaudrate, portTickType xTicksToWait )
+{
+	unsigned long actual;
+	signed short error = usart_baudrate_error(ulBaudrate, &actual);
+
+	// Checked first: a rate the USART cannot generate keeps the current one.
+	// Not before the serial task set up the USART.
+	if (usart_tx_done == NULL || actual == 0 || error > serialBAUDRATE_TOLERANCE || error < -serialBAUDRATE_TOLERANCE)
+		return pdFAIL;
+
+	// The last byte at the old rate on the wire first. Checked again with
+	// the interrupts masked: another task may have written meanwhile.
+	for (;;){
+		if (!xSerialTxWaitDone(xTicksToWait))
+			return pdFAIL;
+		portENTER_CRITICAL();
+		if (!usart_tx_busy)
+			break;
+		portEXIT_CRITICAL();
+	}
+	usart_set_baudrate(EXAMPLE_USART, ulBaudrate, EXAMPLE_TARGET_PBACLK_FREQ_HZ);
+	usart_baudrate = ulBaudrate;
+	portEXIT_CRITICAL();
+
+	return pdPASS;
+}
+
+
+/*! \brief Error of the baud rate the USART generates for a set point.
+ *
+ *  \param baudrate  Input. The set point.
+ *  \param actual    Output. The generated baud rate, 0 if out of range.
+ *
+ *  \return (actual - baudrate) / baudrate, in 0.01 %, saturated.
+ */
+static signed short usart_baudrate_error(unsigned long baudrate, unsigned long *actual)
+{
+	long error;
+
+	*actual = usart_get_actual_baudrate(baudrate, EXAMPLE_TARGET_PBACLK_FREQ_HZ);
+	if (*actual == 0 || baudrate < 100)
+		return 0x7FFF;
+	// In 32 bits up to a 20 % error at 1 Mbaud.
+	error = ((long)*actual - (long)baudrate) * 100 / (long)(baudrate / 100);
+	if (error > 0x7FFF)
+		return 0x7FFF;
+	if (error < -0x7FFF)
+		return -0x7FFF;
+	return (signed short)error;
+}
+
+
+/*! \brief Passes the bytes the USART interrupt took on to usart_recv_queue.
+ */
+static void usart_rx_drain(void)
+{
+	unsigned short tail = usart_rx_tail;
+	unsigned char c;
+
+	if (tail == usart_rx_head)
+		return;
+
+	while (tail != usart_rx_head){
+		c = usart_rx_ring[tail & (USART_RX_RING_SIZE - 1)];
+#if zwaveEVENT_MULTICAST == 1
+		// Unsolicited frames are published to every listener.
+		vZwaveEventByte(c);
+#endif
+		// Never wait for room: the ring would fill up and the interrupt
+		// lose the next bytes. Counted instead.
+		if(xQueueSend(usart_recv_queue, &c, 0) != pdPASS)
+			usart_recv_queue_spoiled++;
+		// Room for the interrupt right away.
+		usart_rx_tail = ++tail;
+	}
+
+#if zwaveSERIAL_RTSCTS == 1
+	// Drained: the module may send again.
+	portENTER_CRITICAL();
+	if (usart_rx_throttled && (unsigned short)(usart_rx_head - usart_rx_tail) <= USART_RX_RTS_ON){
+		usart_rx_throttled = pdFALSE;
+		EXAMPLE_USART->cr = AVR32_USART_CR_RTSEN_MASK;
+	}
+	portEXIT_CRITICAL();
+#endif
+
+	if(uxQueueMessagesWaiting(usart_recv_queue) > usart_recv_queue_peak)
+		usart_recv_queue_peak = uxQueueMessagesWaiting(usart_recv_queue);
+#if zwaveBRIDGE_API == zwaveBRIDGE_RAW
+	// Have the bridge send the bytes to the controller.
+	vZwaveRawKick();
+#elif zwaveBRIDGE_API == zwaveBRIDGE_SELECT
+	vZwaveSelectKick();
+#elif zwaveBRIDGE_API == zwaveBRIDGE_UDP
+	vZwaveUdpKick();
+#endif
+}
+
+
+/*
+ * The USART ISR. Handles the received bytes, the receiver time-out and the
+ * TX ring.
+ */
+#if defined(__GNUC__)
+__attribute__((__naked__))
+#elif defined(__ICCAVR32__)
+#pragma shadow_registers = full   // Naked.
+#endif
+static void usart_isr(void)
+{
+	// This ISR can cause a context switch, so the first statement must be a
+	// call to the portENTER_SWITCHING_ISR() macro.  This must be BEFORE any
+	// variable declarations.
+	portENTER_SWITCHING_ISR();
+
+	usart_isr_non_naked_behaviour();
+
+	// Exit the ISR.  If the serial task was woken by the end of a burst then
+	// a context switch will occur.
+	portEXIT_SWITCHING_ISR();
+}
+
+#if defined(__GNUC__)
+__attribute__((__noinline__))
+#elif defined(__ICCAVR32__)
+#pragma optimize = no_inline
+#endif
+static long usart_isr_non_naked_behaviour(void)
+{
+	unsigned long csr, status;
+	unsigned short head, tail;
+	unsigned char c;
+	long switch_required = FALSE;
+#if configGENERATE_RUN_TIME_STATS == 1
+	unsigned long start = portGET_RUN_TIME_COUNTER_VALUE();
+#endif
+
+	traceAPP_EVENT(traceEVT_ISR_ENTER, EXAMPLE_USART_IRQ);
+
+	// Read once: reading CSR clears CTSIC.
+	csr = EXAMPLE_USART->csr;
+	status = csr & EXAMPLE_USART->imr;
+
+	if (status & (AVR32_USART_CSR_OVRE_MASK | AVR32_USART_CSR_FRAME_MASK | AVR32_USART_CSR_PARE_MASK)){
+		if (status & AVR32_USART_CSR_OVRE_MASK)
+			usart_overrun_errors++;
+		if (status & AVR32_USART_CSR_FRAME_MASK)
+			usart_framing_errors++;
+		if (status & AVR32_USART_CSR_PARE_MASK)
+			usart_parity_errors++;
+		usart_reset_status(EXAMPLE_USART);
+	}
+
+	if (status & AVR32_USART_CSR_RXRDY_MASK){
+		// Reading RHR clears RXRDY, even when the byte is dropped.
+		c = (EXAMPLE_USART->rhr & AVR32_USART_RHR_RXCHR_MASK) >> AVR32_USART_RHR_RXCHR_OFFSET;
+		// Stamped on arrival, not when the serial task drains the ring.
+		traceAPP_EVENT(traceEVT_USART_RX, c);
+#if zwaveBRIDGE_API == zwaveBRIDGE_NETCONN
+		// The line was busy up to now, whether the byte is kept or not.
+		vZwaveCoalesceStampFromISR();
+#endif
+		head = usart_rx_head;
+		if ((unsigned short)(head - usart_rx_tail) < USART_RX_RING_SIZE){
+			usart_rx_ring[head & (USART_RX_RING_SIZE - 1)] = c;
+			usart_rx_head = ++head;
+#if zwaveSERIAL_RTSCTS == 1
+			// Nearly full: the module is to stop sending.
+			if (!usart_rx_throttled && (unsigned short)(head - usart_rx_tail) >= USART_RX_RTS_OFF){
+				usart_rx_throttled = pdTRUE;
+				EXAMPLE_USART->cr = AVR32_USART_CR_RTSDIS_MASK;
+			}
+#endif
+			// Half full in the middle of a burst: have it drained now.
+			if ((unsigned short)(head - usart_rx_tail) == USART_RX_RING_SIZE / 2){
+				portENTER_CRITICAL();
+				xSemaphoreGiveFromISR(usart_rx_burst, &switch_required);
+				portEXIT_CRITICAL();
+			}
+		}else{
+			usart_recv_queue_spoiled++;
+		}
+	}
+
+	if (status & AVR32_USART_CSR_TIMEOUT_MASK){
+		// Clears TIMEOUT: the next one comes after the next burst.
+		usart_rx_timeout_restart(EXAMPLE_USART);
+		portENTER_CRITICAL();
+		xSemaphoreGiveFromISR(usart_rx_burst, &switch_required);
+		portEXIT_CRITICAL();
+	}
+
+#if zwaveSERIAL_RTSCTS == 1
+	if ((status & AVR32_USART_CSR_TXRDY_MASK) && (csr & AVR32_USART_CSR_CTS_MASK)){
+		// CTS deasserted: no new byte until it is asserted again.
+		EXAMPLE_USART->idr = AVR32_USART_IDR_TXRDY_MASK;
+		EXAMPLE_USART->ier = AVR32_USART_IER_CTSIC_MASK;
+		status &= ~AVR32_USART_CSR_TXRDY_MASK;
+	}
+	if ((status & AVR32_USART_CSR_CTSIC_MASK) && !(csr & AVR32_USART_CSR_CTS_MASK)){
+		EXAMPLE_USART->idr = AVR32_USART_IDR_CTSIC_MASK;
+		EXAMPLE_USART->ier = AVR32_USART_IER_TXRDY_MASK;
+	}
+#endif
+
+	if (status & AVR32_USART_CSR_TXRDY_MASK){
+		tail = usart_tx_tail;
+		if (tail != usart_tx_head){
+			EXAMPLE_USART->thr = (usart_tx_ring[tail & (USART_TX_RING_SIZE - 1)] << AVR32_USART_THR_TXCHR_OFFSET) & AVR32_USART_THR_TXCHR_MASK;
+			usart_tx_tail = ++tail;
+		}
+		if (tail == usart_tx_head){
+			// The last byte is in THR: wait for it to leave the shift
+			// register.
+			EXAMPLE_USART->idr = AVR32_USART_IDR_TXRDY_MASK;
+			EXAMPLE_USART->ier = AVR32_USART_IER_TXEMPTY_MASK;
+		}
+	}
+
+	// status is stale once THR was written above: TXEMPTY read again.
+	if ((status & AVR32_USART_CSR_TXEMPTY_MASK) && usart_tx_tail == usart_tx_head
+			&& (EXAMPLE_USART->csr & AVR32_USART_CSR_TXEMPTY_MASK)){
+		EXAMPLE_USART->idr = AVR32_USART_IDR_TXEMPTY_MASK;
+		usart_tx_busy = pdFALSE;
+		portENTER_CRITICAL();
+		xSemaphoreGiveFromISR(usart_tx_done, &switch_required);
+		portEXIT_CRITICAL();
+	}
+
+#if configGENERATE_RUN_TIME_STATS == 1
+	// Without the register saves of usart_isr(): a few cycles.
+	usart_isr_run_time += portGET_RUN_TIME_COUNTER_VALUE() - start;
+#endif
+
+	return switch_required;
+}
+
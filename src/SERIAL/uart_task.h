@@ -1,8 +1,91 @@
 #ifndef UART_TASK_H
 #define UART_TASK_H
 
-#include "portmacro.h"
+#include "FreeRTOS.h"
+
+//! Largest error of the generated baud rate, in 0.01 %: beyond it, the
+//! sampling point drifts out of the bits of a long character.
+#define serialBAUDRATE_TOLERANCE  ( 200 )
 
 portTASK_FUNCTION_PROTO(vBasicSerialServer, pvParameters);
 
+/*! \brief Queues bytes for the Z-Wave module, sent by the USART interrupt.
+ *         Never blocks. Available once vBasicSerialServer has started.
+ *
+ *  \param pcBuffer   Input. The bytes.
+ *  \param usLength   Input. Their number.
+ *
+ *  \return The number of bytes queued, less than usLength if the TX ring is
+ *          full.
+ */
+unsigned portSHORT usSerialTxWrite( const portCHAR *pcBuffer, unsigned portSHORT usLength );
+
+/*! \brief Room left in the TX ring.
+ *
+ *  \return The number of bytes usSerialTxWrite() would take now.
+ */
+unsigned portSHORT usSerialTxRoom( void );
+
+/*! \brief Waits for the last byte queued to be on the wire: out of the TX
+ *         ring and of the USART shift register.
+ *
+ *  \param xTicksToWait   Input. Longest wait, in ticks.
+ *
+ *  \return pdTRUE once the transmitter is idle, pdFALSE on timeout.
+ */
+portBASE_TYPE xSerialTxWaitDone( portTickType xTicksToWait );
+
+#if configGENERATE_RUN_TIME_STATS == 1
+/*! \brief CPU time of the Z-Wave serial path, in run time counter
+ *         increments since the start (see vTaskGetRunTimeStats()).
+ *
+ *  \param pullTask        Output. Run time of the serial task, 0 before it
+ *                         started.
+ *  \param pullInterrupt   Output. Run time of the USART interrupt. It is
+ *                         part of the run time of the tasks it interrupted
+ *                         too, the serial task among them.
+ */
+void vSerialGetRunTime( unsigned long long *pullTask, unsigned long long *pullInterrupt );
+#endif
+
+/*! \brief Baud rate the USART would generate for a set point, with the
+ *         PBA clock of the board.
+ *
+ *  \param ulBaudrate   Input. The set point, in bit/s.
+ *  \param psError      Output. (actual - set point) / set point, in 0.01 %,
+ *                      saturated. May be NULL.
+ *
+ *  \return The generated baud rate, in bit/s, 0 if out of range.
+ */
+unsigned portLONG ulSerialBaudrateFor( unsigned portLONG ulBaudrate, signed portSHORT *psError );
+
+/*! \brief Baud rate the USART generates for the current set point.
+ *
+ *  \param psError   Output. (actual - set point) / set point, in 0.01 %.
+ *                   May be NULL.
+ *
+ *  \return The generated baud rate, in bit/s.
+ */
+unsigned portLONG ulSerialGetBaudrate( signed portSHORT *psError );
+
+/*! \brief The current baud rate set point.
+ *
+ *  \return The set point, in bit/s.
+ */
+unsigned portLONG ulSerialGetBaudrateSetPoint( void );
+
+/*! \brief Switches the Z-Wave serial port to another baud rate, once the
+ *         bytes already queued are on the wire. The module is expected to
+ *         switch too, and to be silent meanwhile.
+ *
+ *  \param ulBaudrate     Input. The new set point, in bit/s.
+ *  \param xTicksToWait   Input. Longest wait for the transmitter, in ticks.
+ *
+ *  \return pdPASS, or pdFAIL if the rate is out of range or out of
+ *          serialBAUDRATE_TOLERANCE with the PBA clock, on timeout, or
+ *          before vBasicSerialServer has started; the current rate is kept
+ *          then.
+ */
+portBASE_TYPE xSerialSetBaudrate( unsigned portLONG ulBaudrate, portTickType xTicksToWait );
+
 #endif
@@ -68,7 +68,7 @@
 
 
 /* Size of each receive buffer - DO NOT CHANGE. */
-#define RX_BUFFER_SIZE    128
+#define RX_BUFFER_SIZE    MACB_RX_BUFFER_SIZE
 
 
 /* The buffer addresses written into the descriptors must be aligned so the
@@ -468,6 +468,32 @@ void vMACBRead(void *pvTo, unsigned long ulSectionLength, unsigned long ulTotalF
     }
   }
 }
+/*-----------------------------------------------------------*/
+
+void vMACBReadBuffer(void *pvTo, unsigned long ulLength)
+{
+  const unsigned int *puiSource;
+  unsigned int *puiTo = pvTo;
+  unsigned long ulWords;
+  unsigned int uiTemp;
+
+  // The Rx buffers and the destination are word aligned: move whole 32 bit
+  // words, the tail of the last word is never part of the frame.
+  puiSource = ( const unsigned int * )( xRxDescriptors[ ulNextRxBuffer ].addr & ADDRESS_MASK );
+  for( ulWords = ( ulLength + 3 ) >> 2; ulWords > 0; ulWords-- )
+  {
+    *puiTo++ = *puiSource++;
+  }
+
+  // Mark the buffer as free again.
+  uiTemp = xRxDescriptors[ ulNextRxBuffer ].addr;
+  xRxDescriptors[ ulNextRxBuffer ].addr = uiTemp & ~( AVR32_OWNERSHIP_BIT );
+  // Move onto the next buffer.
+  if( ++ulNextRxBuffer >= ETHERNET_CONF_NB_RX_BUFFERS )
+  {
+    ulNextRxBuffer = 0;
+  }
+}
 
 /*-----------------------------------------------------------*/
 void vMACBFlushCurrentPacket(unsigned long ulTotalFrameLength)
@@ -509,6 +535,32 @@ void vMACBSetMACAddress(const unsigned char *MACAddress)
   memcpy(cMACAddress, MACAddress, sizeof(cMACAddress));
 }
 
+void vMACBAddMulticastAddress(volatile avr32_macb_t *macb, const unsigned char *MACAddress)
+{
+  unsigned long ulBit;
+  unsigned char ucIndex = 0;
+
+  // Hash index bit n is the XOR of the destination address bits n, n+6, ...
+  // n+42, bit 0 being the first bit on the wire (LSB of the first byte).
+  for (ulBit = 0; ulBit < 48; ulBit++)
+  {
+    if (MACAddress[ulBit / 8] & (1 << (ulBit % 8)))
+    {
+      ucIndex ^= 1 << (ulBit % 6);
+    }
+  }
+
+  if (ucIndex < 32)
+  {
+    macb->hrb |= 1UL << ucIndex;
+  }
+  else
+  {
+    macb->hrt |= 1UL << (ucIndex - 32);
+  }
+  macb->ncfgr |= AVR32_MACB_NCFGR_MTI_MASK;
+}
+
 Bool xMACBInit(volatile avr32_macb_t *macb)
 {
   Bool global_interrupt_enabled = Is_global_interrupt_enabled();
@@ -1031,6 +1083,10 @@ static long prvMACB_ISR_NonNakedBehaviour(void)
   volatile unsigned long ulIntStatus, ulEventStatus;
   long xSwitchRequired = FALSE;
 
+#ifdef FREERTOS_USED
+  traceAPP_EVENT( traceEVT_ISR_ENTER, AVR32_MACB_IRQ );
+#endif
+
   // Find the cause of the interrupt.
   ulIntStatus = AVR32_MACB.isr;
   ulEventStatus = AVR32_MACB.rsr;
@@ -62,6 +62,10 @@
 #include "conf_eth.h"
 
 
+//! Size of each receive buffer of the MACB DMA.
+#define MACB_RX_BUFFER_SIZE             128
+
+
 /*! \name Rx Ring descriptor flags
  */
 //! @{
@@ -389,6 +393,21 @@ extern long lMACBSend(volatile avr32_macb_t *macb, const void *pvFrom, unsigned
  */
 extern void vMACBRead(void *pvTo, unsigned long ulSectionLength, unsigned long ulTotalFrameLength);
 
+/**
+ * \brief Read the next receive buffer of the current frame to pvTo, and give
+ * the buffer back to the MACB.
+ * Alternative to vMACBRead() when the frame is read in sections of exactly
+ * MACB_RX_BUFFER_SIZE bytes, the last one excepted: each section is then a
+ * whole buffer and no position has to be kept between the calls.
+ * The copy is rounded up to a whole number of words: pvTo must be word
+ * aligned and have room for it.
+ * This function should only be called after a call to ulMACBInputLength().
+ *
+ * \param *pvTo       Address of the buffer
+ * \param ulLength    Length of the buffer, at most MACB_RX_BUFFER_SIZE
+ */
+extern void vMACBReadBuffer(void *pvTo, unsigned long ulLength);
+
 /**
  * \brief Flush the current received packet.
  *
@@ -427,6 +446,16 @@ extern unsigned long ulMACBInputLength(void);
  */
 extern void vMACBSetMACAddress(const unsigned char *MACAddress);
 
+/**
+ * \brief Accept the frames sent to a multicast MAC address: sets its bit in
+ * the hash filter (HRB & HRT registers). A bit is shared by several
+ * addresses, the upper layers drop the frames they did not ask for.
+ *
+ * \param *macb        Base address of the MACB
+ * \param *MACAddress  The multicast MAC address.
+ */
+extern void vMACBAddMulticastAddress(volatile avr32_macb_t *macb, const unsigned char *MACAddress);
+
 /**
  * \brief Disable MACB operations (Tx and Rx).
  *
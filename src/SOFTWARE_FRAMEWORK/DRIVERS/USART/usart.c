@@ -73,14 +73,45 @@ static __inline__ int usart_mode_is_multidrop(volatile avr32_usart_t *usart)
 }
 
 
-/*! \brief Calculates a clock divider (\e CD) and a fractional part (\e FP) for
- *         the USART asynchronous modes to generate a baud rate as close as
- *         possible to the baud rate set point.
+/*! \brief Calculates an oversampling (\e Over) and a clock divider with its
+ *         fractional part (\e CD and \e FP) for the USART asynchronous modes
+ *         to generate a baud rate as close as possible to the baud rate set
+ *         point.
  *
  * Baud rate calculation:
  * \f$ Baudrate = \frac{SelectedClock}{Over \times (CD + \frac{FP}{8})} \f$, \e Over being 16 or 8.
  * The maximal oversampling is selected if it allows to generate a baud rate close to the set point.
  *
+ * \param baudrate  Baud rate set point.
+ * \param pba_hz    USART module input clock frequency (PBA clock, Hz).
+ * \param over      Pointer to where the oversampling should be stored.
+ *
+ * \return \e CD and \e FP as one fixed-point number (\e CD in the upper bits),
+ *         or \c 0 if the baud rate set point is out of range for the given
+ *         input clock frequency.
+ */
+static unsigned int usart_get_async_divisor(unsigned int baudrate, unsigned long pba_hz, unsigned int *over)
+{
+  unsigned int cd_fp, cd;
+
+  if (baudrate == 0)
+    return 0;
+
+  *over = (pba_hz >= 16 * baudrate) ? 16 : 8;
+  cd_fp = ((1 << AVR32_USART_BRGR_FP_SIZE) * pba_hz + (*over * baudrate) / 2) / (*over * baudrate);
+  cd = cd_fp >> AVR32_USART_BRGR_FP_SIZE;
+
+  if (cd < 1 || cd > (1 << AVR32_USART_BRGR_CD_SIZE) - 1)
+    return 0;
+
+  return cd_fp;
+}
+
+
+/*! \brief Sets the clock divider (\e CD) and the fractional part (\e FP) of
+ *         the USART asynchronous modes to generate a baud rate as close as
+ *         possible to the baud rate set point.
+ *
  * \param usart     Base address of the USART instance.
  * \param baudrate  Baud rate set point.
  * \param pba_hz    USART module input clock frequency (PBA clock, Hz).
@@ -90,12 +121,12 @@ static __inline__ int usart_mode_is_multidrop(volatile avr32_usart_t *usart)
  */
 static int usart_set_async_baudrate(volatile avr32_usart_t *usart, unsigned int baudrate, unsigned long pba_hz)
 {
-  unsigned int over = (pba_hz >= 16 * baudrate) ? 16 : 8;
-  unsigned int cd_fp = ((1 << AVR32_USART_BRGR_FP_SIZE) * pba_hz + (over * baudrate) / 2) / (over * baudrate);
+  unsigned int over;
+  unsigned int cd_fp = usart_get_async_divisor(baudrate, pba_hz, &over);
   unsigned int cd = cd_fp >> AVR32_USART_BRGR_FP_SIZE;
   unsigned int fp = cd_fp & ((1 << AVR32_USART_BRGR_FP_SIZE) - 1);
 
-  if (cd < 1 || cd > (1 << AVR32_USART_BRGR_CD_SIZE) - 1)
+  if (cd_fp == 0)
     return USART_INVALID_INPUT;
 
   usart->mr = (usart->mr & ~(AVR32_USART_MR_USCLKS_MASK |
@@ -737,6 +768,24 @@ int usart_init_spi_slave(volatile avr32_usart_t *usart, const usart_spi_options_
 #endif  // USART rev. >= 4.0.0
 
 
+int usart_set_baudrate(volatile avr32_usart_t *usart, unsigned int baudrate, long pba_hz)
+{
+  return usart_set_async_baudrate(usart, baudrate, pba_hz);
+}
+
+
+unsigned long usart_get_actual_baudrate(unsigned int baudrate, long pba_hz)
+{
+  unsigned int over;
+  unsigned int cd_fp = usart_get_async_divisor(baudrate, pba_hz, &over);
+
+  if (cd_fp == 0)
+    return 0;
+
+  return ((1 << AVR32_USART_BRGR_FP_SIZE) * (unsigned long)pba_hz + (over * cd_fp) / 2) / (over * cd_fp);
+}
+
+
 //! @}
 
 
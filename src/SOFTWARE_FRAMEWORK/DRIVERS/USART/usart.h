@@ -385,6 +385,33 @@ extern int usart_init_spi_slave(volatile avr32_usart_t *usart, const usart_spi_o
 
 #endif  // USART rev. >= 4.0.0
 
+/*! \brief Changes the baud rate of a USART set up in an asynchronous mode
+ *         (RS232, hardware handshaking, modem, RS485), the rest of its
+ *         configuration being kept.
+ *
+ * The receiver and the transmitter should be idle: a character on the line
+ * while the rate changes is garbled.
+ *
+ * \param usart     Base address of the USART instance.
+ * \param baudrate  Baud rate set point.
+ * \param pba_hz    USART module input clock frequency (PBA clock, Hz).
+ *
+ * \retval USART_SUCCESS        Baud rate successfully changed.
+ * \retval USART_INVALID_INPUT  Baud rate set point is out of range for the given input clock frequency.
+ */
+extern int usart_set_baudrate(volatile avr32_usart_t *usart, unsigned int baudrate, long pba_hz);
+
+/*! \brief Gives the baud rate an asynchronous mode actually generates for a
+ *         baud rate set point, the fractional divisor included.
+ *
+ * \param baudrate  Baud rate set point.
+ * \param pba_hz    USART module input clock frequency (PBA clock, Hz).
+ *
+ * \return The baud rate, or \c 0 if the set point is out of range for the given
+ *         input clock frequency.
+ */
+extern unsigned long usart_get_actual_baudrate(unsigned int baudrate, long pba_hz);
+
 //! @}
 
 
@@ -480,6 +507,58 @@ extern __inline__ int usart_lin_get_error(volatile avr32_usart_t *usart)
 //! @}
 
 
+//------------------------------------------------------------------------------
+/*! \name Receiver Time-out Functions
+ */
+//! @{
+
+/*! \brief Sets the receiver time-out and arms it: TIMEOUT is set once the RX
+ *         line stays idle for \a bits bit periods after a character.
+ *
+ * The time-out starts with the next character received, not right away.
+ *
+ * \param usart   Base address of the USART instance.
+ * \param bits    Time-out in bit periods, \c 0 to disable it.
+ */
+#if (defined __GNUC__)
+__attribute__((__always_inline__))
+#endif
+extern __inline__ void usart_set_rx_timeout(volatile avr32_usart_t *usart, unsigned long bits)
+{
+  usart->rtor = (bits << AVR32_USART_RTOR_TO_OFFSET) & AVR32_USART_RTOR_TO_MASK;
+  usart->cr = AVR32_USART_CR_STTTO_MASK;
+}
+
+/*! \brief Clears TIMEOUT and re-arms the receiver time-out for the next
+ *         character received.
+ *
+ * \param usart   Base address of the USART instance.
+ */
+#if (defined __GNUC__)
+__attribute__((__always_inline__))
+#endif
+extern __inline__ void usart_rx_timeout_restart(volatile avr32_usart_t *usart)
+{
+  usart->cr = AVR32_USART_CR_STTTO_MASK;
+}
+
+/*! \brief Checks if the receiver time-out has expired since it was armed.
+ *
+ * \param usart   Base address of the USART instance.
+ *
+ * \return \c 1 if the RX line has been idle for the time-out, otherwise \c 0.
+ */
+#if (defined __GNUC__)
+__attribute__((__always_inline__))
+#endif
+extern __inline__ int usart_rx_timeout(volatile avr32_usart_t *usart)
+{
+  return (usart->csr & AVR32_USART_CSR_TIMEOUT_MASK) != 0;
+}
+
+//! @}
+
+
 //------------------------------------------------------------------------------
 /*! \name ISO7816 Control Functions
  */
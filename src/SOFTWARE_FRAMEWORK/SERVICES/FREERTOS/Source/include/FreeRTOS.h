@@ -183,6 +183,10 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define INCLUDE_xTaskGetSchedulerState 0
 #endif
 
+#ifndef INCLUDE_xTaskGetIdleTaskHandle
+	#define INCLUDE_xTaskGetIdleTaskHandle 0
+#endif
+
 #if ( configUSE_MUTEXES == 1 )
 	/* xTaskGetCurrentTaskHandle is used by the priority inheritance mechanism
 	within the mutex implementation so must be available if mutexes are used. */
@@ -392,6 +396,14 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 		#error If configGENERATE_RUN_TIME_STATS is defined then portGET_RUN_TIME_COUNTER_VALUE must also be defined.  portGET_RUN_TIME_COUNTER_VALUE should evaluate to the counter value of the timer/counter peripheral used as the run time counter time base.
 	#endif /* portGET_RUN_TIME_COUNTER_VALUE */
 
+	#ifndef configRUN_TIME_STATS_WINDOW_SHIFT
+		#define configRUN_TIME_STATS_WINDOW_SHIFT 20
+	#endif
+
+	#if ( ( configRUN_TIME_STATS_WINDOW_SHIFT < 8 ) || ( configRUN_TIME_STATS_WINDOW_SHIFT > 31 ) )
+		#error configRUN_TIME_STATS_WINDOW_SHIFT must be between 8 and 31.
+	#endif
+
 #endif /* configGENERATE_RUN_TIME_STATS */
 
 #ifndef portCONFIGURE_TIMER_FOR_RUN_TIME_STATS
@@ -402,6 +414,60 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define configUSE_MALLOC_FAILED_HOOK 0
 #endif
 
+#ifndef configUSE_TICKLESS_IDLE
+	#define configUSE_TICKLESS_IDLE 0
+#endif
+
+#ifndef configEXPECTED_IDLE_TIME_BEFORE_SLEEP
+	#define configEXPECTED_IDLE_TIME_BEFORE_SLEEP 2
+#endif
+
+#if configEXPECTED_IDLE_TIME_BEFORE_SLEEP < 2
+	#error configEXPECTED_IDLE_TIME_BEFORE_SLEEP must not be less than 2
+#endif
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	#ifndef portSUPPRESS_TICKS_AND_SLEEP
+		#error If configUSE_TICKLESS_IDLE is set to 1 then portSUPPRESS_TICKS_AND_SLEEP must be defined by the port layer.  portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime ) should stop the tick interrupt, sleep for at most xExpectedIdleTime ticks, then step the tick count by the number of complete tick periods spent asleep.
+	#endif /* portSUPPRESS_TICKS_AND_SLEEP */
+
+#endif /* configUSE_TICKLESS_IDLE */
+
+#ifndef portSUPPRESS_TICKS_AND_SLEEP
+	#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )
+#endif
+
+#ifndef configSUPPORT_STATIC_ALLOCATION
+	#define configSUPPORT_STATIC_ALLOCATION 0
+#endif
+
+#ifndef configUSE_LATENCY_PROFILER
+	#define configUSE_LATENCY_PROFILER 0
+#endif
+
+#if ( configUSE_LATENCY_PROFILER == 1 )
+
+	#if ( configGENERATE_RUN_TIME_STATS != 1 )
+		#error The latency profiler measures with the run time counter: configGENERATE_RUN_TIME_STATS must be set to 1.
+	#endif
+
+	#ifndef configLATENCY_HISTOGRAM_BUCKETS
+		#define configLATENCY_HISTOGRAM_BUCKETS 12
+	#endif
+
+	#ifndef configLATENCY_HISTOGRAM_SHIFT
+		#define configLATENCY_HISTOGRAM_SHIFT 6
+	#endif
+
+#endif /* configUSE_LATENCY_PROFILER */
+
+#ifndef portGET_CALLER_ADDRESS
+	/* Return address of the function calling the one this is used in, used to
+	identify who opened a critical section. */
+	#define portGET_CALLER_ADDRESS() ( ( void * ) 0 )
+#endif
+
 #ifndef portPRIVILEGE_BIT
 	#define portPRIVILEGE_BIT ( ( unsigned portBASE_TYPE ) 0x00 )
 #endif
@@ -418,5 +484,33 @@ typedef portBASE_TYPE (*pdTASK_HOOK_CODE)( void * );
 	#define vPortFreeAligned( pvBlockToFree ) vPortFree( pvBlockToFree )
 #endif
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	/*
+	 * Variable large enough to hold a queue, semaphore or mutex, see
+	 * xQueueCreateStatic().  The members mirror the private xQUEUE structure
+	 * of queue.c (which checks the sizes match) and must not be accessed.  It
+	 * is declared here rather than in queue.h as queue.c does not include
+	 * queue.h.
+	 */
+	typedef struct xSTATIC_LIST
+	{
+		unsigned portBASE_TYPE uxDummy1;
+		void *pvDummy2;
+		portTickType xDummy3;
+		void *pvDummy4[ 2 ];
+	} xStaticList;
+
+	typedef struct xSTATIC_QUEUE
+	{
+		void *pvDummy1[ 4 ];
+		xStaticList xDummy2[ 2 ];
+		unsigned portBASE_TYPE uxDummy3[ 3 ];
+		signed portBASE_TYPE xDummy4[ 2 ];
+		unsigned char ucDummy5;
+	} xStaticQueue;
+
+#endif /* configSUPPORT_STATIC_ALLOCATION */
+
 #endif /* INC_FREERTOS_H */
 
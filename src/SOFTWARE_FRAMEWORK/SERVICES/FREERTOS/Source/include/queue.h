@@ -137,6 +137,66 @@ typedef void * xQueueHandle;
  */
 xQueueHandle xQueueCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize );
 
+/**
+ * queue. h
+ * <pre>
+ xQueueHandle xQueueCreateStatic(
+									unsigned portBASE_TYPE uxQueueLength,
+									unsigned portBASE_TYPE uxItemSize,
+									unsigned char *pucQueueStorage,
+									xStaticQueue *pxStaticQueue
+								);
+ * </pre>
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be defined as 1 for this function to
+ * be available.
+ *
+ * Same as xQueueCreate(), except that the queue structure and its storage
+ * area are buffers provided by the application instead of being allocated
+ * from the heap.  The buffers must remain valid for the lifetime of the
+ * queue; deleting the queue does not free them.
+ *
+ * @param pucQueueStorage Array of at least
+ * queueSTATIC_STORAGE_SIZE( uxQueueLength, uxItemSize ) bytes, used to hold
+ * the items.  Can be NULL if uxItemSize is 0.
+ *
+ * @param pxStaticQueue Variable used to hold the queue structure.
+ *
+ * @return A handle to the queue, or 0 if a buffer is missing or uxQueueLength
+ * is 0.
+ *
+ * Example usage:
+   <pre>
+ #define QUEUE_LENGTH	10
+
+ static unsigned char ucQueueStorage[ queueSTATIC_STORAGE_SIZE( QUEUE_LENGTH, sizeof( unsigned long ) ) ];
+ static xStaticQueue xQueueBuffer;
+
+ void vATask( void *pvParameters )
+ {
+ xQueueHandle xQueue;
+
+	// Create a queue capable of containing 10 unsigned long values, without
+	// using the heap.
+	xQueue = xQueueCreateStatic( QUEUE_LENGTH, sizeof( unsigned long ), ucQueueStorage, &xQueueBuffer );
+
+	// ... Rest of task code.
+ }
+ </pre>
+ * \defgroup xQueueCreateStatic xQueueCreateStatic
+ * \ingroup QueueManagement
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xQueueHandle xQueueCreateStatic( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize, unsigned char *pucQueueStorage, xStaticQueue *pxStaticQueue );
+#endif
+
+/*
+ * Size, in bytes, of the storage area to pass to xQueueCreateStatic().  One
+ * more byte than the items is needed, as for the queues created by
+ * xQueueCreate().
+ */
+#define queueSTATIC_STORAGE_SIZE( uxQueueLength, uxItemSize ) ( ( ( uxQueueLength ) * ( uxItemSize ) ) + 1 )
+
 /**
  * queue. h
  * <pre>
@@ -1219,6 +1279,9 @@ signed portBASE_TYPE xQueueCRReceive( xQueueHandle pxQueue, void *pvBuffer, port
  * xSemaphoreCreateCounting() instead of calling these functions directly.
  */
 xQueueHandle xQueueCreateMutex( void );
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	xQueueHandle xQueueCreateMutexStatic( xStaticQueue *pxStaticQueue );
+#endif
 xQueueHandle xQueueCreateCountingSemaphore( unsigned portBASE_TYPE uxCountValue, unsigned portBASE_TYPE uxInitialCount );
 
 /*
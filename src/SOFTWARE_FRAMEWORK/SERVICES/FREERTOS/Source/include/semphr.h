@@ -115,6 +115,31 @@ typedef xQueueHandle xSemaphoreHandle;
 														}																							\
 													}
 
+/**
+ * semphr. h
+ * <pre>vSemaphoreCreateBinaryStatic( xSemaphoreHandle xSemaphore, xStaticQueue *pxStaticQueue )</pre>
+ *
+ * <i>Macro</i> that creates a binary semaphore as vSemaphoreCreateBinary()
+ * does, but in a variable provided by the application instead of the heap.
+ * configSUPPORT_STATIC_ALLOCATION must be defined as 1 for this macro to be
+ * available.
+ *
+ * @param xSemaphore Handle to the created semaphore.  Should be of type xSemaphoreHandle.
+ *
+ * @param pxStaticQueue Variable used to hold the semaphore.  It must remain
+ * valid for the lifetime of the semaphore.
+ *
+ * \defgroup vSemaphoreCreateBinaryStatic vSemaphoreCreateBinaryStatic
+ * \ingroup Semaphores
+ */
+#define vSemaphoreCreateBinaryStatic( xSemaphore, pxStaticQueue )	{																										\
+																		xSemaphore = xQueueCreateStatic( ( unsigned portBASE_TYPE ) 1, semSEMAPHORE_QUEUE_ITEM_LENGTH, NULL, ( pxStaticQueue ) );	\
+																		if( xSemaphore != NULL )																			\
+																		{																									\
+																			xSemaphoreGive( xSemaphore );																	\
+																		}																									\
+																	}
+
 /**
  * semphr. h
  * xSemaphoreTake( 
@@ -589,6 +614,26 @@ typedef xQueueHandle xSemaphoreHandle;
  */
 #define xSemaphoreCreateMutex() xQueueCreateMutex()
 
+/**
+ * semphr. h
+ * <pre>xSemaphoreHandle xSemaphoreCreateMutexStatic( xStaticQueue *pxStaticQueue )</pre>
+ *
+ * <i>Macro</i> that creates a mutex as xSemaphoreCreateMutex() does, but in a
+ * variable provided by the application instead of the heap.
+ * configSUPPORT_STATIC_ALLOCATION must be defined as 1 for this macro to be
+ * available.
+ *
+ * @param pxStaticQueue Variable used to hold the mutex.  It must remain valid
+ * for the lifetime of the mutex.
+ *
+ * @return xSemaphore Handle to the created mutex.  Should be of type
+ * xSemaphoreHandle.
+ *
+ * \defgroup xSemaphoreCreateMutexStatic xSemaphoreCreateMutexStatic
+ * \ingroup Semaphores
+ */
+#define xSemaphoreCreateMutexStatic( pxStaticQueue ) xQueueCreateMutexStatic( pxStaticQueue )
+
 
 /**
  * semphr. h
@@ -121,6 +121,73 @@ typedef struct xTASK_PARAMTERS
 	xMemoryRegion xRegions[ portNUM_CONFIGURABLE_REGIONS ];
 } xTaskParameters;
 
+/*
+ * Possible return values for eTaskConfirmSleepModeStatus().  Used internally
+ * only.
+ */
+typedef enum
+{
+	eAbortSleep = 0,	/* A task has been made ready or a context switch pended since portSUPPRESS_TICKS_AND_SLEEP() was called - abort entering a sleep mode. */
+	eStandardSleep		/* Enter a sleep mode that will not last any longer than the expected idle time. */
+} eSleepModeStatus;
+
+/*
+ * Latency profile, filled when configUSE_LATENCY_PROFILER is 1.  Times are
+ * in run time counter increments.  pulHistogram[ 0 ] counts the windows
+ * shorter than 2^configLATENCY_HISTOGRAM_SHIFT increments, pulHistogram[ n ]
+ * the windows between 2^( configLATENCY_HISTOGRAM_SHIFT + n - 1 ) and
+ * 2^( configLATENCY_HISTOGRAM_SHIFT + n ), the last bucket everything longer.
+ */
+#if ( configUSE_LATENCY_PROFILER == 1 )
+	typedef struct xLATENCY_PROFILE
+	{
+		unsigned long ulLongest;		/* Longest window measured. */
+		void *pvLongestCaller;			/* Return address of the call that opened the longest window. */
+		unsigned long ulCount;			/* Number of windows measured. */
+		unsigned long pulHistogram[ configLATENCY_HISTOGRAM_BUCKETS ];
+	} xLatencyProfile;
+#endif
+
+/*
+ * Storage for the TCB of a task created by xTaskCreateStatic().  The members
+ * are not to be accessed: the structure only has the same size and alignment
+ * as the TCB, which is private to tasks.c.  tasks.c fails to compile if the
+ * two diverge.
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	typedef struct xSTATIC_TASK
+	{
+		void *pvDummy1;
+		#if ( portUSING_MPU_WRAPPERS == 1 )
+			xMPU_SETTINGS xDummy2;
+		#endif
+		xListItem xDummy3[ 2 ];
+		unsigned portBASE_TYPE uxDummy5;
+		void *pvDummy6;
+		signed char ucDummy7[ configMAX_TASK_NAME_LEN ];
+		#if ( portSTACK_GROWTH > 0 )
+			void *pvDummy8;
+		#endif
+		#if ( portCRITICAL_NESTING_IN_TCB == 1 )
+			unsigned portBASE_TYPE uxDummy9;
+		#endif
+		#if ( configUSE_TRACE_FACILITY == 1 )
+			unsigned portBASE_TYPE uxDummy10;
+		#endif
+		#if ( configUSE_MUTEXES == 1 )
+			unsigned portBASE_TYPE uxDummy11;
+		#endif
+		#if ( configUSE_APPLICATION_TASK_TAG == 1 )
+			void *pvDummy12;
+		#endif
+		#if ( configGENERATE_RUN_TIME_STATS == 1 )
+			unsigned long long ullDummy13;
+			unsigned long ulDummy14[ 3 ];
+		#endif
+		unsigned char ucDummy15;
+	} xStaticTask;
+#endif
+
 /*
  * Defines the priority used by the idle task.  This must not be modified.
  *
@@ -273,6 +340,54 @@ typedef struct xTASK_PARAMTERS
  */
 #define xTaskCreate( pvTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask ) xTaskGenericCreate( ( pvTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( NULL ), ( NULL ) )
 
+/**
+ * task. h
+ *<pre>
+ portBASE_TYPE xTaskCreateStatic(
+							  pdTASK_CODE pvTaskCode,
+							  const char * const pcName,
+							  unsigned short usStackDepth,
+							  void *pvParameters,
+							  unsigned portBASE_TYPE uxPriority,
+							  xTaskHandle *pvCreatedTask,
+							  portSTACK_TYPE *puxStackBuffer,
+							  xStaticTask *pxTaskBuffer
+						  );</pre>
+ *
+ * configSUPPORT_STATIC_ALLOCATION must be defined as 1 for this function to
+ * be available.
+ *
+ * Same as xTaskCreate(), except that the stack and the TCB of the task are
+ * buffers provided by the application instead of being allocated from the
+ * heap.  The creation time then does not depend on the heap state and the
+ * RAM used shows at link time.  The buffers must remain valid for the
+ * lifetime of the task; deleting the task does not free them.
+ *
+ * @param puxStackBuffer Array of at least usStackDepth portSTACK_TYPE
+ * elements, used as the stack of the task.
+ *
+ * @param pxTaskBuffer Variable used to hold the TCB of the task.
+ *
+ * @return pdPASS if the task was created, errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY
+ * if either buffer is NULL.
+ *
+ * Example usage:
+   <pre>
+ static portSTACK_TYPE xStack[ STACK_SIZE ];
+ static xStaticTask xTaskBuffer;
+
+ void vOtherFunction( void )
+ {
+	xTaskCreateStatic( vTaskCode, "NAME", STACK_SIZE, NULL, tskIDLE_PRIORITY, NULL, xStack, &xTaskBuffer );
+ }
+   </pre>
+ * \defgroup xTaskCreateStatic xTaskCreateStatic
+ * \ingroup Tasks
+ */
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	signed portBASE_TYPE xTaskCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, xStaticTask *pxTaskBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * task. h
  *<pre>
@@ -1037,12 +1152,17 @@ void vTaskList( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
  * of the accumulated time value depends on the frequency of the timer
  * configured by the portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() macro.
  * Calling vTaskGetRunTimeStats() writes the total execution time of each
- * task into a buffer, both as an absolute count value and as a percentage
- * of the total system execution time.
+ * task into a buffer, as an absolute count value in thousands of counter
+ * increments, as a percentage of the total system execution time, and as a
+ * percentage of the last complete statistics window.  A statistics window
+ * lasts 2^configRUN_TIME_STATS_WINDOW_SHIFT counter increments.
+ *
+ * The accumulated execution times are held on 64 bits so they do not
+ * overflow when the counter wraps.
  *
  * @param pcWriteBuffer A buffer into which the execution times will be
  * written, in ascii form.  This buffer is assumed to be large enough to
- * contain the generated report.  Approximately 40 bytes per task should
+ * contain the generated report.  Approximately 50 bytes per task should
  * be sufficient.
  *
  * \page vTaskGetRunTimeStats vTaskGetRunTimeStats
@@ -1050,6 +1170,147 @@ void vTaskList( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
  */
 void vTaskGetRunTimeStats( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
 
+/**
+ * task. h
+ * <PRE>unsigned portBASE_TYPE uxTaskGetRunTimeStatsBinary( unsigned char *pucBuffer, unsigned portBASE_TYPE uxBufferLength );</PRE>
+ *
+ * configGENERATE_RUN_TIME_STATS must be defined as 1 for this function
+ * to be available.
+ *
+ * Compact binary form of vTaskGetRunTimeStats(), suitable for sending to a
+ * host as is.  All multi-byte fields are big endian.
+ *
+ * The 16 byte header holds: format version (1), record size (16),
+ * configRUN_TIME_STATS_WINDOW_SHIFT, number of records, the current run time
+ * counter value (32 bits) and the total execution time of all the tasks
+ * (64 bits).
+ *
+ * It is followed by one 16 byte record per task: task number, priority,
+ * state ('R', 'B', 'S' or 'D'), percentage of the last complete statistics
+ * window, execution time within that window (32 bits) and total execution
+ * time (64 bits).
+ *
+ * NOTE: This function suspends the scheduler for its duration.
+ *
+ * @param pucBuffer The buffer into which the statistics are written.
+ *
+ * @param uxBufferLength The size of pucBuffer in bytes.  Tasks that do not
+ * fit are left out.
+ *
+ * @return The number of bytes written into pucBuffer, 0 if pucBuffer cannot
+ * even hold the header.
+ *
+ * \page uxTaskGetRunTimeStatsBinary uxTaskGetRunTimeStatsBinary
+ * \ingroup TaskUtils
+ */
+unsigned portBASE_TYPE uxTaskGetRunTimeStatsBinary( unsigned char *pucBuffer, unsigned portBASE_TYPE uxBufferLength ) PRIVILEGED_FUNCTION;
+
+/**
+ * task. h
+ * <PRE>unsigned long long ullTaskGetRunTimeCounter( xTaskHandle pxTask );</PRE>
+ *
+ * configGENERATE_RUN_TIME_STATS must be defined as 1 for this function
+ * to be available.
+ *
+ * The total execution time of one task, as reported by
+ * vTaskGetRunTimeStats().  It is updated when the task is switched out: the
+ * time of the calling task since it was last switched in is not counted.
+ *
+ * @param pxTask Handle of the task.  Passing NULL returns the execution time
+ * of the calling task.
+ *
+ * @return The execution time of the task, in run time counter increments.
+ *
+ * \page ullTaskGetRunTimeCounter ullTaskGetRunTimeCounter
+ * \ingroup TaskUtils
+ */
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+	unsigned long long ullTaskGetRunTimeCounter( xTaskHandle pxTask ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * task. h
+ * <PRE>xTaskHandle xTaskGetIdleTaskHandle( void );</PRE>
+ *
+ * INCLUDE_xTaskGetIdleTaskHandle must be set to 1 for this function to be
+ * available.
+ *
+ * @return The handle of the idle task, NULL before vTaskStartScheduler() is
+ * called.
+ *
+ * \page xTaskGetIdleTaskHandle xTaskGetIdleTaskHandle
+ * \ingroup TaskUtils
+ */
+#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+	xTaskHandle xTaskGetIdleTaskHandle( void ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * task. h
+ * <PRE>void vTaskGetSchedulerSuspendProfile( xLatencyProfile *pxProfile, portBASE_TYPE xReset );</PRE>
+ *
+ * configUSE_LATENCY_PROFILER must be defined as 1 for this function to be
+ * available.
+ *
+ * Copies the profile of the windows during which the scheduler was
+ * suspended, from the outermost vTaskSuspendAll() to the matching
+ * xTaskResumeAll().  The time the idle task spends asleep in tickless idle
+ * mode is not counted.
+ *
+ * @param pxProfile Where to copy the profile.
+ *
+ * @param xReset pdTRUE to clear the profile once copied.
+ *
+ * \page vTaskGetSchedulerSuspendProfile vTaskGetSchedulerSuspendProfile
+ * \ingroup TaskUtils
+ */
+#if ( configUSE_LATENCY_PROFILER == 1 )
+	void vTaskGetSchedulerSuspendProfile( xLatencyProfile *pxProfile, portBASE_TYPE xReset ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * task. h
+ * <PRE>void vPortGetCriticalProfile( xLatencyProfile *pxProfile, portBASE_TYPE xReset );</PRE>
+ *
+ * configUSE_LATENCY_PROFILER must be defined as 1 for this function to be
+ * available.  It is implemented by the port layer.
+ *
+ * Copies the profile of the windows during which interrupts were disabled by
+ * a critical section, from the outermost portENTER_CRITICAL() to the
+ * matching portEXIT_CRITICAL().  A window during which the task was switched
+ * out is not counted.
+ *
+ * @param pxProfile Where to copy the profile.
+ *
+ * @param xReset pdTRUE to clear the profile once copied.
+ *
+ * \page vPortGetCriticalProfile vPortGetCriticalProfile
+ * \ingroup TaskUtils
+ */
+#if ( configUSE_LATENCY_PROFILER == 1 )
+	void vPortGetCriticalProfile( xLatencyProfile *pxProfile, portBASE_TYPE xReset ) PRIVILEGED_FUNCTION;
+#endif
+
+/**
+ * task. h
+ * <PRE>void vTaskGetLatencyStats( signed char *pcWriteBuffer );</PRE>
+ *
+ * configUSE_LATENCY_PROFILER must be defined as 1 for this function to be
+ * available.
+ *
+ * Writes the critical section and scheduler suspension profiles into a
+ * buffer, in ascii form: longest window, caller that opened it, number of
+ * windows, then the histogram.  Approximately 250 bytes are needed.
+ *
+ * @param pcWriteBuffer A buffer into which the profiles will be written.
+ *
+ * \page vTaskGetLatencyStats vTaskGetLatencyStats
+ * \ingroup TaskUtils
+ */
+#if ( configUSE_LATENCY_PROFILER == 1 )
+	void vTaskGetLatencyStats( signed char *pcWriteBuffer ) PRIVILEGED_FUNCTION;
+#endif
+
 /**
  * task. h
  * <PRE>void vTaskStartTrace( char * pcBuffer, unsigned portBASE_TYPE uxBufferSize );</PRE>
@@ -1151,6 +1412,51 @@ portBASE_TYPE xTaskCallApplicationTaskHook( xTaskHandle xTask, void *pvParameter
  */
 void vTaskIncrementTick( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * configUSE_TICKLESS_IDLE must be set to 1 for this function to be available.
+ *
+ * Called from portSUPPRESS_TICKS_AND_SLEEP() when the tick interrupt has been
+ * held off for a number of tick periods.  Advances the tick count by
+ * xTicksToJump without unblocking any task, so xTicksToJump must not take the
+ * tick count past the wake time of the next delayed task.  MUST BE CALLED
+ * WITH THE SCHEDULER SUSPENDED.
+ */
+void vTaskStepTick( portTickType xTicksToJump ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * configUSE_TICKLESS_IDLE must be set to 1 for this function to be available.
+ *
+ * Called from portSUPPRESS_TICKS_AND_SLEEP() with interrupts disabled, just
+ * before the processor enters sleep mode.  Returns eAbortSleep if a task was
+ * readied or a yield was requested since the idle task decided to sleep, in
+ * which case the port must not sleep.
+ */
+eSleepModeStatus eTaskConfirmSleepModeStatus( void ) PRIVILEGED_FUNCTION;
+
+/*
+ * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS ONLY
+ * INTENDED FOR USE WHEN IMPLEMENTING A PORT OF THE SCHEDULER AND IS
+ * AN INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
+ *
+ * configUSE_LATENCY_PROFILER must be set to 1 for this function to be
+ * available.
+ *
+ * Accounts a window of ulLength run time counter increments, opened by the
+ * call returning to pvCaller, into pxProfile.  MUST BE CALLED WITH
+ * INTERRUPTS DISABLED.
+ */
+#if ( configUSE_LATENCY_PROFILER == 1 )
+	void vTaskLatencyProfileAdd( xLatencyProfile *pxProfile, unsigned long ulLength, void *pvCaller ) PRIVILEGED_FUNCTION;
+#endif
+
 /*
  * THIS FUNCTION MUST NOT BE USED FROM APPLICATION CODE.  IT IS AN
  * INTERFACE WHICH IS FOR THE EXCLUSIVE USE OF THE SCHEDULER.
@@ -70,6 +70,7 @@
 
 /* Standard includes. */
 #include <malloc.h>
+#include <string.h>
 
 /* Newlib add-ons includes. */
 #include "nlao_cpu.h"
@@ -85,6 +86,10 @@
 #if( configTICK_USE_TC==1 )
 	#include "tc.h"
 #endif
+#if( configUSE_TICKLESS_IDLE==1 )
+	#include "pm.h"
+	#include "porttickless.h"
+#endif
 
 
 /* Constants required to setup the task context. */
@@ -104,6 +109,54 @@ volatile unsigned portLONG ulCriticalNesting = 9999UL;
 /* Setup the timer to generate the tick interrupts. */
 static void prvSetupTimerInterrupt( void );
 
+#if( configUSE_LATENCY_PROFILER==1 )
+	/* Profile of the windows during which a critical section kept the
+	interrupts disabled, and state of the window currently open. */
+	static xLatencyProfile xCriticalProfile;
+	static unsigned portLONG ulCriticalStartTime = 0UL;
+	static void *pvCriticalCaller = NULL;
+	static volatile void *pvCriticalTask = NULL;
+	extern volatile void *volatile pxCurrentTCB;
+#endif
+
+#if( configUSE_TICKLESS_IDLE==1 )
+
+	#if( configTICK_USE_TC==1 )
+		#error configUSE_TICKLESS_IDLE requires the tick to be generated by the CPU Cycle Counter (configTICK_USE_TC 0).
+	#endif
+
+	/* Number of COUNT cycles in one tick period. */
+	#define portCYCLES_PER_TICK           ( configCPU_CLOCK_HZ / configTICK_RATE_HZ )
+
+	/* COUNT is 32 bits wide, which bounds how far COMPARE can be pushed out. */
+	#define portMAX_SUPPRESSED_TICKS      ( 0xFFFFFFFFUL / portCYCLES_PER_TICK )
+
+	/* When the sleep ends this close to a tick boundary, the boundary is taken
+	as passed so that the new COMPARE value can never be behind COUNT. */
+	#define portTICKLESS_COMPARE_MARGIN   ( 64UL )
+
+	#ifndef configTICKLESS_SLEEP_MODE
+		#define configTICKLESS_SLEEP_MODE   AVR32_PM_SMODE_IDLE
+	#endif
+
+	/* Set by the tick ISR so vPortSuppressTicksAndSleep() can tell whether the
+	sleep ended on the compare match or on another interrupt. */
+	static volatile portBASE_TYPE xTickFired = pdFALSE;
+
+#endif
+
+#if( configTICK_USE_TC==0 )
+	/* Nonzero while a COUNT&COMPARE match is waiting to be serviced. */
+	#define portTICK_IS_PENDING()         ( AVR32_INTC.irr[AVR32_CORE_COMPARE_IRQ / 32] & ( 1UL << ( AVR32_CORE_COMPARE_IRQ % 32 ) ) )
+#endif
+
+#if( ( configGENERATE_RUN_TIME_STATS==1 ) && ( configTICK_USE_TC==0 ) )
+	/* COUNT is reset on every compare match, so the cycles of the periods
+	already elapsed are added up here by the tick ISR to extend it into a
+	free running run time counter. */
+	static volatile unsigned portLONG ulRunTimeBase = 0UL;
+#endif
+
 /*-----------------------------------------------------------*/
 
 /*
@@ -270,6 +323,15 @@ __attribute__((__noinline__)) void vPortEnterCritical( void )
 	 directly.  Increment ulCriticalNesting to keep a count of how many times
 	 portENTER_CRITICAL() has been called. */
 	ulCriticalNesting++;
+
+#if( configUSE_LATENCY_PROFILER==1 )
+	if( ulCriticalNesting == portNO_CRITICAL_NESTING + 1 )
+	{
+		ulCriticalStartTime = ulPortGetRunTimeCounterValue();
+		pvCriticalCaller = portGET_CALLER_ADDRESS();
+		pvCriticalTask = pxCurrentTCB;
+	}
+#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -280,6 +342,17 @@ __attribute__((__noinline__)) void vPortExitCritical( void )
 		ulCriticalNesting--;
 		if( ulCriticalNesting == portNO_CRITICAL_NESTING )
 		{
+		#if( configUSE_LATENCY_PROFILER==1 )
+			/* A task that yields within a critical section gets its own
+			nesting count back when it resumes: the window it opened is then
+			not measurable and is ignored. */
+			if( pvCriticalTask == pxCurrentTCB )
+			{
+				vTaskLatencyProfileAdd( &xCriticalProfile, ulPortGetRunTimeCounterValue() - ulCriticalStartTime, pvCriticalCaller );
+			}
+			pvCriticalTask = NULL;
+		#endif
+
 			/* Enable all interrupt/exception. */
 			portENABLE_INTERRUPTS();
 		}
@@ -354,7 +427,18 @@ clock cycles from now. */
 
 	__attribute__((__noinline__)) static void prvClearCcInt(void)
 	{
+	#if( configGENERATE_RUN_TIME_STATS==1 )
+		/* COUNT restarted from 0 when it matched COMPARE. */
+		ulRunTimeBase += Get_system_register(AVR32_COMPARE);
+	#endif
+	#if( configUSE_TICKLESS_IDLE==1 )
+		/* The compare may have been pushed out by vPortSuppressTicksAndSleep():
+		go back to the regular tick period. */
+		xTickFired = pdTRUE;
+		Set_system_register(AVR32_COMPARE, portCYCLES_PER_TICK);
+	#else
 		Set_system_register(AVR32_COMPARE, Get_system_register(AVR32_COMPARE));
+	#endif
 	}
 #else
 	__attribute__((__noinline__)) static void prvClearTcInt(void)
@@ -444,3 +528,137 @@ static void prvSetupTimerInterrupt(void)
 	}
 	#endif
 }
+/*-----------------------------------------------------------*/
+
+#if( configUSE_TICKLESS_IDLE==1 )
+
+/* Called from the idle task with the scheduler suspended.  The COUNT register
+is reset by each compare match and is never written here, so it always holds
+the number of cycles since the last tick: COMPARE is pushed out to the tick at
+which the next task is due, and on wake-up COUNT tells how many tick periods
+were actually slept. */
+void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime )
+{
+unsigned portLONG ulCount, ulCompleteTickPeriods, ulNextCompare, ulSleepCompare;
+
+	if( xExpectedIdleTime > portMAX_SUPPRESSED_TICKS )
+	{
+		xExpectedIdleTime = portMAX_SUPPRESSED_TICKS;
+	}
+
+	portDISABLE_INTERRUPTS();
+
+	/* Writing COMPARE would silently drop a tick that matched while interrupts
+	were being disabled, so let that tick be serviced first.  Do not sleep
+	either if a task was readied since the idle task took its decision. */
+	if( portTICK_IS_PENDING() || ( eTaskConfirmSleepModeStatus() == eAbortSleep ) )
+	{
+		portENABLE_INTERRUPTS();
+		return;
+	}
+
+	xTickFired = pdFALSE;
+	ulSleepCompare = ( unsigned portLONG ) xExpectedIdleTime * portCYCLES_PER_TICK;
+	Set_system_register(AVR32_COMPARE, ulSleepCompare);
+
+	/* The sleep instruction re-enables interrupts atomically, so a wake-up
+	source that fires between here and the sleep itself is not missed. */
+	SLEEP(configTICKLESS_SLEEP_MODE);
+
+	/* Whatever woke the MCU up has been serviced by now. */
+	portDISABLE_INTERRUPTS();
+
+	if( ( xTickFired != pdFALSE ) || portTICK_IS_PENDING() )
+	{
+		/* The whole expected idle time elapsed.  The tick ISR restores the
+		regular period and accounts for the last tick itself. */
+		ulCompleteTickPeriods = xExpectedIdleTime - 1UL;
+	}
+	else
+	{
+		/* Another interrupt ended the sleep early.  Count the tick periods
+		that fully elapsed, then re-arm the compare on the next tick boundary
+		so the tick keeps its phase. */
+		ulCount = Get_system_register(AVR32_COUNT);
+		ulCompleteTickPeriods = ulPortTicklessElapsed( ulCount, ulSleepCompare, portCYCLES_PER_TICK,
+		                                               portTICKLESS_COMPARE_MARGIN, &ulNextCompare );
+
+		if( ulNextCompare != 0UL )
+		{
+			Set_system_register(AVR32_COMPARE, ulNextCompare);
+		}
+	}
+
+	vTaskStepTick( ( portTickType ) ulCompleteTickPeriods );
+
+	portENABLE_INTERRUPTS();
+}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if( configGENERATE_RUN_TIME_STATS==1 )
+
+/*
+ * Run time statistics time base: the CPU Cycle Counter, i.e. one increment
+ * per CPU clock cycle.  The value wraps after 2^32 cycles (about 89s at
+ * 48MHz); the kernel only relies on differences between two readings.
+ */
+unsigned portLONG ulPortGetRunTimeCounterValue( void )
+{
+#if( configTICK_USE_TC==1 )
+
+	/* The tick comes from a Timer Counter: COUNT is never reset. */
+	return Get_system_register(AVR32_COUNT);
+
+#else
+
+	unsigned portLONG ulFirst, ulCount, ulBase;
+	portBASE_TYPE xWrapped;
+	Bool global_interrupt_enabled;
+
+	/* Called by vTaskSwitchContext() from the tick ISR, by the trace recorder
+	from other ISRs and by vPortEnterCritical() itself: portENTER_CRITICAL()
+	would nest in interrupt context and recurse, so save and restore the
+	interrupt mask rather than use the critical nesting count. */
+	global_interrupt_enabled = Is_global_interrupt_enabled();
+	Disable_global_interrupt();
+	{
+		/* COUNT is reset on a compare match that the tick ISR may not have
+		accounted for in ulRunTimeBase yet. */
+		ulFirst = Get_system_register(AVR32_COUNT);
+		xWrapped = ( portTICK_IS_PENDING() != 0 );
+		ulCount = Get_system_register(AVR32_COUNT);
+		ulBase = ulRunTimeBase;
+
+		if( xWrapped || ( ulCount < ulFirst ) )
+		{
+			ulBase += Get_system_register(AVR32_COMPARE);
+		}
+	}
+	if( global_interrupt_enabled ) Enable_global_interrupt();
+
+	return ulBase + ulCount;
+
+#endif
+}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if( configUSE_LATENCY_PROFILER==1 )
+
+void vPortGetCriticalProfile( xLatencyProfile *pxProfile, portBASE_TYPE xReset )
+{
+	portENTER_CRITICAL();
+	{
+		*pxProfile = xCriticalProfile;
+		if( xReset != pdFALSE )
+		{
+			memset( &xCriticalProfile, 0, sizeof( xCriticalProfile ) );
+		}
+	}
+	portEXIT_CRITICAL();
+}
+
+#endif
@@ -171,6 +171,30 @@ extern void vPortExitCritical( void );
 #define portEXIT_CRITICAL()       vPortExitCritical();
 
 
+/* Tickless idle: called from the idle task, with the scheduler suspended, to
+stop the tick for up to xExpectedIdleTime ticks and put the MCU to sleep. */
+#if configUSE_TICKLESS_IDLE == 1
+extern void vPortSuppressTicksAndSleep( portTickType xExpectedIdleTime );
+
+#define portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime )  vPortSuppressTicksAndSleep( xExpectedIdleTime )
+#endif
+
+
+/* Run time statistics are taken from the CPU Cycle Counter, which is always
+running: there is no timer to configure. */
+#if configGENERATE_RUN_TIME_STATS == 1
+extern unsigned portLONG ulPortGetRunTimeCounterValue( void );
+
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS()
+#define portGET_RUN_TIME_COUNTER_VALUE()  ulPortGetRunTimeCounterValue()
+#endif
+
+
+/* Return address of the caller of the current function, recorded by the
+latency profiler. */
+#define portGET_CALLER_ADDRESS()  __builtin_return_address( 0 )
+
+
 /* Added as there is no such function in FreeRTOS. */
 extern void *pvPortRealloc( void *pv, size_t xSize );
 /*-----------------------------------------------------------*/
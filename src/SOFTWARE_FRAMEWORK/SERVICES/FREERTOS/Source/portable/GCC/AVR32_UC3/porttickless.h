@@ -0,0 +1,58 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Tick correction of the tickless idle of the AVR32 UC3 port.
+ *
+ * Plain arithmetic on COUNT values, without register access, so that it can
+ * also be built and checked on the host (src/TEST/test_tickless.c).
+ *
+ *****************************************************************************/
+
+#ifndef PORTTICKLESS_H
+#define PORTTICKLESS_H
+
+/*! \brief Tick periods elapsed in a tickless sleep that another interrupt
+ *         ended before the compare match.
+ *
+ *  COUNT is reset by each compare match, so ulCount is the number of cycles
+ *  since the last tick. The tick is re-armed on the next tick boundary to keep
+ *  its phase; a boundary closer than ulMargin is taken as passed, so that the
+ *  new COMPARE value can never be behind COUNT.
+ *
+ *  \param ulCount          Input. COUNT on wake-up, below ulSleepCompare.
+ *  \param ulSleepCompare   Input. COMPARE armed for the sleep, a multiple of
+ *                          ulCyclesPerTick.
+ *  \param ulCyclesPerTick  Input. COUNT cycles in one tick period.
+ *  \param ulMargin         Input. Smallest distance from COUNT to COMPARE.
+ *  \param pulNextCompare   Output. COMPARE value to re-arm, 0 to leave the
+ *                          armed one: the tick ISR then accounts for it.
+ *
+ *  \return The tick periods to step, not counting the tick to come.
+ */
+static __inline__ unsigned long ulPortTicklessElapsed( unsigned long ulCount, unsigned long ulSleepCompare,
+                                                       unsigned long ulCyclesPerTick, unsigned long ulMargin,
+                                                       unsigned long *pulNextCompare )
+{
+unsigned long ulCompleteTickPeriods, ulNextCompare;
+
+	ulCompleteTickPeriods = ulCount / ulCyclesPerTick;
+	ulNextCompare = ( ulCompleteTickPeriods + 1UL ) * ulCyclesPerTick;
+
+	if( ( ulNextCompare - ulCount ) < ulMargin )
+	{
+		ulCompleteTickPeriods++;
+		ulNextCompare += ulCyclesPerTick;
+	}
+
+	if( ulNextCompare >= ulSleepCompare )
+	{
+		/* The next boundary is the one already armed. */
+		*pulNextCompare = 0UL;
+		return ulSleepCompare / ulCyclesPerTick - 1UL;
+	}
+
+	*pulNextCompare = ulNextCompare;
+	return ulCompleteTickPeriods;
+}
+
+#endif
@@ -115,11 +115,23 @@ typedef struct tskTaskControlBlock
 	#endif
 
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
-		unsigned long ulRunTimeCounter;		/*< Used for calculating how much CPU time each task is utilising. */
+		unsigned long long ullRunTimeCounter;	/*< Used for calculating how much CPU time each task is utilising. */
+		unsigned long ulWindowRunTime;			/*< Run time used within the statistics window ulWindowNumber. */
+		unsigned long ulLastWindowRunTime;		/*< Run time used within the statistics window preceding ulWindowNumber. */
+		unsigned long ulWindowNumber;			/*< Statistics window the task last ran in. */
+	#endif
+
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		unsigned char ucStaticallyAllocated;	/*< Set to pdTRUE if the TCB and stack were provided by the application, so must not be freed. */
 	#endif
 
 } tskTCB;
 
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	/* xStaticTask in task.h must mirror tskTCB: fail to compile otherwise. */
+	typedef char tskSTATIC_TASK_SIZE_CHECK[ ( sizeof( xStaticTask ) == sizeof( tskTCB ) ) ? 1 : -1 ];
+#endif
+
 
 /*
  * Some kernel aware debuggers require data to be viewed to be global, rather
@@ -166,11 +178,42 @@ PRIVILEGED_DATA static volatile portBASE_TYPE xMissedYield 						= ( portBASE_TY
 PRIVILEGED_DATA static volatile portBASE_TYPE xNumOfOverflows 					= ( portBASE_TYPE ) 0;
 PRIVILEGED_DATA static unsigned portBASE_TYPE uxTaskNumber 						= ( unsigned portBASE_TYPE ) 0;
 
+#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+
+	PRIVILEGED_DATA static xTaskHandle xIdleTaskHandle = NULL;			/*< Holds the handle of the idle task, created by vTaskStartScheduler(). */
+
+#endif
+
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
 	PRIVILEGED_DATA static char pcStatsString[ 50 ] ;
 	PRIVILEGED_DATA static unsigned long ulTaskSwitchedInTime = 0UL;	/*< Holds the value of a timer/counter the last time a task was switched in. */
-	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long ulTotalRunTime ) PRIVILEGED_FUNCTION;
+	PRIVILEGED_DATA static unsigned long long ullTotalRunTime = 0ULL;	/*< Sum of the run time of all the tasks. */
+	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long long ullTotalRunTime, unsigned long ulWindowNumber ) PRIVILEGED_FUNCTION;
+	static unsigned char *prvWriteRunTimeStatsForTasksInList( unsigned char *pucBuffer, const unsigned char *pucBufferEnd, unsigned portBASE_TYPE *puxCount, xList *pxList, signed char cStatus, unsigned long ulWindowNumber ) PRIVILEGED_FUNCTION;
+	static void prvUpdateRunTimeWindow( tskTCB *pxTCB, unsigned long ulWindowNumber ) PRIVILEGED_FUNCTION;
+	static unsigned long prvGetLastWindowRunTime( const tskTCB *pxTCB, unsigned long ulWindowNumber ) PRIVILEGED_FUNCTION;
+
+	/* The run time is also accounted per statistics window of
+	2^configRUN_TIME_STATS_WINDOW_SHIFT counter increments, so the CPU
+	percentage of the last complete window can be reported. */
+	#define tskRUN_TIME_WINDOW_LENGTH		( 1UL << configRUN_TIME_STATS_WINDOW_SHIFT )
+	#define tskRUN_TIME_WINDOW_MASK			( 0xFFFFFFFFUL >> configRUN_TIME_STATS_WINDOW_SHIFT )
+	#define tskRUN_TIME_WINDOW_OF( ulTime )	( ( unsigned long ) ( ulTime ) >> configRUN_TIME_STATS_WINDOW_SHIFT )
+
+	/* Layout of the uxTaskGetRunTimeStatsBinary() output. */
+	#define tskRUN_TIME_STATS_VERSION		( ( unsigned char ) 1 )
+	#define tskRUN_TIME_STATS_HEADER_SIZE	( 16 )
+	#define tskRUN_TIME_STATS_RECORD_SIZE	( 16 )
+
+#endif
+
+#if ( configUSE_LATENCY_PROFILER == 1 )
+
+	PRIVILEGED_DATA static xLatencyProfile xSuspendProfile;				/*< Profile of the scheduler suspension windows. */
+	PRIVILEGED_DATA static unsigned long ulSuspendStartTime = 0UL;		/*< Run time counter value when the scheduler was suspended. */
+	PRIVILEGED_DATA static void *pvSuspendCaller = NULL;					/*< Return address of the outermost vTaskSuspendAll() call. */
+	static void prvWriteLatencyProfile( signed char *pcWriteBuffer, const char *pcName, const xLatencyProfile *pxProfile ) PRIVILEGED_FUNCTION;
 
 #endif
 
@@ -348,9 +391,15 @@ static void prvCheckTasksWaitingTermination( void ) PRIVILEGED_FUNCTION;
 
 /*
  * Allocates memory from the heap for a TCB and associated stack.  Checks the
- * allocation was successful.
+ * allocation was successful.  If pxTCBBuffer is not NULL the TCB and the
+ * stack are the buffers provided by the application instead.
+ */
+static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer, tskTCB *pxTCBBuffer ) PRIVILEGED_FUNCTION;
+
+/*
+ * Common part of xTaskGenericCreate() and xTaskCreateStatic().
  */
-static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer ) PRIVILEGED_FUNCTION;
+static signed portBASE_TYPE prvTaskCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions, tskTCB *pxTCBBuffer ) PRIVILEGED_FUNCTION;
 
 /*
  * Called from vTaskList.  vListTasks details all the tasks currently under
@@ -378,6 +427,17 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
 
 #endif
 
+/*
+ * Return the number of ticks the idle task can expect to sleep for before a
+ * delayed task has to be woken.  Returns 0 if any task other than the idle
+ * task is ready to run.  MUST BE CALLED WITH THE SCHEDULER SUSPENDED.
+ */
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	static portTickType prvGetExpectedIdleTime( void ) PRIVILEGED_FUNCTION;
+
+#endif
+
 
 /*lint +e956 */
 
@@ -388,6 +448,33 @@ static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TY
  *----------------------------------------------------------*/
 
 signed portBASE_TYPE xTaskGenericCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions )
+{
+	return prvTaskCreate( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, puxStackBuffer, xRegions, NULL );
+}
+/*-----------------------------------------------------------*/
+
+#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+
+	signed portBASE_TYPE xTaskCreateStatic( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, xStaticTask *pxTaskBuffer )
+	{
+	signed portBASE_TYPE xReturn;
+
+		if( ( puxStackBuffer != NULL ) && ( pxTaskBuffer != NULL ) )
+		{
+			xReturn = prvTaskCreate( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, puxStackBuffer, NULL, ( tskTCB * ) pxTaskBuffer );
+		}
+		else
+		{
+			xReturn = errCOULD_NOT_ALLOCATE_REQUIRED_MEMORY;
+		}
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+static signed portBASE_TYPE prvTaskCreate( pdTASK_CODE pxTaskCode, const signed char * const pcName, unsigned short usStackDepth, void *pvParameters, unsigned portBASE_TYPE uxPriority, xTaskHandle *pxCreatedTask, portSTACK_TYPE *puxStackBuffer, const xMemoryRegion * const xRegions, tskTCB *pxTCBBuffer )
 {
 signed portBASE_TYPE xReturn;
 tskTCB * pxNewTCB;
@@ -395,7 +482,7 @@ portBASE_TYPE xRunPrivileged;
 
 	/* Allocate the memory required by the TCB and stack for the new task,
 	checking that the allocation was successful. */
-	pxNewTCB = prvAllocateTCBAndStack( usStackDepth, puxStackBuffer );
+	pxNewTCB = prvAllocateTCBAndStack( usStackDepth, puxStackBuffer, pxTCBBuffer );
 
 	if( pxNewTCB != NULL )
 	{
@@ -1025,7 +1112,15 @@ void vTaskStartScheduler( void )
 portBASE_TYPE xReturn;
 
 	/* Add the idle task at the lowest priority. */
-	xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), ( xTaskHandle * ) NULL );
+	#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+	{
+		xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), &xIdleTaskHandle );
+	}
+	#else
+	{
+		xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), ( xTaskHandle * ) NULL );
+	}
+	#endif
 
 	if( xReturn == pdPASS )
 	{
@@ -1073,8 +1168,22 @@ void vTaskEndScheduler( void )
 }
 /*----------------------------------------------------------*/
 
-void vTaskSuspendAll( void )
+/* Never inlined: the latency profiler records the return address, which
+must be that of the caller, within tasks.c too. */
+__attribute__((__noinline__)) void vTaskSuspendAll( void )
 {
+	#if ( configUSE_LATENCY_PROFILER == 1 )
+	{
+		/* Only the outermost call opens a window.  ISRs do not suspend the
+		scheduler, so the test cannot race with another suspension. */
+		if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
+		{
+			ulSuspendStartTime = portGET_RUN_TIME_COUNTER_VALUE();
+			pvSuspendCaller = portGET_CALLER_ADDRESS();
+		}
+	}
+	#endif
+
 	/* A critical section is not required as the variable is of type
 	portBASE_TYPE. */
 	++uxSchedulerSuspended;
@@ -1097,6 +1206,12 @@ signed portBASE_TYPE xAlreadyYielded = pdFALSE;
 
 		if( uxSchedulerSuspended == ( unsigned portBASE_TYPE ) pdFALSE )
 		{
+			#if ( configUSE_LATENCY_PROFILER == 1 )
+			{
+				vTaskLatencyProfileAdd( &xSuspendProfile, portGET_RUN_TIME_COUNTER_VALUE() - ulSuspendStartTime, pvSuspendCaller );
+			}
+			#endif
+
 			if( uxCurrentNumberOfTasks > ( unsigned portBASE_TYPE ) 0 )
 			{
 				portBASE_TYPE xYieldRequired = pdFALSE;
@@ -1254,13 +1369,21 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 	void vTaskGetRunTimeStats( signed char *pcWriteBuffer )
 	{
 	unsigned portBASE_TYPE uxQueue;
-	unsigned long ulTotalRunTime = portGET_RUN_TIME_COUNTER_VALUE();
+	unsigned long long ullTotal;
+	unsigned long ulWindowNumber;
 
 		/* This is a VERY costly function that should be used for debug only.
 		It leaves interrupts disabled for a LONG time. */
 
 		vTaskSuspendAll();
 		{
+			portENTER_CRITICAL();
+			{
+				ullTotal = ullTotalRunTime;
+				ulWindowNumber = tskRUN_TIME_WINDOW_OF( portGET_RUN_TIME_COUNTER_VALUE() );
+			}
+			portEXIT_CRITICAL();
+
 			/* Run through all the lists that could potentially contain a TCB,
 			generating a table of run timer percentages in the provided
 			buffer. */
@@ -1276,25 +1399,25 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 
 				if( !listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxQueue ] ) ) )
 				{
-					prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) &( pxReadyTasksLists[ uxQueue ] ), ulTotalRunTime );
+					prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) &( pxReadyTasksLists[ uxQueue ] ), ullTotal, ulWindowNumber );
 				}
 			}while( uxQueue > ( unsigned short ) tskIDLE_PRIORITY );
 
 			if( !listLIST_IS_EMPTY( pxDelayedTaskList ) )
 			{
-				prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) pxDelayedTaskList, ulTotalRunTime );
+				prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) pxDelayedTaskList, ullTotal, ulWindowNumber );
 			}
 
 			if( !listLIST_IS_EMPTY( pxOverflowDelayedTaskList ) )
 			{
-				prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) pxOverflowDelayedTaskList, ulTotalRunTime );
+				prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) pxOverflowDelayedTaskList, ullTotal, ulWindowNumber );
 			}
 
 			#if ( INCLUDE_vTaskDelete == 1 )
 			{
 				if( !listLIST_IS_EMPTY( &xTasksWaitingTermination ) )
 				{
-					prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) &xTasksWaitingTermination, ulTotalRunTime );
+					prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) &xTasksWaitingTermination, ullTotal, ulWindowNumber );
 				}
 			}
 			#endif
@@ -1303,7 +1426,7 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 			{
 				if( !listLIST_IS_EMPTY( &xSuspendedTaskList ) )
 				{
-					prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) &xSuspendedTaskList, ulTotalRunTime );
+					prvGenerateRunTimeStatsForTasksInList( pcWriteBuffer, ( xList * ) &xSuspendedTaskList, ullTotal, ulWindowNumber );
 				}
 			}
 			#endif
@@ -1314,6 +1437,188 @@ unsigned portBASE_TYPE uxTaskGetNumberOfTasks( void )
 #endif
 /*----------------------------------------------------------*/
 
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	unsigned portBASE_TYPE uxTaskGetRunTimeStatsBinary( unsigned char *pucBuffer, unsigned portBASE_TYPE uxBufferLength )
+	{
+	unsigned portBASE_TYPE uxQueue, uxCount = 0;
+	const unsigned char *pucBufferEnd = pucBuffer + uxBufferLength;
+	unsigned char *pucRecord;
+	unsigned long long ullTotal;
+	unsigned long ulNow;
+
+		if( uxBufferLength < tskRUN_TIME_STATS_HEADER_SIZE )
+		{
+			return 0;
+		}
+
+		vTaskSuspendAll();
+		{
+			portENTER_CRITICAL();
+			{
+				ullTotal = ullTotalRunTime;
+				ulNow = portGET_RUN_TIME_COUNTER_VALUE();
+			}
+			portEXIT_CRITICAL();
+
+			pucRecord = pucBuffer + tskRUN_TIME_STATS_HEADER_SIZE;
+
+			uxQueue = uxTopUsedPriority + 1;
+
+			do
+			{
+				uxQueue--;
+
+				if( !listLIST_IS_EMPTY( &( pxReadyTasksLists[ uxQueue ] ) ) )
+				{
+					pucRecord = prvWriteRunTimeStatsForTasksInList( pucRecord, pucBufferEnd, &uxCount, ( xList * ) &( pxReadyTasksLists[ uxQueue ] ), tskREADY_CHAR, tskRUN_TIME_WINDOW_OF( ulNow ) );
+				}
+			}while( uxQueue > ( unsigned short ) tskIDLE_PRIORITY );
+
+			if( !listLIST_IS_EMPTY( pxDelayedTaskList ) )
+			{
+				pucRecord = prvWriteRunTimeStatsForTasksInList( pucRecord, pucBufferEnd, &uxCount, ( xList * ) pxDelayedTaskList, tskBLOCKED_CHAR, tskRUN_TIME_WINDOW_OF( ulNow ) );
+			}
+
+			if( !listLIST_IS_EMPTY( pxOverflowDelayedTaskList ) )
+			{
+				pucRecord = prvWriteRunTimeStatsForTasksInList( pucRecord, pucBufferEnd, &uxCount, ( xList * ) pxOverflowDelayedTaskList, tskBLOCKED_CHAR, tskRUN_TIME_WINDOW_OF( ulNow ) );
+			}
+
+			#if ( INCLUDE_vTaskDelete == 1 )
+			{
+				if( !listLIST_IS_EMPTY( &xTasksWaitingTermination ) )
+				{
+					pucRecord = prvWriteRunTimeStatsForTasksInList( pucRecord, pucBufferEnd, &uxCount, ( xList * ) &xTasksWaitingTermination, tskDELETED_CHAR, tskRUN_TIME_WINDOW_OF( ulNow ) );
+				}
+			}
+			#endif
+
+			#if ( INCLUDE_vTaskSuspend == 1 )
+			{
+				if( !listLIST_IS_EMPTY( &xSuspendedTaskList ) )
+				{
+					pucRecord = prvWriteRunTimeStatsForTasksInList( pucRecord, pucBufferEnd, &uxCount, ( xList * ) &xSuspendedTaskList, tskSUSPENDED_CHAR, tskRUN_TIME_WINDOW_OF( ulNow ) );
+				}
+			}
+			#endif
+		}
+		xTaskResumeAll();
+
+		/* Header, all fields big endian:
+		version, record size, window shift, record count,
+		run time counter value, total run time of all the tasks. */
+		pucBuffer[ 0 ] = tskRUN_TIME_STATS_VERSION;
+		pucBuffer[ 1 ] = ( unsigned char ) tskRUN_TIME_STATS_RECORD_SIZE;
+		pucBuffer[ 2 ] = ( unsigned char ) configRUN_TIME_STATS_WINDOW_SHIFT;
+		pucBuffer[ 3 ] = ( unsigned char ) uxCount;
+		pucBuffer[ 4 ] = ( unsigned char ) ( ulNow >> 24 );
+		pucBuffer[ 5 ] = ( unsigned char ) ( ulNow >> 16 );
+		pucBuffer[ 6 ] = ( unsigned char ) ( ulNow >> 8 );
+		pucBuffer[ 7 ] = ( unsigned char ) ulNow;
+		for( uxQueue = 0; uxQueue < 8; uxQueue++ )
+		{
+			pucBuffer[ 8 + uxQueue ] = ( unsigned char ) ( ullTotal >> ( 56 - ( 8 * uxQueue ) ) );
+		}
+
+		return ( unsigned portBASE_TYPE ) ( pucRecord - pucBuffer );
+	}
+
+	unsigned long long ullTaskGetRunTimeCounter( xTaskHandle pxTask )
+	{
+	tskTCB *pxTCB;
+	unsigned long long ullRunTime;
+
+		/* 64 bits, updated by the context switch: read in a critical
+		section. */
+		portENTER_CRITICAL();
+		{
+			pxTCB = prvGetTCBFromHandle( pxTask );
+			ullRunTime = pxTCB->ullRunTimeCounter;
+		}
+		portEXIT_CRITICAL();
+
+		return ullRunTime;
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
+#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+
+	xTaskHandle xTaskGetIdleTaskHandle( void )
+	{
+		return xIdleTaskHandle;
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
+#if ( configUSE_LATENCY_PROFILER == 1 )
+
+	void vTaskLatencyProfileAdd( xLatencyProfile *pxProfile, unsigned long ulLength, void *pvCaller )
+	{
+	unsigned long ulScaled;
+	unsigned portBASE_TYPE uxBucket = 0;
+
+		if( ulLength > pxProfile->ulLongest )
+		{
+			pxProfile->ulLongest = ulLength;
+			pxProfile->pvLongestCaller = pvCaller;
+		}
+
+		pxProfile->ulCount++;
+
+		/* Logarithmic buckets. */
+		ulScaled = ulLength >> configLATENCY_HISTOGRAM_SHIFT;
+		while( ( ulScaled != 0UL ) && ( uxBucket < ( configLATENCY_HISTOGRAM_BUCKETS - 1 ) ) )
+		{
+			ulScaled >>= 1;
+			uxBucket++;
+		}
+
+		pxProfile->pulHistogram[ uxBucket ]++;
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
+#if ( configUSE_LATENCY_PROFILER == 1 )
+
+	void vTaskGetSchedulerSuspendProfile( xLatencyProfile *pxProfile, portBASE_TYPE xReset )
+	{
+		portENTER_CRITICAL();
+		{
+			*pxProfile = xSuspendProfile;
+			if( xReset != pdFALSE )
+			{
+				memset( ( void * ) &xSuspendProfile, 0x00, sizeof( xSuspendProfile ) );
+			}
+		}
+		portEXIT_CRITICAL();
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
+#if ( configUSE_LATENCY_PROFILER == 1 )
+
+	void vTaskGetLatencyStats( signed char *pcWriteBuffer )
+	{
+	xLatencyProfile xProfile;
+
+		pcWriteBuffer[ 0 ] = ( signed char ) 0x00;
+
+		vPortGetCriticalProfile( &xProfile, pdFALSE );
+		prvWriteLatencyProfile( pcWriteBuffer, "critical", &xProfile );
+
+		vTaskGetSchedulerSuspendProfile( &xProfile, pdFALSE );
+		prvWriteLatencyProfile( pcWriteBuffer, "suspend", &xProfile );
+	}
+
+#endif
+/*----------------------------------------------------------*/
+
 #if ( configUSE_TRACE_FACILITY == 1 )
 
 	void vTaskStartTrace( signed char * pcBuffer, unsigned long ulBufferSize )
@@ -1412,6 +1717,43 @@ void vTaskIncrementTick( void )
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	void vTaskStepTick( portTickType xTicksToJump )
+	{
+		/* Correct the tick count value after a period during which the tick
+		was suppressed.  The port never sleeps past the wake time of the first
+		delayed task (see prvGetExpectedIdleTime()) so no task can be due in
+		the ticks being skipped, and the delayed lists cannot need swapping. */
+		xTickCount += xTicksToJump;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	eSleepModeStatus eTaskConfirmSleepModeStatus( void )
+	{
+	eSleepModeStatus eReturn = eStandardSleep;
+
+		if( listCURRENT_LIST_LENGTH( &xPendingReadyList ) != 0 )
+		{
+			/* A task was made ready while the scheduler was suspended. */
+			eReturn = eAbortSleep;
+		}
+		else if( xMissedYield != pdFALSE )
+		{
+			/* A yield was pended while the scheduler was suspended. */
+			eReturn = eAbortSleep;
+		}
+
+		return eReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( ( INCLUDE_vTaskCleanUpResources == 1 ) && ( INCLUDE_vTaskSuspend == 1 ) )
 
 	void vTaskCleanUpResources( void )
@@ -1567,13 +1909,38 @@ void vTaskSwitchContext( void )
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 	{
 		unsigned long ulTempCounter = portGET_RUN_TIME_COUNTER_VALUE();
+		unsigned long ulDelta = ulTempCounter - ulTaskSwitchedInTime;
+		unsigned long ulWindowNumber = tskRUN_TIME_WINDOW_OF( ulTempCounter );
+		unsigned long ulWindowElapsed;
 
 			/* Add the amount of time the task has been running to the accumulated
 			time so far.  The time the task started running was stored in
-			ulTaskSwitchedInTime.  Note that there is no overflow protection here
-			so count values are only valid until the timer overflows.  Generally
-			this will be about 1 hour assuming a 1uS timer increment. */
-			pxCurrentTCB->ulRunTimeCounter += ( ulTempCounter - ulTaskSwitchedInTime );
+			ulTaskSwitchedInTime.  The counter itself may wrap, the difference
+			only has to be shorter than one counter period.  The totals are
+			kept on 64 bits so they do not overflow. */
+			pxCurrentTCB->ullRunTimeCounter += ulDelta;
+			ullTotalRunTime += ulDelta;
+
+			/* Split the same amount between the statistics window the task
+			was switched in during and the current window. */
+			prvUpdateRunTimeWindow( ( tskTCB * ) pxCurrentTCB, tskRUN_TIME_WINDOW_OF( ulTaskSwitchedInTime ) );
+			if( pxCurrentTCB->ulWindowNumber == ulWindowNumber )
+			{
+				pxCurrentTCB->ulWindowRunTime += ulDelta;
+			}
+			else
+			{
+				ulWindowElapsed = ulTempCounter - ( ulWindowNumber << configRUN_TIME_STATS_WINDOW_SHIFT );
+				pxCurrentTCB->ulWindowRunTime += ulDelta - ulWindowElapsed;
+				prvUpdateRunTimeWindow( ( tskTCB * ) pxCurrentTCB, ulWindowNumber );
+				if( ulDelta - ulWindowElapsed > tskRUN_TIME_WINDOW_LENGTH )
+				{
+					/* The task ran throughout the previous window. */
+					pxCurrentTCB->ulLastWindowRunTime = tskRUN_TIME_WINDOW_LENGTH;
+				}
+				pxCurrentTCB->ulWindowRunTime = ulWindowElapsed;
+			}
+
 			ulTaskSwitchedInTime = ulTempCounter;
 	}
 	#endif
@@ -1817,6 +2184,43 @@ static portTASK_FUNCTION( prvIdleTask, pvParameters )
 		}
 		#endif
 
+		#if ( configUSE_TICKLESS_IDLE == 1 )
+		{
+		portTickType xExpectedIdleTime;
+
+			/* It is not desirable to suspend then resume the scheduler on
+			each iteration of the idle task, so first take a rough look at
+			the delayed list without the scheduler suspended. */
+			xExpectedIdleTime = prvGetExpectedIdleTime();
+
+			if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+			{
+				vTaskSuspendAll();
+				{
+					/* Now the scheduler is suspended the expected idle time
+					can be sampled again, and this time its value can be
+					used. */
+					xExpectedIdleTime = prvGetExpectedIdleTime();
+
+					if( xExpectedIdleTime >= configEXPECTED_IDLE_TIME_BEFORE_SLEEP )
+					{
+						portSUPPRESS_TICKS_AND_SLEEP( xExpectedIdleTime );
+
+						#if ( configUSE_LATENCY_PROFILER == 1 )
+						{
+							/* Do not count the time spent asleep as scheduler
+							latency: an interrupt readying a task wakes the
+							processor up. */
+							ulSuspendStartTime = portGET_RUN_TIME_COUNTER_VALUE();
+						}
+						#endif
+					}
+				}
+				xTaskResumeAll();
+			}
+		}
+		#endif
+
 		#if ( configUSE_IDLE_HOOK == 1 )
 		{
 			extern void vApplicationIdleHook( void );
@@ -1894,7 +2298,10 @@ static void prvInitialiseTCBVariables( tskTCB *pxTCB, const signed char * const
 
 	#if ( configGENERATE_RUN_TIME_STATS == 1 )
 	{
-		pxTCB->ulRunTimeCounter = 0UL;
+		pxTCB->ullRunTimeCounter = 0ULL;
+		pxTCB->ulWindowRunTime = 0UL;
+		pxTCB->ulLastWindowRunTime = 0UL;
+		pxTCB->ulWindowNumber = 0UL;
 	}
 	#endif
 
@@ -1962,6 +2369,59 @@ unsigned portBASE_TYPE uxPriority;
 }
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_TICKLESS_IDLE == 1 )
+
+	static portTickType prvGetExpectedIdleTime( void )
+	{
+	portTickType xReturn;
+	tskTCB *pxTCB;
+
+		if( pxCurrentTCB->uxPriority > tskIDLE_PRIORITY )
+		{
+			xReturn = 0;
+		}
+		else if( listCURRENT_LIST_LENGTH( &( pxReadyTasksLists[ tskIDLE_PRIORITY ] ) ) > ( unsigned portBASE_TYPE ) 1 )
+		{
+			/* There are other idle priority tasks in the Ready state.  If
+			time slicing is used then the very next tick interrupt must be
+			processed. */
+			xReturn = 0;
+		}
+		else if( uxTopReadyPriority > tskIDLE_PRIORITY )
+		{
+			/* A higher priority task has been readied but not yet switched
+			in. */
+			xReturn = 0;
+		}
+		else if( uxMissedTicks > ( unsigned portBASE_TYPE ) 0 )
+		{
+			/* Ticks are waiting to be unwound by xTaskResumeAll(), so
+			xTickCount is not yet up to date. */
+			xReturn = 0;
+		}
+		else
+		{
+			pxTCB = ( tskTCB * ) listGET_OWNER_OF_HEAD_ENTRY( pxDelayedTaskList );
+
+			if( pxTCB != NULL )
+			{
+				xReturn = listGET_LIST_ITEM_VALUE( &( pxTCB->xGenericListItem ) ) - xTickCount;
+			}
+			else
+			{
+				/* Nothing is due before the tick count overflows.  The
+				overflow tick itself must still be processed so the delayed
+				lists get swapped. */
+				xReturn = portMAX_DELAY - xTickCount;
+			}
+		}
+
+		return xReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 static void prvCheckTasksWaitingTermination( void )
 {
 	#if ( INCLUDE_vTaskDelete == 1 )
@@ -1997,16 +2457,43 @@ static void prvCheckTasksWaitingTermination( void )
 }
 /*-----------------------------------------------------------*/
 
-static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer )
+static tskTCB *prvAllocateTCBAndStack( unsigned short usStackDepth, portSTACK_TYPE *puxStackBuffer, tskTCB *pxTCBBuffer )
 {
 tskTCB *pxNewTCB;
 
+	#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+	{
+		if( pxTCBBuffer != NULL )
+		{
+			/* The application provided both the TCB and the stack. */
+			pxNewTCB = pxTCBBuffer;
+			pxNewTCB->pxStack = puxStackBuffer;
+			pxNewTCB->ucStaticallyAllocated = pdTRUE;
+
+			/* Just to help debugging. */
+			memset( pxNewTCB->pxStack, tskSTACK_FILL_BYTE, usStackDepth * sizeof( portSTACK_TYPE ) );
+
+			return pxNewTCB;
+		}
+	}
+	#else
+	{
+		( void ) pxTCBBuffer;
+	}
+	#endif
+
 	/* Allocate space for the TCB.  Where the memory comes from depends on
 	the implementation of the port malloc function. */
 	pxNewTCB = ( tskTCB * ) pvPortMalloc( sizeof( tskTCB ) );
 
 	if( pxNewTCB != NULL )
 	{
+		#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			pxNewTCB->ucStaticallyAllocated = pdFALSE;
+		}
+		#endif
+
 		/* Allocate space for the stack used by the task being created.
 		The base of the stack memory stored in the TCB so the task can
 		be deleted later if required. */
@@ -2053,12 +2540,13 @@ tskTCB *pxNewTCB;
 
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
-	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long ulTotalRunTime )
+	static void prvGenerateRunTimeStatsForTasksInList( const signed char *pcWriteBuffer, xList *pxList, unsigned long long ullTotalRunTime, unsigned long ulWindowNumber )
 	{
 	volatile tskTCB *pxNextTCB, *pxFirstTCB;
-	unsigned long ulStatsAsPercentage;
+	unsigned long ulStatsAsPercentage, ulWindowPercentage;
 
-		/* Write the run time stats of all the TCB's in pxList into the buffer. */
+		/* Write the run time stats of all the TCB's in pxList into the buffer.
+		The run time is given in thousands of counter increments. */
 		listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
 		do
 		{
@@ -2066,29 +2554,31 @@ tskTCB *pxNewTCB;
 			listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
 
 			/* Divide by zero check. */
-			if( ulTotalRunTime > 0UL )
+			if( ullTotalRunTime > 0ULL )
 			{
+				ulWindowPercentage = ( unsigned long ) ( ( 100ULL * prvGetLastWindowRunTime( ( tskTCB * ) pxNextTCB, ulWindowNumber ) ) >> configRUN_TIME_STATS_WINDOW_SHIFT );
+
 				/* Has the task run at all? */
-				if( pxNextTCB->ulRunTimeCounter == 0 )
+				if( pxNextTCB->ullRunTimeCounter == 0ULL )
 				{
 					/* The task has used no CPU time at all. */
-					sprintf( pcStatsString, ( char * ) "%s\t\t0\t\t0%%\r\n", pxNextTCB->pcTaskName );
+					sprintf( pcStatsString, ( char * ) "%s\t\t0\t\t0%%\t0%%\r\n", pxNextTCB->pcTaskName );
 				}
 				else
 				{
 					/* What percentage of the total run time as the task used?
 					This will always be rounded down to the nearest integer. */
-					ulStatsAsPercentage = ( 100UL * pxNextTCB->ulRunTimeCounter ) / ulTotalRunTime;
+					ulStatsAsPercentage = ( unsigned long ) ( ( 100ULL * pxNextTCB->ullRunTimeCounter ) / ullTotalRunTime );
 
 					if( ulStatsAsPercentage > 0UL )
 					{
-						sprintf( pcStatsString, ( char * ) "%s\t\t%u\t\t%u%%\r\n", pxNextTCB->pcTaskName, ( unsigned int ) pxNextTCB->ulRunTimeCounter, ( unsigned int ) ulStatsAsPercentage );
+						sprintf( pcStatsString, ( char * ) "%s\t\t%u\t\t%u%%\t%u%%\r\n", pxNextTCB->pcTaskName, ( unsigned int ) ( pxNextTCB->ullRunTimeCounter / 1000ULL ), ( unsigned int ) ulStatsAsPercentage, ( unsigned int ) ulWindowPercentage );
 					}
 					else
 					{
 						/* If the percentage is zero here then the task has
 						consumed less than 1% of the total run time. */
-						sprintf( pcStatsString, ( char * ) "%s\t\t%u\t\t<1%%\r\n", pxNextTCB->pcTaskName, ( unsigned int ) pxNextTCB->ulRunTimeCounter );
+						sprintf( pcStatsString, ( char * ) "%s\t\t%u\t\t<1%%\t%u%%\r\n", pxNextTCB->pcTaskName, ( unsigned int ) ( pxNextTCB->ullRunTimeCounter / 1000ULL ), ( unsigned int ) ulWindowPercentage );
 					}
 				}
 
@@ -2101,6 +2591,136 @@ tskTCB *pxNewTCB;
 #endif
 /*-----------------------------------------------------------*/
 
+#if ( configUSE_LATENCY_PROFILER == 1 )
+
+	static void prvWriteLatencyProfile( signed char *pcWriteBuffer, const char *pcName, const xLatencyProfile *pxProfile )
+	{
+	char pcLine[ 16 ];
+	unsigned portBASE_TYPE uxBucket;
+
+		/* One line: name, longest window, its caller, number of windows, then
+		the histogram buckets. */
+		pcWriteBuffer += strlen( ( char * ) pcWriteBuffer );
+		sprintf( ( char * ) pcWriteBuffer, "%s\t%lu\t0x%08lx\t%lu\t", pcName, pxProfile->ulLongest, ( unsigned long ) pxProfile->pvLongestCaller, pxProfile->ulCount );
+
+		for( uxBucket = 0; uxBucket < configLATENCY_HISTOGRAM_BUCKETS; uxBucket++ )
+		{
+			sprintf( pcLine, "%lu ", pxProfile->pulHistogram[ uxBucket ] );
+			strcat( ( char * ) pcWriteBuffer, pcLine );
+		}
+
+		strcat( ( char * ) pcWriteBuffer, "\r\n" );
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	static unsigned char *prvWriteRunTimeStatsForTasksInList( unsigned char *pucBuffer, const unsigned char *pucBufferEnd, unsigned portBASE_TYPE *puxCount, xList *pxList, signed char cStatus, unsigned long ulWindowNumber )
+	{
+	volatile tskTCB *pxNextTCB, *pxFirstTCB;
+	unsigned long ulLastWindow;
+	unsigned long long ullRunTime;
+	portBASE_TYPE x;
+
+		/* One fixed size record per TCB in pxList, all fields big endian:
+		TCB number, priority, state, CPU percentage over the last complete
+		window, run time in the last complete window, total run time. */
+		listGET_OWNER_OF_NEXT_ENTRY( pxFirstTCB, pxList );
+		do
+		{
+			listGET_OWNER_OF_NEXT_ENTRY( pxNextTCB, pxList );
+
+			if( ( pucBufferEnd - pucBuffer ) < tskRUN_TIME_STATS_RECORD_SIZE )
+			{
+				break;
+			}
+
+			ulLastWindow = prvGetLastWindowRunTime( ( tskTCB * ) pxNextTCB, ulWindowNumber );
+			ullRunTime = pxNextTCB->ullRunTimeCounter;
+
+			#if ( configUSE_TRACE_FACILITY == 1 )
+				pucBuffer[ 0 ] = ( unsigned char ) pxNextTCB->uxTCBNumber;
+			#else
+				pucBuffer[ 0 ] = ( unsigned char ) *puxCount;
+			#endif
+			pucBuffer[ 1 ] = ( unsigned char ) pxNextTCB->uxPriority;
+			pucBuffer[ 2 ] = ( unsigned char ) cStatus;
+			pucBuffer[ 3 ] = ( unsigned char ) ( ( 100ULL * ulLastWindow ) >> configRUN_TIME_STATS_WINDOW_SHIFT );
+			pucBuffer[ 4 ] = ( unsigned char ) ( ulLastWindow >> 24 );
+			pucBuffer[ 5 ] = ( unsigned char ) ( ulLastWindow >> 16 );
+			pucBuffer[ 6 ] = ( unsigned char ) ( ulLastWindow >> 8 );
+			pucBuffer[ 7 ] = ( unsigned char ) ulLastWindow;
+			for( x = 0; x < 8; x++ )
+			{
+				pucBuffer[ 8 + x ] = ( unsigned char ) ( ullRunTime >> ( 56 - ( 8 * x ) ) );
+			}
+
+			pucBuffer += tskRUN_TIME_STATS_RECORD_SIZE;
+			( *puxCount )++;
+
+		} while( pxNextTCB != pxFirstTCB );
+
+		return pucBuffer;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	static void prvUpdateRunTimeWindow( tskTCB *pxTCB, unsigned long ulWindowNumber )
+	{
+		/* Move the task on to window ulWindowNumber.  The run time of the
+		window the task leaves is only kept if it is the one just before. */
+		if( pxTCB->ulWindowNumber != ulWindowNumber )
+		{
+			if( ( ( ulWindowNumber - pxTCB->ulWindowNumber ) & tskRUN_TIME_WINDOW_MASK ) == 1UL )
+			{
+				pxTCB->ulLastWindowRunTime = pxTCB->ulWindowRunTime;
+			}
+			else
+			{
+				pxTCB->ulLastWindowRunTime = 0UL;
+			}
+
+			pxTCB->ulWindowRunTime = 0UL;
+			pxTCB->ulWindowNumber = ulWindowNumber;
+		}
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
+#if ( configGENERATE_RUN_TIME_STATS == 1 )
+
+	static unsigned long prvGetLastWindowRunTime( const tskTCB *pxTCB, unsigned long ulWindowNumber )
+	{
+	unsigned long ulAge, ulReturn;
+
+		/* Run time of the task in the window preceding ulWindowNumber. */
+		ulAge = ( ulWindowNumber - pxTCB->ulWindowNumber ) & tskRUN_TIME_WINDOW_MASK;
+
+		if( ulAge == 0UL )
+		{
+			ulReturn = pxTCB->ulLastWindowRunTime;
+		}
+		else if( ulAge == 1UL )
+		{
+			ulReturn = pxTCB->ulWindowRunTime;
+		}
+		else
+		{
+			ulReturn = 0UL;
+		}
+
+		return ulReturn;
+	}
+
+#endif
+/*-----------------------------------------------------------*/
+
 #if ( ( configUSE_TRACE_FACILITY == 1 ) || ( INCLUDE_uxTaskGetStackHighWaterMark == 1 ) )
 
 	static unsigned short usTaskCheckFreeStackSpace( const unsigned char * pucStackByte )
@@ -2155,6 +2775,16 @@ tskTCB *pxNewTCB;
 	{
 		/* Free up the memory allocated by the scheduler for the task.  It is up to
 		the task to free any memory allocated at the application level. */
+		#if ( configSUPPORT_STATIC_ALLOCATION == 1 )
+		{
+			if( pxTCB->ucStaticallyAllocated != pdFALSE )
+			{
+				/* Nothing to free: the buffers belong to the application. */
+				return;
+			}
+		}
+		#endif
+
 		vPortFreeAligned( pxTCB->pxStack );
 		vPortFree( pxTCB );
 	}
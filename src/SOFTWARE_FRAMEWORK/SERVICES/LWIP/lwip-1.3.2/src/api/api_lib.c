@@ -285,6 +285,27 @@ netconn_accept(struct netconn *conn)
   return newconn;
 }
 
+#if LWIP_SO_RCVTIMEO
+/**
+ * Forget the ERR_TIMEOUT a previous receive left in conn->err: it only
+ * reported that call. Left there, it would hide the ERR_CLSD of a later FIN.
+ * An error the tcpip thread sets meanwhile is kept.
+ *
+ * @param conn the netconn about to receive
+ */
+static void
+netconn_recv_clear_timeout(struct netconn *conn)
+{
+  SYS_ARCH_DECL_PROTECT(lev);
+
+  SYS_ARCH_PROTECT(lev);
+  if (conn->err == ERR_TIMEOUT) {
+    conn->err = ERR_OK;
+  }
+  SYS_ARCH_UNPROTECT(lev);
+}
+#endif /* LWIP_SO_RCVTIMEO */
+
 /**
  * Receive data (in form of a netbuf containing a packet buffer) from a netconn
  *
@@ -320,7 +341,13 @@ netconn_recv(struct netconn *conn)
       return NULL;
     }
 
-    buf = memp_malloc(MEMP_NETBUF);
+    /* Use the netbuf recycled on this netconn, if any. */
+    buf = conn->recv_netbuf;
+    if (buf != NULL) {
+      conn->recv_netbuf = NULL;
+    } else {
+      buf = memp_malloc(MEMP_NETBUF);
+    }
 
     if (buf == NULL) {
       conn->err = ERR_MEM;
@@ -328,8 +355,10 @@ netconn_recv(struct netconn *conn)
     }
 
 #if LWIP_SO_RCVTIMEO
+    netconn_recv_clear_timeout(conn);
     if (sys_arch_mbox_fetch(conn->recvmbox, (void *)&p, conn->recv_timeout)==SYS_ARCH_TIMEOUT) {
-      memp_free(MEMP_NETBUF, buf);
+      /* Keep the netbuf for the next call. */
+      conn->recv_netbuf = buf;
       conn->err = ERR_TIMEOUT;
       return NULL;
     }
@@ -349,9 +378,9 @@ netconn_recv(struct netconn *conn)
 
     /* If we are closed, we indicate that we no longer wish to use the socket */
     if (p == NULL) {
-      memp_free(MEMP_NETBUF, buf);
-      /* Avoid to lose any previous error code */
-      if (conn->err == ERR_OK) {
+      conn->recv_netbuf = buf;
+      /* Avoid to lose any previous fatal error code */
+      if (!ERR_IS_FATAL(conn->err)) {
         conn->err = ERR_CLSD;
       }
       return NULL;
@@ -394,6 +423,119 @@ netconn_recv(struct netconn *conn)
   return buf;
 }
 
+#if LWIP_TCP
+/**
+ * Receive data from a TCP netconn straight into a buffer of the caller:
+ * no netbuf is allocated. Data left over when the buffer is full is kept
+ * on the netconn and returned by the next call.
+ * Don't mix with netconn_recv() on the same netconn.
+ *
+ * @param conn the TCP netconn from which to receive data
+ * @param dataptr buffer where to copy the data
+ * @param len size of the buffer
+ * @return number of bytes copied to dataptr, 0 on error (check conn->err:
+ *         ERR_TIMEOUT, ERR_CLSD...; ERR_TIMEOUT only lasts until the next
+ *         call)
+ */
+u16_t
+netconn_recv_into(struct netconn *conn, void *dataptr, u16_t len)
+{
+  struct api_msg msg;
+  struct pbuf *p;
+  u16_t copied;
+
+  LWIP_ERROR("netconn_recv_into: invalid conn", (conn != NULL), return 0;);
+  LWIP_ERROR("netconn_recv_into: invalid conn->type", (conn->type == NETCONN_TCP), return 0;);
+
+  if ((conn->recvmbox == SYS_MBOX_NULL) || (conn->state == NETCONN_LISTEN)) {
+    conn->err = ERR_CONN;
+    return 0;
+  }
+
+  p = conn->recv_pending;
+  if (p == NULL) {
+    if (ERR_IS_FATAL(conn->err)) {
+      return 0;
+    }
+
+#if LWIP_SO_RCVTIMEO
+    netconn_recv_clear_timeout(conn);
+    if (sys_arch_mbox_fetch(conn->recvmbox, (void *)&p, conn->recv_timeout)==SYS_ARCH_TIMEOUT) {
+      conn->err = ERR_TIMEOUT;
+      return 0;
+    }
+#else
+    sys_arch_mbox_fetch(conn->recvmbox, (void *)&p, 0);
+#endif /* LWIP_SO_RCVTIMEO*/
+
+    if (p != NULL) {
+      SYS_ARCH_DEC(conn->recv_avail, p->tot_len);
+    }
+
+    /* Register event with callback */
+    API_EVENT(conn, NETCONN_EVT_RCVMINUS, (p != NULL) ? p->tot_len : 0);
+
+    /* If we are closed, we indicate that we no longer wish to use the socket */
+    if (p == NULL) {
+      /* Avoid to lose any previous fatal error code */
+      if (!ERR_IS_FATAL(conn->err)) {
+        conn->err = ERR_CLSD;
+      }
+      return 0;
+    }
+    conn->recv_pending_offset = 0;
+  }
+
+  copied = pbuf_copy_partial(p, dataptr, len, conn->recv_pending_offset);
+  conn->recv_pending_offset += copied;
+
+  if (conn->recv_pending_offset < p->tot_len) {
+    conn->recv_pending = p;
+  } else {
+    conn->recv_pending = NULL;
+    /* Let the stack know that we have taken the data. */
+    msg.function = do_recv;
+    msg.msg.conn = conn;
+    msg.msg.msg.r.len = p->tot_len;
+    pbuf_free(p);
+    TCPIP_APIMSG(&msg);
+  }
+
+  LWIP_DEBUGF(API_LIB_DEBUG, ("netconn_recv_into: copied %"U16_F" bytes (err %d)\n", copied, conn->err));
+
+  return copied;
+}
+
+/**
+ * Give a netbuf returned by netconn_recv() back to its TCP netconn instead
+ * of deleting it: the data is freed and the netbuf is used again by the next
+ * netconn_recv() on that netconn, so that a connection keeps receiving when
+ * the MEMP_NETBUF pool is empty.
+ *
+ * @param conn the TCP netconn the netbuf was received from
+ * @param buf the netbuf, not to be used by the caller any more
+ */
+void
+netconn_recycle_netbuf(struct netconn *conn, struct netbuf *buf)
+{
+  LWIP_ERROR("netconn_recycle_netbuf: invalid conn", (conn != NULL), return;);
+
+  if (buf == NULL) {
+    return;
+  }
+  if (buf->p != NULL) {
+    pbuf_free(buf->p);
+  }
+  buf->p = buf->ptr = NULL;
+
+  if ((conn->type == NETCONN_TCP) && (conn->recv_netbuf == NULL)) {
+    conn->recv_netbuf = buf;
+  } else {
+    memp_free(MEMP_NETBUF, buf);
+  }
+}
+#endif /* LWIP_TCP */
+
 /**
  * Send data (in form of a netbuf) to a specific remote IP address and port.
  * Only to be used for UDP and RAW netconns (not TCP).
@@ -450,6 +592,31 @@ netconn_send(struct netconn *conn, struct netbuf *buf)
  */
 err_t
 netconn_write(struct netconn *conn, const void *dataptr, size_t size, u8_t apiflags)
+{
+  return netconn_write_partly(conn, dataptr, size, apiflags, NULL);
+}
+
+/**
+ * Send data over a TCP netconn, possibly only part of it.
+ * With NETCONN_DONTBLOCK in apiflags, only what fits in the send buffer is
+ * enqueued and the calling task never waits for the remote side: the rest
+ * is to be written again when the netconn callback gets NETCONN_EVT_SENDPLUS
+ * (send buffer space came back: on an ACK, or from the poll timer after
+ * ERR_MEM). Without it, this is netconn_write().
+ *
+ * @param conn the TCP netconn over which to send data
+ * @param dataptr pointer to the application buffer that contains the data to send
+ * @param size size of the application data to send
+ * @param apiflags combination of the netconn_write() flags and NETCONN_DONTBLOCK
+ * @param bytes_written if not NULL, receives the number of bytes enqueued,
+ *        also when an error is returned
+ * @return ERR_OK if data was enqueued (maybe not all of it with
+ *         NETCONN_DONTBLOCK), ERR_MEM if nothing could be enqueued without
+ *         waiting, any other err_t on error
+ */
+err_t
+netconn_write_partly(struct netconn *conn, const void *dataptr, size_t size,
+                     u8_t apiflags, size_t *bytes_written)
 {
   struct api_msg msg;
 
@@ -461,11 +628,17 @@ netconn_write(struct netconn *conn, const void *dataptr, size_t size, u8_t apifl
   msg.msg.msg.w.dataptr = dataptr;
   msg.msg.msg.w.apiflags = apiflags;
   msg.msg.msg.w.len = size;
+  msg.msg.msg.w.err = ERR_OK;
   /* For locking the core: this _can_ be delayed on low memory/low send buffer,
      but if it is, this is done inside api_msg.c:do_write(), so we can use the
      non-blocking version here. */
   TCPIP_APIMSG(&msg);
-  return conn->err;
+  if (bytes_written != NULL) {
+    /* do_write() leaves the length enqueued in msg.w.len, also on error:
+       data enqueued before tcp_output() failed will still be sent */
+    *bytes_written = msg.msg.msg.w.len;
+  }
+  return (msg.msg.msg.w.err != ERR_OK) ? msg.msg.msg.w.err : conn->err;
 }
 
 /**
@@ -487,6 +660,79 @@ netconn_close(struct netconn *conn)
   return conn->err;
 }
 
+#if LWIP_TCP
+/**
+ * Disable (or re-enable) the Nagle algorithm on a TCP netconn: with nodelay
+ * set, small writes are sent at once instead of waiting for the previous
+ * segment to be acknowledged.
+ *
+ * @param conn the TCP netconn to configure
+ * @param nodelay 1 to disable the Nagle algorithm, 0 to enable it
+ * @return ERR_OK if the option was set, ERR_VAL if conn is not a TCP netconn
+ */
+err_t
+netconn_set_nodelay(struct netconn *conn, u8_t nodelay)
+{
+  struct api_msg msg;
+
+  LWIP_ERROR("netconn_set_nodelay: invalid conn",  (conn != NULL), return ERR_ARG;);
+
+  msg.function = do_nodelay;
+  msg.msg.conn = conn;
+  msg.msg.msg.nd.nodelay = nodelay;
+  TCPIP_APIMSG(&msg);
+  return conn->err;
+}
+
+/**
+ * Get whether the Nagle algorithm is disabled on a TCP netconn.
+ *
+ * @param conn the TCP netconn to query
+ * @return 1 if the Nagle algorithm is disabled, 0 otherwise
+ */
+u8_t
+netconn_get_nodelay(struct netconn *conn)
+{
+  LWIP_ERROR("netconn_get_nodelay: invalid conn",  (conn != NULL), return 0;);
+
+  /* reading the pcb flags is atomic, no need to go through the tcpip thread */
+  return ((conn->type == NETCONN_TCP) && (conn->pcb.tcp != NULL) &&
+          tcp_nagle_disabled(conn->pcb.tcp)) ? 1 : 0;
+}
+
+/**
+ * Enable the keepalive probes on a TCP netconn, so that a peer which
+ * disappeared without closing the connection is detected: after idle
+ * milliseconds without any segment received, a probe is sent every intvl
+ * milliseconds and the connection is aborted (ERR_ABRT) when cnt probes
+ * got no answer.
+ * intvl and cnt are only used if LWIP_TCP_KEEPALIVE==1 (TCP_MAXIDLE is used
+ * otherwise).
+ *
+ * @param conn the TCP netconn to configure
+ * @param idle idle time before the first probe in milliseconds, 0 to disable
+ *        the keepalive probes
+ * @param intvl time between two probes in milliseconds
+ * @param cnt number of unanswered probes before the connection is aborted
+ * @return ERR_OK if the option was set, ERR_VAL if conn is not a TCP netconn
+ */
+err_t
+netconn_set_keepalive(struct netconn *conn, u32_t idle, u32_t intvl, u32_t cnt)
+{
+  struct api_msg msg;
+
+  LWIP_ERROR("netconn_set_keepalive: invalid conn",  (conn != NULL), return ERR_ARG;);
+
+  msg.function = do_keepalive;
+  msg.msg.conn = conn;
+  msg.msg.msg.ka.idle = idle;
+  msg.msg.msg.ka.intvl = intvl;
+  msg.msg.msg.ka.cnt = cnt;
+  TCPIP_APIMSG(&msg);
+  return conn->err;
+}
+#endif /* LWIP_TCP */
+
 #if LWIP_IGMP
 /**
  * Join multicast groups for UDP netconns.
@@ -258,6 +258,14 @@ poll_tcp(void *arg, struct tcp_pcb *pcb)
     do_close_internal(conn);
   }
 
+  /* A NETCONN_DONTBLOCK write found no room and nothing may be in flight to
+     call sent_tcp: let the application try again. */
+  if (conn->write_blocked && (conn->pcb.tcp != NULL) &&
+      (tcp_sndbuf(conn->pcb.tcp) > TCP_SNDLOWAT)) {
+    conn->write_blocked = 0;
+    API_EVENT(conn, NETCONN_EVT_SENDPLUS, 0);
+  }
+
   return ERR_OK;
 }
 
@@ -285,6 +293,7 @@ sent_tcp(void *arg, struct tcp_pcb *pcb, u16_t len)
 
   if (conn) {
     if ((conn->pcb.tcp != NULL) && (tcp_sndbuf(conn->pcb.tcp) > TCP_SNDLOWAT)) {
+      conn->write_blocked = 0;
       API_EVENT(conn, NETCONN_EVT_SENDPLUS, len);
     }
   }
@@ -554,6 +563,10 @@ netconn_alloc(enum netconn_type t, netconn_callback callback)
 #if LWIP_TCPIP_CORE_LOCKING
   conn->write_delayed = 0;
 #endif /* LWIP_TCPIP_CORE_LOCKING */
+  conn->write_blocked = 0;
+  conn->recv_netbuf  = NULL;
+  conn->recv_pending = NULL;
+  conn->recv_pending_offset = 0;
 #endif /* LWIP_TCP */
 #if LWIP_SO_RCVTIMEO
   conn->recv_timeout = 0;
@@ -591,6 +604,18 @@ netconn_free(struct netconn *conn)
     conn->recvmbox = SYS_MBOX_NULL;
   }
 
+#if LWIP_TCP
+  /* Release what netconn_recv_into() and netconn_recycle_netbuf() kept. */
+  if (conn->recv_pending != NULL) {
+    pbuf_free(conn->recv_pending);
+    conn->recv_pending = NULL;
+  }
+  if (conn->recv_netbuf != NULL) {
+    memp_free(MEMP_NETBUF, conn->recv_netbuf);
+    conn->recv_netbuf = NULL;
+  }
+#endif /* LWIP_TCP */
+
   /* Drain the acceptmbox. */
   if (conn->acceptmbox != SYS_MBOX_NULL) {
     while (sys_mbox_tryfetch(conn->acceptmbox, &mem) != SYS_MBOX_EMPTY) {
@@ -977,10 +1002,13 @@ do_writemore(struct netconn *conn)
   void *dataptr;
   u16_t len, available;
   u8_t write_finished = 0;
+  u8_t dontblock;
   size_t diff;
 
   LWIP_ASSERT("conn->state == NETCONN_WRITE", (conn->state == NETCONN_WRITE));
 
+  dontblock = conn->write_msg->msg.w.apiflags & NETCONN_DONTBLOCK;
+
   dataptr = (u8_t*)conn->write_msg->msg.w.dataptr + conn->write_offset;
   diff = conn->write_msg->msg.w.len - conn->write_offset;
   if (diff > 0xffffUL) { /* max_u16_t */
@@ -1000,12 +1028,19 @@ do_writemore(struct netconn *conn)
 #endif
   }
 
-  err = tcp_write(conn->pcb.tcp, dataptr, len, conn->write_msg->msg.w.apiflags);
+  if (dontblock && (len == 0)) {
+    /* send buffer full: nothing to enqueue, don't wait for sent_tcp */
+    err = ERR_MEM;
+  } else {
+    err = tcp_write(conn->pcb.tcp, dataptr, len, conn->write_msg->msg.w.apiflags);
+  }
   LWIP_ASSERT("do_writemore: invalid length!", ((conn->write_offset + len) <= conn->write_msg->msg.w.len));
   if (err == ERR_OK) {
     conn->write_offset += len;
-    if (conn->write_offset == conn->write_msg->msg.w.len) {
-      /* everything was written */
+    if ((conn->write_offset == conn->write_msg->msg.w.len) || dontblock) {
+      /* everything was written, or all that fitted for NETCONN_DONTBLOCK:
+         tell netconn_write_partly() how much */
+      conn->write_msg->msg.w.len = conn->write_offset;
       write_finished = 1;
       conn->write_msg = NULL;
       conn->write_offset = 0;
@@ -1013,11 +1048,16 @@ do_writemore(struct netconn *conn)
       conn->state = NETCONN_NONE;
     }
     err = tcp_output_nagle(conn->pcb.tcp);
+    if (err == ERR_MEM) {
+      /* enqueued all the same, the timers send it: not an error of the
+         connection, which would stay in conn->err */
+      err = ERR_OK;
+    }
     conn->err = err;
     if ((err == ERR_OK) && (tcp_sndbuf(conn->pcb.tcp) <= TCP_SNDLOWAT)) {
       API_EVENT(conn, NETCONN_EVT_SENDMINUS, len);
     }
-  } else if (err == ERR_MEM) {
+  } else if ((err == ERR_MEM) && !dontblock) {
     /* If ERR_MEM, we wait for sent_tcp or poll_tcp to be called
        we do NOT return to the application thread, since ERR_MEM is
        only a temporary error! */
@@ -1029,9 +1069,22 @@ do_writemore(struct netconn *conn)
     conn->write_delayed = 1;
 #endif
   } else {
-    /* On errors != ERR_MEM, we don't try writing any more but return
-       the error to the application thread. */
-    conn->err = err;
+    /* On errors != ERR_MEM (or ERR_MEM with NETCONN_DONTBLOCK), we don't try
+       writing any more but return the error to the application thread,
+       with the length enqueued by the previous calls. */
+    if ((err == ERR_MEM) && dontblock) {
+      /* Not writable until sent_tcp or poll_tcp finds room again. Only the
+         write failed: not kept in conn->err, where ERR_MEM would hide a
+         later close from netconn_recv(). */
+      conn->write_blocked = 1;
+      API_EVENT(conn, NETCONN_EVT_SENDMINUS, 0);
+      conn->write_msg->msg.w.err = err;
+    } else {
+      conn->err = err;
+    }
+    conn->write_msg->msg.w.len = conn->write_offset;
+    conn->write_msg = NULL;
+    conn->write_offset = 0;
     write_finished = 1;
   }
 
@@ -1093,6 +1146,8 @@ do_write(struct api_msg_msg *msg)
 #endif /* (LWIP_UDP || LWIP_RAW) */
     }
   }
+  /* nothing enqueued */
+  msg->msg.w.len = 0;
   TCPIP_APIMSG_ACK(msg);
 }
 
@@ -1166,6 +1221,65 @@ do_close(struct api_msg_msg *msg)
   }
 }
 
+/**
+ * Enable or disable the Nagle algorithm on the TCP pcb contained in a netconn.
+ * Called from netconn_set_nodelay.
+ *
+ * @param msg the api_msg_msg pointing to the connection
+ */
+void
+do_nodelay(struct api_msg_msg *msg)
+{
+#if LWIP_TCP
+  if (!ERR_IS_FATAL(msg->conn->err)) {
+    if ((msg->conn->pcb.tcp != NULL) && (msg->conn->type == NETCONN_TCP)) {
+      if (msg->msg.nd.nodelay) {
+        tcp_nagle_disable(msg->conn->pcb.tcp);
+        /* don't leave data held back by Nagle waiting for the next write */
+        if ((msg->conn->pcb.tcp->state != LISTEN) && (msg->conn->pcb.tcp->unsent != NULL)) {
+          tcp_output(msg->conn->pcb.tcp);
+        }
+      } else {
+        tcp_nagle_enable(msg->conn->pcb.tcp);
+      }
+    } else {
+      msg->conn->err = ERR_VAL;
+    }
+  }
+#endif /* LWIP_TCP */
+  TCPIP_APIMSG_ACK(msg);
+}
+
+/**
+ * Enable or disable the keepalive probes of a TCP netconn.
+ * Called from netconn_set_keepalive()
+ *
+ * @param msg the api_msg_msg pointing to the connection
+ */
+void
+do_keepalive(struct api_msg_msg *msg)
+{
+#if LWIP_TCP
+  if (!ERR_IS_FATAL(msg->conn->err)) {
+    if ((msg->conn->pcb.tcp != NULL) && (msg->conn->type == NETCONN_TCP)) {
+      if (msg->msg.ka.idle != 0) {
+        msg->conn->pcb.tcp->so_options |= SOF_KEEPALIVE;
+        msg->conn->pcb.tcp->keep_idle = msg->msg.ka.idle;
+#if LWIP_TCP_KEEPALIVE
+        msg->conn->pcb.tcp->keep_intvl = msg->msg.ka.intvl;
+        msg->conn->pcb.tcp->keep_cnt = msg->msg.ka.cnt;
+#endif /* LWIP_TCP_KEEPALIVE */
+      } else {
+        msg->conn->pcb.tcp->so_options &= ~SOF_KEEPALIVE;
+      }
+    } else {
+      msg->conn->err = ERR_VAL;
+    }
+  }
+#endif /* LWIP_TCP */
+  TCPIP_APIMSG_ACK(msg);
+}
+
 #if LWIP_IGMP
 /**
  * Join multicast groups for UDP netconns.
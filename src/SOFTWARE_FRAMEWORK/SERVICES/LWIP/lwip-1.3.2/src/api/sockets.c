@@ -76,6 +76,10 @@ struct lwip_socket {
   u16_t flags;
   /** last error that occurred on this socket */
   int err;
+#if LWIP_SOCKET_CHANNELS
+  /** 1 for a channel socket (no netconn, events set by lwip_channel_event()) */
+  u8_t channel;
+#endif /* LWIP_SOCKET_CHANNELS */
 };
 
 /** Description for a task waiting in select */
@@ -164,10 +168,17 @@ static const int err_to_errno_table[] = {
   set_errno(sk->err); \
 } while (0)
 
+#if LWIP_SOCKET_CHANNELS
+#define sock_is_free(sk) (!(sk)->conn && !(sk)->channel)
+#else /* LWIP_SOCKET_CHANNELS */
+#define sock_is_free(sk) (!(sk)->conn)
+#endif /* LWIP_SOCKET_CHANNELS */
+
 /* Forward delcaration of some functions */
 static void event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len);
 static void lwip_getsockopt_internal(void *arg);
 static void lwip_setsockopt_internal(void *arg);
+static void select_wakeup(int s, struct lwip_socket *sock);
 
 /**
  * Initialize this module. This function has to be called before any other
@@ -208,6 +219,26 @@ get_socket(int s)
   return sock;
 }
 
+#if LWIP_SOCKET_CHANNELS
+/**
+ * Map a externally used socket index to the internal socket representation,
+ * channel sockets included: for the functions that only use the events.
+ *
+ * @param s externally used socket index
+ * @return struct lwip_socket for the socket or NULL if not found
+ */
+static struct lwip_socket *
+get_selectable(int s)
+{
+  if ((s >= 0) && (s < NUM_SOCKETS) && sockets[s].channel) {
+    return &sockets[s];
+  }
+  return get_socket(s);
+}
+#else /* LWIP_SOCKET_CHANNELS */
+#define get_selectable(s) get_socket(s)
+#endif /* LWIP_SOCKET_CHANNELS */
+
 /**
  * Allocate a new socket for a given netconn.
  *
@@ -224,7 +255,7 @@ alloc_socket(struct netconn *newconn)
 
   /* allocate a new socket identifier */
   for (i = 0; i < NUM_SOCKETS; ++i) {
-    if (!sockets[i].conn) {
+    if (sock_is_free(&sockets[i])) {
       sockets[i].conn       = newconn;
       sockets[i].lastdata   = NULL;
       sockets[i].lastoffset = 0;
@@ -372,6 +403,17 @@ lwip_close(int s)
 
   LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_close(%d)\n", s));
 
+#if LWIP_SOCKET_CHANNELS
+  sock = get_selectable(s);
+  if (sock && sock->channel) {
+    sys_sem_wait(socksem);
+    sock->channel = 0;
+    sock_set_errno(sock, 0);
+    sys_sem_signal(socksem);
+    return 0;
+  }
+#endif /* LWIP_SOCKET_CHANNELS */
+
   sock = get_socket(s);
   if (!sock) {
     return -1;
@@ -617,8 +659,10 @@ lwip_recvfrom(int s, void *mem, size_t len, int flags,
       } else {
         sock->lastdata = NULL;
         sock->lastoffset = 0;
-        LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_recvfrom: deleting netbuf=%p\n", (void*)buf));
-        netbuf_delete(buf);
+        LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_recvfrom: recycling netbuf=%p\n", (void*)buf));
+        /* Kept on a TCP netconn for its next netconn_recv(): a socket read
+           in a loop (ZWaveSelect.c) takes nothing from MEMP_NETBUF. */
+        netconn_recycle_netbuf(sock->conn, buf);
       }
     }
   } while (!done);
@@ -661,6 +705,28 @@ lwip_send(int s, const void *data, size_t size, int flags)
 #endif /* (LWIP_UDP || LWIP_RAW) */
   }
 
+  if ((flags & MSG_DONTWAIT) || (sock->flags & O_NONBLOCK)) {
+    /* Only what fits in the send buffer, EWOULDBLOCK if nothing does */
+    err = netconn_write_partly(sock->conn, data, size,
+      NETCONN_COPY | NETCONN_DONTBLOCK | ((flags & MSG_MORE)?NETCONN_MORE:0), &size);
+    LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_send(%d) err=%d size=%"SZT_F" (nonblocking)\n", s, err, size));
+    if (err == ERR_MEM) {
+      /* Nothing enqueued: do_writemore() sent NETCONN_EVT_SENDMINUS, so
+         sendevent is clear and select() waits for the NETCONN_EVT_SENDPLUS
+         of sent_tcp() or poll_tcp() instead of reporting the socket
+         writable again at once. */
+      sock_set_errno(sock, EWOULDBLOCK);
+      return -1;
+    }
+    if (size > 0) {
+      /* Enqueued, even if tcp_output() failed: not to be sent again. */
+      sock_set_errno(sock, 0);
+      return (int)size;
+    }
+    sock_set_errno(sock, err_to_errno(err));
+    return (err == ERR_OK ? (int)size : -1);
+  }
+
   err = netconn_write(sock->conn, data, size, NETCONN_COPY | ((flags & MSG_MORE)?NETCONN_MORE:0));
 
   LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_send(%d) err=%d size=%"SZT_F"\n", s, err, size));
@@ -857,7 +923,7 @@ lwip_selscan(int maxfdp1, fd_set *readset, fd_set *writeset, fd_set *exceptset)
   for(i = 0; i < maxfdp1; i++) {
     if (FD_ISSET(i, readset)) {
       /* See if netconn of this socket is ready for read */
-      p_sock = get_socket(i);
+      p_sock = get_selectable(i);
       if (p_sock && (p_sock->lastdata || (p_sock->rcvevent > 0))) {
         FD_SET(i, &lreadset);
         LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_selscan: fd=%d ready for reading\n", i));
@@ -866,7 +932,7 @@ lwip_selscan(int maxfdp1, fd_set *readset, fd_set *writeset, fd_set *exceptset)
     }
     if (FD_ISSET(i, writeset)) {
       /* See if netconn of this socket is ready for write */
-      p_sock = get_socket(i);
+      p_sock = get_selectable(i);
       if (p_sock && p_sock->sendevent) {
         FD_SET(i, &lwriteset);
         LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_selscan: fd=%d ready for writing\n", i));
@@ -1040,7 +1106,6 @@ event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len)
 {
   int s;
   struct lwip_socket *sock;
-  struct lwip_select_cb *scb;
 
   LWIP_UNUSED_ARG(len);
 
@@ -1094,6 +1159,20 @@ event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len)
   }
   sys_sem_signal(selectsem);
 
+  select_wakeup(s, sock);
+}
+
+/**
+ * Wake up the tasks waiting in select for an event of this socket.
+ *
+ * @param s socket index
+ * @param sock socket whose events were just updated
+ */
+static void
+select_wakeup(int s, struct lwip_socket *sock)
+{
+  struct lwip_select_cb *scb;
+
   /* Now decide if anyone is waiting for this socket */
   /* NOTE: This code is written this way to protect the select link list
      but to avoid a deadlock situation by releasing socksem before
@@ -1125,6 +1204,78 @@ event_callback(struct netconn *conn, enum netconn_evt evt, u16_t len)
   }
 }
 
+#if LWIP_SOCKET_CHANNELS
+/**
+ * Allocate a channel socket: a socket without netconn standing for a data
+ * path of the application (a serial port, a queue...), so that one select
+ * call waits for it together with the network sockets. Its events are set
+ * by lwip_channel_event(), the data is moved by the application itself:
+ * select and close are the only socket functions it supports.
+ *
+ * @return the index of the new socket; -1 on error
+ */
+int
+lwip_channel(void)
+{
+  int i;
+
+  sys_sem_wait(socksem);
+  for (i = 0; i < NUM_SOCKETS; ++i) {
+    if (sock_is_free(&sockets[i])) {
+      sockets[i].channel    = 1;
+      sockets[i].lastdata   = NULL;
+      sockets[i].lastoffset = 0;
+      sockets[i].rcvevent   = 0;
+      sockets[i].sendevent  = 0;
+      sockets[i].flags      = 0;
+      sockets[i].err        = 0;
+      sys_sem_signal(socksem);
+      LWIP_DEBUGF(SOCKETS_DEBUG, ("lwip_channel() = %d\n", i));
+      return i;
+    }
+  }
+  sys_sem_signal(socksem);
+  set_errno(ENFILE);
+  return -1;
+}
+
+/**
+ * Set the events of a channel socket and wake up the tasks waiting in select
+ * for them. The events are levels, not counts: to lose none, the reader
+ * clears the read event before it empties the channel and the writer sets it
+ * after it filled the channel (same for the write event).
+ * Not to be called from an interrupt.
+ *
+ * @param s channel socket index
+ * @param readable 1: ready for read, 0: not ready, -1: unchanged
+ * @param writable 1: ready for write, 0: not ready, -1: unchanged
+ * @return 0 on success, -1 if s is not a channel socket
+ */
+int
+lwip_channel_event(int s, int readable, int writable)
+{
+  struct lwip_socket *sock;
+
+  sock = get_selectable(s);
+  if (!sock || !sock->channel) {
+    set_errno(EBADF);
+    return -1;
+  }
+
+  sys_sem_wait(selectsem);
+  if (readable >= 0) {
+    sock->rcvevent = (readable ? 1 : 0);
+  }
+  if (writable >= 0) {
+    sock->sendevent = (writable ? 1 : 0);
+  }
+  sys_sem_signal(selectsem);
+
+  select_wakeup(s, sock);
+  return 0;
+}
+#endif /* LWIP_SOCKET_CHANNELS */
+
 /**
  * Unimplemented: Close one end of a full-duplex connection.
  * Currently, the full connection is closed.
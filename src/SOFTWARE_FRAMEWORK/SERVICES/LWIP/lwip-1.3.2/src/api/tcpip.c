@@ -92,6 +92,44 @@ tcpip_tcp_timer(void *arg)
   }
 }
 
+#if LWIP_TCP_HIRES_RTO
+/* global variable that shows if the tcp retransmission timer is currently
+   scheduled or not */
+static int tcpip_tcp_rto_timer_active;
+
+/**
+ * Timer callback function that calls tcp_rtotmr() and reschedules itself
+ * while some data is waiting to be acknowledged.
+ *
+ * @param arg unused argument
+ */
+static void
+tcpip_tcp_rto_timer(void *arg)
+{
+  LWIP_UNUSED_ARG(arg);
+
+  if (tcp_rtotmr()) {
+    sys_timeout(TCP_RTO_TMR_INTERVAL, tcpip_tcp_rto_timer, NULL);
+  } else {
+    /* nothing in flight: don't wake the tcpip thread up for nothing */
+    tcpip_tcp_rto_timer_active = 0;
+  }
+}
+
+/**
+ * Called from tcp_output_segment() when data is sent: starts the
+ * retransmission timer if it is not running.
+ */
+void
+tcp_rto_timer_needed(void)
+{
+  if (!tcpip_tcp_rto_timer_active) {
+    tcpip_tcp_rto_timer_active = 1;
+    sys_timeout(TCP_RTO_TMR_INTERVAL, tcpip_tcp_rto_timer, NULL);
+  }
+}
+#endif /* LWIP_TCP_HIRES_RTO */
+
 #if !NO_SYS
 /**
  * Called from TCP_REG when registering a new PCB:
@@ -95,6 +95,7 @@ again:
   }
   if (poolnr > MEMP_POOL_LAST) {
     LWIP_ASSERT("mem_malloc(): no pool is that big!", 0);
+    MEM_STATS_INC(err);
     return NULL;
   }
   element = (struct memp_malloc_helper*)memp_malloc(poolnr);
@@ -108,6 +109,9 @@ again:
       goto again;
     }
 #endif /* MEM_USE_POOLS_TRY_BIGGER_POOL */
+    /* the per pool failures are counted by memp.c, count the mem_malloc()
+       failures as the heap errors */
+    MEM_STATS_INC(err);
     return NULL;
   }
 
@@ -113,6 +113,22 @@ struct memp {
  *  Elements form a linked list. */
 static struct memp *memp_tab[MEMP_MAX];
 
+#if PBUF_POOL_ALIGNMENT
+#if PBUF_POOL_ALIGNMENT & (PBUF_POOL_ALIGNMENT - 1)
+#error PBUF_POOL_ALIGNMENT must be a power of 2
+#endif
+/* The pbuf pool has its own array: PBUF_POOL_LEAD bytes of padding put the
+ * payload following the memp and pbuf headers on a PBUF_POOL_ALIGNMENT
+ * boundary, and the elements are PBUF_POOL_STRIDE bytes apart. */
+#define PBUF_POOL_ALIGN_UP(x)   (((x) + PBUF_POOL_ALIGNMENT - 1) & ~(PBUF_POOL_ALIGNMENT - 1))
+#define PBUF_POOL_HDR           (MEMP_SIZE + LWIP_MEM_ALIGN_SIZE(sizeof(struct pbuf)))
+#define PBUF_POOL_LEAD          (PBUF_POOL_ALIGN_UP(PBUF_POOL_HDR) - PBUF_POOL_HDR)
+#define PBUF_POOL_STRIDE        (PBUF_POOL_ALIGN_UP(PBUF_POOL_HDR) + PBUF_POOL_ALIGN_UP(PBUF_POOL_BUFSIZE))
+#define MEMP_IN_MEMP_MEMORY(type) ((type) != MEMP_PBUF_POOL)
+#else /* PBUF_POOL_ALIGNMENT */
+#define MEMP_IN_MEMP_MEMORY(type) 1
+#endif /* PBUF_POOL_ALIGNMENT */
+
 #else /* MEMP_MEM_MALLOC */
 
 #define MEMP_ALIGN_SIZE(x) (LWIP_MEM_ALIGN_SIZE(x))
@@ -146,10 +162,15 @@ static const char *memp_desc[MEMP_MAX] = {
 
 /** This is the actual memory used by the pools. */
 static u8_t memp_memory[MEM_ALIGNMENT - 1 
-#define LWIP_MEMPOOL(name,num,size,desc) + ( (num) * (MEMP_SIZE + MEMP_ALIGN_SIZE(size) ) )
+#define LWIP_MEMPOOL(name,num,size,desc) + ( MEMP_IN_MEMP_MEMORY(MEMP_##name) ? (num) * (MEMP_SIZE + MEMP_ALIGN_SIZE(size) ) : 0 )
 #include "lwip/memp_std.h"
 ];
 
+#if PBUF_POOL_ALIGNMENT
+/** This is the memory used by the pbuf pool. */
+static u8_t memp_pbuf_pool_memory[PBUF_POOL_ALIGNMENT - 1 + PBUF_POOL_SIZE * PBUF_POOL_STRIDE] PBUF_POOL_MEMORY_ATTRIBUTE;
+#endif /* PBUF_POOL_ALIGNMENT */
+
 #if MEMP_SANITY_CHECK
 /**
  * Check that memp-lists don't form a circle
@@ -217,7 +238,9 @@ memp_overflow_check_all(void)
 
   p = LWIP_MEM_ALIGN(memp_memory);
   for (i = 0; i < MEMP_MAX; ++i) {
-    p = p;
+    if (!MEMP_IN_MEMP_MEMORY(i)) {
+      continue;
+    }
     for (j = 0; j < memp_num[i]; ++j) {
       memp_overflow_check_element(p, memp_sizes[i]);
       p = (struct memp*)((u8_t*)p + MEMP_SIZE + memp_sizes[i] + MEMP_SANITY_REGION_AFTER_ALIGNED);
@@ -237,7 +260,9 @@ memp_overflow_init(void)
 
   p = LWIP_MEM_ALIGN(memp_memory);
   for (i = 0; i < MEMP_MAX; ++i) {
-    p = p;
+    if (!MEMP_IN_MEMP_MEMORY(i)) {
+      continue;
+    }
     for (j = 0; j < memp_num[i]; ++j) {
 #if MEMP_SANITY_REGION_BEFORE_ALIGNED > 0
       m = (u8_t*)p + MEMP_SIZE - MEMP_SANITY_REGION_BEFORE_ALIGNED;
@@ -275,6 +300,18 @@ memp_init(void)
   /* for every pool: */
   for (i = 0; i < MEMP_MAX; ++i) {
     memp_tab[i] = NULL;
+#if PBUF_POOL_ALIGNMENT
+    if (i == MEMP_PBUF_POOL) {
+      u8_t *m = (u8_t *)(((mem_ptr_t)memp_pbuf_pool_memory + PBUF_POOL_ALIGNMENT - 1) &
+                         ~(mem_ptr_t)(PBUF_POOL_ALIGNMENT - 1)) + PBUF_POOL_LEAD;
+      for (j = 0; j < memp_num[i]; ++j) {
+        ((struct memp *)m)->next = memp_tab[i];
+        memp_tab[i] = (struct memp *)m;
+        m += PBUF_POOL_STRIDE;
+      }
+      continue;
+    }
+#endif /* PBUF_POOL_ALIGNMENT */
     /* create a linked list of memp elements */
     for (j = 0; j < memp_num[i]; ++j) {
       memp->next = memp_tab[i];
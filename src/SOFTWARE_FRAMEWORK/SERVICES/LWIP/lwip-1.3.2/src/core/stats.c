@@ -86,6 +86,22 @@ stats_display_igmp(struct stats_igmp *igmp)
 }
 #endif /* IGMP_STATS */
 
+#if TCP_STATS
+void
+stats_display_tcp_conn(struct stats_tcp_conn *conn)
+{
+  LWIP_PLATFORM_DIAG(("\nTCP connections\n\t"));
+  LWIP_PLATFORM_DIAG(("syn_rcvd: %"STAT_COUNTER_F"\n\t", conn->syn_rcvd)); 
+  LWIP_PLATFORM_DIAG(("refused_nolisten: %"STAT_COUNTER_F"\n\t", conn->refused_nolisten)); 
+  LWIP_PLATFORM_DIAG(("refused_backlog: %"STAT_COUNTER_F"\n\t", conn->refused_backlog)); 
+  LWIP_PLATFORM_DIAG(("refused_mem: %"STAT_COUNTER_F"\n\t", conn->refused_mem)); 
+  LWIP_PLATFORM_DIAG(("tw_recycled: %"STAT_COUNTER_F"\n\t", conn->tw_recycled)); 
+  LWIP_PLATFORM_DIAG(("reaped: %"STAT_COUNTER_F"\n\t", conn->reaped)); 
+  LWIP_PLATFORM_DIAG(("recycled: %"STAT_COUNTER_F"\n\t", conn->recycled)); 
+  LWIP_PLATFORM_DIAG(("killed: %"STAT_COUNTER_F"\n", conn->killed));
+}
+#endif /* TCP_STATS */
+
 #if MEM_STATS || MEMP_STATS
 void
 stats_display_mem(struct stats_mem *mem, char *name)
@@ -139,6 +155,7 @@ stats_display(void)
   ICMP_STATS_DISPLAY();
   UDP_STATS_DISPLAY();
   TCP_STATS_DISPLAY();
+  TCP_CONN_STATS_DISPLAY();
   MEM_STATS_DISPLAY();
   for (i = 0; i < MEMP_MAX; i++) {
     MEMP_STATS_DISPLAY(i);
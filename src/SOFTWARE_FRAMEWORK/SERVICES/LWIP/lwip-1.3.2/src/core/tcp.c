@@ -93,6 +93,7 @@ struct tcp_pcb *tcp_tmp_pcb;
 
 static u8_t tcp_timer;
 static u16_t tcp_new_port(void);
+static void tcp_rexmit_timer(struct tcp_pcb *pcb);
 
 /**
  * Called periodically to dispatch TCP timers.
@@ -568,6 +569,83 @@ tcp_connect(struct tcp_pcb *pcb, struct ip_addr *ipaddr, u16_t port,
   return ret;
 } 
 
+/**
+ * Advances the retransmission timer of a pcb by one tick and retransmits if
+ * it expired.
+ *
+ * Called from tcp_slowtmr(), or from tcp_rtotmr() if LWIP_TCP_HIRES_RTO==1.
+ *
+ * @param pcb the tcp_pcb to process (not in persist mode)
+ */
+static void
+tcp_rexmit_timer(struct tcp_pcb *pcb)
+{
+  u16_t eff_wnd;
+
+  /* Increase the retransmission timer if it is running */
+  if(pcb->rtime >= 0)
+    ++pcb->rtime;
+
+  if (pcb->unacked != NULL && pcb->rtime >= pcb->rto) {
+    /* Time for a retransmission. */
+    LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_rexmit_timer: rtime %"S16_F
+                                " pcb->rto %"S16_F"\n",
+                                pcb->rtime, pcb->rto));
+
+    /* Double retransmission time-out unless we are trying to
+     * connect to somebody (i.e., we are in SYN_SENT). */
+    if (pcb->state != SYN_SENT) {
+      pcb->rto = TCP_RTO_BOUND((s32_t)((pcb->sa >> 3) + pcb->sv) << tcp_backoff[pcb->nrtx]);
+    }
+
+    /* Reset the retransmission timer. */
+    pcb->rtime = 0;
+
+    /* Reduce congestion window and ssthresh. */
+    eff_wnd = LWIP_MIN(pcb->cwnd, pcb->snd_wnd);
+    pcb->ssthresh = eff_wnd >> 1;
+    if (pcb->ssthresh < pcb->mss) {
+      pcb->ssthresh = pcb->mss * 2;
+    }
+    pcb->cwnd = pcb->mss;
+    LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_rexmit_timer: cwnd %"U16_F
+                                 " ssthresh %"U16_F"\n",
+                                 pcb->cwnd, pcb->ssthresh));
+
+    /* The following needs to be called AFTER cwnd is set to one
+       mss - STJ */
+    tcp_rexmit_rto(pcb);
+  }
+}
+
+#if LWIP_TCP_HIRES_RTO
+/**
+ * Called every TCP_RTO_TMR_INTERVAL ms and implements the retransmission
+ * timer of the active PCBs. The PCBs that reached the maximum number of
+ * retransmissions are left to tcp_slowtmr().
+ *
+ * @return 1 if a PCB has unacknowledged data, i.e. the timer is still needed
+ */
+u8_t
+tcp_rtotmr(void)
+{
+  struct tcp_pcb *pcb;
+  u8_t running = 0;
+
+  for (pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+    if ((pcb->state == SYN_SENT && pcb->nrtx == TCP_SYNMAXRTX) ||
+        (pcb->nrtx == TCP_MAXRTX) || (pcb->persist_backoff > 0)) {
+      continue;
+    }
+    tcp_rexmit_timer(pcb);
+    if (pcb->unacked != NULL) {
+      running = 1;
+    }
+  }
+  return running;
+}
+#endif /* LWIP_TCP_HIRES_RTO */
+
 /**
  * Called every 500 ms and implements the retransmission timer and the timer that
  * removes PCBs that have been in TIME-WAIT for enough time. It also increments
@@ -579,7 +657,6 @@ void
 tcp_slowtmr(void)
 {
   struct tcp_pcb *pcb, *pcb2, *prev;
-  u16_t eff_wnd;
   u8_t pcb_remove;      /* flag if a PCB should be removed */
   u8_t pcb_reset;       /* flag if a RST should be sent when removing */
   err_t err;
@@ -623,40 +700,9 @@ tcp_slowtmr(void)
           tcp_zero_window_probe(pcb);
         }
       } else {
-        /* Increase the retransmission timer if it is running */
-        if(pcb->rtime >= 0)
-          ++pcb->rtime;
-
-        if (pcb->unacked != NULL && pcb->rtime >= pcb->rto) {
-          /* Time for a retransmission. */
-          LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_slowtmr: rtime %"S16_F
-                                      " pcb->rto %"S16_F"\n",
-                                      pcb->rtime, pcb->rto));
-
-          /* Double retransmission time-out unless we are trying to
-           * connect to somebody (i.e., we are in SYN_SENT). */
-          if (pcb->state != SYN_SENT) {
-            pcb->rto = ((pcb->sa >> 3) + pcb->sv) << tcp_backoff[pcb->nrtx];
-          }
-
-          /* Reset the retransmission timer. */
-          pcb->rtime = 0;
-
-          /* Reduce congestion window and ssthresh. */
-          eff_wnd = LWIP_MIN(pcb->cwnd, pcb->snd_wnd);
-          pcb->ssthresh = eff_wnd >> 1;
-          if (pcb->ssthresh < pcb->mss) {
-            pcb->ssthresh = pcb->mss * 2;
-          }
-          pcb->cwnd = pcb->mss;
-          LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_slowtmr: cwnd %"U16_F
-                                       " ssthresh %"U16_F"\n",
-                                       pcb->cwnd, pcb->ssthresh));
- 
-          /* The following needs to be called AFTER cwnd is set to one
-             mss - STJ */
-          tcp_rexmit_rto(pcb);
-        }
+#if !LWIP_TCP_HIRES_RTO
+        tcp_rexmit_timer(pcb);
+#endif /* !LWIP_TCP_HIRES_RTO: else run by tcp_rtotmr() */
       }
     }
     /* Check if this PCB has stayed too long in FIN-WAIT-2 */
@@ -705,10 +751,11 @@ tcp_slowtmr(void)
 
     /* If this PCB has queued out of sequence data, but has been
        inactive for too long, will drop the data (it will eventually
-       be retransmitted). */
+       be retransmitted). pcb->tmr was taken up to a tick ago: only
+       whole ticks are counted. */
 #if TCP_QUEUE_OOSEQ    
     if (pcb->ooseq != NULL &&
-        (u32_t)tcp_ticks - pcb->tmr >= pcb->rto * TCP_OOSEQ_TIMEOUT) {
+        (u32_t)tcp_ticks - pcb->tmr > TCP_OOSEQ_TICKS(pcb->rto)) {
       tcp_segs_free(pcb->ooseq);
       pcb->ooseq = NULL;
       LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_slowtmr: dropping OOSEQ queued data\n"));
@@ -967,10 +1014,49 @@ tcp_kill_prio(u8_t prio)
   if (inactive != NULL) {
     LWIP_DEBUGF(TCP_DEBUG, ("tcp_kill_prio: killing oldest PCB %p (%"S32_F")\n",
            (void *)inactive, inactivity));
+    TCP_CONN_STATS_INC(killed);
     tcp_abort(inactive);
   }      
 }
 
+#if TCP_PCB_RECYCLE
+/**
+ * Kills the oldest active connection that is in the given state.
+ * Called from tcp_alloc() if no more connections are available, for the
+ * states in which the application has not, or no more, any use of the pcb.
+ *
+ * @param state SYN_RCVD, LAST_ACK or CLOSING
+ * @return 1 if a pcb was killed, 0 if none is in that state
+ */
+static u8_t
+tcp_kill_state(enum tcp_state state)
+{
+  struct tcp_pcb *pcb, *inactive;
+  u32_t inactivity;
+
+  LWIP_ASSERT("invalid state", (state == SYN_RCVD) || (state == LAST_ACK) || (state == CLOSING));
+
+  inactivity = 0;
+  inactive = NULL;
+  /* Go through the list of active pcbs and get the oldest pcb in 'state'. */
+  for(pcb = tcp_active_pcbs; pcb != NULL; pcb = pcb->next) {
+    if (pcb->state == state &&
+       (u32_t)(tcp_ticks - pcb->tmr) >= inactivity) {
+      inactivity = tcp_ticks - pcb->tmr;
+      inactive = pcb;
+    }
+  }
+  if (inactive != NULL) {
+    LWIP_DEBUGF(TCP_DEBUG, ("tcp_kill_state: killing oldest %s PCB %p (%"S32_F")\n",
+           tcp_state_str[state], (void *)inactive, inactivity));
+    TCP_CONN_STATS_INC(reaped);
+    tcp_abort(inactive);
+    return 1;
+  }
+  return 0;
+}
+#endif /* TCP_PCB_RECYCLE */
+
 /**
  * Kills the oldest connection that is in TIME_WAIT state.
  * Called from tcp_alloc() if no more connections are available.
@@ -993,6 +1079,7 @@ tcp_kill_timewait(void)
   if (inactive != NULL) {
     LWIP_DEBUGF(TCP_DEBUG, ("tcp_kill_timewait: killing oldest TIME-WAIT PCB %p (%"S32_F")\n",
            (void *)inactive, inactivity));
+    TCP_CONN_STATS_INC(tw_recycled);
     tcp_abort(inactive);
   }      
 }
@@ -1016,6 +1103,21 @@ tcp_alloc(u8_t prio)
     tcp_kill_timewait();
     /* Try to allocate a tcp_pcb again. */
     pcb = memp_malloc(MEMP_TCP_PCB);
+#if TCP_PCB_RECYCLE
+    if (pcb == NULL) {
+      /* Try killing the oldest half-open connection, then the oldest ones
+         waiting for the last ACK of their close. */
+      LWIP_DEBUGF(TCP_DEBUG, ("tcp_alloc: killing off oldest half-open or closing connection\n"));
+      if (tcp_kill_state(SYN_RCVD) || tcp_kill_state(LAST_ACK) || tcp_kill_state(CLOSING)) {
+        /* Only retried once a pcb was freed: the memp err stats count the
+           pool found full, not the attempts made here. */
+        pcb = memp_malloc(MEMP_TCP_PCB);
+        if (pcb != NULL) {
+          TCP_CONN_STATS_INC(recycled);
+        }
+      }
+    }
+#endif /* TCP_PCB_RECYCLE */
     if (pcb == NULL) {
       /* Try killing active connections with lower priority than the new one. */
       LWIP_DEBUGF(TCP_DEBUG, ("tcp_alloc: killing connection with prio lower than %d\n", prio));
@@ -1044,9 +1146,9 @@ tcp_alloc(u8_t prio)
     /* As initial send MSS, we use TCP_MSS but limit it to 536.
        The send MSS is updated when an MSS option is received. */
     pcb->mss = (TCP_MSS > 536) ? 536 : TCP_MSS;
-    pcb->rto = 3000 / TCP_SLOW_INTERVAL;
+    pcb->rto = TCP_RTO_TICKS(TCP_INITIAL_RTO);
     pcb->sa = 0;
-    pcb->sv = 3000 / TCP_SLOW_INTERVAL;
+    pcb->sv = TCP_RTO_TICKS(TCP_INITIAL_RTO);
     pcb->rtime = -1;
     pcb->cwnd = 1;
     iss = tcp_next_iss();
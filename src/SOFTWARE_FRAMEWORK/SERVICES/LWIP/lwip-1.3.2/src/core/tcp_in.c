@@ -78,6 +78,9 @@ struct tcp_pcb *tcp_input_pcb;
 static err_t tcp_process(struct tcp_pcb *pcb);
 static void tcp_receive(struct tcp_pcb *pcb);
 static void tcp_parseopt(struct tcp_pcb *pcb);
+#if TCP_HEADER_PREDICTION
+static u8_t tcp_fastpath(struct tcp_pcb *pcb);
+#endif /* TCP_HEADER_PREDICTION */
 
 static err_t tcp_listen_input(struct tcp_pcb_listen *pcb);
 static err_t tcp_timewait_input(struct tcp_pcb *pcb);
@@ -212,6 +215,20 @@ tcp_input(struct pbuf *p, struct netif *inp)
          pcb->local_port == tcphdr->dest &&
          ip_addr_cmp(&(pcb->remote_ip), &(iphdr->src)) &&
          ip_addr_cmp(&(pcb->local_ip), &(iphdr->dest))) {
+#if TCP_PCB_RECYCLE
+        if ((flags & (TCP_SYN | TCP_ACK | TCP_RST)) == TCP_SYN &&
+            TCP_SEQ_GT(seqno, pcb->rcv_nxt)) {
+          /* The peer reopens the connection with a sequence number above
+             the old one (RFC 1122 4.2.2.13): free the TIME-WAIT pcb and
+             hand the SYN to the listener. */
+          LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_input: SYN reopens TIME_WAITing connection.\n"));
+          TCP_CONN_STATS_INC(tw_recycled);
+          tcp_pcb_remove(&tcp_tw_pcbs, pcb);
+          memp_free(MEMP_TCP_PCB, pcb);
+          pcb = NULL;
+          break;
+        }
+#endif /* TCP_PCB_RECYCLE */
         /* We don't really care enough to move this PCB to the front
            of the list since we are not very likely to receive that
            many segments for connections in TIME-WAIT. */
@@ -291,7 +308,14 @@ tcp_input(struct pbuf *p, struct netif *inp)
       }
     }
     tcp_input_pcb = pcb;
-    err = tcp_process(pcb);
+#if TCP_HEADER_PREDICTION
+    if (tcp_fastpath(pcb)) {
+      err = ERR_OK;
+    } else
+#endif /* TCP_HEADER_PREDICTION */
+    {
+      err = tcp_process(pcb);
+    }
     /* A return value of ERR_ABRT means that tcp_abort() was called
        and that the pcb has been freed. If so, we don't do anything. */
     if (err != ERR_ABRT) {
@@ -363,6 +387,9 @@ tcp_input(struct pbuf *p, struct netif *inp)
        sender. */
     LWIP_DEBUGF(TCP_RST_DEBUG, ("tcp_input: no PCB match found, resetting.\n"));
     if (!(TCPH_FLAGS(tcphdr) & TCP_RST)) {
+      if ((flags & (TCP_SYN | TCP_ACK)) == TCP_SYN) {
+        TCP_CONN_STATS_INC(refused_nolisten);
+      }
       TCP_STATS_INC(tcp.proterr);
       TCP_STATS_INC(tcp.drop);
       tcp_rst(ackno, seqno + tcplen,
@@ -405,9 +432,11 @@ tcp_listen_input(struct tcp_pcb_listen *pcb)
       tcphdr->dest, tcphdr->src);
   } else if (flags & TCP_SYN) {
     LWIP_DEBUGF(TCP_DEBUG, ("TCP connection request %"U16_F" -> %"U16_F".\n", tcphdr->src, tcphdr->dest));
+    TCP_CONN_STATS_INC(syn_rcvd);
 #if TCP_LISTEN_BACKLOG
     if (pcb->accepts_pending >= pcb->backlog) {
       LWIP_DEBUGF(TCP_DEBUG, ("tcp_listen_input: listen backlog exceeded for port %"U16_F"\n", tcphdr->dest));
+      TCP_CONN_STATS_INC(refused_backlog);
       return ERR_ABRT;
     }
 #endif /* TCP_LISTEN_BACKLOG */
@@ -418,6 +447,7 @@ tcp_listen_input(struct tcp_pcb_listen *pcb)
     if (npcb == NULL) {
       LWIP_DEBUGF(TCP_DEBUG, ("tcp_listen_input: could not allocate PCB\n"));
       TCP_STATS_INC(tcp.memerr);
+      TCP_CONN_STATS_INC(refused_mem);
       return ERR_MEM;
     }
 #if TCP_LISTEN_BACKLOG
@@ -777,6 +807,231 @@ tcp_oos_insert_segment(struct tcp_seg *cseg, struct tcp_seg *next)
 }
 #endif
 
+/**
+ * Called when the incoming segment acknowledges new data: resets the
+ * retransmission state, updates the congestion window and frees the
+ * acknowledged segments of the unacked list.
+ *
+ * Called from tcp_receive() and tcp_fastpath().
+ */
+static void
+tcp_ack_new_data(struct tcp_pcb *pcb)
+{
+  struct tcp_seg *next;
+
+  /* Reset the "IN Fast Retransmit" flag, since we are no longer
+     in fast retransmit. Also reset the congestion window to the
+     slow start threshold. */
+  if (pcb->flags & TF_INFR) {
+    pcb->flags &= ~TF_INFR;
+    pcb->cwnd = pcb->ssthresh;
+  }
+
+  /* Reset the number of retransmissions. */
+  pcb->nrtx = 0;
+
+  /* Reset the retransmission time-out. */
+  pcb->rto = TCP_RTO_BOUND((pcb->sa >> 3) + pcb->sv);
+
+  /* Update the send buffer space. Diff between the two can never exceed 64K? */
+  pcb->acked = (u16_t)(ackno - pcb->lastack);
+
+  pcb->snd_buf += pcb->acked;
+
+  /* Reset the fast retransmit variables. */
+  pcb->dupacks = 0;
+  pcb->lastack = ackno;
+
+  /* Update the congestion control variables (cwnd and
+     ssthresh). */
+  if (pcb->state >= ESTABLISHED) {
+    if (pcb->cwnd < pcb->ssthresh) {
+      if ((u16_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
+        pcb->cwnd += pcb->mss;
+      }
+      LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: slow start cwnd %"U16_F"\n", pcb->cwnd));
+    } else {
+      u16_t new_cwnd = (pcb->cwnd + pcb->mss * pcb->mss / pcb->cwnd);
+      if (new_cwnd > pcb->cwnd) {
+        pcb->cwnd = new_cwnd;
+      }
+      LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: congestion avoidance cwnd %"U16_F"\n", pcb->cwnd));
+    }
+  }
+  LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_receive: ACK for %"U32_F", unacked->seqno %"U32_F":%"U32_F"\n",
+                                ackno,
+                                pcb->unacked != NULL?
+                                ntohl(pcb->unacked->tcphdr->seqno): 0,
+                                pcb->unacked != NULL?
+                                ntohl(pcb->unacked->tcphdr->seqno) + TCP_TCPLEN(pcb->unacked): 0));
+
+  /* Remove segment from the unacknowledged list if the incoming
+     ACK acknowlegdes them. */
+  while (pcb->unacked != NULL &&
+         TCP_SEQ_LEQ(ntohl(pcb->unacked->tcphdr->seqno) +
+                     TCP_TCPLEN(pcb->unacked), ackno)) {
+    LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_receive: removing %"U32_F":%"U32_F" from pcb->unacked\n",
+                                  ntohl(pcb->unacked->tcphdr->seqno),
+                                  ntohl(pcb->unacked->tcphdr->seqno) +
+                                  TCP_TCPLEN(pcb->unacked)));
+
+    next = pcb->unacked;
+    pcb->unacked = pcb->unacked->next;
+
+    LWIP_DEBUGF(TCP_QLEN_DEBUG, ("tcp_receive: queuelen %"U16_F" ... ", (u16_t)pcb->snd_queuelen));
+    LWIP_ASSERT("pcb->snd_queuelen >= pbuf_clen(next->p)", (pcb->snd_queuelen >= pbuf_clen(next->p)));
+    /* Prevent ACK for FIN to generate a sent event */
+    if ((pcb->acked != 0) && ((TCPH_FLAGS(next->tcphdr) & TCP_FIN) != 0)) {
+      pcb->acked--;
+    }
+
+    pcb->snd_queuelen -= pbuf_clen(next->p);
+    tcp_seg_free(next);
+
+    LWIP_DEBUGF(TCP_QLEN_DEBUG, ("%"U16_F" (after freeing unacked)\n", (u16_t)pcb->snd_queuelen));
+    if (pcb->snd_queuelen != 0) {
+      LWIP_ASSERT("tcp_receive: valid queue length", pcb->unacked != NULL ||
+                  pcb->unsent != NULL);
+    }
+  }
+
+  /* If there's nothing left to acknowledge, stop the retransmit
+     timer, otherwise reset it to start again */
+  if(pcb->unacked == NULL)
+    pcb->rtime = -1;
+  else
+    pcb->rtime = 0;
+
+  pcb->polltmr = 0;
+}
+
+/**
+ * Updates the RTT estimation and the retransmission time-out if the incoming
+ * segment acknowledges the segment used for the measurement.
+ *
+ * Called from tcp_receive() and tcp_fastpath().
+ */
+static void
+tcp_rtt_estimate(struct tcp_pcb *pcb)
+{
+  s16_t m;
+
+  /* RTT estimation calculations. This is done by checking if the
+     incoming segment acknowledges the segment we use to take a
+     round-trip time measurement. */
+  if (pcb->rttest && TCP_SEQ_LT(pcb->rtseq, ackno)) {
+    /* diff between this shouldn't exceed 32K since this are tcp timer ticks
+       and a round-trip shouldn't be that long... */
+    m = TCP_RTT_TICKS(TCP_RTT_NOW() - pcb->rttest);
+
+    LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_receive: experienced rtt %"U16_F" ticks (%"U16_F" msec).\n",
+                                m, (u16_t)TCP_RTO_MS(m)));
+
+    /* This is taken directly from VJs original code in his paper */
+    m = m - (pcb->sa >> 3);
+    pcb->sa += m;
+    if (m < 0) {
+      m = -m;
+    }
+    m = m - (pcb->sv >> 2);
+    pcb->sv += m;
+    pcb->rto = TCP_RTO_BOUND((pcb->sa >> 3) + pcb->sv);
+
+    LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_receive: RTO %"U16_F" (%"U16_F" milliseconds)\n",
+                                pcb->rto, (u16_t)TCP_RTO_MS(pcb->rto)));
+
+    pcb->rttest = 0;
+  }
+}
+
+#if TCP_HEADER_PREDICTION
+/**
+ * Header prediction (Van Jacobson): handles the two common segments of an
+ * established connection without going through tcp_process() and
+ * tcp_receive():
+ * - a pure ACK for new data (the Z-Wave frames sent by the bridge);
+ * - the next in-sequence data, acknowledging nothing new (the frames sent to
+ *   the bridge).
+ * Both must carry no option, leave the window unchanged and arrive while
+ * there is no out-of-sequence data nor fast retransmit in progress. Anything
+ * else is left to tcp_process(), which applies exactly the same processing
+ * to these two segments.
+ *
+ * Called from tcp_input().
+ *
+ * @param pcb the tcp_pcb for which a segment arrived
+ * @return 1 if the segment has been processed, 0 if it must go through
+ *         tcp_process()
+ */
+static u8_t
+tcp_fastpath(struct tcp_pcb *pcb)
+{
+  if (pcb->state != ESTABLISHED ||
+      (flags & (TCP_FIN | TCP_SYN | TCP_RST | TCP_ACK | TCP_URG)) != TCP_ACK ||
+      TCPH_HDRLEN(tcphdr) != 5 ||
+      seqno != pcb->rcv_nxt ||
+      tcphdr->wnd != pcb->snd_wnd ||
+      (pcb->flags & TF_INFR)
+#if TCP_QUEUE_OOSEQ
+      || pcb->ooseq != NULL
+#endif /* TCP_QUEUE_OOSEQ */
+     ) {
+    return 0;
+  }
+
+  if (tcplen == 0) {
+    /* Pure ACK: it must acknowledge new data, all of it on the unacked
+       list (see the unsent list walk in tcp_receive()). */
+    if (!TCP_SEQ_BETWEEN(ackno, pcb->lastack + 1, pcb->snd_nxt) ||
+        (pcb->unsent != NULL &&
+         TCP_SEQ_GEQ(ackno, ntohl(pcb->unsent->tcphdr->seqno) + TCP_TCPLEN(pcb->unsent)))) {
+      return 0;
+    }
+  } else {
+    /* Data: it must acknowledge nothing new and fit in the window. */
+    if (ackno != pcb->lastack || tcplen > pcb->rcv_wnd) {
+      return 0;
+    }
+  }
+
+  LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_fastpath: seqno %"U32_F" ackno %"U32_F" len %"U16_F"\n",
+                                seqno, ackno, tcplen));
+
+  /* Same bookkeeping as tcp_process() and tcp_receive(). */
+  pcb->tmr = tcp_ticks;
+  pcb->keep_cnt_sent = 0;
+
+  if (TCP_SEQ_LT(pcb->snd_wl1, seqno) ||
+     (pcb->snd_wl1 == seqno && TCP_SEQ_LT(pcb->snd_wl2, ackno))) {
+    pcb->snd_wl1 = seqno;
+    pcb->snd_wl2 = ackno;
+    if (pcb->snd_wnd > 0 && pcb->persist_backoff > 0) {
+      pcb->persist_backoff = 0;
+    }
+  }
+
+  if (tcplen == 0) {
+    tcp_ack_new_data(pcb);
+    tcp_rtt_estimate(pcb);
+  } else {
+    pcb->acked = 0;
+    pcb->dupacks = 0;
+
+    pcb->rcv_nxt = seqno + tcplen;
+    pcb->rcv_wnd -= tcplen;
+    tcp_update_rcv_ann_wnd(pcb);
+
+    /* The pbuf is now the responsibility of the application. */
+    recv_data = inseg.p;
+    inseg.p = NULL;
+
+    tcp_ack(pcb);
+  }
+
+  return 1;
+}
+#endif /* TCP_HEADER_PREDICTION */
+
 /**
  * Called by tcp_process. Checks if the given segment is an ACK for outstanding
  * data, and if so frees the memory of the buffered data. Next, is places the
@@ -798,7 +1053,6 @@ tcp_receive(struct tcp_pcb *pcb)
 #endif
   struct pbuf *p;
   s32_t off;
-  s16_t m;
   u32_t right_wnd_edge;
   u16_t new_tot_len;
   int found_dupack = 0;
@@ -883,91 +1137,7 @@ tcp_receive(struct tcp_pcb *pcb)
       }
     } else if (TCP_SEQ_BETWEEN(ackno, pcb->lastack+1, pcb->snd_nxt)){
       /* We come here when the ACK acknowledges new data. */
-
-      /* Reset the "IN Fast Retransmit" flag, since we are no longer
-         in fast retransmit. Also reset the congestion window to the
-         slow start threshold. */
-      if (pcb->flags & TF_INFR) {
-        pcb->flags &= ~TF_INFR;
-        pcb->cwnd = pcb->ssthresh;
-      }
-
-      /* Reset the number of retransmissions. */
-      pcb->nrtx = 0;
-
-      /* Reset the retransmission time-out. */
-      pcb->rto = (pcb->sa >> 3) + pcb->sv;
-
-      /* Update the send buffer space. Diff between the two can never exceed 64K? */
-      pcb->acked = (u16_t)(ackno - pcb->lastack);
-
-      pcb->snd_buf += pcb->acked;
-
-      /* Reset the fast retransmit variables. */
-      pcb->dupacks = 0;
-      pcb->lastack = ackno;
-
-      /* Update the congestion control variables (cwnd and
-         ssthresh). */
-      if (pcb->state >= ESTABLISHED) {
-        if (pcb->cwnd < pcb->ssthresh) {
-          if ((u16_t)(pcb->cwnd + pcb->mss) > pcb->cwnd) {
-            pcb->cwnd += pcb->mss;
-          }
-          LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: slow start cwnd %"U16_F"\n", pcb->cwnd));
-        } else {
-          u16_t new_cwnd = (pcb->cwnd + pcb->mss * pcb->mss / pcb->cwnd);
-          if (new_cwnd > pcb->cwnd) {
-            pcb->cwnd = new_cwnd;
-          }
-          LWIP_DEBUGF(TCP_CWND_DEBUG, ("tcp_receive: congestion avoidance cwnd %"U16_F"\n", pcb->cwnd));
-        }
-      }
-      LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_receive: ACK for %"U32_F", unacked->seqno %"U32_F":%"U32_F"\n",
-                                    ackno,
-                                    pcb->unacked != NULL?
-                                    ntohl(pcb->unacked->tcphdr->seqno): 0,
-                                    pcb->unacked != NULL?
-                                    ntohl(pcb->unacked->tcphdr->seqno) + TCP_TCPLEN(pcb->unacked): 0));
-
-      /* Remove segment from the unacknowledged list if the incoming
-         ACK acknowlegdes them. */
-      while (pcb->unacked != NULL &&
-             TCP_SEQ_LEQ(ntohl(pcb->unacked->tcphdr->seqno) +
-                         TCP_TCPLEN(pcb->unacked), ackno)) {
-        LWIP_DEBUGF(TCP_INPUT_DEBUG, ("tcp_receive: removing %"U32_F":%"U32_F" from pcb->unacked\n",
-                                      ntohl(pcb->unacked->tcphdr->seqno),
-                                      ntohl(pcb->unacked->tcphdr->seqno) +
-                                      TCP_TCPLEN(pcb->unacked)));
-
-        next = pcb->unacked;
-        pcb->unacked = pcb->unacked->next;
-
-        LWIP_DEBUGF(TCP_QLEN_DEBUG, ("tcp_receive: queuelen %"U16_F" ... ", (u16_t)pcb->snd_queuelen));
-        LWIP_ASSERT("pcb->snd_queuelen >= pbuf_clen(next->p)", (pcb->snd_queuelen >= pbuf_clen(next->p)));
-        /* Prevent ACK for FIN to generate a sent event */
-        if ((pcb->acked != 0) && ((TCPH_FLAGS(next->tcphdr) & TCP_FIN) != 0)) {
-          pcb->acked--;
-        }
-
-        pcb->snd_queuelen -= pbuf_clen(next->p);
-        tcp_seg_free(next);
-
-        LWIP_DEBUGF(TCP_QLEN_DEBUG, ("%"U16_F" (after freeing unacked)\n", (u16_t)pcb->snd_queuelen));
-        if (pcb->snd_queuelen != 0) {
-          LWIP_ASSERT("tcp_receive: valid queue length", pcb->unacked != NULL ||
-                      pcb->unsent != NULL);
-        }
-      }
-
-      /* If there's nothing left to acknowledge, stop the retransmit
-         timer, otherwise reset it to start again */
-      if(pcb->unacked == NULL)
-        pcb->rtime = -1;
-      else
-        pcb->rtime = 0;
-
-      pcb->polltmr = 0;
+      tcp_ack_new_data(pcb);
     } else {
       /* Fix bug bug #21582: out of sequence ACK, didn't really ack anything */
       pcb->acked = 0;
@@ -1007,32 +1177,7 @@ tcp_receive(struct tcp_pcb *pcb)
     LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_receive: pcb->rttest %"U32_F" rtseq %"U32_F" ackno %"U32_F"\n",
                                 pcb->rttest, pcb->rtseq, ackno));
 
-    /* RTT estimation calculations. This is done by checking if the
-       incoming segment acknowledges the segment we use to take a
-       round-trip time measurement. */
-    if (pcb->rttest && TCP_SEQ_LT(pcb->rtseq, ackno)) {
-      /* diff between this shouldn't exceed 32K since this are tcp timer ticks
-         and a round-trip shouldn't be that long... */
-      m = (s16_t)(tcp_ticks - pcb->rttest);
-
-      LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_receive: experienced rtt %"U16_F" ticks (%"U16_F" msec).\n",
-                                  m, m * TCP_SLOW_INTERVAL));
-
-      /* This is taken directly from VJs original code in his paper */
-      m = m - (pcb->sa >> 3);
-      pcb->sa += m;
-      if (m < 0) {
-        m = -m;
-      }
-      m = m - (pcb->sv >> 2);
-      pcb->sv += m;
-      pcb->rto = (pcb->sa >> 3) + pcb->sv;
-
-      LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_receive: RTO %"U16_F" (%"U16_F" milliseconds)\n",
-                                  pcb->rto, pcb->rto * TCP_SLOW_INTERVAL));
-
-      pcb->rttest = 0;
-    }
+    tcp_rtt_estimate(pcb);
   }
 
   /* If the incoming segment contains data, we must process it
@@ -110,6 +110,8 @@ tcp_send_ctrl(struct tcp_pcb *pcb, u8_t flags)
  * @param apiflags combination of following flags :
  * - TCP_WRITE_FLAG_COPY (0x01) data will be copied into memory belonging to the stack
  * - TCP_WRITE_FLAG_MORE (0x02) for TCP connection, PSH flag will be set on last segment sent,
+ * - TCP_WRITE_FLAG_PUSH (0x04) the unsent data will be sent by the next tcp_output()
+ *   even if the Nagle algorithm would hold it back
  * @return ERR_OK if enqueued, another err_t on error
  * 
  * @see tcp_write()
@@ -151,6 +153,8 @@ tcp_write(struct tcp_pcb *pcb, const void *data, u16_t len, u8_t apiflags)
  * @param apiflags combination of following flags :
  * - TCP_WRITE_FLAG_COPY (0x01) data will be copied into memory belonging to the stack
  * - TCP_WRITE_FLAG_MORE (0x02) for TCP connection, PSH flag will be set on last segment sent,
+ * - TCP_WRITE_FLAG_PUSH (0x04) the unsent data will be sent by the next tcp_output()
+ *   even if the Nagle algorithm would hold it back
  * @param optflags options to include in segment later on (see definition of struct tcp_seg)
  */
 err_t
@@ -164,6 +168,9 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
   void *ptr;
   u16_t queuelen;
   u8_t optlen;
+#if TCP_OVERSIZE
+  u16_t alloclen;
+#endif /* TCP_OVERSIZE */
 
   LWIP_DEBUGF(TCP_OUTPUT_DEBUG, 
               ("tcp_enqueue(pcb=%p, arg=%p, len=%"U16_F", flags=%"X16_F", apiflags=%"U16_F")\n",
@@ -211,6 +218,54 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
       pcb->unacked == NULL && pcb->unsent == NULL);
   }
 
+#if TCP_OVERSIZE
+  /* Copy as much data as possible into the room left at the end of the
+   * last unsent segment: no new segment, pbuf or header for small writes. */
+  if ((len > 0) && (flags == 0) && (apiflags & TCP_WRITE_FLAG_COPY) &&
+      (pcb->unsent != NULL)) {
+    u16_t space;
+
+    for (useg = pcb->unsent; useg->next != NULL; useg = useg->next);
+    if ((useg->oversize_left > 0) &&
+        (useg->len < pcb->mss - optlen) &&
+        (TCP_TCPLEN(useg) != 0) &&
+        !(TCPH_FLAGS(useg->tcphdr) & (TCP_SYN | TCP_FIN)) &&
+        (useg->flags == optflags) &&
+        (ntohl(useg->tcphdr->seqno) + useg->len == seqno)) {
+      /* never grow the segment past the MSS, whatever the pbuf has room for */
+      space = LWIP_MIN(useg->oversize_left, left);
+      space = LWIP_MIN(space, pcb->mss - optlen - useg->len);
+      for (p = useg->p; p->next != NULL; p = p->next) {
+        p->tot_len += space;
+      }
+      MEMCPY((u8_t *)p->payload + p->len, ptr, space);
+      p->len += space;
+      p->tot_len += space;
+      useg->len += space;
+      useg->oversize_left -= space;
+      LWIP_DEBUGF(TCP_OUTPUT_DEBUG | LWIP_DBG_TRACE, ("tcp_enqueue: %"U16_F" bytes into the tail segment, new len %"U16_F"\n",
+        space, useg->len));
+
+      left -= space;
+      seqno += space;
+      ptr = (void *)((u8_t *)ptr + space);
+
+      if (left == 0) {
+        /* everything fitted: no new segment to queue */
+        pcb->snd_lbb += len;
+        pcb->snd_buf -= len;
+        if ((apiflags & TCP_WRITE_FLAG_MORE) == 0) {
+          TCPH_SET_FLAG(useg->tcphdr, TCP_PSH);
+        }
+        if (apiflags & TCP_WRITE_FLAG_PUSH) {
+          pcb->flags |= TF_PUSHNOW;
+        }
+        return ERR_OK;
+      }
+    }
+  }
+#endif /* TCP_OVERSIZE */
+
   /* First, break up the data into segments and tuck them together in
    * the local "queue" variable. */
   useg = queue = seg = NULL;
@@ -228,6 +283,9 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
     }
     seg->next = NULL;
     seg->p = NULL;
+#if TCP_OVERSIZE
+    seg->oversize_left = 0;
+#endif /* TCP_OVERSIZE */
 
     /* first segment of to-be-queued data? */
     if (queue == NULL) {
@@ -246,11 +304,28 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
      * and data copied into pbuf, otherwise data comes from
      * ROM or other static memory, and need not be copied.  */
     if (apiflags & TCP_WRITE_FLAG_COPY) {
+#if TCP_OVERSIZE
+      /* The last segment of a data write gets some room for the next writes,
+       * up to a full segment. */
+      alloclen = seglen;
+      if ((left == seglen) && (flags == 0) && (seglen > 0)) {
+        alloclen = LWIP_MIN(pcb->mss - optlen, LWIP_MEM_ALIGN_SIZE(seglen + TCP_OVERSIZE));
+      }
+      if ((seg->p = pbuf_alloc(PBUF_TRANSPORT, alloclen + optlen, PBUF_RAM)) == NULL) {
+        LWIP_DEBUGF(TCP_OUTPUT_DEBUG | LWIP_DBG_LEVEL_SERIOUS, 
+                    ("tcp_enqueue : could not allocate memory for pbuf copy size %"U16_F"\n", alloclen));
+        goto memerr;
+      }
+      /* keep the room out of the pbuf until it is filled */
+      seg->oversize_left = alloclen - seglen;
+      seg->p->len = seg->p->tot_len = seglen + optlen;
+#else /* TCP_OVERSIZE */
       if ((seg->p = pbuf_alloc(PBUF_TRANSPORT, seglen + optlen, PBUF_RAM)) == NULL) {
         LWIP_DEBUGF(TCP_OUTPUT_DEBUG | LWIP_DBG_LEVEL_SERIOUS, 
                     ("tcp_enqueue : could not allocate memory for pbuf copy size %"U16_F"\n", seglen));
         goto memerr;
       }
+#endif /* TCP_OVERSIZE */
       LWIP_ASSERT("check that first pbuf can hold the complete seglen",
                   (seg->p->len >= seglen + optlen));
       queuelen += pbuf_clen(seg->p);
@@ -379,6 +454,15 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
       pbuf_cat(useg->p, queue->p);
       useg->len += queue->len;
       useg->next = queue->next;
+#if TCP_OVERSIZE
+      /* the last pbuf of useg is now the one of queue, but its room is
+         bounded by what is left of the MSS for the merged segment */
+      if (useg->len + optlen >= pcb->mss) {
+        useg->oversize_left = 0;
+      } else {
+        useg->oversize_left = LWIP_MIN(queue->oversize_left, pcb->mss - optlen - useg->len);
+      }
+#endif /* TCP_OVERSIZE */
     }
 
     LWIP_DEBUGF(TCP_OUTPUT_DEBUG | LWIP_DBG_TRACE | LWIP_DBG_STATE, ("tcp_enqueue: chaining segments, new len %"U16_F"\n", useg->len));
@@ -423,6 +507,12 @@ tcp_enqueue(struct tcp_pcb *pcb, void *arg, u16_t len,
     TCPH_SET_FLAG(seg->tcphdr, TCP_PSH);
   }
 
+  /* The writer wants this data on the wire now: let tcp_output() bypass the
+  Nagle algorithm until everything enqueued so far is sent. */
+  if ((apiflags & TCP_WRITE_FLAG_PUSH) && (len > 0)) {
+    pcb->flags |= TF_PUSHNOW;
+  }
+
   return ERR_OK;
 memerr:
   pcb->flags |= TF_NAGLEMEMERR;
@@ -654,6 +744,10 @@ tcp_output(struct tcp_pcb *pcb)
     pcb->persist_backoff = 1;
   }
 
+  if (pcb->unsent == NULL) {
+    /* pushed data is on the wire */
+    pcb->flags &= ~TF_PUSHNOW;
+  }
   pcb->flags &= ~TF_NAGLEMEMERR;
   return ERR_OK;
 }
@@ -712,9 +806,10 @@ tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
   /* Set retransmission timer running if it is not currently enabled */
   if(pcb->rtime == -1)
     pcb->rtime = 0;
+  tcp_rto_timer_needed();
 
   if (pcb->rttest == 0) {
-    pcb->rttest = tcp_ticks;
+    pcb->rttest = TCP_RTT_NOW();
     pcb->rtseq = ntohl(seg->tcphdr->seqno);
 
     LWIP_DEBUGF(TCP_RTO_DEBUG, ("tcp_output_segment: rtseq %"U32_F"\n", pcb->rtseq));
@@ -730,6 +825,11 @@ tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
 
   seg->p->payload = seg->tcphdr;
 
+#if TCP_OVERSIZE
+  /* the segment is on the wire: its data must not change any more */
+  seg->oversize_left = 0;
+#endif /* TCP_OVERSIZE */
+
   seg->tcphdr->chksum = 0;
 #if CHECKSUM_GEN_TCP
   seg->tcphdr->chksum = inet_chksum_pseudo(seg->p,
@@ -738,6 +838,7 @@ tcp_output_segment(struct tcp_seg *seg, struct tcp_pcb *pcb)
              IP_PROTO_TCP, seg->p->tot_len);
 #endif
   TCP_STATS_INC(tcp.xmit);
+  LWIP_TCP_OUTPUT_HOOK(pcb, seg);
 
 #if LWIP_NETIF_HWADDRHINT
   ip_output_hinted(seg->p, &(pcb->local_ip), &(pcb->remote_ip), pcb->ttl, pcb->tos,
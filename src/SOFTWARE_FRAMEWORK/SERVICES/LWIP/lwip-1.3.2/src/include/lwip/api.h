@@ -58,6 +58,8 @@ extern "C" {
 #define NETCONN_NOCOPY 0x00 /* Only for source code compatibility */
 #define NETCONN_COPY   0x01
 #define NETCONN_MORE   0x02
+#define NETCONN_PUSH   0x04 /* Send now, bypassing the Nagle algorithm (frame boundary) */
+#define NETCONN_DONTBLOCK 0x08 /* Only write what fits in the send buffer, don't wait */
 
 /* Helpers to process several netconn_types by the same code */
 #define NETCONNTYPE_GROUP(t)    (t&0xF0)
@@ -155,6 +157,16 @@ struct netconn {
       if data couldn't be sent in the first try. */
   u8_t write_delayed;
 #endif /* LWIP_TCPIP_CORE_LOCKING */
+  /** TCP: a NETCONN_DONTBLOCK write found no room and sent NETCONN_EVT_SENDMINUS:
+      NETCONN_EVT_SENDPLUS is owed once there is room again. */
+  u8_t write_blocked;
+  /** TCP: netbuf given back by netconn_recycle_netbuf(), used by the next
+      netconn_recv() instead of one from MEMP_NETBUF. */
+  struct netbuf *recv_netbuf;
+  /** TCP: pbuf only partly copied out by netconn_recv_into(), and how much
+      of it was copied. */
+  struct pbuf *recv_pending;
+  u16_t recv_pending_offset;
 #endif /* LWIP_TCP */
   /** A callback function that is informed about events for this netconn */
   netconn_callback callback;
@@ -200,7 +212,18 @@ err_t             netconn_send    (struct netconn *conn,
 err_t             netconn_write   (struct netconn *conn,
                                    const void *dataptr, size_t size,
                                    u8_t apiflags);
+err_t             netconn_write_partly(struct netconn *conn,
+                                   const void *dataptr, size_t size,
+                                   u8_t apiflags, size_t *bytes_written);
 err_t             netconn_close   (struct netconn *conn);
+#if LWIP_TCP
+err_t             netconn_set_nodelay(struct netconn *conn, u8_t nodelay);
+u8_t              netconn_get_nodelay(struct netconn *conn);
+err_t             netconn_set_keepalive(struct netconn *conn, u32_t idle,
+                                        u32_t intvl, u32_t cnt);
+u16_t             netconn_recv_into(struct netconn *conn, void *dataptr, u16_t len);
+void              netconn_recycle_netbuf(struct netconn *conn, struct netbuf *buf);
+#endif /* LWIP_TCP */
 
 #if LWIP_IGMP
 err_t             netconn_join_leave_group (struct netconn *conn,
@@ -215,6 +238,14 @@ err_t             netconn_gethostbyname(const char *name, struct ip_addr *addr);
 #define netconn_err(conn)          ((conn)->err)
 #define netconn_recv_bufsize(conn) ((conn)->recv_bufsize)
 
+#if LWIP_SO_RCVTIMEO
+/** Set the time (in milliseconds, 0 for ever) netconn_recv() and
+    netconn_accept() wait before returning NULL with ERR_TIMEOUT. */
+#define netconn_set_recvtimeout(conn, timeout) ((conn)->recv_timeout = (timeout))
+/** Get the receive timeout of a netconn. */
+#define netconn_get_recvtimeout(conn)          ((conn)->recv_timeout)
+#endif /* LWIP_SO_RCVTIMEO */
+
 #ifdef __cplusplus
 }
 #endif
@@ -84,11 +84,24 @@ struct api_msg_msg {
       const void *dataptr;
       size_t len;
       u8_t apiflags;
+      /** ERR_MEM when a NETCONN_DONTBLOCK write found no room: only
+          returned by netconn_write_partly(), not kept in conn->err */
+      err_t err;
     } w;
     /** used for do_recv */
     struct {
       u16_t len;
     } r;
+    /** used for do_nodelay */
+    struct {
+      u8_t nodelay;
+    } nd;
+    /** used for do_keepalive */
+    struct {
+      u32_t idle;
+      u32_t intvl;
+      u32_t cnt;
+    } ka;
 #if LWIP_IGMP
     /** used for do_join_leave_group */
     struct {
@@ -144,6 +157,8 @@ void do_recv            ( struct api_msg_msg *msg);
 void do_write           ( struct api_msg_msg *msg);
 void do_getaddr         ( struct api_msg_msg *msg);
 void do_close           ( struct api_msg_msg *msg);
+void do_nodelay         ( struct api_msg_msg *msg);
+void do_keepalive       ( struct api_msg_msg *msg);
 #if LWIP_IGMP
 void do_join_leave_group( struct api_msg_msg *msg);
 #endif /* LWIP_IGMP */
@@ -834,6 +834,44 @@
 #define TCP_SNDLOWAT                    ((TCP_SND_BUF)/2)
 #endif
 
+/**
+ * TCP_OVERSIZE: The number of bytes tcp_enqueue may allocate ahead of time
+ * in the pbuf of a copied segment, so that the next small writes are copied
+ * into the tail unsent segment instead of getting their own segment and pbuf.
+ * 0 disables it. The meaningful range is 0 to TCP_MSS.
+ */
+#ifndef TCP_OVERSIZE
+#define TCP_OVERSIZE                    0
+#endif
+
+/**
+ * TCP_HEADER_PREDICTION==1: tcp_input() processes the pure ACKs and the
+ * in-sequence data segments of ESTABLISHED connections on a fast path,
+ * bypassing tcp_process() and tcp_receive().
+ */
+#ifndef TCP_HEADER_PREDICTION
+#define TCP_HEADER_PREDICTION           0
+#endif
+
+/**
+ * TCP_PCB_RECYCLE==1: when no tcp_pcb is free, tcp_alloc() reaps the oldest
+ * half-open (SYN_RCVD) and closing (LAST_ACK, CLOSING) connections before
+ * killing an open one, and a SYN with a higher sequence number reopens a
+ * connection in TIME-WAIT (RFC 1122 4.2.2.13) instead of being answered.
+ */
+#ifndef TCP_PCB_RECYCLE
+#define TCP_PCB_RECYCLE                 0
+#endif
+
+/**
+ * LWIP_TCP_OUTPUT_HOOK(pcb, seg): called by tcp_output_segment() for every
+ * segment handed to IP, retransmissions included, once its header is
+ * complete. Used to trace when the data actually leaves TCP.
+ */
+#ifndef LWIP_TCP_OUTPUT_HOOK
+#define LWIP_TCP_OUTPUT_HOOK(pcb, seg)
+#endif
+
 /**
  * TCP_LISTEN_BACKLOG: Enable the backlog option for tcp listen pcb.
  */
@@ -850,6 +888,45 @@
 #define TCP_DEFAULT_LISTEN_BACKLOG      0xff
 #endif
 
+/**
+ * LWIP_TCP_HIRES_RTO==1: run the retransmission timer every
+ * TCP_RTO_TMR_INTERVAL milliseconds instead of every TCP_SLOW_INTERVAL, and
+ * measure the round-trip time with sys_now(), so that the RTO can follow a
+ * LAN round-trip time down to TCP_MIN_RTO. With NO_SYS==1, tcp_rtotmr() must
+ * be called every TCP_RTO_TMR_INTERVAL by the application.
+ */
+#ifndef LWIP_TCP_HIRES_RTO
+#define LWIP_TCP_HIRES_RTO              0
+#endif
+
+/**
+ * TCP_RTO_TMR_INTERVAL: period of tcp_rtotmr(), in milliseconds: the
+ * resolution of the RTO when LWIP_TCP_HIRES_RTO==1.
+ */
+#ifndef TCP_RTO_TMR_INTERVAL
+#define TCP_RTO_TMR_INTERVAL            10
+#endif
+
+/**
+ * TCP_MIN_RTO, TCP_MAX_RTO: bounds of the RTO, in milliseconds, when
+ * LWIP_TCP_HIRES_RTO==1.
+ */
+#ifndef TCP_MIN_RTO
+#define TCP_MIN_RTO                     (3 * TCP_RTO_TMR_INTERVAL)
+#endif
+
+#ifndef TCP_MAX_RTO
+#define TCP_MAX_RTO                     60000
+#endif
+
+/**
+ * TCP_INITIAL_RTO: RTO used until the first round-trip time is measured, in
+ * milliseconds.
+ */
+#ifndef TCP_INITIAL_RTO
+#define TCP_INITIAL_RTO                 3000
+#endif
+
 /**
  * LWIP_TCP_TIMESTAMPS==1: support the TCP timestamp option.
  */
@@ -904,6 +981,27 @@
 #define PBUF_POOL_BUFSIZE               LWIP_MEM_ALIGN_SIZE(TCP_MSS+40+PBUF_LINK_HLEN)
 #endif
 
+/**
+ * PBUF_POOL_ALIGNMENT: when not 0, the pbuf pool is carved out of its own
+ * array, in which the payload of every pbuf allocated with PBUF_RAW starts
+ * on a PBUF_POOL_ALIGNMENT boundary (a power of 2, multiple of MEM_ALIGNMENT).
+ * Each element then takes the pbuf header and PBUF_POOL_BUFSIZE, both rounded
+ * up to PBUF_POOL_ALIGNMENT. Used to match the pbufs to the receive buffers
+ * of a DMA driver. The pool is not covered by MEMP_OVERFLOW_CHECK.
+ */
+#ifndef PBUF_POOL_ALIGNMENT
+#define PBUF_POOL_ALIGNMENT             0
+#endif
+
+/**
+ * PBUF_POOL_MEMORY_ATTRIBUTE: compiler attribute appended to the declaration
+ * of the PBUF_POOL_ALIGNMENT array, e.g. to place it in a dedicated linker
+ * section.
+ */
+#ifndef PBUF_POOL_MEMORY_ATTRIBUTE
+#define PBUF_POOL_MEMORY_ATTRIBUTE
+#endif
+
 /*
    ------------------------------------------------
    ---------- Network Interfaces options ----------
@@ -1211,6 +1309,16 @@
 #define LWIP_COMPAT_SOCKETS             1
 #endif
 
+/**
+ * LWIP_SOCKET_CHANNELS==1: Enable lwip_channel() and lwip_channel_event():
+ * sockets without netconn whose events are set by the application, to have
+ * select wait for a serial port or a queue together with the network sockets.
+ * They take a socket slot each (NUM_SOCKETS is MEMP_NUM_NETCONN).
+ */
+#ifndef LWIP_SOCKET_CHANNELS
+#define LWIP_SOCKET_CHANNELS            0
+#endif
+
 /**
  * LWIP_POSIX_SOCKETS_IO_NAMES==1: Enable POSIX-style sockets functions names.
  * Disable this option if you use a POSIX operating system that uses the same
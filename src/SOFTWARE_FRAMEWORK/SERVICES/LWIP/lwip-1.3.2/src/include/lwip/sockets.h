@@ -323,6 +323,11 @@ int lwip_select(int maxfdp1, fd_set *readset, fd_set *writeset, fd_set *exceptse
                 struct timeval *timeout);
 int lwip_ioctl(int s, long cmd, void *argp);
 
+#if LWIP_SOCKET_CHANNELS
+int lwip_channel(void);
+int lwip_channel_event(int s, int readable, int writable);
+#endif /* LWIP_SOCKET_CHANNELS */
+
 #if LWIP_COMPAT_SOCKETS
 #define accept(a,b,c)         lwip_accept(a,b,c)
 #define bind(a,b,c)           lwip_bind(a,b,c)
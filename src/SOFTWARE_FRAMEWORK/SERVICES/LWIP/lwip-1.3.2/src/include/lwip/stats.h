@@ -84,6 +84,17 @@ struct stats_igmp {
   STAT_COUNTER group_query_rxed; /* */
 };
 
+struct stats_tcp_conn {
+  STAT_COUNTER syn_rcvd;         /* Connection requests received. */
+  STAT_COUNTER refused_nolisten; /* Connection requests reset: no listener. */
+  STAT_COUNTER refused_backlog;  /* Connection requests dropped: backlog full. */
+  STAT_COUNTER refused_mem;      /* Connection requests dropped: no free pcb. */
+  STAT_COUNTER tw_recycled;      /* TIME-WAIT pcbs reused. */
+  STAT_COUNTER reaped;           /* Half-open or closing pcbs killed for room. */
+  STAT_COUNTER recycled;         /* New pcbs allocated in the room of a reaped one. */
+  STAT_COUNTER killed;           /* Open connections killed for room. */
+};
+
 struct stats_mem {
   mem_size_t avail;
   mem_size_t used;
@@ -127,6 +138,7 @@ struct stats_ {
 #endif
 #if TCP_STATS
   struct stats_proto tcp;
+  struct stats_tcp_conn tcp_conn;
 #endif
 #if MEM_STATS
   struct stats_mem mem;
@@ -154,9 +166,13 @@ extern struct stats_ lwip_stats;
 #if TCP_STATS
 #define TCP_STATS_INC(x) STATS_INC(x)
 #define TCP_STATS_DISPLAY() stats_display_proto(&lwip_stats.tcp, "TCP")
+#define TCP_CONN_STATS_INC(x) STATS_INC(tcp_conn.x)
+#define TCP_CONN_STATS_DISPLAY() stats_display_tcp_conn(&lwip_stats.tcp_conn)
 #else
 #define TCP_STATS_INC(x)
 #define TCP_STATS_DISPLAY()
+#define TCP_CONN_STATS_INC(x)
+#define TCP_CONN_STATS_DISPLAY()
 #endif
 
 #if UDP_STATS
@@ -266,6 +282,7 @@ extern struct stats_ lwip_stats;
 void stats_display(void);
 void stats_display_proto(struct stats_proto *proto, char *name);
 void stats_display_igmp(struct stats_igmp *igmp);
+void stats_display_tcp_conn(struct stats_tcp_conn *conn);
 void stats_display_mem(struct stats_mem *mem, char *name);
 void stats_display_memp(struct stats_mem *mem, int index);
 void stats_display_sys(struct stats_sys *sys);
@@ -273,6 +290,7 @@ void stats_display_sys(struct stats_sys *sys);
 #define stats_display()
 #define stats_display_proto(proto, name)
 #define stats_display_igmp(igmp)
+#define stats_display_tcp_conn(conn)
 #define stats_display_mem(mem, name)
 #define stats_display_memp(mem, index)
 #define stats_display_sys(sys)
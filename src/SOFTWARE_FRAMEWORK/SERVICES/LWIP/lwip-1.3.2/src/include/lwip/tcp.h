@@ -55,6 +55,11 @@ struct tcp_pcb;
 
 /* Lower layer interface to TCP: */
 #define tcp_init() /* Compatibility define, not init needed. */
+#if LWIP_TCP_HIRES_RTO
+u8_t             tcp_rtotmr  (void);  /* Must be called every
+                                         TCP_RTO_TMR_INTERVAL ms while it
+                                         returns 1. */
+#endif /* LWIP_TCP_HIRES_RTO */
 void             tcp_tmr     (void);  /* Must be called every
                                          TCP_TMR_INTERVAL
                                          ms. (Typically 250 ms). */
@@ -108,6 +113,7 @@ err_t            tcp_close   (struct tcp_pcb *pcb);
 /* Flags for "apiflags" parameter in tcp_write and tcp_enqueue */
 #define TCP_WRITE_FLAG_COPY 0x01
 #define TCP_WRITE_FLAG_MORE 0x02
+#define TCP_WRITE_FLAG_PUSH 0x04
 
 err_t            tcp_write   (struct tcp_pcb *pcb, const void *dataptr, u16_t len,
                               u8_t apiflags);
@@ -139,12 +145,13 @@ u32_t            tcp_update_rcv_ann_wnd(struct tcp_pcb *pcb);
  * segments as possible. Only send if
  * - no previously transmitted data on the connection remains unacknowledged or
  * - the TF_NODELAY flag is set (nagle algorithm turned off for this pcb) or
+ * - the TF_PUSHNOW flag is set (data written with TCP_WRITE_FLAG_PUSH is unsent) or
  * - the only unsent segment is at least pcb->mss bytes long (or there is more
  *   than one unsent segment - with lwIP, this can happen although unsent->len < mss)
  * - or if we are in fast-retransmit (TF_INFR)
  */
 #define tcp_do_output_nagle(tpcb) ((((tpcb)->unacked == NULL) || \
-                            ((tpcb)->flags & (TF_NODELAY | TF_INFR)) || \
+                            ((tpcb)->flags & (TF_NODELAY | TF_PUSHNOW | TF_INFR)) || \
                             (((tpcb)->unsent != NULL) && (((tpcb)->unsent->next != NULL) || \
                               ((tpcb)->unsent->len >= (tpcb)->mss))) \
                             ) ? 1 : 0)
@@ -186,11 +193,34 @@ u32_t            tcp_update_rcv_ann_wnd(struct tcp_pcb *pcb);
 #define TCP_SLOW_INTERVAL      (2*TCP_TMR_INTERVAL)  /* the coarse grained timeout in milliseconds */
 #endif /* TCP_SLOW_INTERVAL */
 
+#if LWIP_TCP_HIRES_RTO
+/* The retransmission timer (rtime, rto, sa and sv) counts TCP_RTO_TMR_INTERVAL
+   ticks of tcp_rtotmr(), round-trip times are measured with sys_now(). */
+#define TCP_RTO_TICKS(ms)      ((s16_t)(((ms) + TCP_RTO_TMR_INTERVAL - 1) / TCP_RTO_TMR_INTERVAL))
+#define TCP_RTO_BOUND(rto)     ((s16_t)LWIP_MIN(LWIP_MAX((s32_t)(rto), TCP_RTO_TICKS(TCP_MIN_RTO)), \
+                                                TCP_RTO_TICKS(TCP_MAX_RTO)))
+#define TCP_RTO_MS(rto)        ((s32_t)(rto) * TCP_RTO_TMR_INTERVAL)
+#define TCP_RTT_NOW()          (sys_now() | 1) /* 0 means "no measurement running" */
+#define TCP_RTT_TICKS(elapsed) ((s16_t)((elapsed) / TCP_RTO_TMR_INTERVAL))
+#else /* LWIP_TCP_HIRES_RTO */
+/* The retransmission timer counts tcp_slowtmr() ticks. */
+#define TCP_RTO_TICKS(ms)      ((s16_t)((ms) / TCP_SLOW_INTERVAL))
+#define TCP_RTO_BOUND(rto)     ((s16_t)(rto))
+#define TCP_RTO_MS(rto)        ((s32_t)(rto) * TCP_SLOW_INTERVAL)
+#define TCP_RTT_NOW()          (tcp_ticks)
+#define TCP_RTT_TICKS(elapsed) ((s16_t)(elapsed))
+#endif /* LWIP_TCP_HIRES_RTO */
+
 #define TCP_FIN_WAIT_TIMEOUT 20000 /* milliseconds */
 #define TCP_SYN_RCVD_TIMEOUT 20000 /* milliseconds */
 
 #define TCP_OOSEQ_TIMEOUT        6U /* x RTO */
 
+/* TCP_OOSEQ_TIMEOUT RTOs in tcp_slowtmr() ticks, rounded up: with the fine
+   grained RTO, one RTO is often shorter than one tick. */
+#define TCP_OOSEQ_TICKS(rto)     LWIP_MAX(1, ((u32_t)TCP_RTO_MS(rto) * TCP_OOSEQ_TIMEOUT + TCP_SLOW_INTERVAL - 1) \
+                                             / TCP_SLOW_INTERVAL)
+
 #ifndef TCP_MSL
 #define TCP_MSL 60000UL /* The maximum segment lifetime in milliseconds */
 #endif
@@ -307,6 +337,7 @@ struct tcp_pcb {
 #define TF_ACK_NOW     ((u8_t)0x02U)   /* Immediate ACK. */
 #define TF_INFR        ((u8_t)0x04U)   /* In fast recovery. */
 #define TF_TIMESTAMP   ((u8_t)0x08U)   /* Timestamp option enabled */
+#define TF_PUSHNOW     ((u8_t)0x10U)   /* Data written with TCP_WRITE_FLAG_PUSH is unsent: bypass Nagle until it is sent. */
 #define TF_FIN         ((u8_t)0x20U)   /* Connection was closed locally (FIN segment enqueued). */
 #define TF_NODELAY     ((u8_t)0x40U)   /* Disable Nagle algorithm */
 #define TF_NAGLEMEMERR ((u8_t)0x80U)   /* nagle enabled, memerr, try to output to prevent delayed ACK to happen */
@@ -331,7 +362,7 @@ struct tcp_pcb {
   /* RTT (round trip time) estimation variables */
   u32_t rttest; /* RTT estimate in 500ms ticks */
   u32_t rtseq;  /* sequence number being timed */
-  s16_t sa, sv; /* @todo document this */
+  s16_t sa, sv; /* smoothed RTT (x8) and RTT deviation (x4), in retransmission timer ticks */
 
   s16_t rto;    /* retransmission time-out */
   u8_t nrtx;    /* number of retransmissions */
@@ -532,6 +563,10 @@ struct tcp_seg {
 #define TF_SEG_OPTS_MSS   (u8_t)0x01U   /* Include MSS option. */
 #define TF_SEG_OPTS_TS    (u8_t)0x02U   /* Include timestamp option. */
   struct tcp_hdr *tcphdr;  /* the TCP header */
+#if TCP_OVERSIZE
+  u16_t oversize_left;     /* spare bytes after the data of the last pbuf of p,
+                              usable by tcp_enqueue until the segment is sent */
+#endif /* TCP_OVERSIZE */
 };
 
 #define LWIP_TCP_OPT_LENGTH(flags)              \
@@ -618,6 +653,12 @@ s16_t tcp_pcbs_sane(void);
 void tcp_timer_needed(void);
 #endif
 
+#if LWIP_TCP_HIRES_RTO && !NO_SYS
+void tcp_rto_timer_needed(void);
+#else
+#define tcp_rto_timer_needed()
+#endif
+
 /* The TCP PCB lists. */
 union tcp_listen_pcbs_t { /* List of all TCP PCBs in LISTEN state. */
   struct tcp_pcb_listen *listen_pcbs; 
@@ -0,0 +1,184 @@
+/*! \file *********************************************************************
+ *
+ * \brief Drives the netconn API on the host.
+ *
+ *****************************************************************************/
+
+#include "lwip/api.h"
+#include "lwip/api_msg.h"
+#include "lwip/sys.h"
+#include "lwip/tcpip.h"
+
+#include "api_helper.h"
+
+//! Messages a mailbox holds, the largest *_MBOX_SIZE of the options.
+#define API_HELPER_MBOX_SIZE  16
+
+unsigned long api_helper_apimsgs;
+unsigned long api_helper_callbacks;
+
+struct api_helper_sem
+{
+  u8_t count;
+};
+
+struct api_helper_mbox
+{
+  void *msgs[API_HELPER_MBOX_SIZE];
+  int size, first, count;
+};
+
+void sys_init(void)
+{
+}
+
+sys_sem_t sys_sem_new(u8_t count)
+{
+  sys_sem_t sem = malloc(sizeof(*sem));
+
+  if (sem != NULL) {
+    sem->count = count;
+  }
+  return sem;
+}
+
+void sys_sem_signal(sys_sem_t sem)
+{
+  sem->count++;
+}
+
+u32_t sys_arch_sem_wait(sys_sem_t sem, u32_t timeout)
+{
+  if (sem->count == 0) {
+    LWIP_ASSERT("sys_arch_sem_wait: would wait for ever", timeout != 0);
+    return SYS_ARCH_TIMEOUT;
+  }
+  sem->count--;
+  return 0;
+}
+
+/* Those of core/sys.c, without the sys_timeout() list the host has no use
+   for: the sockets wait on their semaphores with them. */
+void sys_sem_wait(sys_sem_t sem)
+{
+  sys_arch_sem_wait(sem, 0);
+}
+
+int sys_sem_wait_timeout(sys_sem_t sem, u32_t timeout)
+{
+  return sys_arch_sem_wait(sem, timeout) != SYS_ARCH_TIMEOUT;
+}
+
+void sys_sem_free(sys_sem_t sem)
+{
+  free(sem);
+}
+
+sys_mbox_t sys_mbox_new(int size)
+{
+  sys_mbox_t mbox;
+
+  LWIP_ASSERT("sys_mbox_new: size", size <= API_HELPER_MBOX_SIZE);
+  mbox = malloc(sizeof(*mbox));
+  if (mbox != NULL) {
+    mbox->size = size > 0 ? size : API_HELPER_MBOX_SIZE;
+    mbox->first = mbox->count = 0;
+  }
+  return mbox;
+}
+
+err_t sys_mbox_trypost(sys_mbox_t mbox, void *msg)
+{
+  if (mbox->count == mbox->size) {
+    return ERR_MEM;
+  }
+  mbox->msgs[(mbox->first + mbox->count++) % mbox->size] = msg;
+  return ERR_OK;
+}
+
+void sys_mbox_post(sys_mbox_t mbox, void *msg)
+{
+  err_t err = sys_mbox_trypost(mbox, msg);
+
+  LWIP_ASSERT("sys_mbox_post: would wait for room", err == ERR_OK);
+  LWIP_UNUSED_ARG(err);
+}
+
+u32_t sys_arch_mbox_tryfetch(sys_mbox_t mbox, void **msg)
+{
+  if (mbox->count == 0) {
+    return SYS_MBOX_EMPTY;
+  }
+  if (msg != NULL) {
+    *msg = mbox->msgs[mbox->first];
+  }
+  mbox->first = (mbox->first + 1) % mbox->size;
+  mbox->count--;
+  return 0;
+}
+
+u32_t sys_arch_mbox_fetch(sys_mbox_t mbox, void **msg, u32_t timeout)
+{
+  if (mbox->count == 0) {
+    LWIP_ASSERT("sys_arch_mbox_fetch: would wait for ever", timeout != 0);
+    return SYS_ARCH_TIMEOUT;
+  }
+  return sys_arch_mbox_tryfetch(mbox, msg);
+}
+
+void sys_mbox_free(sys_mbox_t mbox)
+{
+  free(mbox);
+}
+
+/* The timers run in tcp_helper_run(). */
+void tcp_timer_needed(void)
+{
+}
+
+/* The sys_timeout() timers never expire: the exchanges of the tests and
+   benchmarks are over before. */
+void sys_timeout(u32_t msecs, sys_timeout_handler h, void *arg)
+{
+}
+
+#if LWIP_TCP_HIRES_RTO
+void tcp_rto_timer_needed(void)
+{
+}
+#endif
+
+/* The tcpip thread runs the call at once. */
+err_t tcpip_callback_with_block(void (*f)(void *ctx), void *ctx, u8_t block)
+{
+  api_helper_callbacks++;
+  f(ctx);
+  return ERR_OK;
+}
+
+/* The tcpip thread takes the message at once. */
+err_t tcpip_apimsg(struct api_msg *apimsg)
+{
+  u32_t waited;
+
+  api_helper_apimsgs++;
+  apimsg->function(&apimsg->msg);
+  waited = sys_arch_sem_wait(apimsg->msg.conn->op_completed, 0);
+  LWIP_UNUSED_ARG(waited);
+  return ERR_OK;
+}
+
+struct netconn *api_helper_accepted(void)
+{
+  struct netconn *listener, *conn;
+
+  listener = netconn_new(NETCONN_TCP);
+  LWIP_ASSERT("netconn_new", listener != NULL);
+  netconn_bind(listener, IP_ADDR_ANY, TCP_HELPER_LOCAL_PORT);
+  netconn_listen(listener);
+  tcp_helper_connect();
+  conn = netconn_accept(listener);
+  LWIP_ASSERT("netconn_accept", conn != NULL);
+  netconn_delete(listener);
+  return conn;
+}
@@ -0,0 +1,34 @@
+/*! \file *********************************************************************
+ *
+ * \brief Drives the netconn API on the host, over the connection of
+ *        lwip/tcp_helper.c.
+ *
+ * The calls of the API are run at once, as if the tcpip thread took them
+ * as soon as they were posted; they fail an assertion where the calling
+ * task would wait for the remote side. What the stack posts to a netconn
+ * is in its mailbox when the segment handed to tcp_helper_input() returns.
+ *
+ *****************************************************************************/
+
+#ifndef API_HELPER_H
+#define API_HELPER_H
+
+#include "lwip/api.h"
+
+#include "tcp_helper.h"
+
+/*! Messages posted to the tcpip thread: netconn calls, each of which has
+    the calling task wait on a semaphore, and tcpip_callback() calls. */
+extern unsigned long api_helper_apimsgs;
+extern unsigned long api_helper_callbacks;
+
+/*! \brief Creates a TCP netconn listening on TCP_HELPER_LOCAL_PORT, connects
+ *         the peer to it and returns the accepted netconn, in ESTABLISHED
+ *         state with nothing sent or received; the listening one is deleted.
+ *
+ *  The local sequence numbers start at conn->pcb.tcp->snd_nxt, the remote
+ *  ones at TCP_HELPER_REMOTE_ISS.
+ */
+struct netconn *api_helper_accepted(void);
+
+#endif
@@ -0,0 +1,23 @@
+/*! \file *********************************************************************
+ *
+ * \brief lwIP operating system layer of the host tests of the netconn API:
+ *        one thread, semaphores and mailboxes that never wait.
+ *
+ * A wait that would block the calling task on the board returns
+ * SYS_ARCH_TIMEOUT at once, without advancing sys_now(); one without a
+ * timeout fails an assertion instead. The tests only wait for what is
+ * already there, or poll with a timeout.
+ *
+ *****************************************************************************/
+
+#ifndef __ARCH_SYS_ARCH_H__
+#define __ARCH_SYS_ARCH_H__
+
+typedef struct api_helper_sem *sys_sem_t;
+typedef struct api_helper_mbox *sys_mbox_t;
+typedef int sys_thread_t;
+
+#define SYS_MBOX_NULL  ((sys_mbox_t)0)
+#define SYS_SEM_NULL   ((sys_sem_t)0)
+
+#endif /* __ARCH_SYS_ARCH_H__ */
@@ -0,0 +1,37 @@
+/*! \file *********************************************************************
+ *
+ * \brief lwIP options of the test_api_*.c tests and bench_api_*.c
+ *        benchmarks: those of the host tests with the netconn API, its
+ *        netbufs and mailboxes as in CONFIG/lwipopts.h.
+ *
+ *****************************************************************************/
+
+#ifndef __API_LWIPOPTS_H__
+#define __API_LWIPOPTS_H__
+
+#include "../lwip/lwipopts.h"
+
+#undef NO_SYS
+#define NO_SYS                  0
+#undef LWIP_NETCONN
+#define LWIP_NETCONN            1
+
+#define LWIP_SO_RCVTIMEO        1
+#define MEMP_NUM_NETBUF         3
+#define MEMP_NUM_NETCONN        4
+#define DEFAULT_TCP_RECVMBOX_SIZE 6
+#define DEFAULT_ACCEPTMBOX_SIZE 6
+
+/* The sockets of the select() bridge, without the names the C library of
+   the host has too. */
+#undef LWIP_SOCKET
+#define LWIP_SOCKET             1
+#define LWIP_SOCKET_CHANNELS    1
+#define LWIP_COMPAT_SOCKETS     0
+#define LWIP_TIMEVAL_PRIVATE    0
+
+/* The UDP bridge. */
+#undef LWIP_UDP
+#define LWIP_UDP                1
+
+#endif /* __API_LWIPOPTS_H__ */
@@ -0,0 +1,166 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host benchmark of the netbufs taken from MEMP_NETBUF per Z-Wave
+ *        frame forwarded through a netconn, with and without recycling.
+ *
+ * The peer sends a frame of FRAME_LEN bytes; the netconn reads it, writes
+ * a response of as many bytes and the peer acknowledges it. The frame is
+ * read three ways:
+ *   - delete:  netconn_recv(), then netbuf_delete(), as before recycling;
+ *   - recycle: netconn_recv(), then netconn_recycle_netbuf(), as
+ *              lwip_recvfrom() does for the socket bridge;
+ *   - into:    netconn_recv_into() a buffer of the caller, as the Z-Wave
+ *              session does;
+ * each also with a receive timeout before every frame, as a task polling
+ * with SO_RCVTIMEO sees. MEMP_NETBUF holds 3 netbufs, as on the board.
+ *
+ * Then the same with the pool empty, its netbufs held by the other
+ * connections of the bridge once the first frame was read: the frames
+ * forwarded out of FRAMES before the first read that failed.
+ *
+ * The time is that of the read and the write, in time stamp counter ticks
+ * on x86, in ns elsewhere: the median over FRAMES frames.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "lwip/memp.h"
+#include "lwip/stats.h"
+
+#include "api_helper.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS_UNIT "TSC"
+static unsigned long long ticks(void)
+{
+  return __rdtsc();
+}
+#else
+#define TICKS_UNIT "ns"
+static unsigned long long ticks(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+#endif
+
+#define FRAMES     10000
+#define FRAME_LEN  10
+
+enum mode { DELETE, RECYCLE, INTO };
+
+static const char *mode_name[] = { "delete", "recycle", "into" };
+
+static unsigned long long elapsed[FRAMES];
+
+static int compare(const void *a, const void *b)
+{
+  unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+
+  return x < y ? -1 : x > y;
+}
+
+/* Netbufs in use, those of the pool taken by netconn_recv() among them. */
+static u16_t netbufs_used(void)
+{
+  return lwip_stats.memp[MEMP_NETBUF].used;
+}
+
+/* Reads a frame, or times out when polling before it is sent; the netbufs
+   taken from the pool are counted in allocs. Returns 0 if nothing was read. */
+static int read_frame(struct netconn *conn, enum mode mode, unsigned long *allocs)
+{
+  u8_t frame[FRAME_LEN];
+  struct netbuf *buf;
+  u16_t used = netbufs_used();
+
+  if (mode == INTO) {
+    return netconn_recv_into(conn, frame, sizeof(frame)) == FRAME_LEN;
+  }
+  buf = netconn_recv(conn);
+  if (netbufs_used() > used) {
+    (*allocs)++;
+  }
+  if (buf == NULL) {
+    return 0;
+  }
+  netbuf_copy(buf, frame, sizeof(frame));
+  if (mode == DELETE) {
+    netbuf_delete(buf);
+  } else {
+    netconn_recycle_netbuf(conn, buf);
+  }
+  return 1;
+}
+
+static void bench(enum mode mode, int poll, int drain)
+{
+  static const u8_t response[FRAME_LEN] = { 0x01, 0x08, 0x01, 0x13 };
+  void *held[MEMP_NUM_NETBUF];
+  struct netconn *conn;
+  unsigned long allocs = 0, first_allocs = 0, forwarded = 0;
+  unsigned long long start;
+  u32_t seqno = TCP_HELPER_REMOTE_ISS;
+  int nheld = 0, i;
+
+  tcp_helper_init();
+  conn = api_helper_accepted();
+  netconn_set_recvtimeout(conn, 1);
+
+  /* The first frame warms up and is not counted. */
+  for (i = 0; i <= FRAMES; i++) {
+    if (drain && i == 1) {
+      while (nheld < MEMP_NUM_NETBUF && (held[nheld] = memp_malloc(MEMP_NETBUF)) != NULL) {
+        nheld++;
+      }
+    }
+    if (poll && read_frame(conn, mode, i > 0 ? &allocs : &first_allocs)) {
+      break;
+    }
+    tcp_helper_input(seqno, conn->pcb.tcp->snd_nxt, TCP_ACK | TCP_PSH, NULL, FRAME_LEN);
+    seqno += FRAME_LEN;
+    start = ticks();
+    if (!read_frame(conn, mode, i > 0 ? &allocs : &first_allocs)) {
+      break;
+    }
+    netconn_write(conn, response, sizeof(response), NETCONN_COPY);
+    if (i > 0) {
+      elapsed[forwarded++] = ticks() - start;
+    }
+    tcp_helper_input(seqno, conn->pcb.tcp->snd_nxt, TCP_ACK, NULL, 0);
+  }
+
+  qsort(elapsed, forwarded, sizeof(elapsed[0]), compare);
+  printf("%-8s %5s %6s %12.3f %10lu %10llu\n", mode_name[mode], poll ? "yes" : "no",
+         drain ? "empty" : "free", forwarded ? (double)allocs / forwarded : 0.0, forwarded,
+         forwarded ? elapsed[forwarded / 2] : 0ULL);
+
+  while (nheld > 0) {
+    memp_free(MEMP_NETBUF, held[--nheld]);
+  }
+  tcp_abort(conn->pcb.tcp);
+  netconn_delete(conn);
+}
+
+int main(void)
+{
+  enum mode mode;
+  int drain, poll;
+
+  printf("%-8s %5s %6s %12s %10s %10s   (" TICKS_UNIT ")\n", "read", "poll", "pool",
+         "netbuf/frame", "forwarded", "time");
+  for (drain = 0; drain <= 1; drain++) {
+    for (poll = 0; poll <= 1; poll++) {
+      for (mode = DELETE; mode <= INTO; mode++) {
+        bench(mode, poll, drain);
+      }
+    }
+  }
+  return 0;
+}
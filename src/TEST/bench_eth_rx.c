@@ -0,0 +1,163 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host benchmark of the Ethernet receive path: time to take a frame
+ *        from the MACB receive buffers into a chain of the pbuf pool, at
+ *        64, 512 and 1514 bytes.
+ *
+ * The MACB driver (macb.c) is included and run against the register model
+ * of zwave/avr32/io.h; the benchmark plays the DMA, writing each frame into
+ * the receive buffers and handing them over in the descriptors. The frame
+ * is then read as low_level_input() (ethernetif.c) reads it: its length,
+ * a pbuf chain from the pool, and the copy, whole buffer by whole buffer
+ * with vMACBReadBuffer() on 128 byte aligned pbufs, through vMACBRead()
+ * otherwise. Freeing the chain is not counted.
+ *
+ * The make target bench runs it with the pbuf pool of CONFIG/lwipopts.h and
+ * with the 6 pbufs of 500 bytes it had before (PBUF_POOL_LAYOUT_500). The time is
+ * in time stamp counter ticks on x86, in ns elsewhere: the lowest median of
+ * ROUNDS rounds of FRAMES frames.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "lwip/init.h"
+#include "lwip/pbuf.h"
+
+#include "macb.c"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS_UNIT "TSC"
+static unsigned long long ticks(void)
+{
+  return __rdtsc();
+}
+#else
+#define TICKS_UNIT "ns"
+static unsigned long long ticks(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+#endif
+
+#define FRAMES  20000
+#define ROUNDS  9
+
+static unsigned long long elapsed[FRAMES];
+static unsigned char frame[1514];
+
+static int compare(const void *a, const void *b)
+{
+  unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+
+  return x < y ? -1 : x > y;
+}
+
+/* The MACB receives a frame of len bytes in the buffers from ulNextRxBuffer on. */
+static void dma_receive(unsigned long len)
+{
+  unsigned long i = ulNextRxBuffer, done = 0, n;
+
+  while (done < len) {
+    n = len - done < RX_BUFFER_SIZE ? len - done : RX_BUFFER_SIZE;
+    memcpy((char *)(unsigned long)(xRxDescriptors[i].addr & ADDRESS_MASK), frame + done, n);
+    done += n;
+    xRxDescriptors[i].U_Status.status = (done == n ? AVR32_SOF : 0) |
+                                        (done == len ? AVR32_EOF | len : 0);
+    xRxDescriptors[i].addr |= AVR32_OWNERSHIP_BIT;
+    if (++i >= ETHERNET_CONF_NB_RX_BUFFERS) {
+      i = 0;
+    }
+  }
+}
+
+/* The part of low_level_input() that follows the semaphore. */
+static struct pbuf *input(void)
+{
+  struct pbuf *p, *q;
+  u16_t len;
+
+  len = ulMACBInputLength();
+  if (len == 0) {
+    return NULL;
+  }
+  p = pbuf_alloc(PBUF_RAW, len, PBUF_POOL);
+  if (p != NULL) {
+#if PBUF_POOL_BUFSIZE == MACB_RX_BUFFER_SIZE
+    for (q = p; q != NULL; q = q->next) {
+      vMACBReadBuffer(q->payload, q->len);
+    }
+#else
+    vMACBRead(NULL, 0, len);
+    for (q = p; q != NULL; q = q->next) {
+      vMACBRead(q->payload, q->len, len);
+    }
+#endif
+  }
+  return p;
+}
+
+static unsigned long long bench(unsigned long len)
+{
+  unsigned long long best = ~0ULL, start;
+  struct pbuf *p;
+  int round, i;
+
+  for (round = 0; round < ROUNDS; round++) {
+    for (i = 0; i < FRAMES; i++) {
+      dma_receive(len);
+      start = ticks();
+      p = input();
+      elapsed[i] = ticks() - start;
+      if (p == NULL || p->tot_len != len || memcmp(p->payload, frame, p->len) != 0) {
+        printf("frame of %lu bytes lost or damaged\n", len);
+        exit(1);
+      }
+      pbuf_free(p);
+    }
+    qsort(elapsed, FRAMES, sizeof(elapsed[0]), compare);
+    if (elapsed[FRAMES / 2] < best) {
+      best = elapsed[FRAMES / 2];
+    }
+  }
+  return best;
+}
+
+int main(void)
+{
+  static const unsigned long lens[] = { 64, 512, 1514 };
+  struct pbuf *held[PBUF_POOL_SIZE];
+  unsigned long long t;
+  int i, n;
+
+  for (i = 0; i < (int)sizeof(frame); i++) {
+    frame[i] = (unsigned char)(i * 7 + 1);
+  }
+  lwip_init();
+  prvSetupDescriptors(&AVR32_MACB);
+
+  /* Full-size frames the pool holds at once. */
+  for (n = 0; n < PBUF_POOL_SIZE; n++) {
+    held[n] = pbuf_alloc(PBUF_RAW, 1514, PBUF_POOL);
+    if (held[n] == NULL) {
+      break;
+    }
+  }
+  for (i = 0; i < n; i++) {
+    pbuf_free(held[i]);
+  }
+
+  printf("pbufs %d x %d bytes, %d frames of 1514 held\n", PBUF_POOL_SIZE, PBUF_POOL_BUFSIZE, n);
+  printf("%6s %10s %12s   (" TICKS_UNIT ")\n", "bytes", "per frame", "per 100 B");
+  for (i = 0; i < 3; i++) {
+    t = bench(lens[i]);
+    printf("%6lu %10llu %12.1f\n", lens[i], t, 100.0 * t / lens[i]);
+  }
+  return 0;
+}
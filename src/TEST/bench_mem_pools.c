@@ -0,0 +1,161 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host benchmark of mem_malloc() over the size classes of
+ *        CONFIG/lwippools.h (MEM_USE_POOLS) against the 3 KB heap: latency
+ *        and failure rate under mixed traffic.
+ *
+ * The requests are those of the PBUF_RAM pbufs of the board: 72 bytes of
+ * pbuf and TCP/IP/link headers (16 byte struct pbuf on the UC3) and
+ *   - 35 % pure ACKs and RSTs, no data;
+ *   - 35 % Z-Wave frames of 5 to 40 bytes copied by tcp_enqueue() with the
+ *     TCP_OVERSIZE room;
+ *   - 15 % Z-Wave frames of 5 to 64 bytes without room (UDP bridge);
+ *   - 10 % writes of 100 to 256 bytes;
+ *   - 5 % full segments of 1460 bytes.
+ * After each request blocks are freed at random until no more than a
+ * target drawn in [0, 2 x load] are held, so that about load blocks are
+ * held on average, with bursts of twice that.
+ *
+ * The make target bench runs it with the pools and with MEM_USE_POOLS 0.
+ * The time is in time stamp counter ticks on x86, in ns elsewhere; the
+ * host has no SYS_ARCH_PROTECT nor heap semaphore to take.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "lwip/init.h"
+#include "lwip/mem.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS_UNIT "TSC"
+static unsigned long long ticks(void)
+{
+  return __rdtsc();
+}
+#else
+#define TICKS_UNIT "ns"
+static unsigned long long ticks(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+#endif
+
+#define REQUESTS  200000
+#define HEADERS   72
+#define KINDS     5
+#define MAX_HELD  64
+
+static const char *kind_name[KINDS] = { "ack", "room", "frame", "256", "1460" };
+
+static unsigned long long alloc_ticks[REQUESTS], free_ticks[REQUESTS];
+
+static unsigned int next_random(unsigned int *seed)
+{
+  *seed = *seed * 1103515245 + 12345;
+  return (*seed >> 16) & 0x7FFF;
+}
+
+static int compare(const void *a, const void *b)
+{
+  unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+
+  return x < y ? -1 : x > y;
+}
+
+/* Size of a request of the mix, and its kind. */
+static mem_size_t request(unsigned int *seed, int *kind)
+{
+  unsigned int r = next_random(seed) % 100;
+  mem_size_t len;
+
+  if (r < 35) {
+    *kind = 0;
+    len = 0;
+  } else if (r < 70) {
+    *kind = 1;
+    len = 5 + next_random(seed) % 36;
+    len = LWIP_MEM_ALIGN_SIZE(len + TCP_OVERSIZE);
+  } else if (r < 85) {
+    *kind = 2;
+    len = 5 + next_random(seed) % 60;
+  } else if (r < 95) {
+    *kind = 3;
+    len = 100 + next_random(seed) % 157;
+  } else {
+    *kind = 4;
+    len = 1460;
+  }
+  return HEADERS + len;
+}
+
+static void bench(int load)
+{
+  void *held[MAX_HELD];
+  unsigned long requests[KINDS] = { 0 }, failures[KINDS] = { 0 };
+  unsigned long long start;
+  unsigned int seed = 1;
+  int nheld = 0, nalloc = 0, nfree = 0, target, kind, i;
+  mem_size_t size;
+  void *p;
+
+  lwip_init();
+  while (nalloc < REQUESTS) {
+    size = request(&seed, &kind);
+    start = ticks();
+    p = mem_malloc(size);
+    alloc_ticks[nalloc++] = ticks() - start;
+    requests[kind]++;
+    if (p == NULL) {
+      failures[kind]++;
+    } else if (nheld < MAX_HELD) {
+      held[nheld++] = p;
+    } else {
+      mem_free(p);
+    }
+
+    target = next_random(&seed) % (2 * load + 1);
+    while (nheld > target) {
+      i = next_random(&seed) % nheld;
+      start = ticks();
+      mem_free(held[i]);
+      if (nfree < REQUESTS) {
+        free_ticks[nfree++] = ticks() - start;
+      }
+      held[i] = held[--nheld];
+    }
+  }
+  while (nheld > 0) {
+    mem_free(held[--nheld]);
+  }
+
+  qsort(alloc_ticks, nalloc, sizeof(alloc_ticks[0]), compare);
+  qsort(free_ticks, nfree, sizeof(free_ticks[0]), compare);
+  printf("%5u %5d", MEM_USE_POOLS, load);
+  for (kind = 0; kind < KINDS; kind++) {
+    printf(" %6.1f", requests[kind] ? 100.0 * failures[kind] / requests[kind] : 0.0);
+  }
+  printf(" %8llu %8llu %8llu\n", alloc_ticks[nalloc / 2], alloc_ticks[nalloc * 99 / 100], free_ticks[nfree / 2]);
+}
+
+int main(void)
+{
+  int kind;
+
+  printf("%5s %5s", "pools", "load");
+  for (kind = 0; kind < KINDS; kind++) {
+    printf(" %6s", kind_name[kind]);
+  }
+  printf(" %8s %8s %8s   (failed %%, " TICKS_UNIT ")\n", "malloc", "p99", "free");
+  bench(2);
+  bench(4);
+  bench(8);
+  bench(16);
+  return 0;
+}
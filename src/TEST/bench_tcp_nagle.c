@@ -0,0 +1,143 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host benchmark of the Nagle algorithm against TF_NODELAY and
+ *        TCP_WRITE_FLAG_PUSH: round trip of the Serial API exchanges of a
+ *        simulated controller.
+ *
+ * The controller sends a request of 10 bytes. The bridge writes the ACK byte
+ * of the module 1 ms later and the response frame, 8 to 40 bytes, 5 to 30 ms
+ * after that, each in its own write, as the session does. The controller
+ * answers the response with its own ACK byte, thinks 10 to 50 ms and sends
+ * the next request. It acknowledges the segments it receives with that data
+ * or, if it has none to send, after its delayed ACK time: 40 ms as Linux
+ * does, 200 ms as Windows does. The LAN takes no time.
+ *
+ * The round trip is from the request to the last byte of the response, in
+ * whole milliseconds. With the Nagle algorithm the response waits behind the
+ * unacknowledged ACK byte until the delayed ACK of the controller.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "tcp_helper.h"
+
+#define EXCHANGES   2000
+#define REQUEST_LEN 10
+#define TIMEOUT_MS  5000
+
+enum mode { NAGLE, NODELAY, PUSH };
+
+static char data[64];
+static u32_t rtt[EXCHANGES];
+
+static unsigned int next_random(unsigned int *seed)
+{
+  *seed = *seed * 1103515245 + 12345;
+  return (*seed >> 16) & 0x7FFF;
+}
+
+static int compare(const void *a, const void *b)
+{
+  u32_t x = *(const u32_t *)a, y = *(const u32_t *)b;
+
+  return x < y ? -1 : x > y;
+}
+
+static void bench(const char *name, enum mode mode, u32_t delack_ms)
+{
+  struct tcp_pcb *pcb;
+  unsigned int seed = 1;
+  u8_t apiflags = TCP_WRITE_FLAG_COPY | (mode == PUSH ? TCP_WRITE_FLAG_PUSH : 0);
+  u32_t client_sent = 0, client_rcvd = 0, expected, ack_due = 0;
+  u32_t start, ack_at, response_at, next_request = 0;
+  u16_t response_len = 0;
+  int ack_pending = 0, n = 0, lost = 0, i;
+
+  tcp_helper_init();
+  pcb = tcp_helper_established();
+  if (mode == NODELAY) {
+    tcp_nagle_disable(pcb);
+  }
+
+  while (n + lost < EXCHANGES) {
+    /* The request, carrying the ACK of what the controller received. */
+    while (tcp_helper_now < next_request) {
+      tcp_helper_run(1);
+    }
+    tcp_helper_nsent = 0;
+    tcp_helper_input(TCP_HELPER_REMOTE_ISS + client_sent, TCP_HELPER_LOCAL_ISS + client_rcvd,
+                     TCP_ACK | TCP_PSH, NULL, REQUEST_LEN);
+    client_sent += REQUEST_LEN;
+    ack_pending = 0;
+    start = tcp_helper_now;
+    ack_at = start + 1;
+    response_at = ack_at + 5 + next_random(&seed) % 26;
+    response_len = 8 + next_random(&seed) % 33;
+    expected = client_rcvd + 1 + response_len;
+
+    while (client_rcvd < expected && tcp_helper_now - start < TIMEOUT_MS) {
+      tcp_helper_run(1);
+
+      /* The bridge. */
+      if (tcp_helper_now == ack_at) {
+        tcp_write(pcb, data, 1, apiflags);
+        tcp_output(pcb);
+      }
+      if (tcp_helper_now == response_at) {
+        tcp_write(pcb, data, response_len, apiflags);
+        tcp_output(pcb);
+      }
+
+      /* The controller. */
+      for (i = 0; i < tcp_helper_nsent && i < TCP_HELPER_MAX_SENT; i++) {
+        if (tcp_helper_sent[i].len > 0 && tcp_helper_sent[i].seqno == TCP_HELPER_LOCAL_ISS + client_rcvd) {
+          client_rcvd += tcp_helper_sent[i].len;
+          if (!ack_pending) {
+            ack_pending = 1;
+            ack_due = tcp_helper_now + delack_ms;
+          }
+        }
+      }
+      tcp_helper_nsent = 0;
+      if (client_rcvd < expected && ack_pending && tcp_helper_now >= ack_due) {
+        tcp_helper_input(TCP_HELPER_REMOTE_ISS + client_sent, TCP_HELPER_LOCAL_ISS + client_rcvd,
+                         TCP_ACK, NULL, 0);
+        ack_pending = 0;
+      }
+    }
+
+    if (client_rcvd < expected) {
+      lost++;
+      break;
+    }
+    rtt[n++] = tcp_helper_now - start;
+
+    /* The ACK byte of the controller acknowledges the response. */
+    tcp_helper_input(TCP_HELPER_REMOTE_ISS + client_sent, TCP_HELPER_LOCAL_ISS + client_rcvd,
+                     TCP_ACK | TCP_PSH, NULL, 1);
+    client_sent++;
+    ack_pending = 0;
+    next_request = tcp_helper_now + 10 + next_random(&seed) % 41;
+  }
+  tcp_abort(pcb);
+
+  qsort(rtt, n, sizeof(rtt[0]), compare);
+  printf("%-8s %10u %8u %8u %8u %8u %8u %6d\n", name, (unsigned)delack_ms,
+         (unsigned)(n ? rtt[0] : 0), (unsigned)(n ? rtt[n / 2] : 0), (unsigned)(n ? rtt[n * 9 / 10] : 0),
+         (unsigned)(n ? rtt[n * 99 / 100] : 0), (unsigned)(n ? rtt[n - 1] : 0), lost);
+}
+
+int main(void)
+{
+  printf("%-8s %10s %8s %8s %8s %8s %8s %6s\n", "mode", "delack ms", "min ms", "median", "p90",
+         "p99", "max", "stuck");
+  bench("Nagle", NAGLE, 40);
+  bench("NODELAY", NODELAY, 40);
+  bench("PUSH", PUSH, 40);
+  bench("Nagle", NAGLE, 200);
+  bench("NODELAY", NODELAY, 200);
+  bench("PUSH", PUSH, 200);
+  return 0;
+}
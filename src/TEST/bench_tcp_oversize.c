@@ -0,0 +1,85 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host benchmark of the room tcp_enqueue() allocates ahead in the last
+ *        unsent segment (TCP_OVERSIZE): segments and pbufs per byte for
+ *        bursts of small writes.
+ *
+ * Writes of 5 to 30 bytes, copied as the bridge does, are queued without
+ * tcp_output() in between until the burst is written or a write is refused;
+ * then the queue is sent and the peer acknowledges all of it. A refused
+ * write is retried in the next burst. The make target bench runs it with
+ * TCP_OVERSIZE as in CONFIG/lwipopts.h and with TCP_OVERSIZE 0.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+
+#include "tcp_helper.h"
+
+#define TOTAL_BYTES  200000UL
+
+static char data[32];
+
+static unsigned int next_random(unsigned int *seed)
+{
+  *seed = *seed * 1103515245 + 12345;
+  return (*seed >> 16) & 0x7FFF;
+}
+
+static void bench(u16_t burst)
+{
+  struct tcp_pcb *pcb;
+  unsigned int seed = 1;
+  unsigned long written = 0, writes = 0, refused = 0, segments = 0, pbufs = 0, bursts = 0;
+  u32_t acked = 0;
+  u16_t len = 0, queued;
+  int i;
+
+  tcp_helper_init();
+  pcb = tcp_helper_established();
+  tcp_nagle_disable(pcb);
+
+  while (written < TOTAL_BYTES) {
+    for (queued = 0; queued < burst; ) {
+      if (len == 0) {
+        len = 5 + next_random(&seed) % 26;
+      }
+      if (tcp_write(pcb, data, len, TCP_WRITE_FLAG_COPY) != ERR_OK) {
+        refused++;
+        break;
+      }
+      writes++;
+      written += len;
+      queued += len;
+      len = 0;
+    }
+    bursts++;
+
+    tcp_helper_nsent = 0;
+    tcp_output(pcb);
+    for (i = 0; i < tcp_helper_nsent && i < TCP_HELPER_MAX_SENT; i++) {
+      if (tcp_helper_sent[i].len > 0) {
+        segments++;
+        pbufs += tcp_helper_sent[i].pbufs;
+      }
+    }
+    acked = pcb->snd_nxt - TCP_HELPER_LOCAL_ISS;
+    tcp_helper_input(TCP_HELPER_REMOTE_ISS, TCP_HELPER_LOCAL_ISS + acked, TCP_ACK, NULL, 0);
+  }
+  tcp_abort(pcb);
+
+  printf("%6u %8u %10.1f %10.2f %10.2f %10.1f %8.1f\n", burst, TCP_OVERSIZE, (double)written / bursts,
+         1000.0 * segments / written, 1000.0 * pbufs / written, (double)written / segments,
+         100.0 * refused / writes);
+}
+
+int main(void)
+{
+  printf("%6s %8s %10s %10s %10s %10s %8s\n", "burst", "oversize", "bytes/out", "seg/KB",
+         "pbufs/KB", "bytes/seg", "refused%");
+  bench(30);
+  bench(100);
+  bench(300);
+  bench(TCP_SND_BUF);
+  return 0;
+}
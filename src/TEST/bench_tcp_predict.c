@@ -0,0 +1,133 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host benchmark of the header prediction of tcp_input()
+ *        (TCP_HEADER_PREDICTION): time per received segment of an
+ *        established connection, fast path against full path.
+ *
+ * Three streams of segments from the peer: pure ACKs of 1 byte writes of
+ * the connection, in-sequence segments of 20 bytes, as the Z-Wave frames
+ * of the controller, and of 1000 bytes. Only tcp_input() is timed, from a
+ * segment built beforehand to its return; the writes and the recv callback
+ * (tcp_recv_null()) are outside or inside it as on the board. The make
+ * target bench runs it with TCP_HEADER_PREDICTION as in CONFIG/lwipopts.h
+ * and with TCP_HEADER_PREDICTION 0.
+ *
+ * The time is in time stamp counter ticks on x86, in ns elsewhere: the
+ * median of SEGMENTS segments, after as many to warm the caches, the lowest
+ * of ROUNDS rounds so that the load of the host counts little.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "tcp_helper.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS_UNIT "TSC"
+static unsigned long long ticks(void)
+{
+  return __rdtsc();
+}
+#else
+#define TICKS_UNIT "ns"
+static unsigned long long ticks(void)
+{
+  struct timespec t;
+
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+#endif
+
+#define SEGMENTS  20000
+#define ROUNDS    9
+
+static char data[1];
+static unsigned long long elapsed[SEGMENTS];
+
+static int compare(const void *a, const void *b)
+{
+  unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+
+  return x < y ? -1 : x > y;
+}
+
+/* Median of the round. */
+static unsigned long long median(void)
+{
+  qsort(elapsed, SEGMENTS, sizeof(elapsed[0]), compare);
+  return elapsed[SEGMENTS / 2];
+}
+
+/* Pure ACKs, each of the byte written before it. */
+static unsigned long long bench_acks(void)
+{
+  struct tcp_pcb *pcb;
+  struct pbuf *p;
+  unsigned long long start;
+  int i;
+
+  tcp_helper_init();
+  pcb = tcp_helper_established();
+  tcp_nagle_disable(pcb);
+  for (i = -SEGMENTS; i < SEGMENTS; i++) {
+    tcp_write(pcb, data, 1, TCP_WRITE_FLAG_COPY);
+    tcp_output(pcb);
+    tcp_helper_nsent = 0;
+    p = tcp_helper_segment(TCP_HELPER_REMOTE_ISS, pcb->snd_nxt, TCP_ACK, NULL, 0);
+    start = ticks();
+    tcp_input(p, netif_default);
+    if (i >= 0) {
+      elapsed[i] = ticks() - start;
+    }
+  }
+  tcp_abort(pcb);
+  return median();
+}
+
+/* In-sequence data of len bytes, acknowledging nothing new. */
+static unsigned long long bench_data(u16_t len)
+{
+  struct tcp_pcb *pcb;
+  struct pbuf *p;
+  unsigned long long start;
+  u32_t seqno = TCP_HELPER_REMOTE_ISS;
+  int i;
+
+  tcp_helper_init();
+  pcb = tcp_helper_established();
+  for (i = -SEGMENTS; i < SEGMENTS; i++) {
+    tcp_helper_nsent = 0;
+    p = tcp_helper_segment(seqno, TCP_HELPER_LOCAL_ISS, TCP_ACK | TCP_PSH, NULL, len);
+    start = ticks();
+    tcp_input(p, netif_default);
+    if (i >= 0) {
+      elapsed[i] = ticks() - start;
+    }
+    seqno += len;
+  }
+  tcp_abort(pcb);
+  return median();
+}
+
+int main(void)
+{
+  unsigned long long best[3] = { ~0ULL, ~0ULL, ~0ULL }, t;
+  int round;
+
+  for (round = 0; round < ROUNDS; round++) {
+    t = bench_acks();
+    best[0] = t < best[0] ? t : best[0];
+    t = bench_data(20);
+    best[1] = t < best[1] ? t : best[1];
+    t = bench_data(1000);
+    best[2] = t < best[2] ? t : best[2];
+  }
+  printf("%-10s %10s %10s %10s %10s   (" TICKS_UNIT " per segment)\n", "predict", "pure ACK",
+         "data 20", "data 1000", "");
+  printf("%-10u %10llu %10llu %10llu\n", TCP_HEADER_PREDICTION, best[0], best[1], best[2]);
+  return 0;
+}
@@ -0,0 +1,251 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host benchmark of the Z-Wave bridges on TCP, netconn (ZWaveTCP.c)
+ *        and raw API (ZWaveRaw.c), and on UDP (ZWaveUDP.c): time per
+ *        request/response round trip, messages to the lwIP task and packets
+ *        sent.
+ *
+ * The controller sends a request of FRAME_LEN bytes, the bridge puts it in
+ * zw_tcp_recv_queue, the serial side takes it and puts a response of as
+ * many bytes in usart_recv_queue, the bridge sends it to the controller,
+ * which acknowledges it. The serial side is the same for every bridge and
+ * kicks the raw and UDP ones as uart_task.c does. The raw and UDP bridges
+ * are those of ZWaveRaw.c and ZWaveUDP.c. The netconn side makes the calls
+ * the session of ZWaveTCP.c makes for a frame: netconn_recv_into() and a
+ * NETCONN_DONTBLOCK write. On UDP the request and the response are a DATA
+ * datagram each, acknowledged by an ACK one.
+ *
+ * On the host the lwIP task runs every message at once (api/api_helper.c),
+ * so the time is the CPU of the whole exchange, stack included, without
+ * what the messages cost on the board: a netconn call is a post to the
+ * mbox of the lwIP task and a semaphore the calling task waits on, two
+ * context switches; a tcpip_callback() is a post and one switch to the
+ * lwIP task. Hence the messages counted per frame.
+ *
+ * The time is in time stamp counter ticks on x86, in ns elsewhere: the
+ * lowest median of ROUNDS rounds of FRAMES frames.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/* Instead of the netconn bridge of zwave/conf_lwip_threads.h, one bridge
+   after the other. */
+#define zwaveBRIDGE_API  zwaveBRIDGE_RAW
+
+#include "api_helper.h"
+#include "zwave_helper.h"
+#include "ZWaveTCP.h"
+
+/* The bridges listen where the controller of tcp_helper connects. */
+#undef zwavePORT
+#define zwavePORT  TCP_HELPER_LOCAL_PORT
+#include "ZWaveRaw.c"
+
+#undef zwaveBRIDGE_API
+#define zwaveBRIDGE_API  zwaveBRIDGE_UDP
+#include "ZWaveUDP.c"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TICKS_UNIT "TSC"
+static unsigned long long ticks(void)
+{
+	return __rdtsc();
+}
+#else
+#define TICKS_UNIT "ns"
+static unsigned long long ticks(void)
+{
+	struct timespec t;
+
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1000000000ULL + t.tv_nsec;
+}
+#endif
+
+#define FRAMES     5000
+#define ROUNDS     9
+#define FRAME_LEN  10
+
+enum bridge { NETCONN, RAW, UDP, BRIDGES };
+
+static const char *bridge_name[BRIDGES] = { "netconn", "raw", "udp" };
+
+/* zwaveRECV_CHUNK of ZWaveTCP.c. */
+#define RECV_CHUNK  64
+
+static unsigned long long elapsed[FRAMES];
+
+static int compare(const void *a, const void *b)
+{
+	unsigned long long x = *(const unsigned long long *)a, y = *(const unsigned long long *)b;
+
+	return x < y ? -1 : x > y;
+}
+
+/* The serial task: takes the request, the module answers with a Serial API
+   frame of FRAME_LEN bytes. */
+static void serial_side(enum bridge bridge)
+{
+	static const unsigned char response[FRAME_LEN] = { 0x01, FRAME_LEN - 2, 0x01, 0x13 };
+	unsigned char c;
+	int taken = 0, i;
+
+	while (xQueueReceive(zw_tcp_recv_queue, &c, 0) == pdPASS)
+		taken++;
+	if (bridge == RAW && taken > 0)
+		vZwaveRawKick();
+	if (taken != FRAME_LEN) {
+		printf("%d bytes of the request on the serial side\n", taken);
+		exit(1);
+	}
+	for (i = 0; i < FRAME_LEN; i++)
+		xQueueSend(usart_recv_queue, &response[i], 0);
+	if (bridge == RAW)
+		vZwaveRawKick();
+	else if (bridge == UDP)
+		vZwaveUdpKick();
+}
+
+/* The netconn session of ZWaveTCP.c, for one frame. */
+static void netconn_side(struct netconn *conn)
+{
+	char rx[RECV_CHUNK], tx[FRAME_LEN];
+	u16_t len, i;
+	size_t written;
+
+	len = netconn_recv_into(conn, rx, sizeof(rx));
+	for (i = 0; i < len; i++)
+		xQueueSend(zw_tcp_recv_queue, &rx[i], 0);
+	serial_side(NETCONN);
+	for (len = 0; len < sizeof(tx) && xQueueReceive(usart_recv_queue, &tx[len], 0) == pdPASS; len++)
+		;
+	netconn_write_partly(conn, tx, len, NETCONN_COPY | NETCONN_DONTBLOCK | NETCONN_PUSH, &written);
+}
+
+/* Sequence number of the next DATA of the controller: the UDP bridge keeps
+   its session from a round to the next. */
+static u8_t udp_seq;
+
+/* The controller sends a request in a DATA datagram, acknowledges the one
+   of the response. */
+static void udp_side(void)
+{
+	u8_t request[zwaveUDP_HEADER_SIZE + FRAME_LEN] = { zwaveUDP_DATA };
+	u8_t ack[zwaveUDP_HEADER_SIZE] = { zwaveUDP_ACK };
+
+	request[1] = udp_seq++;
+	tcp_helper_udp_input(zwavePORT, request, sizeof(request));
+	serial_side(UDP);
+	/* After the ACK of the request. */
+	if (tcp_helper_udp_nsent > 0)
+		ack[1] = tcp_helper_udp_sent[tcp_helper_udp_nsent - 1].data[1];
+	tcp_helper_udp_input(zwavePORT, ack, sizeof(ack));
+}
+
+/* Bytes of the response sent: a window update or the ACK of the request
+   may come before it. */
+static int response_sent(enum bridge bridge)
+{
+	int sent = 0, i;
+
+	if (bridge == UDP) {
+		for (i = 0; i < tcp_helper_udp_nsent; i++)
+			if (tcp_helper_udp_sent[i].data[0] == zwaveUDP_DATA)
+				sent += tcp_helper_udp_sent[i].len - zwaveUDP_HEADER_SIZE;
+	} else {
+		for (i = 0; i < tcp_helper_nsent; i++)
+			sent += tcp_helper_sent[i].len;
+	}
+	return sent;
+}
+
+static void bench(enum bridge bridge, unsigned long long *best, double *apimsgs, double *callbacks,
+		double *packets)
+{
+	struct netconn *conn = NULL;
+	struct tcp_pcb *pcb = NULL;
+	unsigned long long start;
+	unsigned long npackets = 0;
+	u32_t seqno = TCP_HELPER_REMOTE_ISS;
+	int i;
+
+	tcp_helper_init();
+	usart_recv_queue = xQueueCreate(zwaveRECV_QUEUE_LENGTH, 1);
+	if (bridge == UDP) {
+		vZwaveUdpInit(NULL);
+	} else {
+		zw_tcp_recv_queue = xQueueCreate(zwaveRECV_QUEUE_LENGTH, 1);
+		if (bridge == RAW) {
+			vZwaveRawInit(NULL);
+			tcp_helper_connect();
+			pcb = pxZwaveRawPcb;
+		} else {
+			conn = api_helper_accepted();
+			netconn_set_nodelay(conn, zwaveNODELAY);
+			pcb = conn->pcb.tcp;
+		}
+	}
+	api_helper_apimsgs = api_helper_callbacks = 0;
+
+	for (i = 0; i < FRAMES; i++) {
+		tcp_helper_nsent = tcp_helper_udp_nsent = 0;
+		start = ticks();
+		if (bridge == UDP) {
+			udp_side();
+		} else {
+			tcp_helper_input(seqno, pcb->snd_nxt, TCP_ACK | TCP_PSH, NULL, FRAME_LEN);
+			seqno += FRAME_LEN;
+			if (bridge == RAW)
+				serial_side(RAW);
+			else
+				netconn_side(conn);
+			tcp_helper_input(seqno, pcb->snd_nxt, TCP_ACK, NULL, 0);
+		}
+		elapsed[i] = ticks() - start;
+		npackets += tcp_helper_nsent + tcp_helper_udp_nsent;
+		if (response_sent(bridge) != FRAME_LEN || (pcb != NULL && pcb->snd_nxt != pcb->lastack)) {
+			printf("%s: response of frame %d not sent\n", bridge_name[bridge], i);
+			exit(1);
+		}
+	}
+
+	qsort(elapsed, FRAMES, sizeof(elapsed[0]), compare);
+	if (elapsed[FRAMES / 2] < *best)
+		*best = elapsed[FRAMES / 2];
+	*apimsgs = (double)api_helper_apimsgs / FRAMES;
+	*callbacks = (double)api_helper_callbacks / FRAMES;
+	*packets = (double)npackets / FRAMES;
+
+	if (bridge == UDP) {
+		udp_remove(pxZwaveUdpPcb);
+	} else {
+		tcp_abort(pcb);
+		if (bridge == RAW)
+			tcp_close(pxZwaveRawListener);
+		else
+			netconn_delete(conn);
+	}
+}
+
+int main(void)
+{
+	unsigned long long best[BRIDGES] = { ~0ULL, ~0ULL, ~0ULL };
+	double apimsgs[BRIDGES], callbacks[BRIDGES], packets[BRIDGES];
+	enum bridge bridge;
+	int round;
+
+	for (round = 0; round < ROUNDS; round++)
+		for (bridge = NETCONN; bridge < BRIDGES; bridge++)
+			bench(bridge, &best[bridge], &apimsgs[bridge], &callbacks[bridge], &packets[bridge]);
+
+	printf("%-8s %10s %10s %10s %10s   (" TICKS_UNIT ", messages and packets sent per frame)\n", "bridge",
+			"time", "netconn", "callback", "packets");
+	for (bridge = NETCONN; bridge < BRIDGES; bridge++)
+		printf("%-8s %10llu %10.2f %10.2f %10.2f\n", bridge_name[bridge], best[bridge], apimsgs[bridge],
+				callbacks[bridge], packets[bridge]);
+	return 0;
+}
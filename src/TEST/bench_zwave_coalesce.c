@@ -0,0 +1,169 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host benchmark of the coalescing policies (ZWaveCoalesce.c):
+ *        segments per second and latency of the serial bytes, per policy.
+ *
+ * A simulated Z-Wave module answers at 115200 baud, without end: an ACK,
+ * 2 ms later a response frame of 8 to 40 bytes, then 5 to 30 ms of silence.
+ * The time stamp of each byte is taken when it arrives, as the USART
+ * interrupt does. The session of the netconn bridge (ZWaveTCP.c) is
+ * simulated as it runs: it takes the bytes that arrived when it wakes up,
+ * sends what the policy releases, and sleeps for xZwaveCoalesceWait() ticks,
+ * zwaveRECV_TIMEOUT at most. The controller sends nothing and every write
+ * is taken whole.
+ *
+ * Latency is from the arrival of a byte to the write of its segment.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <string.h>
+
+#include "zwave_helper.h"
+#include "ZWaveCoalesce.h"
+
+#define SIMULATED_US     ( 60ULL * 1000000 )
+#define BYTE_US          ( 10ULL * 1000000 / 115200 )
+#define RECV_TIMEOUT_MS  ( 10 )
+#define BUFFER_SIZE      ( zwaveFRAME_MAX_SIZE )
+
+/* Arrival times of the bytes not taken by the session yet. */
+#define MAX_PENDING      1024
+
+struct stream
+{
+	unsigned long long next_us;   /* arrival of the next byte */
+	unsigned int seed;
+	int left;                     /* bytes of the frame being sent */
+	int frame_len;
+	int after_ack;                /* the response follows the ACK */
+	int frame_end;                /* the last byte returned ends a frame */
+};
+
+static unsigned int next_random(unsigned int *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return (*seed >> 16) & 0x7FFF;
+}
+
+/* Next byte of the module, and when it arrives. */
+static unsigned char stream_byte(struct stream *s, unsigned long long *at)
+{
+	unsigned char b;
+
+	*at = s->next_us;
+	s->next_us += BYTE_US;
+	if (s->left == 0) {
+		if (!s->after_ack) {
+			s->after_ack = 1;
+			s->frame_end = 1;
+			s->next_us += 2000;
+			return zwaveFRAME_ACK;
+		}
+		s->after_ack = 0;
+		s->frame_len = 8 + next_random(&s->seed) % 33;
+		s->left = s->frame_len;
+	}
+	s->left--;
+	if (s->left == s->frame_len - 1) {
+		b = zwaveFRAME_SOF;
+	} else if (s->left == s->frame_len - 2) {
+		b = (unsigned char)(s->frame_len - 2);
+	} else {
+		b = 0x55;
+	}
+	s->frame_end = (s->left == 0);
+	if (s->frame_end) {
+		s->next_us += 5000 + 1000ULL * (next_random(&s->seed) % 26);
+	}
+	return b;
+}
+
+static void bench(const char *name, unsigned char policy, unsigned short param)
+{
+	struct stream s = { 1000, 1, 0, 0, 0, 0 };
+	xZwaveCoalesce c;
+	unsigned long long arrival[MAX_PENDING], held_at[BUFFER_SIZE];
+	unsigned char pending_byte[MAX_PENDING], pending_end[MAX_PENDING];
+	unsigned char held_end[BUFFER_SIZE];
+	unsigned long long now = 0, next_at, latency, sum_latency = 0, max_latency = 0;
+	unsigned long segments = 0, bytes = 0, split = 0;
+	int npending = 0, nheld = 0, i;
+	unsigned short ready;
+	portTickType wait;
+	unsigned char b;
+
+	zwave_helper_set_time(0);
+	vZwaveCoalesceInit(&c, policy, param);
+	b = stream_byte(&s, &next_at);
+
+	while (now < SIMULATED_US) {
+		/* The bytes arrived meanwhile, stamped on arrival. */
+		while (next_at <= now && npending < MAX_PENDING) {
+			zwave_helper_set_time(next_at);
+			vZwaveCoalesceStampFromISR();
+			arrival[npending] = next_at;
+			pending_byte[npending] = b;
+			pending_end[npending] = s.frame_end;
+			npending++;
+			b = stream_byte(&s, &next_at);
+		}
+		zwave_helper_set_time(now);
+
+		/* The session: take what fits, send what is released. */
+		for (i = 0; i < npending && nheld < BUFFER_SIZE; i++) {
+			vZwaveCoalesceAdd(&c, pending_byte[i]);
+			held_at[nheld] = arrival[i];
+			held_end[nheld] = pending_end[i];
+			nheld++;
+		}
+		npending -= i;
+		memmove(arrival, arrival + i, npending * sizeof(arrival[0]));
+		memmove(pending_byte, pending_byte + i, npending);
+		memmove(pending_end, pending_end + i, npending);
+
+		ready = usZwaveCoalesceReady(&c, BUFFER_SIZE);
+		if (ready > 0) {
+			segments++;
+			bytes += ready;
+			if (!held_end[ready - 1]) {
+				split++;
+			}
+			for (i = 0; i < ready; i++) {
+				latency = now - held_at[i];
+				sum_latency += latency;
+				if (latency > max_latency) {
+					max_latency = latency;
+				}
+			}
+			vZwaveCoalesceSent(&c, ready);
+			nheld -= ready;
+			memmove(held_at, held_at + ready, nheld * sizeof(held_at[0]));
+			memmove(held_end, held_end + ready, nheld);
+		}
+
+		wait = xZwaveCoalesceWait(&c);
+		if (wait > RECV_TIMEOUT_MS / portTICK_RATE_MS) {
+			wait = RECV_TIMEOUT_MS / portTICK_RATE_MS;
+		}
+		/* Woken on a tick. */
+		now = (now / 1000 + wait * portTICK_RATE_MS) * 1000;
+	}
+
+	printf("%-12s %10.1f %10.1f %10.2f %10.2f %10lu\n", name,
+	       segments / (SIMULATED_US / 1e6), bytes ? (double)bytes / segments : 0.0,
+	       bytes ? sum_latency / 1000.0 / bytes : 0.0, max_latency / 1000.0, split);
+}
+
+int main(void)
+{
+	printf("%-12s %10s %10s %10s %10s %10s\n", "policy", "segments/s", "bytes/seg",
+	       "mean ms", "max ms", "split");
+	bench("NONE", zwaveCOALESCE_NONE, 0);
+	bench("FRAME", zwaveCOALESCE_FRAME, 0);
+	bench("SIZE 32", zwaveCOALESCE_SIZE, 32);
+	bench("SIZE 128", zwaveCOALESCE_SIZE, 128);
+	bench("GAP 500us", zwaveCOALESCE_GAP, 500);
+	bench("GAP 3000us", zwaveCOALESCE_GAP, 3000);
+	return 0;
+}
@@ -0,0 +1,196 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host benchmark of the receive side of the serial task (uart_task.c):
+ *        how late the bytes of the Z-Wave module reach usart_recv_queue, and
+ *        how well the idle time of the line is known when they do.
+ *
+ * The module answers at 115200 baud, without end, as in
+ * bench_zwave_coalesce.c: an ACK, 2 ms later a response frame of 8 to 40
+ * bytes, then 5 to 30 ms of silence. The USART of the register model raises
+ * RXRDY at the end of each byte and TIMEOUT USART_RX_TIMEOUT_BITS bit
+ * periods after the last one once restarted (STTTO), as the UC3A does. The
+ * interrupt and the drain are those of uart_task.c; the serial task is
+ * woken at once by usart_rx_burst, or polls every 10 ms.
+ *
+ * - "TIMEOUT": the receiver time-out ends each burst, as in the firmware.
+ * - "poll": TIMEOUT masked, the bytes only go at the 10 ms poll or at half a
+ *   ring: the serial task before the receiver time-out.
+ *
+ * Latency is from the arrival of the last byte of a frame to its drain. The
+ * idle error is ulZwaveCoalesceIdle() right after a drain against the true
+ * idle time of the line, with the stamp of the interrupt ("isr") and with
+ * a stamp taken in the drain ("drain"), as before.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+
+#include "zwave_helper.h"
+#include "uart_task.c"
+
+#define SIMULATED_US     ( 60ULL * 1000000 )
+#define BAUDRATE         115200
+#define POLL_MS          10
+#define NEVER            ( ~0ULL )
+
+/* Arrival of the bytes not drained yet. */
+#define MAX_PENDING      1024
+
+struct stream
+{
+	unsigned long long next_us;   /* arrival of the next byte */
+	unsigned long byte_us;
+	unsigned int seed;
+	int left;                     /* bytes of the frame being sent */
+	int frame_len;
+	int after_ack;                /* the response follows the ACK */
+	int frame_end;                /* the last byte returned ends a frame */
+};
+
+static unsigned int next_random(unsigned int *seed)
+{
+	*seed = *seed * 1103515245 + 12345;
+	return (*seed >> 16) & 0x7FFF;
+}
+
+/* Next byte of the module, and when it arrives. */
+static unsigned char stream_byte(struct stream *s, unsigned long long *at)
+{
+	*at = s->next_us;
+	s->next_us += s->byte_us;
+	if (s->left == 0) {
+		if (!s->after_ack) {
+			s->after_ack = 1;
+			s->frame_end = 1;
+			s->next_us += 2000;
+			return 0x06;
+		}
+		s->after_ack = 0;
+		s->frame_len = 8 + next_random(&s->seed) % 33;
+		s->left = s->frame_len;
+	}
+	s->left--;
+	s->frame_end = (s->left == 0);
+	if (s->frame_end) {
+		s->next_us += 5000 + 1000ULL * (next_random(&s->seed) % 26);
+	}
+	return 0x55;
+}
+
+static void serial_open(unsigned long imr)
+{
+	usart_rx_head = usart_rx_tail = 0;
+	zwave_helper_usart.imr = 0;
+	usart_init_rs232(EXAMPLE_USART, &USART_OPTIONS, EXAMPLE_TARGET_PBACLK_FREQ_HZ);
+	zwave_helper_usart_update();
+	usart_recv_queue = xQueueCreate(USART_RECV_QUEUE_LENGTH, 1);
+	vSemaphoreCreateBinary(usart_rx_burst);
+	xSemaphoreTake(usart_rx_burst, 0);
+	vSemaphoreCreateBinary(usart_tx_done);
+	xSerialSetBaudrate(BAUDRATE, 0);
+	usart_set_rx_timeout(EXAMPLE_USART, USART_RX_TIMEOUT_BITS);
+	EXAMPLE_USART->ier = imr;
+	zwave_helper_usart_update();
+}
+
+static void bench(const char *name, unsigned long imr)
+{
+	struct stream s = { 1000, 0, 1, 0, 0, 0, 0 };
+	unsigned long long arrival[MAX_PENDING], next_at, timeout_at = NEVER, wake_at;
+	unsigned char ends[MAX_PENDING];
+	unsigned long long now, last_us = 0, latency, sum_latency = 0, max_latency = 0;
+	unsigned long long idle, isr_error, max_isr_error = 0, sum_drain_error = 0, max_drain_error = 0;
+	unsigned long actual, timeout_us, frames = 0, drains = 0;
+	int npending = 0, armed = 1, head = 0;
+	unsigned char b, c;
+
+	zwave_helper_set_time(0);
+	serial_open(imr);
+	actual = ulSerialGetBaudrate(NULL);
+	s.byte_us = (10UL * 1000000 + actual / 2) / actual;
+	timeout_us = (USART_RX_TIMEOUT_BITS * 1000000UL + actual / 2) / actual;
+	b = stream_byte(&s, &next_at);
+	wake_at = POLL_MS * 1000;
+
+	while ((now = next_at < wake_at ? next_at : wake_at) < SIMULATED_US) {
+		if (timeout_at < now) {
+			now = timeout_at;
+		}
+		zwave_helper_set_time(now);
+
+		if (now == timeout_at) {
+			/* RTOR bit periods of silence. */
+			timeout_at = NEVER;
+			zwave_helper_usart.csr |= AVR32_USART_CSR_TIMEOUT_MASK;
+			if (usart_isr_non_naked_behaviour()) {
+				wake_at = now;
+			}
+			zwave_helper_usart.csr &= ~AVR32_USART_CSR_TIMEOUT_MASK;
+			armed = zwave_helper_usart_update() == AVR32_USART_CR_STTTO_MASK;
+		} else if (now == next_at) {
+			zwave_helper_usart.rhr = b;
+			zwave_helper_usart.csr |= AVR32_USART_CSR_RXRDY_MASK;
+			if (usart_isr_non_naked_behaviour()) {
+				wake_at = now;
+			}
+			zwave_helper_usart.csr &= ~AVR32_USART_CSR_RXRDY_MASK;
+			if (armed && (zwave_helper_usart.imr & AVR32_USART_CSR_TIMEOUT_MASK)) {
+				timeout_at = now + timeout_us;
+			}
+			if (npending < MAX_PENDING) {
+				arrival[(head + npending) % MAX_PENDING] = now;
+				ends[(head + npending) % MAX_PENDING] = s.frame_end;
+				npending++;
+			}
+			last_us = now;
+			b = stream_byte(&s, &next_at);
+		} else {
+			/* The serial task: woken by usart_rx_burst or at the poll. */
+			xSemaphoreTake(usart_rx_burst, 0);
+			usart_rx_drain();
+			if (uxQueueMessagesWaiting(usart_recv_queue) > 0) {
+				drains++;
+				while (xQueueReceive(usart_recv_queue, &c, 0) == pdPASS && npending > 0) {
+					if (ends[head]) {
+						frames++;
+						latency = now - arrival[head];
+						sum_latency += latency;
+						if (latency > max_latency) {
+							max_latency = latency;
+						}
+					}
+					head = (head + 1) % MAX_PENDING;
+					npending--;
+				}
+				idle = now - last_us;
+				isr_error = ulZwaveCoalesceIdle() > idle ? ulZwaveCoalesceIdle() - idle
+				                                         : idle - ulZwaveCoalesceIdle();
+				if (isr_error > max_isr_error) {
+					max_isr_error = isr_error;
+				}
+				/* Stamped in the drain, the idle time would read 0. */
+				sum_drain_error += idle;
+				if (idle > max_drain_error) {
+					max_drain_error = idle;
+				}
+			}
+			wake_at = (now / 1000 + POLL_MS) * 1000;
+		}
+	}
+
+	printf("%-8s %10.1f %10.2f %10.2f %12llu %12.1f %12llu\n", name,
+	       drains / (SIMULATED_US / 1e6), sum_latency / 1000.0 / frames, max_latency / 1000.0,
+	       max_isr_error, (double)sum_drain_error / drains, max_drain_error);
+}
+
+int main(void)
+{
+	unsigned long rx = AVR32_USART_IER_RXRDY_MASK | AVR32_USART_IER_OVRE_MASK |
+	                   AVR32_USART_IER_FRAME_MASK | AVR32_USART_IER_PARE_MASK;
+
+	printf("%-8s %10s %10s %10s %12s %12s %12s\n", "", "drains/s", "mean ms", "max ms",
+	       "isr max us", "drain mean us", "drain max us");
+	bench("TIMEOUT", rx | AVR32_USART_IER_TIMEOUT_MASK);
+	bench("poll", rx);
+	return 0;
+}
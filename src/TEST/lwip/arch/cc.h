@@ -0,0 +1,46 @@
+/*! \file *********************************************************************
+ *
+ * \brief lwIP compiler and platform definitions of the host tests.
+ *
+ *****************************************************************************/
+
+#ifndef __ARCH_CC_H__
+#define __ARCH_CC_H__
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifndef BYTE_ORDER
+#define BYTE_ORDER LITTLE_ENDIAN
+#endif /* BYTE_ORDER */
+
+typedef uint8_t    u8_t;
+typedef int8_t     s8_t;
+typedef uint16_t   u16_t;
+typedef int16_t    s16_t;
+typedef uint32_t   u32_t;
+typedef int32_t    s32_t;
+
+typedef uintptr_t mem_ptr_t;
+
+#define U16_F "hu"
+#define S16_F "hd"
+#define X16_F "hx"
+#define U32_F "u"
+#define S32_F "d"
+#define X32_F "x"
+
+#define PACK_STRUCT_FIELD(x) x
+#define PACK_STRUCT_STRUCT __attribute__ ((__packed__))
+#define PACK_STRUCT_BEGIN
+#define PACK_STRUCT_END
+
+#define LWIP_PLATFORM_DIAG(x) do { printf x; } while (0)
+
+#define LWIP_PLATFORM_ASSERT(x) do { printf("lwIP assertion \"%s\" failed at line %d in %s\n", x, __LINE__, __FILE__); \
+                                     fflush(NULL); abort(); } while (0)
+
+#define LWIP_PROVIDE_ERRNO
+
+#endif /* __ARCH_CC_H__ */
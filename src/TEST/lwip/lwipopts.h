@@ -0,0 +1,63 @@
+/*! \file *********************************************************************
+ *
+ * \brief lwIP options of the host tests: the raw TCP core, NO_SYS, with the
+ *        TCP options of CONFIG/lwipopts.h.
+ *
+ *****************************************************************************/
+
+#ifndef __LWIPOPTS_H__
+#define __LWIPOPTS_H__
+
+#define NO_SYS                  1
+#define SYS_LIGHTWEIGHT_PROT    0
+#define LWIP_NETCONN            0
+#define LWIP_SOCKET             0
+#define LWIP_ARP                0
+#define ARP_QUEUEING            0
+#define LWIP_ICMP               0
+#define LWIP_UDP                0
+#define LWIP_DHCP               0
+#define LWIP_RAW                0
+#define IP_REASSEMBLY           0
+#define IP_FRAG                 0
+#define LWIP_STATS              1
+
+#define MEM_ALIGNMENT           4
+#define MEM_SIZE                16 * 1024
+#define MEMP_NUM_PBUF           16
+#define MEMP_NUM_TCP_PCB        4
+#define MEMP_NUM_TCP_PCB_LISTEN 2
+#define MEMP_NUM_TCP_SEG        32
+#define PBUF_POOL_SIZE          16
+#define PBUF_POOL_BUFSIZE       1600
+
+/* The segments are handed to tcp_input() by the tests, without checksums. */
+#define CHECKSUM_GEN_TCP        0
+#define CHECKSUM_CHECK_TCP      0
+#define CHECKSUM_GEN_IP         0
+#define CHECKSUM_CHECK_IP       0
+
+/* As in CONFIG/lwipopts.h. */
+#define LWIP_TCP                1
+#define TCP_WND                 1500
+#define TCP_QUEUE_OOSEQ         1
+#define TCP_MSS                 1500
+#define TCP_SND_BUF             2150
+#define TCP_SND_QUEUELEN        6 * TCP_SND_BUF/TCP_MSS
+/* The benchmarks are run without it too: see VARIANTS in the Makefile. */
+#ifndef TCP_OVERSIZE
+#define TCP_OVERSIZE            128
+#endif
+#define LWIP_TCP_HIRES_RTO      1
+#define TCP_RTO_TMR_INTERVAL    10
+#define TCP_MIN_RTO             40
+#define TCP_INITIAL_RTO         1000
+#ifndef TCP_HEADER_PREDICTION
+#define TCP_HEADER_PREDICTION   1
+#endif
+#define TCP_PCB_RECYCLE         1
+#define TCP_MAXRTX              12
+#define TCP_SYNMAXRTX           4
+#define LWIP_TCP_KEEPALIVE      1
+
+#endif /* __LWIPOPTS_H__ */
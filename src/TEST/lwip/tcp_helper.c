@@ -0,0 +1,223 @@
+/*! \file *********************************************************************
+ *
+ * \brief Drives the lwIP TCP core on the host.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "lwip/init.h"
+#include "lwip/ip.h"
+#include "lwip/netif.h"
+#include "lwip/tcp.h"
+#include "lwip/udp.h"
+
+#include "tcp_helper.h"
+
+struct tcp_helper_seg tcp_helper_sent[TCP_HELPER_MAX_SENT];
+int tcp_helper_nsent;
+u16_t tcp_helper_remote_port;
+u32_t tcp_helper_now;
+#if LWIP_UDP
+struct tcp_helper_udp tcp_helper_udp_sent[TCP_HELPER_MAX_UDP];
+int tcp_helper_udp_nsent;
+#endif
+
+static struct netif helper_netif;
+static struct ip_addr local_ip, remote_ip, netmask;
+
+u32_t sys_now(void)
+{
+  return tcp_helper_now;
+}
+
+static err_t helper_output(struct netif *netif, struct pbuf *p, struct ip_addr *ipaddr)
+{
+  struct ip_hdr iphdr;
+  struct tcp_hdr tcphdr;
+  struct tcp_helper_seg *seg;
+  u16_t iphl;
+
+  LWIP_UNUSED_ARG(netif);
+  LWIP_UNUSED_ARG(ipaddr);
+
+  pbuf_copy_partial(p, &iphdr, sizeof(iphdr), 0);
+  iphl = IPH_HL(&iphdr) * 4;
+#if LWIP_UDP
+  if (IPH_PROTO(&iphdr) == IP_PROTO_UDP) {
+    struct udp_hdr udphdr;
+    struct tcp_helper_udp *dgram;
+
+    pbuf_copy_partial(p, &udphdr, sizeof(udphdr), iphl);
+    if (tcp_helper_udp_nsent < TCP_HELPER_MAX_UDP) {
+      dgram = &tcp_helper_udp_sent[tcp_helper_udp_nsent];
+      dgram->dest = ntohs(udphdr.dest);
+      dgram->len = p->tot_len - iphl - UDP_HLEN;
+      memset(dgram->data, 0, sizeof(dgram->data));
+      pbuf_copy_partial(p, dgram->data, sizeof(dgram->data), iphl + UDP_HLEN);
+    }
+    tcp_helper_udp_nsent++;
+    return ERR_OK;
+  }
+#endif
+  pbuf_copy_partial(p, &tcphdr, sizeof(tcphdr), iphl);
+
+  if (tcp_helper_nsent < TCP_HELPER_MAX_SENT) {
+    seg = &tcp_helper_sent[tcp_helper_nsent];
+    seg->seqno = ntohl(tcphdr.seqno);
+    seg->ackno = ntohl(tcphdr.ackno);
+    seg->flags = TCPH_FLAGS(&tcphdr);
+    seg->len = p->tot_len - iphl - TCPH_HDRLEN(&tcphdr) * 4;
+    seg->wnd = ntohs(tcphdr.wnd);
+    seg->pbufs = pbuf_clen(p);
+  }
+  tcp_helper_nsent++;
+  return ERR_OK;
+}
+
+static err_t helper_netif_init(struct netif *netif)
+{
+  netif->output = helper_output;
+  netif->mtu = 1500;
+  netif->flags = NETIF_FLAG_UP;
+  return ERR_OK;
+}
+
+void tcp_helper_init(void)
+{
+  lwip_init();
+  IP4_ADDR(&local_ip, 192, 168, 0, 1);
+  IP4_ADDR(&remote_ip, 192, 168, 0, 2);
+  IP4_ADDR(&netmask, 255, 255, 255, 0);
+  netif_add(&helper_netif, &local_ip, &netmask, &remote_ip, NULL, helper_netif_init, ip_input);
+  netif_set_default(&helper_netif);
+  netif_set_up(&helper_netif);
+  tcp_helper_nsent = 0;
+#if LWIP_UDP
+  tcp_helper_udp_nsent = 0;
+#endif
+  tcp_helper_remote_port = TCP_HELPER_REMOTE_PORT;
+  tcp_helper_now = 0;
+}
+
+struct tcp_pcb *tcp_helper_established(void)
+{
+  struct tcp_pcb *pcb = tcp_new();
+
+  LWIP_ASSERT("tcp_new", pcb != NULL);
+  ip_addr_set(&pcb->local_ip, &local_ip);
+  ip_addr_set(&pcb->remote_ip, &remote_ip);
+  pcb->local_port = TCP_HELPER_LOCAL_PORT;
+  pcb->remote_port = tcp_helper_remote_port;
+  pcb->state = ESTABLISHED;
+  pcb->snd_nxt = pcb->lastack = pcb->snd_lbb = TCP_HELPER_LOCAL_ISS;
+  pcb->snd_wl2 = TCP_HELPER_LOCAL_ISS;
+  pcb->rcv_nxt = pcb->snd_wl1 = TCP_HELPER_REMOTE_ISS;
+  pcb->snd_wnd = TCP_WND;
+  pcb->cwnd = TCP_WND;
+  pcb->mss = TCP_MSS;
+  TCP_REG(&tcp_active_pcbs, pcb);
+  return pcb;
+}
+
+struct pbuf *tcp_helper_segment(u32_t seqno, u32_t ackno, u8_t flags, const void *data, u16_t len)
+{
+  struct pbuf *p;
+  struct ip_hdr *iphdr;
+  struct tcp_hdr *tcphdr;
+
+  p = pbuf_alloc(PBUF_RAW, IP_HLEN + TCP_HLEN + len, PBUF_RAM);
+  LWIP_ASSERT("pbuf_alloc", p != NULL && p->next == NULL);
+  memset(p->payload, 0, IP_HLEN + TCP_HLEN);
+
+  iphdr = p->payload;
+  IPH_VHLTOS_SET(iphdr, 4, IP_HLEN / 4, 0);
+  IPH_LEN_SET(iphdr, htons(p->tot_len));
+  IPH_TTL_SET(iphdr, 64);
+  IPH_PROTO_SET(iphdr, IP_PROTO_TCP);
+  ip_addr_set(&iphdr->src, &remote_ip);
+  ip_addr_set(&iphdr->dest, &local_ip);
+
+  tcphdr = (struct tcp_hdr *)((u8_t *)p->payload + IP_HLEN);
+  tcphdr->src = htons(tcp_helper_remote_port);
+  tcphdr->dest = htons(TCP_HELPER_LOCAL_PORT);
+  tcphdr->seqno = htonl(seqno);
+  tcphdr->ackno = htonl(ackno);
+  TCPH_HDRLEN_SET(tcphdr, TCP_HLEN / 4);
+  TCPH_FLAGS_SET(tcphdr, flags);
+  tcphdr->wnd = htons(TCP_WND);
+
+  if (data != NULL) {
+    memcpy((u8_t *)tcphdr + TCP_HLEN, data, len);
+  } else {
+    memset((u8_t *)tcphdr + TCP_HLEN, 'x', len);
+  }
+
+  return p;
+}
+
+void tcp_helper_input(u32_t seqno, u32_t ackno, u8_t flags, const void *data, u16_t len)
+{
+  tcp_input(tcp_helper_segment(seqno, ackno, flags, data, len), &helper_netif);
+}
+
+u32_t tcp_helper_connect(void)
+{
+  int nsent = tcp_helper_nsent;
+  u32_t iss;
+
+  tcp_helper_input(TCP_HELPER_REMOTE_ISS - 1, 0, TCP_SYN, NULL, 0);
+  LWIP_ASSERT("SYN-ACK sent", tcp_helper_nsent == nsent + 1 &&
+              tcp_helper_sent[nsent].flags == (TCP_SYN | TCP_ACK));
+  iss = tcp_helper_sent[nsent].seqno;
+  tcp_helper_input(TCP_HELPER_REMOTE_ISS, iss + 1, TCP_ACK, NULL, 0);
+  tcp_helper_nsent = nsent;
+  return iss + 1;
+}
+
+#if LWIP_UDP
+void tcp_helper_udp_input(u16_t port, const void *data, u16_t len)
+{
+  struct pbuf *p;
+  struct ip_hdr *iphdr;
+  struct udp_hdr *udphdr;
+
+  p = pbuf_alloc(PBUF_RAW, IP_HLEN + UDP_HLEN + len, PBUF_RAM);
+  LWIP_ASSERT("pbuf_alloc", p != NULL && p->next == NULL);
+  memset(p->payload, 0, IP_HLEN + UDP_HLEN);
+
+  iphdr = p->payload;
+  IPH_VHLTOS_SET(iphdr, 4, IP_HLEN / 4, 0);
+  IPH_LEN_SET(iphdr, htons(p->tot_len));
+  IPH_TTL_SET(iphdr, 64);
+  IPH_PROTO_SET(iphdr, IP_PROTO_UDP);
+  ip_addr_set(&iphdr->src, &remote_ip);
+  ip_addr_set(&iphdr->dest, &local_ip);
+
+  /* No checksum: udp_input() takes it as such. */
+  udphdr = (struct udp_hdr *)((u8_t *)p->payload + IP_HLEN);
+  udphdr->src = htons(tcp_helper_remote_port);
+  udphdr->dest = htons(port);
+  udphdr->len = htons(UDP_HLEN + len);
+  memcpy((u8_t *)udphdr + UDP_HLEN, data, len);
+
+  udp_input(p, &helper_netif);
+}
+#endif
+
+void tcp_helper_run(u32_t ms)
+{
+  u32_t t;
+
+  for (t = 0; t < ms; t++) {
+    tcp_helper_now++;
+#if LWIP_TCP_HIRES_RTO
+    if (tcp_helper_now % TCP_RTO_TMR_INTERVAL == 0) {
+      tcp_rtotmr();
+    }
+#endif
+    if (tcp_helper_now % TCP_TMR_INTERVAL == 0) {
+      tcp_tmr();
+    }
+  }
+}
@@ -0,0 +1,106 @@
+/*! \file *********************************************************************
+ *
+ * \brief Drives the lwIP TCP core on the host: an established connection,
+ *        the segments it receives and the ones it sends.
+ *
+ * The connection goes from TCP_HELPER_LOCAL:TCP_HELPER_LOCAL_PORT to
+ * TCP_HELPER_REMOTE:tcp_helper_remote_port, TCP_HELPER_REMOTE_PORT unless a
+ * test connects a second peer. What it sends through the netif
+ * is recorded in tcp_helper_sent[], what it receives is built by
+ * tcp_helper_input(). With LWIP_UDP the same goes for the datagrams of the
+ * peer: tcp_helper_udp_sent[] and tcp_helper_udp_input().
+ *
+ *****************************************************************************/
+
+#ifndef TCP_HELPER_H
+#define TCP_HELPER_H
+
+#include "lwip/tcp.h"
+
+#define TCP_HELPER_LOCAL_PORT   4000
+#define TCP_HELPER_REMOTE_PORT  5000
+
+//! Initial sequence numbers of the two ends.
+#define TCP_HELPER_LOCAL_ISS    1000
+#define TCP_HELPER_REMOTE_ISS   5000
+
+//! Segments recorded.
+#define TCP_HELPER_MAX_SENT     64
+
+//! A segment sent by the connection.
+struct tcp_helper_seg
+{
+  u32_t seqno;
+  u32_t ackno;
+  u8_t  flags;
+  u16_t len;    /* of the data */
+  u16_t wnd;
+  u8_t  pbufs;  /* in the chain handed to the netif */
+};
+
+extern struct tcp_helper_seg tcp_helper_sent[TCP_HELPER_MAX_SENT];
+extern int tcp_helper_nsent;
+
+//! Port of the peer, TCP_HELPER_REMOTE_PORT after tcp_helper_init().
+extern u16_t tcp_helper_remote_port;
+
+//! Milliseconds returned by sys_now().
+extern u32_t tcp_helper_now;
+
+/*! \brief Initializes lwIP and the netif, nothing sent. */
+void tcp_helper_init(void);
+
+/*! \brief Creates a connection in ESTABLISHED state, nothing sent or
+ *         received yet, with a peer window of TCP_WND.
+ */
+struct tcp_pcb *tcp_helper_established(void);
+
+/*! \brief Connects the peer to a pcb listening on TCP_HELPER_LOCAL_PORT:
+ *         SYN from TCP_HELPER_REMOTE_ISS - 1, SYN-ACK, ACK. What was sent
+ *         is not kept in tcp_helper_sent[].
+ *
+ *  \return The local sequence number of the first byte to send.
+ */
+u32_t tcp_helper_connect(void);
+
+/*! \brief Hands a segment from the peer to tcp_input().
+ *
+ *  \param seqno  Sequence number, absolute.
+ *  \param ackno  Acknowledgment number, absolute; used with TCP_ACK.
+ *  \param flags  TCP_ACK, TCP_PSH, TCP_FIN...
+ *  \param data   Data, may be NULL: len bytes of 'x' are then sent.
+ *  \param len    Data length.
+ */
+void tcp_helper_input(u32_t seqno, u32_t ackno, u8_t flags, const void *data, u16_t len);
+
+/*! \brief Builds the segment tcp_helper_input() hands to tcp_input(), for
+ *         tcp_input(p, netif_default).
+ */
+struct pbuf *tcp_helper_segment(u32_t seqno, u32_t ackno, u8_t flags, const void *data, u16_t len);
+
+/*! \brief Runs the TCP timers for ms milliseconds, advancing sys_now(). */
+void tcp_helper_run(u32_t ms);
+
+#if LWIP_UDP
+//! Datagrams recorded, and bytes kept of the payload of each.
+#define TCP_HELPER_MAX_UDP      16
+#define TCP_HELPER_UDP_DATA     16
+
+//! A datagram sent to the peer.
+struct tcp_helper_udp
+{
+  u16_t dest;   /* port */
+  u16_t len;    /* of the payload */
+  u8_t  data[TCP_HELPER_UDP_DATA];  /* its first bytes */
+};
+
+extern struct tcp_helper_udp tcp_helper_udp_sent[TCP_HELPER_MAX_UDP];
+extern int tcp_helper_udp_nsent;
+
+/*! \brief Hands a datagram from the peer, from tcp_helper_remote_port to
+ *         port, to udp_input().
+ */
+void tcp_helper_udp_input(u16_t port, const void *data, u16_t len);
+#endif
+
+#endif
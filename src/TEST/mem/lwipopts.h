@@ -0,0 +1,36 @@
+/*! \file *********************************************************************
+ *
+ * \brief lwIP options of the bench_mem_*.c and bench_eth_*.c benchmarks:
+ *        those of the host tests with the heap, the size-class pools and
+ *        the pbuf pool of CONFIG/lwipopts.h.
+ *
+ *****************************************************************************/
+
+#ifndef __MEM_LWIPOPTS_H__
+#define __MEM_LWIPOPTS_H__
+
+#include "../lwip/lwipopts.h"
+
+#undef MEM_SIZE
+#define MEM_SIZE                3 * 1024
+/* Run without the pools too: see VARIANTS in the Makefile. */
+#ifndef MEM_USE_POOLS
+#define MEM_USE_POOLS           1
+#endif
+#define MEMP_USE_CUSTOM_POOLS   1
+#define MEM_USE_POOLS_TRY_BIGGER_POOL 1
+#define PBUF_LINK_HLEN          16
+
+#undef PBUF_POOL_SIZE
+#undef PBUF_POOL_BUFSIZE
+#ifndef PBUF_POOL_LAYOUT_500
+#define PBUF_POOL_SIZE          24
+#define PBUF_POOL_BUFSIZE       128
+#define PBUF_POOL_ALIGNMENT     128
+#else
+/* The pool before the pbufs matched the MACB receive buffers. */
+#define PBUF_POOL_SIZE          6
+#define PBUF_POOL_BUFSIZE       500
+#endif
+
+#endif /* __MEM_LWIPOPTS_H__ */
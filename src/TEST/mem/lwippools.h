@@ -0,0 +1,2 @@
+/* The pools of the firmware. No include guard: included several times. */
+#include "../../CONFIG/lwippools.h"
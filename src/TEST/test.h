@@ -0,0 +1,31 @@
+/*! \file *********************************************************************
+ *
+ * \brief Minimal checks for the host tests.
+ *
+ * TEST_CHECK() reports a failed condition and goes on; TEST_END() returns the
+ * exit status of the test program.
+ *
+ *****************************************************************************/
+
+#ifndef TEST_H
+#define TEST_H
+
+#include <stdio.h>
+
+static int test_failures = 0;
+
+#define TEST_CHECK(cond, ...)                                               \
+	do {                                                                \
+		if (!(cond)) {                                              \
+			test_failures++;                                    \
+			printf("%s:%d: %s: ", __FILE__, __LINE__, #cond);   \
+			printf(__VA_ARGS__);                                \
+			printf("\n");                                       \
+		}                                                           \
+	} while (0)
+
+#define TEST_END()                                                          \
+	(printf("%s: %s\n", __FILE__, test_failures ? "FAILED" : "ok"),     \
+	 test_failures ? 1 : 0)
+
+#endif
@@ -0,0 +1,82 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of a close from the peer followed by a NETCONN_DONTBLOCK
+ *        write on a full send buffer: the ERR_MEM of the write is returned
+ *        but not kept in conn->err, so the read that follows reports the
+ *        close and the Z-Wave session ends instead of waiting for its idle
+ *        timeout.
+ *
+ *****************************************************************************/
+
+#include "test.h"
+
+#include "api_helper.h"
+
+/* Writes until the send buffer is full; returns the error of the write that
+   found no room. */
+static err_t fill(struct netconn *conn, size_t *written)
+{
+  static const char data[1000];
+  err_t err;
+  int writes;
+
+  for (writes = 0; writes < 10; writes++) {
+    err = netconn_write_partly(conn, data, sizeof(data), NETCONN_COPY | NETCONN_DONTBLOCK, written);
+    if (err != ERR_OK) {
+      return err;
+    }
+  }
+  return ERR_OK;
+}
+
+/* The peer closes, acknowledging nothing new. */
+static void peer_fin(struct netconn *conn)
+{
+  tcp_helper_input(TCP_HELPER_REMOTE_ISS, conn->pcb.tcp->lastack, TCP_ACK | TCP_FIN, NULL, 0);
+}
+
+int main(void)
+{
+  struct netconn *conn;
+  struct netbuf *buf;
+  char rx[64];
+  size_t written;
+  err_t err;
+
+  /* netconn_recv_into(), as the Z-Wave session reads. */
+  tcp_helper_init();
+  conn = api_helper_accepted();
+  netconn_set_recvtimeout(conn, 1);
+  TEST_CHECK(netconn_recv_into(conn, rx, sizeof(rx)) == 0 && conn->err == ERR_TIMEOUT,
+             "silent peer: conn->err %d", conn->err);
+  /* The FIN comes in before the write, the session reads after it. */
+  peer_fin(conn);
+  err = fill(conn, &written);
+  TEST_CHECK(err == ERR_MEM && written == 0, "full send buffer: %d, %u bytes written", err, (unsigned)written);
+  TEST_CHECK(conn->err == ERR_OK, "conn->err %d after ERR_MEM", conn->err);
+  TEST_CHECK(netconn_recv_into(conn, rx, sizeof(rx)) == 0, "data after FIN");
+  TEST_CHECK(conn->err == ERR_CLSD && ERR_IS_FATAL(conn->err), "after FIN: conn->err %d", conn->err);
+  tcp_abort(conn->pcb.tcp);
+  netconn_delete(conn);
+
+  /* netconn_recv(), as the sockets read. */
+  tcp_helper_init();
+  conn = api_helper_accepted();
+  netconn_set_recvtimeout(conn, 1);
+  err = fill(conn, &written);
+  TEST_CHECK(err == ERR_MEM && conn->err == ERR_OK, "full send buffer: %d, conn->err %d", err, conn->err);
+
+  /* The peer acknowledges what was sent: room again, the write goes. */
+  tcp_helper_input(TCP_HELPER_REMOTE_ISS, conn->pcb.tcp->snd_nxt, TCP_ACK, NULL, 0);
+  err = netconn_write_partly(conn, rx, sizeof(rx), NETCONN_COPY | NETCONN_DONTBLOCK, &written);
+  TEST_CHECK(err == ERR_OK && written == sizeof(rx), "after ACK: %d, %u bytes written", err, (unsigned)written);
+  peer_fin(conn);
+  err = fill(conn, &written);
+  TEST_CHECK(err == ERR_MEM && conn->err == ERR_OK, "full again: %d, conn->err %d", err, conn->err);
+  buf = netconn_recv(conn);
+  TEST_CHECK(buf == NULL && conn->err == ERR_CLSD, "after FIN: %p, conn->err %d", (void *)buf, conn->err);
+  tcp_abort(conn->pcb.tcp);
+  netconn_delete(conn);
+
+  return TEST_END();
+}
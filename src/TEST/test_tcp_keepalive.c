@@ -0,0 +1,110 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the keepalive probes of a connection, set as the
+ *        Z-Wave session sets them (netconn_set_keepalive()): a peer that
+ *        answers them is kept, a silent one is aborted and its pcb freed.
+ *
+ *****************************************************************************/
+
+#include "test.h"
+
+#include "lwip/stats.h"
+
+#include "tcp_helper.h"
+
+/* zwaveKEEPALIVE_IDLE, _INTVL and _COUNT of ZWaveTCP.c. */
+#define KEEP_IDLE   5000
+#define KEEP_INTVL  1000
+#define KEEP_CNT    3
+
+static err_t aborted;
+static int errors;
+
+static void on_error(void *arg, err_t err)
+{
+  LWIP_UNUSED_ARG(arg);
+  aborted = err;
+  errors++;
+}
+
+/* As do_keepalive() does it. */
+static struct tcp_pcb *established_with_keepalive(void)
+{
+  struct tcp_pcb *pcb = tcp_helper_established();
+
+  pcb->so_options |= SOF_KEEPALIVE;
+  pcb->keep_idle = KEEP_IDLE;
+  pcb->keep_intvl = KEEP_INTVL;
+  pcb->keep_cnt = KEEP_CNT;
+  tcp_err(pcb, on_error);
+  return pcb;
+}
+
+static int is_probe(const struct tcp_helper_seg *seg)
+{
+  return seg->len == 0 && seg->seqno == TCP_HELPER_LOCAL_ISS - 1 && !(seg->flags & TCP_RST);
+}
+
+int main(void)
+{
+  struct tcp_pcb *pcb;
+  u32_t start, probe_at[KEEP_CNT + 1], abort_at = 0;
+  int probes = 0, resets = 0, i;
+
+  tcp_helper_init();
+
+  /* The peer answers every probe: the connection stays. */
+  pcb = established_with_keepalive();
+  start = tcp_helper_now;
+  while (tcp_helper_now - start < 4 * KEEP_IDLE) {
+    tcp_helper_nsent = 0;
+    tcp_helper_run(1);
+    for (i = 0; i < tcp_helper_nsent; i++) {
+      if (is_probe(&tcp_helper_sent[i])) {
+        probes++;
+        tcp_helper_input(TCP_HELPER_REMOTE_ISS, TCP_HELPER_LOCAL_ISS, TCP_ACK, NULL, 0);
+      }
+    }
+  }
+  TEST_CHECK(errors == 0, "answered probes, aborted with %d", aborted);
+  TEST_CHECK(probes >= 3 && probes <= 4, "%d probes in %u ms", probes, 4 * KEEP_IDLE);
+  TEST_CHECK(pcb->keep_cnt_sent == 0, "%u probes unanswered", pcb->keep_cnt_sent);
+  tcp_abort(pcb);
+  errors = 0;
+  probes = 0;
+
+  /* The peer is gone: KEEP_CNT probes KEEP_INTVL apart after KEEP_IDLE,
+  then a reset and the pcb freed, in whole slow timer ticks. */
+  pcb = established_with_keepalive();
+  TEST_CHECK(lwip_stats.memp[MEMP_TCP_PCB].used == 1, "%u pcbs used", lwip_stats.memp[MEMP_TCP_PCB].used);
+  start = tcp_helper_now;
+  while (errors == 0 && tcp_helper_now - start < 4 * KEEP_IDLE) {
+    tcp_helper_nsent = 0;
+    tcp_helper_run(1);
+    for (i = 0; i < tcp_helper_nsent; i++) {
+      if (is_probe(&tcp_helper_sent[i]) && probes <= KEEP_CNT) {
+        probe_at[probes++] = tcp_helper_now - start;
+      }
+      if (tcp_helper_sent[i].flags & TCP_RST) {
+        resets++;
+      }
+    }
+  }
+  abort_at = tcp_helper_now - start;
+
+  TEST_CHECK(probes == KEEP_CNT, "%d probes", probes);
+  for (i = 0; i < probes && i < KEEP_CNT; i++) {
+    TEST_CHECK(probe_at[i] > KEEP_IDLE + i * KEEP_INTVL &&
+               probe_at[i] <= KEEP_IDLE + i * KEEP_INTVL + TCP_SLOW_INTERVAL,
+               "probe %d after %u ms", i, probe_at[i]);
+  }
+  TEST_CHECK(errors == 1 && aborted == ERR_ABRT, "%d errors, the last %d", errors, aborted);
+  TEST_CHECK(abort_at > KEEP_IDLE + KEEP_CNT * KEEP_INTVL &&
+             abort_at <= KEEP_IDLE + KEEP_CNT * KEEP_INTVL + TCP_SLOW_INTERVAL,
+             "aborted after %u ms", abort_at);
+  TEST_CHECK(resets == 1, "%d resets", resets);
+  TEST_CHECK(tcp_active_pcbs == NULL, "pcb still active");
+  TEST_CHECK(lwip_stats.memp[MEMP_TCP_PCB].used == 0, "%u pcbs used", lwip_stats.memp[MEMP_TCP_PCB].used);
+
+  return TEST_END();
+}
@@ -0,0 +1,95 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the loss recovery of the fine grained retransmission
+ *        timer (LWIP_TCP_HIRES_RTO): the lost segment is resent after the
+ *        RTO measured on the LAN, with back-off, and a segment received out
+ *        of order is kept until the missing one is resent.
+ *
+ *****************************************************************************/
+
+#include "test.h"
+
+#include "tcp_helper.h"
+
+static char data[200];
+
+/* Runs the timers until a segment starting at seqno is sent again, for at
+most ms milliseconds: the time it took, 0 if none. */
+static u32_t wait_resend(u32_t seqno, u32_t ms)
+{
+  u32_t start = tcp_helper_now;
+  int n = 0;
+
+  tcp_helper_nsent = 0;
+  while (tcp_helper_now - start < ms) {
+    tcp_helper_run(1);
+    for (; n < tcp_helper_nsent; n++) {
+      if (tcp_helper_sent[n].seqno == seqno && tcp_helper_sent[n].len > 0) {
+        return tcp_helper_now - start;
+      }
+    }
+  }
+  return 0;
+}
+
+int main(void)
+{
+  struct tcp_pcb *pcb;
+  u32_t rto_ms, first, second, acked = 0;
+  int i;
+
+  tcp_helper_init();
+  pcb = tcp_helper_established();
+
+  /* Segments acknowledged after 5 ms: the RTO comes down from
+  TCP_INITIAL_RTO to the LAN. */
+  for (i = 0; i < 20; i++) {
+    tcp_helper_nsent = 0;
+    TEST_CHECK(tcp_write(pcb, data, 100, TCP_WRITE_FLAG_COPY) == ERR_OK, "write");
+    tcp_output(pcb);
+    TEST_CHECK(tcp_helper_nsent == 1 && tcp_helper_sent[0].len == 100, "%d segments sent", tcp_helper_nsent);
+    tcp_helper_run(5);
+    acked += 100;
+    tcp_helper_input(TCP_HELPER_REMOTE_ISS, TCP_HELPER_LOCAL_ISS + acked, TCP_ACK, NULL, 0);
+    TEST_CHECK(pcb->unacked == NULL, "not acknowledged");
+  }
+  rto_ms = TCP_RTO_MS(pcb->rto);
+  TEST_CHECK(rto_ms >= TCP_MIN_RTO && rto_ms < 100, "RTO of %u ms", rto_ms);
+
+  /* The second one is lost, and its first retransmission too. */
+  TEST_CHECK(tcp_write(pcb, data, 100, TCP_WRITE_FLAG_COPY) == ERR_OK, "write");
+  tcp_output(pcb);
+  first = wait_resend(TCP_HELPER_LOCAL_ISS + acked, 5000);
+  TEST_CHECK(first >= TCP_MIN_RTO && first <= rto_ms + TCP_RTO_TMR_INTERVAL,
+             "resent after %u ms, RTO of %u ms", first, rto_ms);
+  second = wait_resend(TCP_HELPER_LOCAL_ISS + acked, 5000);
+  /* Backed off from the estimate, before TCP_MIN_RTO is applied. */
+  TEST_CHECK(second > first && second <= 2 * first + TCP_RTO_TMR_INTERVAL,
+             "resent again after %u ms, the first time after %u ms", second, first);
+  acked += 100;
+  tcp_helper_input(TCP_HELPER_REMOTE_ISS, TCP_HELPER_LOCAL_ISS + acked, TCP_ACK, NULL, 0);
+  TEST_CHECK(pcb->unacked == NULL && pcb->unsent == NULL, "not acknowledged");
+
+  /* The peer loses a segment and sends the next one: it is queued out of
+  sequence, and kept over a slow timer tick although 6 RTOs are less than
+  a tick. */
+  tcp_helper_input(TCP_HELPER_REMOTE_ISS + 100, TCP_HELPER_LOCAL_ISS + acked, TCP_ACK, NULL, 100);
+  TEST_CHECK(pcb->ooseq != NULL, "not queued out of sequence");
+  tcp_helper_run(TCP_SLOW_INTERVAL);
+  TEST_CHECK(pcb->ooseq != NULL, "out of sequence segment dropped after one tick");
+
+  /* The lost one is resent: both are received. */
+  tcp_helper_input(TCP_HELPER_REMOTE_ISS, TCP_HELPER_LOCAL_ISS + acked, TCP_ACK, NULL, 100);
+  TEST_CHECK(pcb->rcv_nxt == TCP_HELPER_REMOTE_ISS + 200, "received up to +%u", pcb->rcv_nxt - TCP_HELPER_REMOTE_ISS);
+  TEST_CHECK(pcb->ooseq == NULL, "still queued out of sequence");
+
+  /* Never resent: the out of sequence segment is dropped once the
+  connection was inactive for 6 RTOs, rounded up to whole ticks. */
+  tcp_helper_input(TCP_HELPER_REMOTE_ISS + 300, TCP_HELPER_LOCAL_ISS + acked, TCP_ACK, NULL, 100);
+  TEST_CHECK(pcb->ooseq != NULL, "not queued out of sequence");
+  tcp_helper_run(TCP_SLOW_INTERVAL * (TCP_OOSEQ_TICKS(pcb->rto) + 1));
+  TEST_CHECK(pcb->ooseq == NULL, "out of sequence segment kept");
+
+  tcp_abort(pcb);
+  return TEST_END();
+}
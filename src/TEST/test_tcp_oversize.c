@@ -0,0 +1,56 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the room tcp_enqueue() allocates ahead in the last
+ *        unsent segment (TCP_OVERSIZE): no segment may grow past the MSS.
+ *
+ *****************************************************************************/
+
+#include "test.h"
+
+#include "tcp_helper.h"
+
+static char data[TCP_SND_BUF];
+
+static void check_unsent(struct tcp_pcb *pcb, const char *step)
+{
+  struct tcp_seg *seg;
+  u32_t queued = 0;
+
+  for (seg = pcb->unsent; seg != NULL; seg = seg->next) {
+    TEST_CHECK(seg->len <= pcb->mss, "%s: segment of %u bytes", step, seg->len);
+    TEST_CHECK(seg->len + seg->oversize_left <= pcb->mss,
+               "%s: segment of %u bytes with %u more bytes of room", step, seg->len, seg->oversize_left);
+    TEST_CHECK(seg->p->tot_len == seg->len + TCP_HLEN, "%s: pbuf of %u bytes for %u", step, seg->p->tot_len, seg->len);
+    queued += seg->len;
+  }
+  TEST_CHECK(queued == pcb->snd_lbb - pcb->snd_nxt, "%s: %u bytes queued, %u written", step, queued,
+             pcb->snd_lbb - pcb->snd_nxt);
+}
+
+int main(void)
+{
+  struct tcp_pcb *pcb;
+  u16_t len;
+
+  tcp_helper_init();
+
+  /* A copied write merged into a segment that was not copied: the room left
+  in the pbuf of the write must not be used past the MSS. */
+  pcb = tcp_helper_established();
+  TEST_CHECK(tcp_write(pcb, data, TCP_MSS - 50, 0) == ERR_OK, "write");
+  TEST_CHECK(tcp_write(pcb, data, 10, TCP_WRITE_FLAG_COPY) == ERR_OK, "write");
+  check_unsent(pcb, "merged");
+  TEST_CHECK(tcp_write(pcb, data, 100, TCP_WRITE_FLAG_COPY) == ERR_OK, "write");
+  check_unsent(pcb, "appended after merge");
+  tcp_abort(pcb);
+
+  /* Small copied writes, as the bridge does, until the send queue is full:
+  appended, never past the MSS. */
+  pcb = tcp_helper_established();
+  for (len = 1; tcp_write(pcb, data, len, TCP_WRITE_FLAG_COPY) == ERR_OK; len = len % 200 + 7);
+  TEST_CHECK(pcb->snd_queuelen >= TCP_SND_QUEUELEN || pcb->snd_buf < len, "write of %u failed", len);
+  check_unsent(pcb, "small writes");
+  tcp_abort(pcb);
+
+  return TEST_END();
+}
@@ -0,0 +1,53 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the pcb recycling of tcp_alloc() (TCP_PCB_RECYCLE):
+ *        a full pool is counted once in the memp err stats, a pcb allocated
+ *        in the room of a reaped one in tcp_conn.recycled.
+ *
+ *****************************************************************************/
+
+#include "test.h"
+
+#include "lwip/stats.h"
+
+#include "tcp_helper.h"
+
+int main(void)
+{
+  struct tcp_pcb *pcbs[MEMP_NUM_TCP_PCB], *pcb;
+  int i;
+
+  tcp_helper_init();
+
+  for (i = 0; i < MEMP_NUM_TCP_PCB; i++) {
+    pcbs[i] = tcp_helper_established();
+  }
+  TEST_CHECK(lwip_stats.memp[MEMP_TCP_PCB].err == 0, "err %u", lwip_stats.memp[MEMP_TCP_PCB].err);
+
+  /* Nothing to reap, nothing of a lower priority: no pcb. */
+  pcb = tcp_alloc(TCP_PRIO_MIN);
+  TEST_CHECK(pcb == NULL, "allocated from a full pool");
+  TEST_CHECK(lwip_stats.tcp_conn.reaped == 0 && lwip_stats.tcp_conn.recycled == 0,
+             "reaped %u recycled %u", lwip_stats.tcp_conn.reaped, lwip_stats.tcp_conn.recycled);
+  TEST_CHECK(lwip_stats.memp[MEMP_TCP_PCB].err > 0, "full pool not counted");
+
+  /* A half-open connection is reaped for the new one. */
+  lwip_stats.memp[MEMP_TCP_PCB].err = 0;
+  pcbs[2]->state = SYN_RCVD;
+  pcb = tcp_alloc(TCP_PRIO_MIN);
+  TEST_CHECK(pcb != NULL, "half-open pcb not recycled");
+  TEST_CHECK(lwip_stats.tcp_conn.reaped == 1 && lwip_stats.tcp_conn.recycled == 1,
+             "reaped %u recycled %u", lwip_stats.tcp_conn.reaped, lwip_stats.tcp_conn.recycled);
+  TEST_CHECK(lwip_stats.memp[MEMP_TCP_PCB].err == 1, "err %u", lwip_stats.memp[MEMP_TCP_PCB].err);
+  TEST_CHECK(lwip_stats.tcp_conn.killed == 0, "killed %u", lwip_stats.tcp_conn.killed);
+  memp_free(MEMP_TCP_PCB, pcb);
+
+  /* Room in the pool: no stats. */
+  lwip_stats.memp[MEMP_TCP_PCB].err = 0;
+  pcb = tcp_alloc(TCP_PRIO_MIN);
+  TEST_CHECK(pcb != NULL, "free pcb not allocated");
+  TEST_CHECK(lwip_stats.tcp_conn.recycled == 1 && lwip_stats.memp[MEMP_TCP_PCB].err == 0,
+             "recycled %u err %u", lwip_stats.tcp_conn.recycled, lwip_stats.memp[MEMP_TCP_PCB].err);
+
+  return TEST_END();
+}
@@ -0,0 +1,81 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the tick correction of the tickless idle
+ *        (porttickless.h).
+ *
+ * A sleep is armed for a number of ticks and cut short at every COUNT value
+ * (by steps): the ticks stepped, plus the one the tick ISR accounts for at the
+ * next compare match, must be the tick boundaries actually passed by then,
+ * and the match must stay on a boundary, ahead of COUNT.
+ *
+ *****************************************************************************/
+
+#include "test.h"
+
+#include "porttickless.h"
+
+/* configCPU_CLOCK_HZ / configTICK_RATE_HZ and the margin of port.c. */
+#define CYCLES_PER_TICK   48000UL
+#define COMPARE_MARGIN    64UL
+
+static void check_sleep(unsigned long ulExpectedIdleTime, unsigned long ulStep)
+{
+	unsigned long ulSleepCompare = ulExpectedIdleTime * CYCLES_PER_TICK;
+	unsigned long ulCount, ulStepped, ulNextCompare, ulMatch;
+
+	for (ulCount = 0; ulCount < ulSleepCompare; ulCount += ulStep) {
+		ulStepped = ulPortTicklessElapsed(ulCount, ulSleepCompare, CYCLES_PER_TICK,
+		                                  COMPARE_MARGIN, &ulNextCompare);
+		ulMatch = ulNextCompare ? ulNextCompare : ulSleepCompare;
+
+		TEST_CHECK(ulMatch % CYCLES_PER_TICK == 0,
+		           "idle %lu count %lu: compare %lu off a boundary", ulExpectedIdleTime, ulCount, ulMatch);
+		TEST_CHECK(ulNextCompare == 0 || ulMatch - ulCount >= COMPARE_MARGIN,
+		           "idle %lu count %lu: compare %lu too close", ulExpectedIdleTime, ulCount, ulMatch);
+		TEST_CHECK(ulMatch > ulCount && ulMatch <= ulSleepCompare,
+		           "idle %lu count %lu: compare %lu past the sleep", ulExpectedIdleTime, ulCount, ulMatch);
+		/* The tick ISR adds one tick at the match. */
+		TEST_CHECK(ulStepped + 1 == ulMatch / CYCLES_PER_TICK,
+		           "idle %lu count %lu: %lu ticks stepped, match at %lu", ulExpectedIdleTime, ulCount,
+		           ulStepped, ulMatch);
+		/* Never ahead of the time really slept. */
+		TEST_CHECK(ulStepped * CYCLES_PER_TICK <= ulCount + COMPARE_MARGIN,
+		           "idle %lu count %lu: %lu ticks stepped", ulExpectedIdleTime, ulCount, ulStepped);
+	}
+}
+
+int main(void)
+{
+	unsigned long ulNext, ulStepped;
+
+	/* Woken right after the last tick. */
+	ulStepped = ulPortTicklessElapsed(0, 10 * CYCLES_PER_TICK, CYCLES_PER_TICK, COMPARE_MARGIN, &ulNext);
+	TEST_CHECK(ulStepped == 0 && ulNext == CYCLES_PER_TICK, "%lu %lu", ulStepped, ulNext);
+
+	/* Woken in the middle of the third period. */
+	ulStepped = ulPortTicklessElapsed(100000, 10 * CYCLES_PER_TICK, CYCLES_PER_TICK, COMPARE_MARGIN, &ulNext);
+	TEST_CHECK(ulStepped == 2 && ulNext == 3 * CYCLES_PER_TICK, "%lu %lu", ulStepped, ulNext);
+
+	/* Woken within the margin of a boundary: it is taken as passed. */
+	ulStepped = ulPortTicklessElapsed(CYCLES_PER_TICK - 10, 10 * CYCLES_PER_TICK, CYCLES_PER_TICK,
+	                                  COMPARE_MARGIN, &ulNext);
+	TEST_CHECK(ulStepped == 1 && ulNext == 2 * CYCLES_PER_TICK, "%lu %lu", ulStepped, ulNext);
+
+	/* Woken in the last period, or within the margin of the armed match:
+	COMPARE is left alone. */
+	ulStepped = ulPortTicklessElapsed(9 * CYCLES_PER_TICK + 5, 10 * CYCLES_PER_TICK, CYCLES_PER_TICK,
+	                                  COMPARE_MARGIN, &ulNext);
+	TEST_CHECK(ulStepped == 9 && ulNext == 0, "%lu %lu", ulStepped, ulNext);
+	ulStepped = ulPortTicklessElapsed(10 * CYCLES_PER_TICK - 1, 10 * CYCLES_PER_TICK, CYCLES_PER_TICK,
+	                                  COMPARE_MARGIN, &ulNext);
+	TEST_CHECK(ulStepped == 9 && ulNext == 0, "%lu %lu", ulStepped, ulNext);
+
+	/* A one tick sleep has nothing to correct. */
+	check_sleep(1, 1);
+	check_sleep(2, 1);
+	check_sleep(10, 7);
+	/* portMAX_SUPPRESSED_TICKS: COMPARE close to the top of COUNT. */
+	check_sleep(0xFFFFFFFFUL / CYCLES_PER_TICK, 48001);
+
+	return TEST_END();
+}
@@ -0,0 +1,97 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the trace stream analyzer (TRACE/trace_analyzer.c), on
+ *        a made up stream.
+ *
+ *****************************************************************************/
+
+#include "test.h"
+
+#define TRACE_ANALYZER_NO_MAIN
+#include "trace_analyzer.c"
+
+static const char acTaskList[] =
+  "IDLE\t\tR\t0\t100\t0\r\n"
+  "ZW\t\tB\t2\t200\t3\r\n";
+
+static unsigned char aucStream[ 1024 ];
+static size_t xStreamLength;
+
+static void put_record( unsigned long ulStamp, unsigned char ucEvent, unsigned char ucTask, unsigned short usParam )
+{
+  unsigned char *p = aucStream + xStreamLength;
+
+  p[ 0 ] = ( unsigned char ) ( ulStamp >> 24 );
+  p[ 1 ] = ( unsigned char ) ( ulStamp >> 16 );
+  p[ 2 ] = ( unsigned char ) ( ulStamp >> 8 );
+  p[ 3 ] = ( unsigned char ) ulStamp;
+  p[ 4 ] = ucEvent;
+  p[ 5 ] = ucTask;
+  p[ 6 ] = ( unsigned char ) ( usParam >> 8 );
+  p[ 7 ] = ( unsigned char ) usParam;
+  xStreamLength += traceRECORD_SIZE;
+}
+
+int main( void )
+{
+  static xTraceStats xStats;
+  size_t xOffset;
+  FILE *pxNull;
+
+  /* Header as sent by TraceTCP.c: 48 MHz timestamps, 1 kHz tick. */
+  memcpy( aucStream, "FRTR\x01\x08\x00\x00\x02\xDC\x6C\x00\x00\x00\x03\xE8", 16 );
+  aucStream[ 16 ] = 0;
+  aucStream[ 17 ] = sizeof( acTaskList ) - 1;
+  memcpy( aucStream + 18, acTaskList, sizeof( acTaskList ) - 1 );
+  xStreamLength = 18 + sizeof( acTaskList ) - 1;
+
+  put_record( 1000, traceEVT_TASK_SWITCHED_IN, 0, 0 );
+  put_record( 2000, traceEVT_USART_RX, 0, 0x01 );
+  put_record( 2500, traceEVT_USART_RX, 0, 0x03 );
+  put_record( 4000, traceEVT_TASK_SWITCHED_IN, 3, 2 );
+  put_record( 50000, traceEVT_TCP_WRITE, 3, 2 );
+  /* The segment of the trace server does not end the latency, the Z-Wave
+  one does. */
+  put_record( 60000, traceEVT_TCP_SEGMENT, 3, 24 );
+  put_record( 70000, traceEVT_TCP_SEGMENT, 3, 23 );
+  put_record( 100000, traceEVT_TASK_SWITCHED_IN, 0, 0 );
+  /* The timestamps wrap. */
+  put_record( 0xFFFFFFF0UL, traceEVT_TASK_SWITCHED_IN, 3, 2 );
+  put_record( 0x10, traceEVT_TASK_SWITCHED_IN, 0, 0 );
+  /* What ran in the gap is unknown. */
+  put_record( 0x110, traceEVT_OVERFLOW, 0, 5 );
+  put_record( 0x200, traceEVT_TASK_SWITCHED_IN, 3, 2 );
+  put_record( 0x300, traceEVT_TASK_DELAY, 3, 0 );
+
+  xOffset = xTraceHeader( &xStats, aucStream, xStreamLength );
+  TEST_CHECK( xOffset == 18 + sizeof( acTaskList ) - 1, "header of %zu bytes", xOffset );
+  TEST_CHECK( xStats.ulTimeStampHz == 48000000UL && xStats.ulTickHz == 1000, "%lu %lu", xStats.ulTimeStampHz, xStats.ulTickHz );
+  TEST_CHECK( strcmp( xStats.acName[ 0 ], "IDLE" ) == 0, "task 0 is '%s'", xStats.acName[ 0 ] );
+  TEST_CHECK( strcmp( xStats.acName[ 3 ], "ZW" ) == 0, "task 3 is '%s'", xStats.acName[ 3 ] );
+
+  for( ; xOffset + traceRECORD_SIZE <= xStreamLength; xOffset += traceRECORD_SIZE )
+    vTraceRecordStats( &xStats, aucStream + xOffset );
+  vTraceFinish( &xStats );
+
+  TEST_CHECK( xStats.ulRecords == 13, "%lu records", xStats.ulRecords );
+  TEST_CHECK( xStats.ulLost == 5, "%lu lost", xStats.ulLost );
+  TEST_CHECK( xStats.ullCycles[ 0 ] == 3000 + 0xFFFFFFF0ULL - 100000, "task 0 ran %llu", xStats.ullCycles[ 0 ] );
+  TEST_CHECK( xStats.ullCycles[ 3 ] == 96000 + 0x20 + 0x100, "task 3 ran %llu", xStats.ullCycles[ 3 ] );
+  TEST_CHECK( xStats.ulLatencyCount == 1 && xStats.ullLatencyMin == 68000 && xStats.ullLatencyMax == 68000,
+              "%lu latencies, %llu to %llu", xStats.ulLatencyCount, xStats.ullLatencyMin, xStats.ullLatencyMax );
+
+  pxNull = fopen( "/dev/null", "w" );
+  if( pxNull )
+  {
+    vTraceReport( &xStats, pxNull );
+    fclose( pxNull );
+  }
+
+  /* Not a trace stream. */
+  aucStream[ 0 ] = 'X';
+  TEST_CHECK( xTraceHeader( &xStats, aucStream, xStreamLength ) == 0, "bad magic accepted" );
+  aucStream[ 0 ] = 'F';
+  TEST_CHECK( xTraceHeader( &xStats, aucStream, 20 ) == 0, "truncated task list accepted" );
+
+  return TEST_END();
+}
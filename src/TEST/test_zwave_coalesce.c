@@ -0,0 +1,163 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the coalescing policies (ZWaveCoalesce.c): when the
+ *        held serial bytes are released, and how long a connection may wait
+ *        for them.
+ *
+ *****************************************************************************/
+
+#include <string.h>
+
+#include "test.h"
+
+#include "zwave_helper.h"
+#include "ZWaveCoalesce.h"
+
+/* A request frame of 5 bytes: SOF, length, type, function, checksum. */
+static const unsigned char frame[] = { zwaveFRAME_SOF, 0x03, 0x00, 0x15, 0xE9 };
+
+#define BUFFER_SIZE  64
+
+static void add(xZwaveCoalesce *c, const unsigned char *bytes, int n)
+{
+	int i;
+
+	for (i = 0; i < n; i++) {
+		vZwaveCoalesceStampFromISR();
+		vZwaveCoalesceAdd(c, bytes[i]);
+	}
+}
+
+static void test_none(void)
+{
+	xZwaveCoalesce c;
+
+	zwave_helper_set_time(1000000);
+	vZwaveCoalesceInit(&c, zwaveCOALESCE_NONE, 0);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 0, "nothing held");
+	TEST_CHECK(xZwaveCoalesceWait(&c) == portMAX_DELAY, "wait %u", xZwaveCoalesceWait(&c));
+	add(&c, frame, 2);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 2, "NONE holds %u", usZwaveCoalesceReady(&c, BUFFER_SIZE));
+	TEST_CHECK(xZwaveCoalesceWait(&c) == 1, "due bytes wait %u", xZwaveCoalesceWait(&c));
+	vZwaveCoalesceSent(&c, 2);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 0 && c.usHeld == 0, "held %u", c.usHeld);
+}
+
+static void test_frame(void)
+{
+	xZwaveCoalesce c;
+	unsigned char ack = zwaveFRAME_ACK;
+
+	zwave_helper_set_time(2000000);
+	vZwaveCoalesceInit(&c, zwaveCOALESCE_FRAME, 0);
+
+	/* An ACK is a frame of its own. */
+	add(&c, &ack, 1);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 1, "ACK held");
+
+	/* Half a frame behind it: only the ACK goes. */
+	add(&c, frame, 3);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 1, "%u ready", usZwaveCoalesceReady(&c, BUFFER_SIZE));
+	vZwaveCoalesceSent(&c, 1);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 0, "partial frame released");
+	TEST_CHECK(xZwaveCoalesceWait(&c) == zwaveCOALESCE_MAX_DELAY, "wait %u", xZwaveCoalesceWait(&c));
+
+	/* The end of the frame releases it whole. */
+	zwave_helper_set_time(2010000);
+	TEST_CHECK(xZwaveCoalesceWait(&c) == zwaveCOALESCE_MAX_DELAY - 10, "wait %u", xZwaveCoalesceWait(&c));
+	add(&c, frame + 3, 2);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 5, "%u ready", usZwaveCoalesceReady(&c, BUFFER_SIZE));
+
+	/* A partial write leaves the rest due. */
+	vZwaveCoalesceSent(&c, 2);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 3, "%u ready", usZwaveCoalesceReady(&c, BUFFER_SIZE));
+	vZwaveCoalesceSent(&c, 3);
+
+	/* A frame never completed goes after zwaveCOALESCE_MAX_DELAY. */
+	add(&c, frame, 2);
+	zwave_helper_set_time(2010000 + 1000 * (zwaveCOALESCE_MAX_DELAY - 1) * portTICK_RATE_MS);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 0, "released early");
+	TEST_CHECK(xZwaveCoalesceWait(&c) == 1, "wait %u", xZwaveCoalesceWait(&c));
+	zwave_helper_set_time(2010000 + 1000 * zwaveCOALESCE_MAX_DELAY * portTICK_RATE_MS);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 2, "not released at the delay");
+}
+
+static void test_size(void)
+{
+	xZwaveCoalesce c;
+	unsigned char bytes[16];
+
+	memset(bytes, 0x55, sizeof(bytes));
+	zwave_helper_set_time(3000000);
+	vZwaveCoalesceInit(&c, zwaveCOALESCE_SIZE, 8);
+	add(&c, bytes, 7);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 0, "7 bytes released");
+	add(&c, bytes, 1);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 8, "8 bytes held");
+	vZwaveCoalesceSent(&c, 8);
+
+	/* A full buffer goes whatever the policy. */
+	add(&c, bytes, 4);
+	TEST_CHECK(usZwaveCoalesceReady(&c, 4) == 4, "full buffer held");
+}
+
+static void test_gap(void)
+{
+	xZwaveCoalesce c;
+	unsigned long long t = 4000000;
+
+	zwave_helper_set_time(t);
+	vZwaveCoalesceInit(&c, zwaveCOALESCE_GAP, 2500);
+	add(&c, frame, 5);
+	TEST_CHECK(ulZwaveCoalesceIdle() == 0, "idle %u", ulZwaveCoalesceIdle());
+	TEST_CHECK(xZwaveCoalesceWait(&c) == 3, "wait %u for a 2.5ms gap", xZwaveCoalesceWait(&c));
+
+	zwave_helper_set_time(t + 2000);
+	TEST_CHECK(ulZwaveCoalesceIdle() >= 1990 && ulZwaveCoalesceIdle() <= 2000, "idle %u", ulZwaveCoalesceIdle());
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 0, "released before the gap");
+	TEST_CHECK(xZwaveCoalesceWait(&c) == 1, "wait %u", xZwaveCoalesceWait(&c));
+
+	zwave_helper_set_time(t + 2600);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 5, "not released after the gap");
+	vZwaveCoalesceSent(&c, 5);
+
+	/* Longer than the counter tells. */
+	zwave_helper_set_time(t + 200000);
+	TEST_CHECK(ulZwaveCoalesceIdle() == 0xFFFFFFFF, "idle %u after 200ms", ulZwaveCoalesceIdle());
+}
+
+static void test_set_policy(void)
+{
+	xZwaveCoalesce c;
+	unsigned char bytes[4] = { 0x55, 0x55, 0x55, 0x55 };
+
+	zwave_helper_set_time(5000000);
+	vZwaveCoalesceInit(&c, zwaveCOALESCE_SIZE, 100);
+
+	/* Switched to FRAME in the middle of the stream: the frame boundaries
+	were followed anyway. */
+	add(&c, frame, 5);
+	add(&c, frame, 2);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 0, "SIZE released early");
+	vZwaveCoalesceSetPolicy(&c, zwaveCOALESCE_FRAME, 0);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 5, "%u ready", usZwaveCoalesceReady(&c, BUFFER_SIZE));
+
+	/* Released bytes stay due under a stricter policy. */
+	vZwaveCoalesceSetPolicy(&c, zwaveCOALESCE_SIZE, 100);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 5, "%u ready", usZwaveCoalesceReady(&c, BUFFER_SIZE));
+	vZwaveCoalesceSent(&c, 5);
+	add(&c, bytes, 4);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 0, "%u ready", usZwaveCoalesceReady(&c, BUFFER_SIZE));
+	vZwaveCoalesceSetPolicy(&c, zwaveCOALESCE_NONE, 0);
+	TEST_CHECK(usZwaveCoalesceReady(&c, BUFFER_SIZE) == 6, "%u ready", usZwaveCoalesceReady(&c, BUFFER_SIZE));
+}
+
+int main(void)
+{
+	test_none();
+	test_frame();
+	test_size();
+	test_gap();
+	test_set_policy();
+	return TEST_END();
+}
@@ -0,0 +1,89 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the control tool (NETWORK/ZWaveTCP/zwave_control.c):
+ *        the decoding of the answers and the load between two of them.
+ *
+ *****************************************************************************/
+
+#include "test.h"
+
+#define ZWAVE_CONTROL_NO_MAIN
+#include "zwave_control.c"
+
+static void put32( unsigned char *p, unsigned long ulValue )
+{
+  p[ 0 ] = ( unsigned char ) ( ulValue >> 24 );
+  p[ 1 ] = ( unsigned char ) ( ulValue >> 16 );
+  p[ 2 ] = ( unsigned char ) ( ulValue >> 8 );
+  p[ 3 ] = ( unsigned char ) ulValue;
+}
+
+static void make_load( unsigned char *pucAnswer, unsigned long ulNow, unsigned long ulIdle,
+                       unsigned long ulTask, unsigned long ulInterrupt )
+{
+  pucAnswer[ 0 ] = zwaveCONTROL_LOAD;
+  pucAnswer[ 1 ] = zwaveCONTROL_OK;
+  put32( pucAnswer + 2, ulNow );
+  put32( pucAnswer + 6, ulIdle );
+  put32( pucAnswer + 10, ulTask );
+  put32( pucAnswer + 14, ulInterrupt );
+}
+
+static void test_load( void )
+{
+  unsigned char aucAnswer[ zwaveCONTROL_LOAD_SIZE ];
+  xZwaveLoad xFrom, xTo;
+  double dBusy, dTask, dInterrupt;
+
+  make_load( aucAnswer, 0x12345678, 0x01020304, 0xA0B0C0D0, 7 );
+  TEST_CHECK( iZwaveLoadDecode( &xFrom, aucAnswer, sizeof( aucAnswer ) ) == zwaveCONTROL_OK, "not decoded" );
+  TEST_CHECK( xFrom.ulNow == 0x12345678 && xFrom.ulIdle == 0x01020304 &&
+              xFrom.ulSerialTask == 0xA0B0C0D0 && xFrom.ulSerialInterrupt == 7,
+              "decoded %lx %lx %lx %lx", xFrom.ulNow, xFrom.ulIdle, xFrom.ulSerialTask, xFrom.ulSerialInterrupt );
+
+  TEST_CHECK( iZwaveLoadDecode( &xFrom, aucAnswer, sizeof( aucAnswer ) - 1 ) == zwaveCONTROL_BAD_REQUEST, "short answer taken" );
+  aucAnswer[ 1 ] = zwaveCONTROL_UNSUPPORTED;
+  TEST_CHECK( iZwaveLoadDecode( &xFrom, aucAnswer, 2 ) == zwaveCONTROL_UNSUPPORTED, "status lost" );
+  aucAnswer[ 0 ] = zwaveCONTROL_COALESCE;
+  TEST_CHECK( iZwaveLoadDecode( &xFrom, aucAnswer, 2 ) == zwaveCONTROL_BAD_REQUEST, "other command taken" );
+
+  /* 1 s at 48 MHz, across the wrap of every counter: idle 75 %, serial
+  task 5 %, USART interrupt 2 %. */
+  make_load( aucAnswer, 0xFF000000, 0xFFF00000, 0xFFFFFF00, 0xFFFFFFFF );
+  iZwaveLoadDecode( &xFrom, aucAnswer, sizeof( aucAnswer ) );
+  make_load( aucAnswer, 0xFF000000 + 48000000, 0xFFF00000 + 36000000, 0xFFFFFF00 + 2400000, 0xFFFFFFFF + 960000 );
+  iZwaveLoadDecode( &xTo, aucAnswer, sizeof( aucAnswer ) );
+  TEST_CHECK( iZwaveLoadShare( &xFrom, &xTo, &dBusy, &dTask, &dInterrupt ), "no time passed" );
+  TEST_CHECK( dBusy > 24.999 && dBusy < 25.001, "busy %.3f %%", dBusy );
+  TEST_CHECK( dTask > 4.999 && dTask < 5.001, "serial task %.3f %%", dTask );
+  TEST_CHECK( dInterrupt > 1.999 && dInterrupt < 2.001, "interrupt %.3f %%", dInterrupt );
+
+  TEST_CHECK( !iZwaveLoadShare( &xTo, &xTo, &dBusy, &dTask, &dInterrupt ), "load of no time" );
+}
+
+static void test_baud( void )
+{
+  unsigned char aucAnswer[ zwaveCONTROL_BAUD_SIZE ] = { zwaveCONTROL_BAUD, zwaveCONTROL_OK };
+  xZwaveBaud xBaud;
+
+  put32( aucAnswer + 2, 2500000 );
+  put32( aucAnswer + 6, 2400000 );
+  aucAnswer[ 10 ] = 0xFE;
+  aucAnswer[ 11 ] = 0x70;
+  TEST_CHECK( iZwaveBaudDecode( &xBaud, aucAnswer, sizeof( aucAnswer ) ) == zwaveCONTROL_OK, "not decoded" );
+  TEST_CHECK( xBaud.ulSetPoint == 2500000 && xBaud.ulActual == 2400000 && xBaud.iError == -400,
+              "decoded %lu %lu %d", xBaud.ulSetPoint, xBaud.ulActual, xBaud.iError );
+
+  TEST_CHECK( iZwaveBaudDecode( &xBaud, aucAnswer, 10 ) == zwaveCONTROL_BAD_REQUEST, "short answer taken" );
+  aucAnswer[ 1 ] = zwaveCONTROL_BUSY;
+  TEST_CHECK( iZwaveBaudDecode( &xBaud, aucAnswer, 2 ) == zwaveCONTROL_BUSY, "status lost" );
+  aucAnswer[ 0 ] = zwaveCONTROL_LOAD;
+  TEST_CHECK( iZwaveBaudDecode( &xBaud, aucAnswer, 2 ) == zwaveCONTROL_BAD_REQUEST, "other command taken" );
+}
+
+int main( void )
+{
+  test_load();
+  test_baud();
+  return TEST_END();
+}
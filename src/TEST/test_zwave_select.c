@@ -0,0 +1,116 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the select() bridge (NETWORK/ZWaveTCP/ZWaveSelect.c):
+ *        one controller on the Serial API link, a second one refused, the
+ *        frames of the first one passed whole and its responses sent to it
+ *        alone.
+ *
+ * The bridge runs on the sockets of api/, one turn of its loop at a time;
+ * the serial task is played by the test, through the two queues.
+ *
+ *****************************************************************************/
+
+#include "test.h"
+
+#define zwaveBRIDGE_API  zwaveBRIDGE_SELECT
+
+#include "api_helper.h"
+#include "zwave_helper.h"
+#include "ZWaveTCP.h"
+
+/* The bridge listens where the controllers of tcp_helper connect. */
+#undef zwavePORT
+#define zwavePORT  TCP_HELPER_LOCAL_PORT
+#include "ZWaveSelect.c"
+
+/* The port of the second controller. */
+#define OTHER_PORT  ( TCP_HELPER_REMOTE_PORT + 1 )
+
+static int lListener, lChannel;
+
+/* Bytes of zw_tcp_recv_queue, as the serial task takes them. */
+static int serial_take(unsigned char *buf, int max)
+{
+	int n = 0;
+
+	while (n < max && xQueueReceive(zw_tcp_recv_queue, &buf[n], 0) == pdPASS)
+		n++;
+	vZwaveSelectKick();
+	return n;
+}
+
+/* Bytes of data and flags of the segments sent since tcp_helper_nsent was
+   cleared. */
+static int sent(u8_t *flags)
+{
+	int len = 0, i;
+
+	*flags = 0;
+	for (i = 0; i < tcp_helper_nsent; i++){
+		len += tcp_helper_sent[i].len;
+		*flags |= tcp_helper_sent[i].flags;
+	}
+	return len;
+}
+
+int main(void)
+{
+	static const unsigned char request[] = { 0x01, 0x03, 0x00, 0x15, 0xE9 };
+	static const unsigned char other[] = { 0x01, 0x03, 0x00, 0x07, 0xFB };
+	static const unsigned char response[] = { 0x01, 0x08, 0x01, 0x15, 0x5A, 0x2D, 0x57, 0x61, 0x76, 0x65 };
+	unsigned char buf[32];
+	u32_t iss, other_iss;
+	u8_t flags;
+	int lSocket, n, i;
+
+	tcp_helper_init();
+	usart_recv_queue = xQueueCreate(zwaveRECV_QUEUE_LENGTH, 1);
+	TEST_CHECK(prvZwaveSelectOpen(&lListener, &lChannel) == pdPASS, "bridge not started");
+
+	/* The first controller is served. */
+	iss = tcp_helper_connect();
+	prvZwaveSelectPoll(lListener, lChannel);
+	lSocket = xZwaveClients[0].lSocket;
+	TEST_CHECK(lSocket >= 0, "first controller refused");
+
+	/* The second one is closed at once and its request dropped. */
+	tcp_helper_remote_port = OTHER_PORT;
+	other_iss = tcp_helper_connect();
+	tcp_helper_nsent = 0;
+	prvZwaveSelectPoll(lListener, lChannel);
+	sent(&flags);
+	TEST_CHECK(flags & (TCP_FIN | TCP_RST), "second controller not closed");
+	TEST_CHECK(xZwaveClients[0].lSocket == lSocket, "first controller replaced");
+	tcp_helper_input(TCP_HELPER_REMOTE_ISS, other_iss, TCP_ACK | TCP_PSH, other, sizeof(other));
+	prvZwaveSelectPoll(lListener, lChannel);
+
+	/* The request of the first one reaches the serial port whole and
+	alone. */
+	tcp_helper_remote_port = TCP_HELPER_REMOTE_PORT;
+	tcp_helper_input(TCP_HELPER_REMOTE_ISS, iss, TCP_ACK | TCP_PSH, request, sizeof(request));
+	prvZwaveSelectPoll(lListener, lChannel);
+	n = serial_take(buf, sizeof(buf));
+	TEST_CHECK(n == sizeof(request) && memcmp(buf, request, n) == 0,
+			"%d bytes on the serial port for a request of %u", n, (unsigned)sizeof(request));
+
+	/* The response goes to it, once. */
+	for (i = 0; i < (int)sizeof(response); i++)
+		xQueueSend(usart_recv_queue, &response[i], 0);
+	vZwaveSelectKick();
+	tcp_helper_nsent = 0;
+	prvZwaveSelectPoll(lListener, lChannel);
+	n = sent(&flags);
+	TEST_CHECK(n == sizeof(response), "%d bytes sent for a response of %u", n, (unsigned)sizeof(response));
+	TEST_CHECK(usZwaveFromSerialLength == 0, "response still held for another controller");
+
+	/* It leaves: the next controller is served. */
+	tcp_helper_input(TCP_HELPER_REMOTE_ISS + sizeof(request), iss + sizeof(response), TCP_ACK | TCP_FIN, NULL, 0);
+	prvZwaveSelectPoll(lListener, lChannel);
+	TEST_CHECK(xZwaveClients[0].lSocket < 0, "closed controller kept");
+	tcp_helper_remote_port = OTHER_PORT + 1;
+	tcp_helper_connect();
+	prvZwaveSelectPoll(lListener, lChannel);
+	TEST_CHECK(xZwaveClients[0].lSocket >= 0, "next controller refused");
+
+	return TEST_END();
+}
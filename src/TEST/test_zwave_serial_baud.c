@@ -0,0 +1,150 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the baud rate of the serial task (uart_task.c) and of
+ *        the divisor math of the USART driver under it, against the register
+ *        model: CD, FP and OVER across PBA clocks and baud rates, the rate
+ *        and error reported, the rates refused.
+ *
+ *****************************************************************************/
+
+#include <math.h>
+
+#include "test.h"
+
+#include "zwave_helper.h"
+#include "uart_task.c"
+
+static const unsigned long pba_clocks[] = { 12000000, 16500000, 24000000, 33000000, 48000000, 66000000 };
+
+static const unsigned long baudrates[] = { 1200, 9600, 19200, 38400, 57600, 115200, 230400, 250000,
+                                           460800, 500000, 921600, 1000000, 1500000, 3000000 };
+
+/* The serial task up to its loop, as far as the baud rate goes. */
+static void serial_open(void)
+{
+	usart_baudrate = USART_BAUDRATE;
+	usart_tx_busy = pdFALSE;
+	usart_init_rs232(EXAMPLE_USART, &USART_OPTIONS, EXAMPLE_TARGET_PBACLK_FREQ_HZ);
+	zwave_helper_usart_update();
+	vSemaphoreCreateBinary(usart_tx_done);
+}
+
+/* What the USART generates from BRGR and MR: PBA / (over * (CD + FP / 8)). */
+static double usart_rate(unsigned long pba, unsigned int over, unsigned int cd_fp)
+{
+	return 8.0 * pba / ((double)over * cd_fp);
+}
+
+static void test_divisor(void)
+{
+	unsigned int i, j, over, cd, fp, cd_fp;
+	unsigned long pba, baud, actual;
+	double rate, error;
+	int status;
+
+	for (i = 0; i < sizeof(pba_clocks) / sizeof(pba_clocks[0]); i++) {
+		for (j = 0; j < sizeof(baudrates) / sizeof(baudrates[0]); j++) {
+			pba = pba_clocks[i];
+			baud = baudrates[j];
+			zwave_helper_usart.mr = 0;
+			zwave_helper_usart.brgr = 0;
+			status = usart_set_baudrate(&zwave_helper_usart, baud, pba);
+			actual = usart_get_actual_baudrate(baud, pba);
+
+			/* The largest oversampling the clock allows. */
+			over = (pba >= 16 * baud) ? 16 : 8;
+			if (status != USART_SUCCESS) {
+				TEST_CHECK(actual == 0, "%lu Hz %lu baud: refused, rate %lu", pba, baud, actual);
+				TEST_CHECK(8.0 * pba / ((double)over * baud) < 7.5,
+				           "%lu Hz %lu baud refused in range", pba, baud);
+				continue;
+			}
+			TEST_CHECK(((zwave_helper_usart.mr & AVR32_USART_MR_OVER_MASK) != 0) == (over == 8),
+			           "%lu Hz %lu baud: OVER %lu", pba, baud, zwave_helper_usart.mr & AVR32_USART_MR_OVER_MASK);
+			cd = (zwave_helper_usart.brgr >> AVR32_USART_BRGR_CD_OFFSET) & ((1 << AVR32_USART_BRGR_CD_SIZE) - 1);
+			fp = (zwave_helper_usart.brgr >> AVR32_USART_BRGR_FP_OFFSET) & ((1 << AVR32_USART_BRGR_FP_SIZE) - 1);
+			cd_fp = cd * 8 + fp;
+			TEST_CHECK(cd >= 1, "%lu Hz %lu baud: CD %u", pba, baud, cd);
+
+			/* The closest divisor of the 1/8 steps. */
+			rate = usart_rate(pba, over, cd_fp);
+			error = fabs(rate - baud);
+			TEST_CHECK(error <= fabs(usart_rate(pba, over, cd_fp + 1) - baud) &&
+			           (cd_fp == 8 || error <= fabs(usart_rate(pba, over, cd_fp - 1) - baud)),
+			           "%lu Hz %lu baud: CD %u FP %u not the closest", pba, baud, cd, fp);
+
+			/* The rate reported is the rate generated. */
+			TEST_CHECK(fabs(rate - actual) <= 0.5, "%lu Hz %lu baud: reported %lu, generates %.1f",
+			           pba, baud, actual, rate);
+		}
+	}
+}
+
+static void test_rates(void)
+{
+	static const struct { unsigned long baud, actual; short error; unsigned int cd, fp; } expected[] = {
+		{   57600,   57692,  15, 26, 0 },
+		{  115200,  115385,  16, 13, 0 },
+		{  230400,  230769,  16,  6, 4 },
+		{  921600,  923077,  16,  1, 5 },
+		{ 1500000, 1500000,   0,  1, 0 },
+		{ 3000000, 3000000,   0,  1, 0 },
+	};
+	unsigned int i;
+	signed short error;
+
+	/* At the 24 MHz PBA clock of the board. */
+	for (i = 0; i < sizeof(expected) / sizeof(expected[0]); i++) {
+		TEST_CHECK(ulSerialBaudrateFor(expected[i].baud, &error) == expected[i].actual &&
+		           error == expected[i].error, "%lu baud: %lu, error %d", expected[i].baud,
+		           (unsigned long)ulSerialBaudrateFor(expected[i].baud, NULL), error);
+		usart_set_baudrate(&zwave_helper_usart, expected[i].baud, EXAMPLE_TARGET_PBACLK_FREQ_HZ);
+		TEST_CHECK(zwave_helper_usart.brgr == (expected[i].cd | expected[i].fp << AVR32_USART_BRGR_FP_OFFSET),
+		           "%lu baud: BRGR %08lx", expected[i].baud, zwave_helper_usart.brgr);
+	}
+
+	TEST_CHECK(ulSerialBaudrateFor(2500000, &error) == 2400000 && error == -400, "2500000 baud: error %d", error);
+	TEST_CHECK(ulSerialBaudrateFor(4000000, &error) == 0 && error == 0x7FFF, "4000000 baud: error %d", error);
+	/* Below 100 baud the error is not computed: refused. */
+	TEST_CHECK(ulSerialBaudrateFor(50, &error) == 50 && error == 0x7FFF, "50 baud: error %d", error);
+}
+
+static void test_set(void)
+{
+	signed short error;
+
+	/* Before the serial task set up the USART. */
+	usart_tx_done = NULL;
+	TEST_CHECK(xSerialSetBaudrate(115200, 0) == pdFAIL, "set before the serial task");
+
+	serial_open();
+	TEST_CHECK(ulSerialGetBaudrateSetPoint() == 57600 && ulSerialGetBaudrate(&error) == 57692 && error == 15,
+	           "start up rate %lu, error %d", (unsigned long)ulSerialGetBaudrate(NULL), error);
+	TEST_CHECK(zwave_helper_usart.brgr == 26, "start up BRGR %08lx", zwave_helper_usart.brgr);
+
+	TEST_CHECK(xSerialSetBaudrate(115200, 0) == pdPASS, "115200 refused");
+	TEST_CHECK(ulSerialGetBaudrateSetPoint() == 115200 && ulSerialGetBaudrate(&error) == 115385 && error == 16,
+	           "rate %lu, error %d", (unsigned long)ulSerialGetBaudrate(NULL), error);
+	TEST_CHECK(zwave_helper_usart.brgr == 13 && !(zwave_helper_usart.mr & AVR32_USART_MR_OVER_MASK),
+	           "BRGR %08lx MR %08lx", zwave_helper_usart.brgr, zwave_helper_usart.mr);
+
+	/* 4 % off, then out of range: the rate is kept. */
+	TEST_CHECK(xSerialSetBaudrate(2500000, 0) == pdFAIL, "2500000 taken");
+	TEST_CHECK(xSerialSetBaudrate(4000000, 0) == pdFAIL, "4000000 taken");
+	TEST_CHECK(ulSerialGetBaudrateSetPoint() == 115200 && zwave_helper_usart.brgr == 13,
+	           "rate %lu, BRGR %08lx", (unsigned long)ulSerialGetBaudrateSetPoint(), zwave_helper_usart.brgr);
+
+	/* Not while the USART sends. */
+	usart_tx_busy = pdTRUE;
+	TEST_CHECK(xSerialSetBaudrate(57600, 0) == pdFAIL, "set while sending");
+	TEST_CHECK(ulSerialGetBaudrateSetPoint() == 115200, "rate %lu", (unsigned long)ulSerialGetBaudrateSetPoint());
+	usart_tx_busy = pdFALSE;
+}
+
+int main(void)
+{
+	test_divisor();
+	test_rates();
+	test_set();
+	return TEST_END();
+}
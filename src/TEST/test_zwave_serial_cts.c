@@ -0,0 +1,98 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the CTS handshaking of the transmit side of the serial
+ *        task (uart_task.c): no byte written to THR while the module holds
+ *        CTS deasserted, the send resumed on the CTSIC of its assertion.
+ *
+ * The transmitter of the register model is always ready: TXRDY and TXEMPTY
+ * stay set, a byte is sent when the interrupt writes THR.
+ *
+ *****************************************************************************/
+
+#include "test.h"
+
+#include "zwave_helper.h"
+#include "uart_task.c"
+
+/* THR before the interrupt: no byte written. */
+#define THR_UNWRITTEN  0xFFFFFFFFUL
+
+/* The transmit side of the serial task, the module ready to receive. */
+static void serial_open(void)
+{
+	usart_tx_head = usart_tx_tail = 0;
+	usart_tx_busy = pdFALSE;
+	zwave_helper_usart.imr = 0;
+	zwave_helper_usart.csr = AVR32_USART_CSR_TXRDY_MASK | AVR32_USART_CSR_TXEMPTY_MASK;
+
+	usart_init_rs232(EXAMPLE_USART, &USART_OPTIONS, EXAMPLE_TARGET_PBACLK_FREQ_HZ);
+	vSemaphoreCreateBinary(usart_tx_done);
+	zwave_helper_usart_cts(1);
+	zwave_helper_usart_update();
+}
+
+/* One call of the interrupt. Returns the byte written to THR, -1 if none. */
+static int interrupt(void)
+{
+	zwave_helper_usart.thr = THR_UNWRITTEN;
+	usart_isr_non_naked_behaviour();
+	zwave_helper_usart_update();
+	if (zwave_helper_usart.thr == THR_UNWRITTEN)
+		return -1;
+	return (zwave_helper_usart.thr & AVR32_USART_THR_TXCHR_MASK) >> AVR32_USART_THR_TXCHR_OFFSET;
+}
+
+static void test_deasserted_mid_frame(void)
+{
+	static const unsigned char frame[] = { 0x01, 0x03, 0x00, 0x15, 0xE9 };
+	int i;
+
+	serial_open();
+	TEST_CHECK(usSerialTxWrite((const char *)frame, sizeof(frame)) == sizeof(frame), "frame not taken");
+	zwave_helper_usart_update();
+	TEST_CHECK(interrupt() == frame[0], "first byte not sent");
+
+	/* The module is busy: TXRDY traded for CTSIC, however often the
+	interrupt comes. */
+	zwave_helper_usart_cts(0);
+	for (i = 0; i < 3; i++)
+		TEST_CHECK(interrupt() == -1, "byte sent with CTS deasserted, interrupt %d", i);
+	TEST_CHECK(!(zwave_helper_usart.imr & AVR32_USART_CSR_TXRDY_MASK), "TXRDY left enabled");
+	TEST_CHECK(zwave_helper_usart.imr & AVR32_USART_CSR_CTSIC_MASK, "CTSIC not enabled");
+	TEST_CHECK(usart_tx_busy, "send over with %d bytes left", (int)sizeof(frame) - 1);
+
+	/* Asserted again: CTSIC gives TXRDY back, the rest of the frame goes in
+	order. */
+	zwave_helper_usart_cts(1);
+	TEST_CHECK(interrupt() == -1, "byte sent from the CTSIC interrupt");
+	TEST_CHECK(!(zwave_helper_usart.imr & AVR32_USART_CSR_CTSIC_MASK), "CTSIC left enabled");
+	for (i = 1; i < (int)sizeof(frame); i++)
+		TEST_CHECK(interrupt() == frame[i], "byte %d not sent after CTSIC", i);
+	interrupt();
+	TEST_CHECK(!usart_tx_busy && xSemaphoreTake(usart_tx_done, 0) == pdTRUE, "send not done");
+}
+
+static void test_deasserted_before_write(void)
+{
+	static const char ack = 0x06;
+
+	/* CTS changes while nothing is sent: CTSIC is masked, ignored. */
+	serial_open();
+	zwave_helper_usart_cts(0);
+	TEST_CHECK(interrupt() == -1 && zwave_helper_usart.imr == 0, "idle interrupt on CTSIC");
+
+	/* Written while the module is busy: held until it is ready. */
+	usSerialTxWrite(&ack, 1);
+	zwave_helper_usart_update();
+	TEST_CHECK(interrupt() == -1, "ACK sent with CTS deasserted");
+	zwave_helper_usart_cts(1);
+	interrupt();
+	TEST_CHECK(interrupt() == ack, "ACK not sent after CTSIC");
+}
+
+int main(void)
+{
+	test_deasserted_mid_frame();
+	test_deasserted_before_write();
+	return TEST_END();
+}
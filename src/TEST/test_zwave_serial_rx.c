@@ -0,0 +1,182 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the receive side of the serial task (uart_task.c): the
+ *        USART interrupt against the register model, and the drain of its
+ *        ring to usart_recv_queue.
+ *
+ * A byte is received as the USART does it: RHR and RXRDY set at the end of
+ * its stop bit, the interrupt called, RXRDY cleared by the read of RHR.
+ *
+ *****************************************************************************/
+
+#include "test.h"
+
+#include "zwave_helper.h"
+#include "uart_task.c"
+
+/* The serial task up to its loop: what vBasicSerialServer() sets up. */
+static void serial_open(void)
+{
+	usart_rx_head = usart_rx_tail = 0;
+	usart_rx_throttled = pdFALSE;
+	usart_recv_queue_spoiled = 0;
+	usart_overrun_errors = usart_framing_errors = usart_parity_errors = 0;
+	zwave_helper_usart.imr = 0;
+
+	usart_init_rs232(EXAMPLE_USART, &USART_OPTIONS, EXAMPLE_TARGET_PBACLK_FREQ_HZ);
+	zwave_helper_usart_update();
+	usart_recv_queue = xQueueCreate(USART_RECV_QUEUE_LENGTH, 1);
+	vSemaphoreCreateBinary(usart_rx_burst);
+	xSemaphoreTake(usart_rx_burst, 0);
+	vSemaphoreCreateBinary(usart_tx_done);
+	usart_set_rx_timeout(EXAMPLE_USART, USART_RX_TIMEOUT_BITS);
+	EXAMPLE_USART->ier = AVR32_USART_IER_RXRDY_MASK | AVR32_USART_IER_TIMEOUT_MASK |
+			AVR32_USART_IER_OVRE_MASK | AVR32_USART_IER_FRAME_MASK | AVR32_USART_IER_PARE_MASK;
+	EXAMPLE_USART->cr = AVR32_USART_CR_RTSEN_MASK;
+	zwave_helper_usart_update();
+}
+
+/* Byte c received at us. Returns what the interrupt returns. */
+static long receive(unsigned char c, unsigned long long us)
+{
+	long switch_required;
+
+	zwave_helper_set_time(us);
+	zwave_helper_usart.rhr = c;
+	zwave_helper_usart.csr |= AVR32_USART_CSR_RXRDY_MASK;
+	switch_required = usart_isr_non_naked_behaviour();
+	zwave_helper_usart.csr &= ~AVR32_USART_CSR_RXRDY_MASK;
+	return switch_required;
+}
+
+static void test_stamp(void)
+{
+	unsigned long long t = 1000000;
+	unsigned char c;
+	int i;
+
+	serial_open();
+	for (i = 0; i < 5; i++)
+		TEST_CHECK(!receive(0x10 + i, t + i * 87), "woken by byte %d", i);
+
+	/* Drained 3 ms after the last byte: the line was idle since the byte,
+	not since the drain. */
+	zwave_helper_set_time(t + 4 * 87 + 3000);
+	usart_rx_drain();
+	TEST_CHECK(ulZwaveCoalesceIdle() >= 2990 && ulZwaveCoalesceIdle() <= 3000,
+	           "idle %u", ulZwaveCoalesceIdle());
+	TEST_CHECK(uxQueueMessagesWaiting(usart_recv_queue) == 5, "%u bytes queued",
+	           uxQueueMessagesWaiting(usart_recv_queue));
+	for (i = 0; i < 5; i++) {
+		xQueueReceive(usart_recv_queue, &c, 0);
+		TEST_CHECK(c == 0x10 + i, "byte %d is %02x", i, c);
+	}
+
+	/* RXRDY masked: the byte is left in RHR. */
+	zwave_helper_usart.imr &= ~AVR32_USART_CSR_RXRDY_MASK;
+	receive(0x20, t + 10000);
+	TEST_CHECK(usart_rx_head == usart_rx_tail, "masked RXRDY taken");
+	zwave_helper_usart.imr |= AVR32_USART_CSR_RXRDY_MASK;
+
+	/* A byte dropped on a full ring is stamped anyway: the line was busy. */
+	usart_rx_head = usart_rx_tail + USART_RX_RING_SIZE;
+	receive(0x20, t + 20000);
+	TEST_CHECK(usart_recv_queue_spoiled == 1, "%lu spoiled", usart_recv_queue_spoiled);
+	zwave_helper_set_time(t + 20500);
+	TEST_CHECK(ulZwaveCoalesceIdle() >= 490 && ulZwaveCoalesceIdle() <= 500,
+	           "idle %u after a dropped byte", ulZwaveCoalesceIdle());
+}
+
+static void test_timeout(void)
+{
+	serial_open();
+	receive(0x06, 2000000);
+	TEST_CHECK(xSemaphoreTake(usart_rx_burst, 0) != pdTRUE, "burst ended by a byte");
+	TEST_CHECK(zwave_helper_usart.rtor == USART_RX_TIMEOUT_BITS, "RTOR %lu", zwave_helper_usart.rtor);
+
+	/* RTOR bit periods later: the end of the burst, the time-out restarted
+	for the next one. */
+	zwave_helper_set_time(2000000 + 260);
+	zwave_helper_usart.csr |= AVR32_USART_CSR_TIMEOUT_MASK;
+	TEST_CHECK(usart_isr_non_naked_behaviour(), "serial task not woken");
+	zwave_helper_usart.csr &= ~AVR32_USART_CSR_TIMEOUT_MASK;
+	TEST_CHECK(zwave_helper_usart_update() == AVR32_USART_CR_STTTO_MASK, "time-out not restarted");
+	TEST_CHECK(xSemaphoreTake(usart_rx_burst, 0) == pdTRUE, "burst not given");
+	usart_rx_drain();
+	TEST_CHECK(uxQueueMessagesWaiting(usart_recv_queue) == 1, "%u bytes queued",
+	           uxQueueMessagesWaiting(usart_recv_queue));
+}
+
+static void test_half_full(void)
+{
+	int i;
+
+	serial_open();
+	for (i = 0; i < USART_RX_RING_SIZE / 2 - 1; i++)
+		receive(0x55, 3000000 + i * 87);
+	TEST_CHECK(xSemaphoreTake(usart_rx_burst, 0) != pdTRUE, "given before half full");
+	TEST_CHECK(receive(0x55, 3000000 + i * 87), "not woken at half full");
+	TEST_CHECK(xSemaphoreTake(usart_rx_burst, 0) == pdTRUE, "not given at half full");
+}
+
+static void test_rts(void)
+{
+	int i;
+
+	serial_open();
+	for (i = 0; i < USART_RX_RTS_OFF - 1; i++)
+		receive(0x55, 4000000 + i * 87);
+	TEST_CHECK(zwave_helper_usart_update() == 0 && !usart_rx_throttled, "throttled early");
+	receive(0x55, 4000000 + i * 87);
+	TEST_CHECK(zwave_helper_usart_update() == AVR32_USART_CR_RTSDIS_MASK && usart_rx_throttled,
+	           "RTS not deasserted at %d bytes", USART_RX_RTS_OFF);
+
+	usart_rx_drain();
+	TEST_CHECK(zwave_helper_usart_update() == AVR32_USART_CR_RTSEN_MASK && !usart_rx_throttled,
+	           "RTS not asserted once drained");
+}
+
+static void test_line_errors(void)
+{
+	serial_open();
+	zwave_helper_usart.csr = AVR32_USART_CSR_OVRE_MASK | AVR32_USART_CSR_FRAME_MASK;
+	usart_isr_non_naked_behaviour();
+	zwave_helper_usart.csr = 0;
+	TEST_CHECK(usart_overrun_errors == 1 && usart_framing_errors == 1 && usart_parity_errors == 0,
+	           "errors %lu %lu %lu", usart_overrun_errors, usart_framing_errors, usart_parity_errors);
+	TEST_CHECK(zwave_helper_usart_update() == AVR32_USART_CR_RSTSTA_MASK, "status not reset");
+}
+
+static void test_run_time(void)
+{
+	static int task;
+	unsigned long long task_run_time, isr_run_time;
+
+	serial_open();
+	vSerialGetRunTime(&task_run_time, &isr_run_time);
+	TEST_CHECK(task_run_time == 0, "task run time %llu before the task", task_run_time);
+
+	/* 100 cycles from the entry of the interrupt to its exit. */
+	usart_task = &task;
+	zwave_helper_task_run_time = 5000;
+	usart_isr_run_time = 0;
+	zwave_helper_run_time_step = 100;
+	receive(0x55, 5000000);
+	receive(0x55, 5000087);
+	zwave_helper_run_time_step = 0;
+	vSerialGetRunTime(&task_run_time, &isr_run_time);
+	TEST_CHECK(task_run_time == 5000, "task run time %llu", task_run_time);
+	TEST_CHECK(isr_run_time == 200, "interrupt run time %llu", isr_run_time);
+	usart_task = NULL;
+}
+
+int main(void)
+{
+	test_stamp();
+	test_timeout();
+	test_half_full();
+	test_rts();
+	test_line_errors();
+	test_run_time();
+	return TEST_END();
+}
@@ -0,0 +1,109 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host test of the sequence numbers of the UDP bridge
+ *        (NETWORK/ZWaveTCP/ZWaveUDP.c): repeats, frames ahead, and the
+ *        restart of a controller at sequence number 0 on the same port.
+ *
+ * The bridge runs on the UDP of api/, the controller is the peer of
+ * lwip/tcp_helper.c and the serial task is played by the test.
+ *
+ *****************************************************************************/
+
+#include "test.h"
+
+#define zwaveBRIDGE_API  zwaveBRIDGE_UDP
+
+#include "api_helper.h"
+#include "zwave_helper.h"
+#include "ZWaveTCP.h"
+
+/* The bridge listens where the controller of tcp_helper sends. */
+#undef zwavePORT
+#define zwavePORT  TCP_HELPER_LOCAL_PORT
+#include "ZWaveUDP.c"
+
+static const u8_t request[] = { 0x01, 0x03, 0x00, 0x15, 0xE9 };
+
+/* The controller sends the request as DATA seq; returns the bytes the
+   bridge queued to the serial port, -1 if it did not acknowledge it. */
+static int data(u8_t seq)
+{
+	u8_t dgram[zwaveUDP_HEADER_SIZE + sizeof(request)], c;
+	int queued = 0, i;
+
+	dgram[0] = zwaveUDP_DATA;
+	dgram[1] = seq;
+	memcpy(dgram + zwaveUDP_HEADER_SIZE, request, sizeof(request));
+	tcp_helper_udp_nsent = 0;
+	tcp_helper_udp_input(zwavePORT, dgram, sizeof(dgram));
+	while (xQueueReceive(zw_tcp_recv_queue, &c, 0) == pdPASS)
+		queued++;
+	for (i = 0; i < tcp_helper_udp_nsent; i++){
+		if (tcp_helper_udp_sent[i].data[0] == zwaveUDP_ACK && tcp_helper_udp_sent[i].data[1] == seq)
+			return queued;
+	}
+	return -1;
+}
+
+/* Sequence numbers from..to - 1, in order: all queued. */
+static void data_up_to(u8_t from, u8_t to)
+{
+	while (from != to){
+		TEST_CHECK(data(from) == sizeof(request), "frame %u not queued", from);
+		from++;
+	}
+}
+
+static int slots_sent(void)
+{
+	int n = 0, i;
+
+	for (i = 0; i < zwaveUDP_WINDOW; i++)
+		n += xZwaveUdpWindow[i].ucState == zwaveUDP_SLOT_SENT;
+	return n;
+}
+
+int main(void)
+{
+	static const u8_t response[] = { 0x01, 0x04, 0x01, 0x15, 0x00, 0xEF };
+	int i;
+
+	tcp_helper_init();
+	usart_recv_queue = xQueueCreate(zwaveRECV_QUEUE_LENGTH, 1);
+	vZwaveUdpInit(NULL);
+
+	/* A repeat, its ACK lost: acknowledged again, not queued twice. */
+	TEST_CHECK(data(0) == sizeof(request), "first frame not queued");
+	TEST_CHECK(data(0) == 0, "repeat queued again");
+
+	/* Sequence number 0 up to zwaveUDP_WINDOW frames later: a repeat. */
+	data_up_to(1, zwaveUDP_WINDOW);
+	TEST_CHECK(data(0) == 0, "repeat within the window taken as a restart");
+
+	/* Further on: the controller was restarted, a new session. */
+	data_up_to(zwaveUDP_WINDOW, zwaveUDP_WINDOW + 1);
+	TEST_CHECK(data(0) == sizeof(request), "frame 0 of a restarted controller not queued");
+	TEST_CHECK(data(1) == sizeof(request), "frame 1 after the restart not queued");
+
+	/* Close to the wrap, 0 is a frame ahead: dropped, no ACK. */
+	data_up_to(2, 256 - zwaveUDP_WINDOW + 1);
+	TEST_CHECK(data(0) == -1, "frame ahead taken as a restart");
+	data_up_to(256 - zwaveUDP_WINDOW + 1, 0);
+	TEST_CHECK(data(0) == sizeof(request), "frame 0 after the wrap not queued");
+
+	/* A restart forgets the frames sent to the controller before it. */
+	for (i = 0; i < (int)sizeof(response); i++)
+		xQueueSend(usart_recv_queue, &response[i], 0);
+	vZwaveUdpKick();
+	TEST_CHECK(slots_sent() == 1, "%d response frames waiting for their ACK", slots_sent());
+	data_up_to(1, zwaveUDP_WINDOW + 1);
+	TEST_CHECK(data(0) == sizeof(request), "frame 0 of a restarted controller not queued");
+	TEST_CHECK(slots_sent() == 0, "frames of the previous session kept");
+
+	/* Another port: a new session at any sequence number. */
+	tcp_helper_remote_port = TCP_HELPER_REMOTE_PORT + 1;
+	TEST_CHECK(data(7) == sizeof(request), "first frame of another port not queued");
+	TEST_CHECK(data(7) == 0, "repeat of another port queued again");
+
+	return TEST_END();
+}
@@ -0,0 +1,19 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of FreeRTOS.h.
+ *
+ *****************************************************************************/
+
+#ifndef INC_FREERTOS_H
+#define INC_FREERTOS_H
+
+#include "FreeRTOSConfig.h"
+
+#define pdFALSE   ( ( portBASE_TYPE ) 0 )
+#define pdTRUE    ( ( portBASE_TYPE ) 1 )
+#define pdPASS    ( pdTRUE )
+#define pdFAIL    ( pdFALSE )
+
+#include "portmacro.h"
+
+#endif
@@ -0,0 +1,22 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of FreeRTOSConfig.h: the values the Z-Wave sources
+ *        use.
+ *
+ *****************************************************************************/
+
+#ifndef FREERTOS_CONFIG_H
+#define FREERTOS_CONFIG_H
+
+#define configCPU_CLOCK_HZ                ( 48000000 )
+#define configPBA_CLOCK_HZ                ( 24000000 )
+#define configTICK_RATE_HZ                ( ( portTickType ) 1000 )
+#define configTICK_USE_TC                 0
+#define configTICK_TC_CHANNEL             2
+#define configSUPPORT_STATIC_ALLOCATION   0
+#define configUSE_TRACE_RECORDER          0
+#define configGENERATE_RUN_TIME_STATS     1
+
+#include "trace_recorder.h"
+
+#endif
@@ -0,0 +1,200 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host model of the AVR32 registers the Z-Wave sources use: the
+ *        counter values of the TC channels, the USART of the Z-Wave module
+ *        (USART1 of the EVK1100) and the MACB, set and read by the test.
+ *
+ * The USART registers are plain memory: CSR and RHR are what the test put
+ * there, IER and IDR are applied to IMR by zwave_helper_usart_update(), CR
+ * keeps the last command written. CTS and CTSIC are driven by
+ * zwave_helper_usart_cts(), CTSIC cleared by the next update as the read of
+ * CSR in the interrupt clears it. The bit layout is the UC3A one.
+ *
+ * The MACB registers are plain memory too, for the receive path of the
+ * driver: the test plays the DMA on the receive descriptors.
+ *
+ *****************************************************************************/
+
+#ifndef AVR32_IO_H
+#define AVR32_IO_H
+
+typedef struct
+{
+	unsigned long cv;
+} avr32_tc_channel_t;
+
+typedef struct
+{
+	avr32_tc_channel_t channel[3];
+} avr32_tc_t;
+
+extern volatile avr32_tc_t zwave_helper_tc;
+#define AVR32_TC  zwave_helper_tc
+
+typedef struct
+{
+	unsigned long cr, mr, ier, idr, imr, csr, rhr, thr, brgr, rtor, ttgr, fidi, ner, ifr, man;
+} avr32_usart_t;
+
+extern volatile avr32_usart_t zwave_helper_usart;
+#define AVR32_USART1  zwave_helper_usart
+
+#define AVR32_USART1_RXD_0_0_PIN         5
+#define AVR32_USART1_RXD_0_0_FUNCTION    0
+#define AVR32_USART1_TXD_0_0_PIN         6
+#define AVR32_USART1_TXD_0_0_FUNCTION    0
+#define AVR32_USART1_RTS_0_0_PIN         7
+#define AVR32_USART1_RTS_0_0_FUNCTION    0
+#define AVR32_USART1_CTS_0_0_PIN         8
+#define AVR32_USART1_CTS_0_0_FUNCTION    0
+#define AVR32_USART1_CLK_PBA             9
+#define AVR32_USART1_IRQ                 192
+#define AVR32_PDCA_CLK_HSB               0
+#define AVR32_PDCA_CLK_PBA               0
+#define AVR32_INTC_INT0                  0
+#define AVR32_INTC_INT2                  2
+
+#define AVR32_USART_CR_RSTRX_MASK        0x00000004
+#define AVR32_USART_CR_RSTTX_MASK        0x00000008
+#define AVR32_USART_CR_RXEN_MASK         0x00000010
+#define AVR32_USART_CR_RXDIS_MASK        0x00000020
+#define AVR32_USART_CR_TXEN_MASK         0x00000040
+#define AVR32_USART_CR_TXDIS_MASK        0x00000080
+#define AVR32_USART_CR_RSTSTA_MASK       0x00000100
+#define AVR32_USART_CR_STTTO_MASK        0x00000800
+#define AVR32_USART_CR_SENDA_MASK        0x00001000
+#define AVR32_USART_CR_RSTIT_MASK        0x00002000
+#define AVR32_USART_CR_RSTNACK_MASK      0x00004000
+#define AVR32_USART_CR_DTRDIS_MASK       0x00020000
+#define AVR32_USART_CR_RTSEN_MASK        0x00040000
+#define AVR32_USART_CR_RTSDIS_MASK       0x00080000
+
+#define AVR32_USART_MR_MODE_OFFSET       0
+#define AVR32_USART_MR_MODE_MASK         0x0000000F
+#define AVR32_USART_MR_MODE_NORMAL       0x00000000
+#define AVR32_USART_MR_MODE_RS485        0x00000001
+#define AVR32_USART_MR_MODE_HARDWARE     0x00000002
+#define AVR32_USART_MR_MODE_MODEM        0x00000003
+#define AVR32_USART_MR_MODE_ISO7816_T0   0x00000004
+#define AVR32_USART_MR_MODE_ISO7816_T1   0x00000006
+#define AVR32_USART_MODE_IRDA            0x00000008
+#define AVR32_USART_MR_USCLKS_OFFSET     4
+#define AVR32_USART_MR_USCLKS_MASK       0x00000030
+#define AVR32_USART_MR_USCLKS_MCK        0x00000000
+#define AVR32_USART_MR_USCLKS_SCK        0x00000003
+#define AVR32_USART_MR_CHRL_OFFSET       6
+#define AVR32_USART_MR_SYNC_OFFSET       8
+#define AVR32_USART_MR_SYNC_MASK         0x00000100
+#define AVR32_USART_MR_PAR_OFFSET        9
+#define AVR32_USART_MR_PAR_EVEN          0x00000000
+#define AVR32_USART_MR_PAR_ODD           0x00000001
+#define AVR32_USART_MR_PAR_SPACE         0x00000002
+#define AVR32_USART_MR_PAR_MARK          0x00000003
+#define AVR32_USART_MR_PAR_NONE          0x00000004
+#define AVR32_USART_MR_PAR_MULTI         0x00000006
+#define AVR32_USART_MR_NBSTOP_OFFSET     12
+#define AVR32_USART_MR_NBSTOP_1          0x00000000
+#define AVR32_USART_MR_NBSTOP_1_5        0x00000001
+#define AVR32_USART_MR_NBSTOP_2          0x00000002
+#define AVR32_USART_MR_CHMODE_OFFSET     14
+#define AVR32_USART_MR_CHMODE_NORMAL     0x00000000
+#define AVR32_USART_MR_CHMODE_ECHO       0x00000001
+#define AVR32_USART_MR_CHMODE_LOCAL_LOOP 0x00000002
+#define AVR32_USART_MR_CHMODE_REMOTE_LOOP 0x00000003
+#define AVR32_USART_MR_MSBF_OFFSET       16
+#define AVR32_USART_MR_MODE9_MASK        0x00020000
+#define AVR32_USART_MR_CLKO_MASK         0x00040000
+#define AVR32_USART_MR_OVER_OFFSET       19
+#define AVR32_USART_MR_OVER_MASK         0x00080000
+#define AVR32_USART_MR_OVER_X16          0x00000000
+#define AVR32_USART_MR_OVER_X8           0x00000001
+#define AVR32_USART_MR_INACK_OFFSET      20
+#define AVR32_USART_MR_DSNACK_OFFSET     21
+#define AVR32_USART_MR_MAX_ITERATION_OFFSET 24
+#define AVR32_USART_MR_FILTER_MASK       0x10000000
+
+/* CSR, IER, IDR and IMR share the layout. */
+#define AVR32_USART_CSR_RXRDY_MASK       0x00000001
+#define AVR32_USART_CSR_TXRDY_MASK       0x00000002
+#define AVR32_USART_CSR_OVRE_MASK        0x00000020
+#define AVR32_USART_CSR_FRAME_MASK       0x00000040
+#define AVR32_USART_CSR_PARE_MASK        0x00000080
+#define AVR32_USART_CSR_TIMEOUT_MASK     0x00000100
+#define AVR32_USART_CSR_TXEMPTY_MASK     0x00000200
+#define AVR32_USART_CSR_CTSIC_MASK       0x00080000
+#define AVR32_USART_CSR_CTS_MASK         0x00800000
+#define AVR32_USART_IER_RXRDY_MASK       AVR32_USART_CSR_RXRDY_MASK
+#define AVR32_USART_IER_TXRDY_MASK       AVR32_USART_CSR_TXRDY_MASK
+#define AVR32_USART_IER_OVRE_MASK        AVR32_USART_CSR_OVRE_MASK
+#define AVR32_USART_IER_FRAME_MASK       AVR32_USART_CSR_FRAME_MASK
+#define AVR32_USART_IER_PARE_MASK        AVR32_USART_CSR_PARE_MASK
+#define AVR32_USART_IER_TIMEOUT_MASK     AVR32_USART_CSR_TIMEOUT_MASK
+#define AVR32_USART_IER_TXEMPTY_MASK     AVR32_USART_CSR_TXEMPTY_MASK
+#define AVR32_USART_IER_CTSIC_MASK       AVR32_USART_CSR_CTSIC_MASK
+#define AVR32_USART_IDR_TXRDY_MASK       AVR32_USART_CSR_TXRDY_MASK
+#define AVR32_USART_IDR_TXEMPTY_MASK     AVR32_USART_CSR_TXEMPTY_MASK
+#define AVR32_USART_IDR_CTSIC_MASK       AVR32_USART_CSR_CTSIC_MASK
+
+#define AVR32_USART_RHR_RXCHR_OFFSET     0
+#define AVR32_USART_RHR_RXCHR_MASK       0x000001FF
+#define AVR32_USART_THR_TXCHR_OFFSET     0
+#define AVR32_USART_THR_TXCHR_MASK       0x000001FF
+
+#define AVR32_USART_BRGR_CD_OFFSET       0
+#define AVR32_USART_BRGR_CD_SIZE         16
+#define AVR32_USART_BRGR_FP_OFFSET       16
+#define AVR32_USART_BRGR_FP_SIZE         3
+
+#define AVR32_USART_RTOR_TO_OFFSET       0
+#define AVR32_USART_RTOR_TO_MASK         0x0000FFFF
+
+typedef struct
+{
+	unsigned long ncr, ncfgr, nsr, tsr, rbqp, tbqp, rsr, isr, ier, idr, imr, man;
+	unsigned long hrb, hrt, sa1b, sa1t, usrio;
+} avr32_macb_t;
+
+extern volatile avr32_macb_t zwave_helper_macb;
+#define AVR32_MACB  zwave_helper_macb
+
+#define AVR32_MACB_IRQ                   64
+
+#define AVR32_MACB_NCR_RE_MASK           0x00000004
+#define AVR32_MACB_NCR_TE_MASK           0x00000008
+#define AVR32_MACB_NCR_MPE_MASK          0x00000010
+#define AVR32_MACB_RE_OFFSET             2
+#define AVR32_MACB_TE_OFFSET             3
+#define AVR32_MACB_TSTART_MASK           0x00000200
+
+#define AVR32_MACB_SPD_MASK              0x00000001
+#define AVR32_MACB_FD_MASK               0x00000002
+#define AVR32_MACB_NCFGR_MTI_MASK        0x00000040
+#define AVR32_MACB_NCFGR_CLK_OFFSET      10
+#define AVR32_MACB_NCFGR_CLK_DIV8        0x00000000
+#define AVR32_MACB_NCFGR_CLK_DIV16       0x00000001
+#define AVR32_MACB_NCFGR_CLK_DIV32       0x00000002
+#define AVR32_MACB_NCFGR_CLK_DIV64       0x00000003
+#define AVR32_MACB_NCFGR_DRFCS_MASK      0x00020000
+
+#define AVR32_MACB_NSR_IDLE_MASK         0x00000004
+#define AVR32_MACB_TSR_COMP_MASK         0x00000020
+
+#define AVR32_MACB_RSR_BNA_MASK          0x00000001
+#define AVR32_MACB_REC_MASK              0x00000002
+#define AVR32_MACB_RSR_OVR_MASK          0x00000004
+
+#define AVR32_MACB_IER_RCOMP_MASK        0x00000002
+#define AVR32_MACB_IDR_RCOMP_MASK        0x00000002
+#define AVR32_MACB_IER_TCOMP_MASK        0x00000080
+#define AVR32_MACB_TCOMP_MASK            0x00000080
+
+#define AVR32_MACB_SOF_OFFSET            30
+#define AVR32_MACB_SOF_MASK              0xC0000000
+#define AVR32_MACB_RW_OFFSET             28
+#define AVR32_MACB_PHYA_OFFSET           23
+#define AVR32_MACB_REGA_OFFSET           18
+#define AVR32_MACB_CODE_OFFSET           16
+
+#define AVR32_MACB_RMII_MASK             0x00000001
+
+#endif
@@ -0,0 +1,13 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of board.h: the EVK1100.
+ *
+ *****************************************************************************/
+
+#ifndef _BOARD_H_
+#define _BOARD_H_
+
+#define EVK1100  1
+#define BOARD    EVK1100
+
+#endif
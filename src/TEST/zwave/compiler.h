@@ -0,0 +1,22 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of compiler.h: what the USART and MACB drivers use.
+ *
+ *****************************************************************************/
+
+#ifndef _COMPILER_H_
+#define _COMPILER_H_
+
+typedef unsigned char Bool;
+
+#define FALSE  0
+#define TRUE   1
+
+#define PASS   0
+#define FAIL   1
+
+#define Is_global_interrupt_enabled()  FALSE
+#define Disable_global_interrupt()     ( ( void ) 0 )
+#define Enable_global_interrupt()      ( ( void ) 0 )
+
+#endif
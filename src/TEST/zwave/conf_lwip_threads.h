@@ -0,0 +1,23 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of conf_lwip_threads.h: the netconn bridge unless
+ *        zwaveBRIDGE_API is set, with RTS/CTS handshaking.
+ *
+ *****************************************************************************/
+
+#ifndef _CONF_LWIP_THREADS_H_
+#define _CONF_LWIP_THREADS_H_
+
+#define zwaveBRIDGE_NETCONN               0
+#define zwaveBRIDGE_RAW                   1
+#define zwaveBRIDGE_SELECT                2
+#define zwaveBRIDGE_UDP                   3
+/* bench_zwave_bridge.c builds the raw API bridge. */
+#ifndef zwaveBRIDGE_API
+#define zwaveBRIDGE_API                   zwaveBRIDGE_NETCONN
+#endif
+#define zwaveEVENT_MULTICAST              0
+#define zwaveCONTROL                      0
+#define zwaveSERIAL_RTSCTS                1
+
+#endif
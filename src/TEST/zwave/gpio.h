@@ -0,0 +1,18 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of the GPIO driver: the pins are not modeled.
+ *
+ *****************************************************************************/
+
+#ifndef _GPIO_H_
+#define _GPIO_H_
+
+typedef const struct
+{
+	unsigned char pin;
+	unsigned char function;
+} gpio_map_t[];
+
+static inline int gpio_enable_module(const gpio_map_t gpiomap, unsigned int size) { return 0; }
+
+#endif
@@ -0,0 +1,12 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of partest.h: no LEDs.
+ *
+ *****************************************************************************/
+
+#ifndef PARTEST_H
+#define PARTEST_H
+
+static inline void vParTestToggleLED( unsigned portBASE_TYPE uxLED ) { }
+
+#endif
@@ -0,0 +1,34 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of the AVR32 UC3 portmacro.h: the same type widths.
+ *
+ *****************************************************************************/
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#define portCHAR        char
+#define portLONG        int
+#define portSHORT       short
+#define portBASE_TYPE   portLONG
+
+typedef unsigned portLONG portTickType;
+#define portMAX_DELAY ( portTickType ) 0xffffffff
+
+#define portTICK_RATE_MS      ( ( portTickType ) 1000 / configTICK_RATE_HZ )
+
+/* CPU cycles, as on the board: see zwave_helper_set_time(). */
+extern unsigned portLONG ulPortGetRunTimeCounterValue( void );
+#define portGET_RUN_TIME_COUNTER_VALUE()  ulPortGetRunTimeCounterValue()
+
+#define portENTER_CRITICAL()
+#define portEXIT_CRITICAL()
+
+/* The ISRs are called as plain functions. */
+#define portENTER_SWITCHING_ISR()
+#define portEXIT_SWITCHING_ISR()
+
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+#endif
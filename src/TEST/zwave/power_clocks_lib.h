@@ -0,0 +1,5 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of power_clocks_lib.h: not used on the EVK1100.
+ *
+ *****************************************************************************/
@@ -0,0 +1,21 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of queue.h: queues of bytes that never block,
+ *        modeled by zwave_helper.c.
+ *
+ *****************************************************************************/
+
+#ifndef QUEUE_H
+#define QUEUE_H
+
+typedef struct zwave_helper_queue *xQueueHandle;
+
+/* uxItemSize 1, or 0 for a semaphore. */
+xQueueHandle xQueueCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize );
+signed portBASE_TYPE xQueueSend( xQueueHandle xQueue, const void *pvItemToQueue, portTickType xTicksToWait );
+/* long: the portBASE_TYPE of the AVR32, the type the interrupts use. */
+signed portBASE_TYPE xQueueSendFromISR( xQueueHandle xQueue, const void *pvItemToQueue, long *pxHigherPriorityTaskWoken );
+signed portBASE_TYPE xQueueReceive( xQueueHandle xQueue, void *pvBuffer, portTickType xTicksToWait );
+unsigned portBASE_TYPE uxQueueMessagesWaiting( const xQueueHandle xQueue );
+
+#endif
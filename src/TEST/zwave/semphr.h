@@ -0,0 +1,27 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of semphr.h: binary semaphores on the queues of
+ *        queue.h.
+ *
+ *****************************************************************************/
+
+#ifndef SEMAPHORE_H
+#define SEMAPHORE_H
+
+#include "queue.h"
+
+typedef xQueueHandle xSemaphoreHandle;
+
+/* Created given, as in FreeRTOS. */
+#define vSemaphoreCreateBinary( xSemaphore )                      \
+	{                                                         \
+		( xSemaphore ) = xQueueCreate( 1, 0 );            \
+		if( ( xSemaphore ) != NULL )                      \
+			xSemaphoreGive( ( xSemaphore ) );         \
+	}
+
+#define xSemaphoreTake( xSemaphore, xBlockTime )  xQueueReceive( ( xSemaphore ), NULL, ( xBlockTime ) )
+#define xSemaphoreGive( xSemaphore )  xQueueSend( ( xSemaphore ), NULL, 0 )
+#define xSemaphoreGiveFromISR( xSemaphore, pxHigherPriorityTaskWoken )  xQueueSendFromISR( ( xSemaphore ), NULL, ( pxHigherPriorityTaskWoken ) )
+
+#endif
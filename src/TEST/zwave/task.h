@@ -0,0 +1,23 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of task.h: the tick count is zwave_helper_ticks, the
+ *        calling task zwave_helper_task, of run time zwave_helper_task_run_time.
+ *
+ *****************************************************************************/
+
+#ifndef TASK_H
+#define TASK_H
+
+typedef void * xTaskHandle;
+
+portTickType xTaskGetTickCount( void );
+
+static inline void vTaskDelete( xTaskHandle pxTask ) { }
+
+void vTaskDelay( portTickType xTicksToDelay );
+
+xTaskHandle xTaskGetCurrentTaskHandle( void );
+
+unsigned long long ullTaskGetRunTimeCounter( xTaskHandle pxTask );
+
+#endif
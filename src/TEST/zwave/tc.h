@@ -0,0 +1,28 @@
+/*! \file *********************************************************************
+ *
+ * \brief Host stand-in of the TC driver: the channel set-up is not modeled.
+ *
+ *****************************************************************************/
+
+#ifndef TC_H
+#define TC_H
+
+#include "avr32/io.h"
+
+#define FALSE 0
+
+#define TC_EVT_EFFECT_NOOP        0
+#define TC_WAVEFORM_SEL_UP_MODE   0
+#define TC_SEL_NO_EDGE            0
+#define TC_CLOCK_SOURCE_TC4       4
+
+typedef struct
+{
+	unsigned int channel, bswtrg, beevt, bcpc, bcpb, aswtrg, aeevt, acpc, acpa;
+	unsigned int wavsel, enetrg, eevt, eevtedg, cpcdis, cpcstop, burst, clki, tcclks;
+} tc_waveform_opt_t;
+
+static inline int tc_init_waveform(volatile avr32_tc_t *tc, const tc_waveform_opt_t *opt) { return 0; }
+static inline int tc_start(volatile avr32_tc_t *tc, unsigned int channel) { return 0; }
+
+#endif
@@ -0,0 +1,132 @@
+/*! \file *********************************************************************
+ *
+ * \brief Drives the Z-Wave sources on the host.
+ *
+ *****************************************************************************/
+
+#include <stdlib.h>
+
+#include "zwave_helper.h"
+#include "task.h"
+#include "queue.h"
+#include "ZWaveCoalesce.h"
+
+struct zwave_helper_queue
+{
+	unsigned char *items;
+	unsigned int length, item_size, count, head;
+};
+
+portTickType zwave_helper_ticks;
+void *zwave_helper_task;
+unsigned long long zwave_helper_task_run_time;
+unsigned long zwave_helper_run_time_step;
+volatile avr32_tc_t zwave_helper_tc;
+volatile avr32_usart_t zwave_helper_usart;
+volatile avr32_macb_t zwave_helper_macb;
+
+static unsigned long zwave_helper_run_time;
+
+portTickType xTaskGetTickCount( void )
+{
+	return zwave_helper_ticks;
+}
+
+void vTaskDelay( portTickType xTicksToDelay )
+{
+	zwave_helper_ticks += xTicksToDelay;
+}
+
+xTaskHandle xTaskGetCurrentTaskHandle( void )
+{
+	return zwave_helper_task;
+}
+
+unsigned long long ullTaskGetRunTimeCounter( xTaskHandle pxTask )
+{
+	return zwave_helper_task_run_time;
+}
+
+unsigned portLONG ulPortGetRunTimeCounterValue( void )
+{
+	unsigned long value = zwave_helper_run_time;
+
+	zwave_helper_run_time += zwave_helper_run_time_step;
+	return value;
+}
+
+void zwave_helper_set_time(unsigned long long us)
+{
+	zwave_helper_ticks = (portTickType)(us / (1000 * portTICK_RATE_MS));
+	zwave_helper_run_time = (unsigned long)(us * (configCPU_CLOCK_HZ / 1000000));
+	zwave_helper_tc.channel[zwaveCOALESCE_TC_CHANNEL].cv =
+		(us * (configPBA_CLOCK_HZ / 1000000) / zwaveCOALESCE_TC_DIVIDER) & 0xFFFF;
+}
+
+unsigned long zwave_helper_usart_update(void)
+{
+	unsigned long cr;
+
+	zwave_helper_usart.imr = (zwave_helper_usart.imr | zwave_helper_usart.ier) & ~zwave_helper_usart.idr;
+	zwave_helper_usart.ier = 0;
+	zwave_helper_usart.idr = 0;
+	zwave_helper_usart.csr &= ~AVR32_USART_CSR_CTSIC_MASK;
+	cr = zwave_helper_usart.cr;
+	zwave_helper_usart.cr = 0;
+	return cr;
+}
+
+void zwave_helper_usart_cts(int asserted)
+{
+	unsigned long csr = asserted ? zwave_helper_usart.csr & ~AVR32_USART_CSR_CTS_MASK
+	                             : zwave_helper_usart.csr | AVR32_USART_CSR_CTS_MASK;
+
+	if (csr != zwave_helper_usart.csr)
+		csr |= AVR32_USART_CSR_CTSIC_MASK;
+	zwave_helper_usart.csr = csr;
+}
+
+xQueueHandle xQueueCreate( unsigned portBASE_TYPE uxQueueLength, unsigned portBASE_TYPE uxItemSize )
+{
+	xQueueHandle q = calloc(1, sizeof(*q));
+
+	q->items = calloc(uxQueueLength, uxItemSize ? uxItemSize : 1);
+	q->length = uxQueueLength;
+	q->item_size = uxItemSize;
+	return q;
+}
+
+signed portBASE_TYPE xQueueSend( xQueueHandle xQueue, const void *pvItemToQueue, portTickType xTicksToWait )
+{
+	if (xQueue->count == xQueue->length)
+		return pdFAIL;
+	if (xQueue->item_size)
+		xQueue->items[(xQueue->head + xQueue->count) % xQueue->length] = *(const unsigned char *)pvItemToQueue;
+	xQueue->count++;
+	return pdPASS;
+}
+
+signed portBASE_TYPE xQueueSendFromISR( xQueueHandle xQueue, const void *pvItemToQueue, long *pxHigherPriorityTaskWoken )
+{
+	/* The task waiting on it, if any, is woken. */
+	if (xQueueSend(xQueue, pvItemToQueue, 0) != pdPASS)
+		return pdFAIL;
+	*pxHigherPriorityTaskWoken = pdTRUE;
+	return pdPASS;
+}
+
+signed portBASE_TYPE xQueueReceive( xQueueHandle xQueue, void *pvBuffer, portTickType xTicksToWait )
+{
+	if (xQueue->count == 0)
+		return pdFAIL;
+	if (xQueue->item_size)
+		*(unsigned char *)pvBuffer = xQueue->items[xQueue->head];
+	xQueue->head = (xQueue->head + 1) % xQueue->length;
+	xQueue->count--;
+	return pdPASS;
+}
+
+unsigned portBASE_TYPE uxQueueMessagesWaiting( const xQueueHandle xQueue )
+{
+	return xQueue->count;
+}
@@ -0,0 +1,51 @@
+/*! \file *********************************************************************
+ *
+ * \brief Drives the Z-Wave sources on the host: the tick count and the TC
+ *        channel of the coalescing, both from one clock, and the USART
+ *        registers.
+ *
+ *****************************************************************************/
+
+#ifndef ZWAVE_HELPER_H
+#define ZWAVE_HELPER_H
+
+#include "FreeRTOS.h"
+#include "avr32/io.h"
+
+//! Returned by xTaskGetTickCount().
+extern portTickType zwave_helper_ticks;
+
+//! Returned by xTaskGetCurrentTaskHandle().
+extern void *zwave_helper_task;
+
+//! Returned by ullTaskGetRunTimeCounter() for any task.
+extern unsigned long long zwave_helper_task_run_time;
+
+//! Added to the run time counter by each read of it: the cycles of the code
+//! between two reads.
+extern unsigned long zwave_helper_run_time_step;
+
+/*! \brief Sets the time: the tick count, the run time counter (CPU cycles)
+ *         and the counter of zwaveCOALESCE_TC_CHANNEL as if started at 0.
+ *
+ *  \param us  Time in us.
+ */
+void zwave_helper_set_time(unsigned long long us);
+
+/*! \brief Does what the USART does with the registers written since the last
+ *         call: IER and IDR are applied to IMR, then cleared.
+ *
+ *  \return The last command written to CR since the last call, then CR is
+ *          cleared.
+ */
+unsigned long zwave_helper_usart_update(void);
+
+/*! \brief Sets the CTS input of the USART; a change sets CTSIC, which the
+ *         next zwave_helper_usart_update() clears.
+ *
+ *  \param asserted  Non-zero when the module is ready to receive (CTS low,
+ *                   the CTS bit of CSR clear).
+ */
+void zwave_helper_usart_cts(int asserted);
+
+#endif
@@ -0,0 +1,137 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Streams the trace recorder ring over TCP.
+ *
+ * A client connecting to traceTCP_PORT receives:
+ * - a 16 byte header, big endian: "FRTR", version (1), record size (8),
+ *   2 reserved bytes, timestamp frequency in Hz, tick frequency in Hz;
+ * - a 16 bit big endian length followed by that many bytes of vTaskList()
+ *   output, to map the task numbers of the records to task names;
+ * - then the trace records (see trace_recorder.h), starting from the oldest
+ *   one still in the ring, until the connection is closed.
+ *
+ * The events of the server task itself are not recorded, only its context
+ * switches: the stream does not feed on its own queue and lwIP calls. The
+ * work it causes in the tcpip and Ethernet tasks is still recorded.
+ *
+ * TRACE/trace_analyzer.c decodes the stream on the host.
+ *
+ *****************************************************************************/
+
+/* Standard includes. */
+#include <string.h>
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* lwIP includes. */
+#include "lwip/api.h"
+
+#include "trace_recorder.h"
+#include "TraceTCP.h"
+
+
+#if ( configUSE_TRACE_RECORDER == 1 )
+
+/*! The port on which we listen. */
+#define traceTCP_PORT           ( 24 )
+
+/*! Delay between two reads of the ring when it is empty. */
+#define traceTCP_POLL_DELAY     ( 50 / portTICK_RATE_MS )
+
+/*! Records sent per netconn_write() call. */
+#define traceTCP_CHUNK_RECORDS  ( 64 )
+
+/*! Room for the vTaskList() output. */
+#define traceTCP_TASK_LIST_SIZE ( 512 )
+
+/*! Function to process the current connection */
+static void prvTraceTCP_HandleSession( struct netconn *pxNetCon );
+
+
+portTASK_FUNCTION( vTraceTCPServer, pvParameters )
+{
+	struct netconn *pxTraceListener, *pxNewConnection;
+
+	vTraceExcludeCurrentTask();
+
+	pxTraceListener = netconn_new( NETCONN_TCP );
+	netconn_bind( pxTraceListener, NULL, traceTCP_PORT );
+	netconn_listen( pxTraceListener );
+
+	/* Loop forever */
+	for( ;; )
+	{
+		/* Wait for a connection. */
+		pxNewConnection = netconn_accept( pxTraceListener );
+
+		if( pxNewConnection != NULL )
+		{
+			prvTraceTCP_HandleSession( pxNewConnection );
+		}
+	}
+}
+
+
+/*! \brief stream the trace records until the connection fails
+ *
+ *  \param pxNetCon   Input. The netconn to use to send data.
+ *
+ */
+static void prvTraceTCP_HandleSession( struct netconn *pxNetCon )
+{
+	static unsigned portCHAR pucChunk[ traceTCP_CHUNK_RECORDS * traceRECORD_SIZE ];
+	static signed portCHAR pcTaskList[ traceTCP_TASK_LIST_SIZE ];
+	unsigned portLONG ulLength;
+	err_t xErr;
+
+	/* Header. */
+	memcpy( pucChunk, "FRTR", 4 );
+	pucChunk[ 4 ] = 1;
+	pucChunk[ 5 ] = traceRECORD_SIZE;
+	pucChunk[ 6 ] = 0;
+	pucChunk[ 7 ] = 0;
+	pucChunk[ 8 ] = ( unsigned portCHAR ) ( configCPU_CLOCK_HZ >> 24 );
+	pucChunk[ 9 ] = ( unsigned portCHAR ) ( configCPU_CLOCK_HZ >> 16 );
+	pucChunk[ 10 ] = ( unsigned portCHAR ) ( configCPU_CLOCK_HZ >> 8 );
+	pucChunk[ 11 ] = ( unsigned portCHAR ) configCPU_CLOCK_HZ;
+	pucChunk[ 12 ] = ( unsigned portCHAR ) ( configTICK_RATE_HZ >> 24 );
+	pucChunk[ 13 ] = ( unsigned portCHAR ) ( configTICK_RATE_HZ >> 16 );
+	pucChunk[ 14 ] = ( unsigned portCHAR ) ( configTICK_RATE_HZ >> 8 );
+	pucChunk[ 15 ] = ( unsigned portCHAR ) configTICK_RATE_HZ;
+
+	/* Task names. */
+	pcTaskList[ 0 ] = 0;
+	vTaskList( pcTaskList );
+	ulLength = strlen( ( char * ) pcTaskList );
+	pucChunk[ 16 ] = ( unsigned portCHAR ) ( ulLength >> 8 );
+	pucChunk[ 17 ] = ( unsigned portCHAR ) ulLength;
+
+	xErr = netconn_write( pxNetCon, pucChunk, 18, NETCONN_COPY );
+	if( xErr == ERR_OK )
+	{
+		xErr = netconn_write( pxNetCon, pcTaskList, ulLength, NETCONN_COPY );
+	}
+
+	/* Records, from the oldest one still available. */
+	vTraceRewind();
+	while( xErr == ERR_OK )
+	{
+		ulLength = ulTraceRead( pucChunk, sizeof( pucChunk ) );
+		if( ulLength > 0 )
+		{
+			xErr = netconn_write( pxNetCon, pucChunk, ulLength, NETCONN_COPY );
+		}
+		else
+		{
+			vTaskDelay( traceTCP_POLL_DELAY );
+		}
+	}
+
+	netconn_close( pxNetCon );
+	netconn_delete( pxNetCon );
+}
+
+#endif /* configUSE_TRACE_RECORDER */
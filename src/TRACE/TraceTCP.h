@@ -0,0 +1,22 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Streams the trace recorder ring over TCP.
+ *
+ *****************************************************************************/
+
+#ifndef TRACE_TCP_H
+#define TRACE_TCP_H
+
+#include "portmacro.h"
+
+
+/*! \brief Trace server main task: streams the trace records to the client
+ *         connected to traceTCP_PORT.
+ *
+ *  \param pvParameters   Input. Not Used.
+ *
+ */
+portTASK_FUNCTION_PROTO( vTraceTCPServer, pvParameters );
+
+#endif
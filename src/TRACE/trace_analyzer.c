@@ -0,0 +1,335 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Host tool: decodes a capture of the trace TCP server stream.
+ *
+ * Capture, then analyze:
+ *   nc <board> 24 > trace.bin        (stop it with Ctrl-C)
+ *   trace_analyzer trace.bin
+ *
+ * Reports the CPU time of every task, from its context switches, the count
+ * of every event, the records lost to overflows and the latency from a byte
+ * received by the USART to the first TCP data segment of the Z-Wave port
+ * handed to IP after it: the RX ring, Nagle and tcp_output() included.
+ *
+ * Built with the host compiler: cc -O2 -o trace_analyzer trace_analyzer.c
+ * src/TEST/test_trace_analyzer.c checks it on a made up stream.
+ *
+ *****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* The event codes of the firmware. */
+#define configUSE_TRACE_RECORDER 1
+#include "trace_recorder.h"
+
+
+//! Length of the stream header, up to the length of the task list.
+#define TRACE_HEADER_SIZE       18
+
+//! Task numbers are 8 bits in the records.
+#define TRACE_MAX_TASKS         256
+
+//! Local port of the Z-Wave segments (zwavePORT).
+#define TRACE_ZWAVE_PORT        23
+
+//! Longest task name kept.
+#define TRACE_NAME_SIZE         16
+
+//! What the stream tells.
+typedef struct
+{
+  unsigned long ulTimeStampHz;                    //!< Frequency of the timestamps.
+  unsigned long ulTickHz;                         //!< Tick frequency.
+  char acName[ TRACE_MAX_TASKS ][ TRACE_NAME_SIZE ]; //!< Task names, by number.
+
+  unsigned long ulRecords;                        //!< Records decoded.
+  unsigned long ulEvents[ 256 ];                  //!< Records, by event.
+  unsigned long ulLost;                           //!< Records reported lost by overflow records.
+
+  int iStarted;                                   //!< A timestamp was seen.
+  unsigned long ulLastStamp;                      //!< Last 32 bit timestamp.
+  unsigned long long ullNow;                      //!< Timestamps unwrapped to 64 bits.
+  unsigned long long ullFirst;                    //!< Time of the first context switch.
+  int iCurrent;                                   //!< Task running, -1 until the first switch.
+  unsigned long long ullSince;                    //!< Time it was switched in.
+  unsigned long long ullCycles[ TRACE_MAX_TASKS ]; //!< Time run, by task.
+
+  unsigned long ulRxPending;                      //!< USART bytes not written to TCP yet.
+  unsigned long long ullRxFirst;                  //!< Time of the oldest of them.
+  unsigned long ulLatencyCount;                   //!< Z-Wave segments that followed USART bytes.
+  unsigned long long ullLatencySum;               //!< Oldest byte to the segment, summed...
+  unsigned long long ullLatencyMin;               //!< ... lowest ...
+  unsigned long long ullLatencyMax;               //!< ... and highest.
+} xTraceStats;
+
+
+/*! \brief Reads a big endian 32 bit value. */
+static unsigned long prvGet32( const unsigned char *p )
+{
+  return ( ( unsigned long ) p[ 0 ] << 24 ) | ( ( unsigned long ) p[ 1 ] << 16 ) | ( ( unsigned long ) p[ 2 ] << 8 ) | p[ 3 ];
+}
+
+
+/*! \brief Takes the task names out of the vTaskList() output: name, state,
+ *         priority, stack and number, tab separated, one task per line.
+ */
+static void prvTraceTaskList( xTraceStats *pxStats, const char *pcList, size_t xLength )
+{
+  const char *pcLine = pcList, *pcEnd = pcList + xLength, *pcEol, *pcTab, *pcNumber;
+  size_t xName;
+  unsigned long ulNumber;
+
+  while( pcLine < pcEnd )
+  {
+    for( pcEol = pcLine; pcEol < pcEnd && *pcEol != '\n'; pcEol++ );
+
+    /* The name is the first field, the number the last one. */
+    for( pcTab = pcLine; pcTab < pcEol && *pcTab != '\t'; pcTab++ );
+    for( pcNumber = pcEol; pcNumber > pcTab && pcNumber[ -1 ] != '\t'; pcNumber-- );
+    if( pcTab < pcEol && pcNumber > pcTab )
+    {
+      ulNumber = strtoul( pcNumber, NULL, 10 );
+      xName = ( size_t ) ( pcTab - pcLine );
+      while( xName > 0 && pcLine[ xName - 1 ] == ' ' )
+        xName--;
+      if( xName >= TRACE_NAME_SIZE )
+        xName = TRACE_NAME_SIZE - 1;
+      if( ulNumber < TRACE_MAX_TASKS )
+      {
+        memcpy( pxStats->acName[ ulNumber ], pcLine, xName );
+        pxStats->acName[ ulNumber ][ xName ] = 0;
+      }
+    }
+    pcLine = pcEol + 1;
+  }
+}
+
+
+/*! \brief Decodes the header and the task list.
+ *
+ * \return The number of bytes they take, 0 if the stream does not start with
+ *         them.
+ */
+size_t xTraceHeader( xTraceStats *pxStats, const unsigned char *pucStream, size_t xLength )
+{
+  size_t xList;
+
+  memset( pxStats, 0, sizeof( *pxStats ) );
+  pxStats->iCurrent = -1;
+
+  if( xLength < TRACE_HEADER_SIZE || memcmp( pucStream, "FRTR", 4 ) != 0
+      || pucStream[ 4 ] != 1 || pucStream[ 5 ] != traceRECORD_SIZE )
+    return 0;
+
+  pxStats->ulTimeStampHz = prvGet32( pucStream + 8 );
+  pxStats->ulTickHz = prvGet32( pucStream + 12 );
+  xList = ( ( size_t ) pucStream[ 16 ] << 8 ) | pucStream[ 17 ];
+  if( xLength < TRACE_HEADER_SIZE + xList || pxStats->ulTimeStampHz == 0 )
+    return 0;
+
+  prvTraceTaskList( pxStats, ( const char * ) pucStream + TRACE_HEADER_SIZE, xList );
+  return TRACE_HEADER_SIZE + xList;
+}
+
+
+/*! \brief Accounts for one record, in stream order. */
+void vTraceRecordStats( xTraceStats *pxStats, const unsigned char *pucRecord )
+{
+  unsigned long ulStamp = prvGet32( pucRecord );
+  unsigned char ucEvent = pucRecord[ 4 ], ucTask = pucRecord[ 5 ];
+  unsigned short usParam = ( unsigned short ) ( ( pucRecord[ 6 ] << 8 ) | pucRecord[ 7 ] );
+  unsigned long long ullLatency;
+
+  /* The 32 bit timestamps wrap: records are closer than a wrap apart. */
+  if( pxStats->iStarted )
+    pxStats->ullNow += ( unsigned long ) ( ( ulStamp - pxStats->ulLastStamp ) & 0xFFFFFFFFUL );
+  pxStats->iStarted = 1;
+  pxStats->ulLastStamp = ulStamp;
+
+  pxStats->ulRecords++;
+  pxStats->ulEvents[ ucEvent ]++;
+
+  switch( ucEvent )
+  {
+  case traceEVT_OVERFLOW:
+    /* Time and task run during the gap are unknown. */
+    pxStats->ulLost += usParam;
+    pxStats->iCurrent = -1;
+    pxStats->ulRxPending = 0;
+    break;
+
+  case traceEVT_TASK_SWITCHED_IN:
+    if( pxStats->iCurrent >= 0 )
+      pxStats->ullCycles[ pxStats->iCurrent ] += pxStats->ullNow - pxStats->ullSince;
+    else if( pxStats->ulEvents[ traceEVT_TASK_SWITCHED_IN ] == 1 )
+      pxStats->ullFirst = pxStats->ullNow;
+    pxStats->iCurrent = ucTask;
+    pxStats->ullSince = pxStats->ullNow;
+    break;
+
+  case traceEVT_USART_RX:
+    if( pxStats->ulRxPending++ == 0 )
+      pxStats->ullRxFirst = pxStats->ullNow;
+    break;
+
+  case traceEVT_TCP_SEGMENT:
+    if( usParam == TRACE_ZWAVE_PORT && pxStats->ulRxPending )
+    {
+      ullLatency = pxStats->ullNow - pxStats->ullRxFirst;
+      if( pxStats->ulLatencyCount == 0 || ullLatency < pxStats->ullLatencyMin )
+        pxStats->ullLatencyMin = ullLatency;
+      if( ullLatency > pxStats->ullLatencyMax )
+        pxStats->ullLatencyMax = ullLatency;
+      pxStats->ullLatencySum += ullLatency;
+      pxStats->ulLatencyCount++;
+      pxStats->ulRxPending = 0;
+    }
+    break;
+
+  default:
+    break;
+  }
+}
+
+
+/*! \brief Closes the run time of the task running at the last record. */
+void vTraceFinish( xTraceStats *pxStats )
+{
+  if( pxStats->iCurrent >= 0 )
+  {
+    pxStats->ullCycles[ pxStats->iCurrent ] += pxStats->ullNow - pxStats->ullSince;
+    pxStats->ullSince = pxStats->ullNow;
+  }
+}
+
+
+/*! \brief Name of an event, for the report. */
+static const char *prvTraceEventName( unsigned int uxEvent )
+{
+  switch( uxEvent )
+  {
+  case traceEVT_OVERFLOW:               return "overflow";
+  case traceEVT_TASK_SWITCHED_IN:       return "task switched in";
+  case traceEVT_TASK_SWITCHED_OUT:      return "task switched out";
+  case traceEVT_TASK_CREATE:            return "task create";
+  case traceEVT_TASK_DELETE:            return "task delete";
+  case traceEVT_TASK_DELAY:             return "task delay";
+  case traceEVT_TASK_SUSPEND:           return "task suspend";
+  case traceEVT_TASK_RESUME:            return "task resume";
+  case traceEVT_QUEUE_SEND:             return "queue send";
+  case traceEVT_QUEUE_SEND_FAILED:      return "queue send failed";
+  case traceEVT_QUEUE_RECEIVE:          return "queue receive";
+  case traceEVT_QUEUE_RECEIVE_FAILED:   return "queue receive failed";
+  case traceEVT_QUEUE_BLOCK_SEND:       return "queue block on send";
+  case traceEVT_QUEUE_BLOCK_RECEIVE:    return "queue block on receive";
+  case traceEVT_QUEUE_SEND_FROM_ISR:    return "queue send from ISR";
+  case traceEVT_QUEUE_RECEIVE_FROM_ISR: return "queue receive from ISR";
+  case traceEVT_ISR_ENTER:              return "ISR enter";
+  case traceEVT_USART_RX:               return "USART RX";
+  case traceEVT_USART_TX:               return "USART TX";
+  case traceEVT_NET_RX:                 return "Ethernet RX";
+  case traceEVT_NET_TX:                 return "Ethernet TX";
+  case traceEVT_TCP_WRITE:              return "Z-Wave TCP write";
+  case traceEVT_TCP_SEGMENT:            return "TCP segment out";
+  default:                              return "unknown";
+  }
+}
+
+
+/*! \brief Prints the report. */
+void vTraceReport( const xTraceStats *pxStats, FILE *pxOut )
+{
+  unsigned long long ullTotal = 0;
+  double dUs = 1e6 / ( double ) pxStats->ulTimeStampHz;
+  unsigned int ux;
+
+  for( ux = 0; ux < TRACE_MAX_TASKS; ux++ )
+    ullTotal += pxStats->ullCycles[ ux ];
+
+  fprintf( pxOut, "%lu records, %lu lost, %.3f ms traced, timestamps at %lu Hz, tick at %lu Hz\n\n",
+           pxStats->ulRecords, pxStats->ulLost, ( double ) ( pxStats->ullSince - pxStats->ullFirst ) * dUs / 1000,
+           pxStats->ulTimeStampHz, pxStats->ulTickHz );
+
+  fprintf( pxOut, "%-4s %-16s %14s %7s\n", "#", "task", "cycles", "CPU" );
+  for( ux = 0; ux < TRACE_MAX_TASKS; ux++ )
+  {
+    if( pxStats->ullCycles[ ux ] == 0 )
+      continue;
+    fprintf( pxOut, "%-4u %-16s %14llu %6.2f%%\n", ux, pxStats->acName[ ux ][ 0 ] ? pxStats->acName[ ux ] : "?",
+             pxStats->ullCycles[ ux ], 100.0 * ( double ) pxStats->ullCycles[ ux ] / ( double ) ullTotal );
+  }
+
+  fprintf( pxOut, "\n%-24s %10s\n", "event", "records" );
+  for( ux = 0; ux < 256; ux++ )
+  {
+    if( pxStats->ulEvents[ ux ] )
+      fprintf( pxOut, "%-24s %10lu\n", prvTraceEventName( ux ), pxStats->ulEvents[ ux ] );
+  }
+
+  fprintf( pxOut, "\nUSART RX to Z-Wave TCP segment: " );
+  if( pxStats->ulLatencyCount )
+    fprintf( pxOut, "%lu segments, min %.1f us, avg %.1f us, max %.1f us\n", pxStats->ulLatencyCount,
+             ( double ) pxStats->ullLatencyMin * dUs,
+             ( double ) pxStats->ullLatencySum * dUs / ( double ) pxStats->ulLatencyCount,
+             ( double ) pxStats->ullLatencyMax * dUs );
+  else
+    fprintf( pxOut, "none\n" );
+}
+
+
+#ifndef TRACE_ANALYZER_NO_MAIN
+
+int main( int argc, char **argv )
+{
+  static xTraceStats xStats;
+  FILE *pxIn = stdin;
+  unsigned char *pucStream = NULL;
+  size_t xLength = 0, xSize = 0, xRead, xOffset;
+
+  if( argc > 2 )
+  {
+    fprintf( stderr, "usage: %s [capture]\n", argv[ 0 ] );
+    return 2;
+  }
+  if( argc == 2 && ( pxIn = fopen( argv[ 1 ], "rb" ) ) == NULL )
+  {
+    perror( argv[ 1 ] );
+    return 1;
+  }
+
+  do
+  {
+    if( xLength == xSize )
+    {
+      xSize = xSize ? 2 * xSize : 65536;
+      if( ( pucStream = realloc( pucStream, xSize ) ) == NULL )
+      {
+        perror( "realloc" );
+        return 1;
+      }
+    }
+    xRead = fread( pucStream + xLength, 1, xSize - xLength, pxIn );
+    xLength += xRead;
+  } while( xRead > 0 );
+
+  xOffset = xTraceHeader( &xStats, pucStream, xLength );
+  if( xOffset == 0 )
+  {
+    fprintf( stderr, "not a trace stream\n" );
+    return 1;
+  }
+
+  /* A capture cut by Ctrl-C may end in the middle of a record. */
+  for( ; xOffset + traceRECORD_SIZE <= xLength; xOffset += traceRECORD_SIZE )
+    vTraceRecordStats( &xStats, pucStream + xOffset );
+  vTraceFinish( &xStats );
+
+  vTraceReport( &xStats, stdout );
+  free( pucStream );
+  return 0;
+}
+
+#endif
@@ -0,0 +1,200 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Scheduler event trace recorder.
+ *
+ * See trace_recorder.h for the record format.
+ *
+ *****************************************************************************/
+
+#include "compiler.h"
+
+/* Scheduler includes. */
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "trace_recorder.h"
+
+
+#if ( configUSE_TRACE_RECORDER == 1 )
+
+#if ( configUSE_TRACE_FACILITY != 1 )
+#  error The trace recorder identifies the tasks by their number: configUSE_TRACE_FACILITY must be 1.
+#endif
+
+#if ( configGENERATE_RUN_TIME_STATS != 1 )
+#  error The trace recorder timestamps come from the run time counter: configGENERATE_RUN_TIME_STATS must be 1.
+#endif
+
+#if ( ( configTRACE_RECORDER_SIZE & ( configTRACE_RECORDER_SIZE - 1 ) ) != 0 )
+#  error configTRACE_RECORDER_SIZE must be a power of 2.
+#endif
+
+#define traceRING_MASK   ( configTRACE_RECORDER_SIZE - 1 )
+
+//! One record, in CPU byte order.
+typedef struct
+{
+  unsigned long  ulTimeStamp;
+  unsigned char  ucEvent;
+  unsigned char  ucTask;
+  unsigned short usParam;
+} xTraceRecord;
+
+//! The ring.
+static xTraceRecord xTraceRing[ configTRACE_RECORDER_SIZE ];
+
+//! Number of records ever written; the next one goes to ( ulTraceHead & traceRING_MASK ).
+static volatile unsigned long ulTraceHead = 0;
+
+//! Number of records ever read back.
+static unsigned long ulTraceTail = 0;
+
+//! Number of the task currently running.
+static volatile unsigned char ucTraceCurrentTask = 0;
+
+//! Recording on/off.
+static volatile unsigned char ucTraceEnabled = 1;
+
+//! Number of the task set by vTraceExcludeCurrentTask(), traceNO_TASK if none.
+#define traceNO_TASK     0xFFFF
+static volatile unsigned short usTraceExcludedTask = traceNO_TASK;
+
+//! Nonzero in interrupt and exception modes, the tasks run in supervisor mode.
+#define traceIN_INTERRUPT()  ( ( Get_system_register( AVR32_SR ) & AVR32_SR_M_MASK ) > ( AVR32_SR_M_SUP << AVR32_SR_M_OFFSET ) )
+
+
+/*! \brief Writes a record, interrupts being disabled.
+ */
+static void prvTraceWrite( unsigned char ucEvent, unsigned short usParam )
+{
+  xTraceRecord *pxRecord = &xTraceRing[ ulTraceHead & traceRING_MASK ];
+
+  pxRecord->ulTimeStamp = portGET_RUN_TIME_COUNTER_VALUE();
+  pxRecord->ucEvent = ucEvent;
+  pxRecord->ucTask = ucTraceCurrentTask;
+  pxRecord->usParam = usParam;
+  ulTraceHead++;
+}
+
+
+void vTraceRecord( unsigned char ucEvent, unsigned short usParam )
+{
+  Bool global_interrupt_enabled;
+
+  if( !ucTraceEnabled )
+    return;
+
+  if( ucTraceCurrentTask == usTraceExcludedTask && ucEvent != traceEVT_TASK_SWITCHED_OUT && !traceIN_INTERRUPT() )
+    return;
+
+  /* May be called from an ISR or from a critical section: save and restore
+  the interrupt mask rather than use portENTER_CRITICAL(). */
+  global_interrupt_enabled = Is_global_interrupt_enabled();
+  Disable_global_interrupt();
+  prvTraceWrite( ucEvent, usParam );
+  if( global_interrupt_enabled ) Enable_global_interrupt();
+}
+
+
+void vTraceTaskSwitchedIn( unsigned char ucTaskNumber, unsigned short usPriority )
+{
+  Bool global_interrupt_enabled;
+
+  global_interrupt_enabled = Is_global_interrupt_enabled();
+  Disable_global_interrupt();
+  ucTraceCurrentTask = ucTaskNumber;
+  if( ucTraceEnabled )
+    prvTraceWrite( traceEVT_TASK_SWITCHED_IN, usPriority );
+  if( global_interrupt_enabled ) Enable_global_interrupt();
+}
+
+
+void vTraceExcludeCurrentTask( void )
+{
+  usTraceExcludedTask = ucTraceCurrentTask;
+}
+
+
+void vTraceEnable( unsigned char ucEnable )
+{
+  ucTraceEnabled = ucEnable;
+}
+
+
+void vTraceRewind( void )
+{
+  Bool global_interrupt_enabled;
+
+  global_interrupt_enabled = Is_global_interrupt_enabled();
+  Disable_global_interrupt();
+  if( ulTraceHead > configTRACE_RECORDER_SIZE )
+    ulTraceTail = ulTraceHead - configTRACE_RECORDER_SIZE;
+  else
+    ulTraceTail = 0;
+  if( global_interrupt_enabled ) Enable_global_interrupt();
+}
+
+
+/*! \brief Serializes a record, big endian.
+ */
+static unsigned char *prvTraceCopy( unsigned char *pucBuffer, unsigned long ulTimeStamp, unsigned char ucEvent, unsigned char ucTask, unsigned short usParam )
+{
+  *pucBuffer++ = ( unsigned char ) ( ulTimeStamp >> 24 );
+  *pucBuffer++ = ( unsigned char ) ( ulTimeStamp >> 16 );
+  *pucBuffer++ = ( unsigned char ) ( ulTimeStamp >> 8 );
+  *pucBuffer++ = ( unsigned char ) ulTimeStamp;
+  *pucBuffer++ = ucEvent;
+  *pucBuffer++ = ucTask;
+  *pucBuffer++ = ( unsigned char ) ( usParam >> 8 );
+  *pucBuffer++ = ( unsigned char ) usParam;
+  return pucBuffer;
+}
+
+
+unsigned long ulTraceRead( unsigned char *pucBuffer, unsigned long ulLength )
+{
+  unsigned char *pucNext = pucBuffer;
+  unsigned long ulLost;
+  xTraceRecord xRecord;
+  Bool global_interrupt_enabled;
+
+  while( ulLength >= 2 * traceRECORD_SIZE )
+  {
+    /* Interrupts are only disabled while one record is taken out, the ring
+    keeps filling up in between. */
+    global_interrupt_enabled = Is_global_interrupt_enabled();
+    Disable_global_interrupt();
+    if( ulTraceTail == ulTraceHead )
+    {
+      if( global_interrupt_enabled ) Enable_global_interrupt();
+      break;
+    }
+    ulLost = ulTraceHead - ulTraceTail;
+    if( ulLost > configTRACE_RECORDER_SIZE )
+    {
+      /* The writer went round the ring: skip to the oldest record left. */
+      ulLost -= configTRACE_RECORDER_SIZE;
+      ulTraceTail += ulLost;
+    }
+    else
+    {
+      ulLost = 0;
+    }
+    xRecord = xTraceRing[ ulTraceTail & traceRING_MASK ];
+    ulTraceTail++;
+    if( global_interrupt_enabled ) Enable_global_interrupt();
+
+    if( ulLost )
+    {
+      pucNext = prvTraceCopy( pucNext, xRecord.ulTimeStamp, traceEVT_OVERFLOW, 0, ( ulLost > 0xFFFF ) ? 0xFFFF : ( unsigned short ) ulLost );
+      ulLength -= traceRECORD_SIZE;
+    }
+    pucNext = prvTraceCopy( pucNext, xRecord.ulTimeStamp, xRecord.ucEvent, xRecord.ucTask, xRecord.usParam );
+    ulLength -= traceRECORD_SIZE;
+  }
+
+  return ( unsigned long ) ( pucNext - pucBuffer );
+}
+
+#endif /* configUSE_TRACE_RECORDER */
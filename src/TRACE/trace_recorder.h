@@ -0,0 +1,141 @@
+/*This file has been prepared for Doxygen automatic documentation generation.*/
+/*! \file *********************************************************************
+ *
+ * \brief Scheduler event trace recorder.
+ *
+ * The FreeRTOS trace macros, and a few application hooks, write timestamped
+ * fixed size records into a RAM ring. The ring is read back with
+ * ulTraceRead(), for instance by the trace TCP server.
+ *
+ * Record format (8 bytes, big endian, as returned by ulTraceRead()):
+ * - 32 bits: timestamp, in run time counter increments (CPU cycles);
+ * - 8 bits:  event, one of the traceEVT_ values;
+ * - 8 bits:  number of the task running when the event was recorded
+ *            (the "#" column of vTaskList());
+ * - 16 bits: event parameter (see each traceEVT_ value).
+ *
+ * This header is included by FreeRTOSConfig.h, before the FreeRTOS types
+ * are known: only plain C types are used here.
+ *
+ *****************************************************************************/
+
+#ifndef TRACE_RECORDER_H
+#define TRACE_RECORDER_H
+
+#if ( configUSE_TRACE_RECORDER == 1 )
+
+/*! \name Trace events
+ */
+//! @{
+#define traceEVT_OVERFLOW               0x00  //!< Records lost before this one: param = count (saturated).
+#define traceEVT_TASK_SWITCHED_IN       0x01  //!< param = priority.
+#define traceEVT_TASK_SWITCHED_OUT      0x02  //!< param = priority.
+#define traceEVT_TASK_CREATE            0x03  //!< param = number of the created task.
+#define traceEVT_TASK_DELETE            0x04  //!< param = number of the deleted task.
+#define traceEVT_TASK_DELAY             0x05  //!< param = 0.
+#define traceEVT_TASK_SUSPEND           0x06  //!< param = number of the suspended task.
+#define traceEVT_TASK_RESUME            0x07  //!< param = number of the resumed task.
+#define traceEVT_QUEUE_SEND             0x10  //!< param = queue id (low bits of its address).
+#define traceEVT_QUEUE_SEND_FAILED      0x11  //!< param = queue id.
+#define traceEVT_QUEUE_RECEIVE          0x12  //!< param = queue id.
+#define traceEVT_QUEUE_RECEIVE_FAILED   0x13  //!< param = queue id.
+#define traceEVT_QUEUE_BLOCK_SEND       0x14  //!< param = queue id.
+#define traceEVT_QUEUE_BLOCK_RECEIVE    0x15  //!< param = queue id.
+#define traceEVT_QUEUE_SEND_FROM_ISR    0x16  //!< param = queue id.
+#define traceEVT_QUEUE_RECEIVE_FROM_ISR 0x17  //!< param = queue id.
+#define traceEVT_ISR_ENTER              0x20  //!< param = IRQ number.
+#define traceEVT_USART_RX               0x30  //!< Byte read from the USART, by its interrupt: param = byte.
+#define traceEVT_USART_TX               0x31  //!< Byte written to the USART: param = byte.
+#define traceEVT_NET_RX                 0x40  //!< Frame received by the MACB: param = length.
+#define traceEVT_NET_TX                 0x41  //!< Frame handed to the MACB: param = length.
+#define traceEVT_TCP_WRITE              0x42  //!< Z-Wave bytes passed to netconn_write(): param = length.
+#define traceEVT_TCP_SEGMENT            0x43  //!< TCP data segment handed to IP: param = local port.
+//! @}
+
+//! Size of one record, as returned by ulTraceRead().
+#define traceRECORD_SIZE                8
+
+//! Queue id used in the records: the low bits of the queue address.
+#define traceQUEUE_ID( pxQueue )        ( ( unsigned short ) ( unsigned long ) ( pxQueue ) )
+
+
+/*! \brief Adds a record to the ring. Can be called from tasks, critical
+ *         sections and ISRs.
+ *
+ * \param ucEvent  Input. One of the traceEVT_ values.
+ * \param usParam  Input. Event parameter.
+ */
+extern void vTraceRecord( unsigned char ucEvent, unsigned short usParam );
+
+/*! \brief Records a context switch; sets the task number used by the next
+ *         records. Called by traceTASK_SWITCHED_IN().
+ *
+ * \param ucTaskNumber  Input. Number of the task switched in.
+ * \param usPriority    Input. Its priority.
+ */
+extern void vTraceTaskSwitchedIn( unsigned char ucTaskNumber, unsigned short usPriority );
+
+/*! \brief Stops recording the events of the calling task, except its context
+ *         switches: for the task streaming the ring, whose own queue and
+ *         lwIP calls would otherwise fill it. Events recorded by ISRs while
+ *         the task runs are kept.
+ */
+extern void vTraceExcludeCurrentTask( void );
+
+/*! \brief Starts or stops recording. Recording is on by default.
+ *
+ * \param ucEnable  Input. 0 to stop recording, 1 to restart it.
+ */
+extern void vTraceEnable( unsigned char ucEnable );
+
+/*! \brief Moves the read position to the oldest record still in the ring.
+ */
+extern void vTraceRewind( void );
+
+/*! \brief Copies the records not read yet into a buffer, in the format
+ *         described at the top of this file. A traceEVT_OVERFLOW record is
+ *         inserted where records were overwritten before being read.
+ *
+ * \param pucBuffer  Output. Where to copy the records.
+ * \param ulLength   Input. Size of pucBuffer, in bytes.
+ *
+ * \return The number of bytes copied, a multiple of traceRECORD_SIZE.
+ */
+extern unsigned long ulTraceRead( unsigned char *pucBuffer, unsigned long ulLength );
+
+
+/*! \name FreeRTOS trace macros
+ *
+ * pxCurrentTCB, pxNewTCB and pxTCB are only visible inside tasks.c, which is
+ * where these macros are expanded.
+ */
+//! @{
+#define traceTASK_SWITCHED_IN()                   vTraceTaskSwitchedIn( ( unsigned char ) pxCurrentTCB->uxTCBNumber, ( unsigned short ) pxCurrentTCB->uxPriority )
+#define traceTASK_SWITCHED_OUT()                  vTraceRecord( traceEVT_TASK_SWITCHED_OUT, ( unsigned short ) pxCurrentTCB->uxPriority )
+#define traceTASK_CREATE( pxNewTCB )              vTraceRecord( traceEVT_TASK_CREATE, ( unsigned short ) ( pxNewTCB )->uxTCBNumber )
+#define traceTASK_DELETE( pxTaskToDelete )        vTraceRecord( traceEVT_TASK_DELETE, ( unsigned short ) ( pxTaskToDelete )->uxTCBNumber )
+#define traceTASK_DELAY()                         vTraceRecord( traceEVT_TASK_DELAY, 0 )
+#define traceTASK_DELAY_UNTIL()                   vTraceRecord( traceEVT_TASK_DELAY, 0 )
+#define traceTASK_SUSPEND( pxTaskToSuspend )      vTraceRecord( traceEVT_TASK_SUSPEND, ( unsigned short ) ( pxTaskToSuspend )->uxTCBNumber )
+#define traceTASK_RESUME( pxTaskToResume )        vTraceRecord( traceEVT_TASK_RESUME, ( unsigned short ) ( pxTaskToResume )->uxTCBNumber )
+#define traceTASK_RESUME_FROM_ISR( pxTaskToResume ) vTraceRecord( traceEVT_TASK_RESUME, ( unsigned short ) ( pxTaskToResume )->uxTCBNumber )
+#define traceQUEUE_SEND( pxQueue )                vTraceRecord( traceEVT_QUEUE_SEND, traceQUEUE_ID( pxQueue ) )
+#define traceQUEUE_SEND_FAILED( pxQueue )         vTraceRecord( traceEVT_QUEUE_SEND_FAILED, traceQUEUE_ID( pxQueue ) )
+#define traceQUEUE_RECEIVE( pxQueue )             vTraceRecord( traceEVT_QUEUE_RECEIVE, traceQUEUE_ID( pxQueue ) )
+#define traceQUEUE_RECEIVE_FAILED( pxQueue )      vTraceRecord( traceEVT_QUEUE_RECEIVE_FAILED, traceQUEUE_ID( pxQueue ) )
+#define traceBLOCKING_ON_QUEUE_SEND( pxQueue )    vTraceRecord( traceEVT_QUEUE_BLOCK_SEND, traceQUEUE_ID( pxQueue ) )
+#define traceBLOCKING_ON_QUEUE_RECEIVE( pxQueue ) vTraceRecord( traceEVT_QUEUE_BLOCK_RECEIVE, traceQUEUE_ID( pxQueue ) )
+#define traceQUEUE_SEND_FROM_ISR( pxQueue )       vTraceRecord( traceEVT_QUEUE_SEND_FROM_ISR, traceQUEUE_ID( pxQueue ) )
+#define traceQUEUE_RECEIVE_FROM_ISR( pxQueue )    vTraceRecord( traceEVT_QUEUE_RECEIVE_FROM_ISR, traceQUEUE_ID( pxQueue ) )
+//! @}
+
+//! Application hook: records an event, compiled out when the recorder is off.
+#define traceAPP_EVENT( ucEvent, usParam )        vTraceRecord( ( ucEvent ), ( unsigned short ) ( usParam ) )
+
+#else
+
+#define traceAPP_EVENT( ucEvent, usParam )
+
+#endif /* configUSE_TRACE_RECORDER */
+
+#endif /* TRACE_RECORDER_H */
@@ -10,10 +10,29 @@
 
 
 xQueueHandle usart_recv_queue;
-unsigned short int usart_recv_queue_spoiled;
+// Serial bytes lost because the RX ring of the USART interrupt or
+// usart_recv_queue was full.
+unsigned long int usart_recv_queue_spoiled;
+// Highest fill level of usart_recv_queue seen: how far the network side
+// is behind the serial port.
+unsigned short int usart_recv_queue_peak;
+// Line errors of the Z-Wave serial port (CSR OVRE, FRAME and PARE): bytes
+// overwritten before the interrupt read them, and bytes received garbled.
+unsigned long int usart_overrun_errors;
+unsigned long int usart_framing_errors;
+unsigned long int usart_parity_errors;
 
 xQueueHandle zw_tcp_recv_queue;
-unsigned short int zw_tcp_recv_queue_spoiled;
+// Network bytes lost because zw_tcp_recv_queue was full: stays 0, the
+// bridges leave the bytes in the TCP window (or the datagram
+// unacknowledged) instead.
+unsigned long int zw_tcp_recv_queue_spoiled;
+// Times the network data had to wait for room in zw_tcp_recv_queue, the
+// TCP window closing meanwhile: the serial port is the bottleneck.
+unsigned long int zw_tcp_recv_queue_stalls;
+// Frames to the controller the UDP bridge gave up on, unacknowledged after
+// their last retransmission: serial bytes the controller may have missed.
+unsigned long int zw_udp_frames_given_up;
 
 unsigned short int connection_active;
 
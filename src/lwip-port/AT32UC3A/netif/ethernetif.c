@@ -54,6 +54,7 @@
 #include <lwip/stats.h>
 #include <lwip/snmp.h>
 #include "netif/etharp.h"
+#include "lwip/igmp.h"
 #include "netif/ppp_oe.h"
 
 #include "conf_eth.h"
@@ -80,6 +81,40 @@ struct ethernetif {
 /* Forward declarations. */
 static void  ethernetif_input(void * );
 
+#if LWIP_IGMP
+/**
+ * Has the MACB accept the frames of a multicast group joined by igmp.c.
+ *
+ * @param netif the lwip network interface structure for this ethernetif
+ * @param group the IP address of the group
+ * @param action IGMP_ADD_MAC_FILTER or IGMP_DEL_MAC_FILTER
+ * @return ERR_OK
+ */
+static err_t
+ethernetif_igmp_mac_filter(struct netif *netif, struct ip_addr *group, u8_t action)
+{
+  unsigned char ucMACAddress[ ETHARP_HWADDR_LEN ];
+  u32_t ulGroup = ntohl(group->addr);
+
+  LWIP_UNUSED_ARG(netif);
+
+  /* 01:00:5e and the low 23 bits of the group. */
+  ucMACAddress[0] = 0x01;
+  ucMACAddress[1] = 0x00;
+  ucMACAddress[2] = 0x5e;
+  ucMACAddress[3] = (unsigned char)((ulGroup >> 16) & 0x7f);
+  ucMACAddress[4] = (unsigned char)(ulGroup >> 8);
+  ucMACAddress[5] = (unsigned char)ulGroup;
+
+  /* On IGMP_DEL_MAC_FILTER the hash bit stays set: other groups may share it,
+     the IP layer drops what is not for a joined group. */
+  if (action == IGMP_ADD_MAC_FILTER) {
+    vMACBAddMulticastAddress(&AVR32_MACB, ucMACAddress);
+  }
+  return ERR_OK;
+}
+#endif /* LWIP_IGMP */
+
 /**
  * In this function, the hardware should be initialized.
  * Called from ethernetif_init().
@@ -110,6 +145,10 @@ low_level_init(struct netif *netif)
   /* device capabilities */
   /* don't set NETIF_FLAG_ETHARP if this device is not an ethernet one */
   netif->flags |= NETIF_FLAG_BROADCAST | NETIF_FLAG_ETHARP;
+#if LWIP_IGMP
+  netif->flags |= NETIF_FLAG_IGMP;
+  netif->igmp_mac_filter = ethernetif_igmp_mac_filter;
+#endif
  
   /* Do whatever else is needed to initialize interface. */  
   /* Initialise the MACB. */
@@ -163,7 +202,13 @@ low_level_output(struct netif *netif, struct pbuf *p)
 
   if( xTxSemaphore == NULL )
   {
+#if configSUPPORT_STATIC_ALLOCATION == 1
+    static xStaticQueue xTxSemaphoreBuffer;
+
+    vSemaphoreCreateBinaryStatic( xTxSemaphore, &xTxSemaphoreBuffer );
+#else
     vSemaphoreCreateBinary( xTxSemaphore );
+#endif
   }
 
 #if ETH_PAD_SIZE
@@ -173,6 +218,7 @@ low_level_output(struct netif *netif, struct pbuf *p)
   /* Access to the MACB is guarded using a semaphore. */
   if( xSemaphoreTake( xTxSemaphore, netifGUARD_BLOCK_NBTICKS ) )
   {
+    traceAPP_EVENT( traceEVT_NET_TX, p->tot_len );
     for( q = p; q != NULL; q = q->next )
     {
       /* Send the data from the pbuf to the interface, one pbuf at a
@@ -217,7 +263,13 @@ static struct pbuf *low_level_input(struct netif *netif)
 
   if( xRxSemaphore == NULL )
   {
+#if configSUPPORT_STATIC_ALLOCATION == 1
+    static xStaticQueue xRxSemaphoreBuffer;
+
+    vSemaphoreCreateBinaryStatic( xRxSemaphore, &xRxSemaphoreBuffer );
+#else
     vSemaphoreCreateBinary( xRxSemaphore );
+#endif
   }
 
   /* Access to the MACB is guarded using a semaphore. */
@@ -241,6 +293,13 @@ static struct pbuf *low_level_input(struct netif *netif)
         pbuf_header( p, -ETH_PAD_SIZE );    /* drop the padding word */
 #endif
 
+#if ( PBUF_POOL_BUFSIZE == MACB_RX_BUFFER_SIZE ) && !ETH_PAD_SIZE
+        /* Each pbuf of the chain maps to one Rx buffer: move them whole. */
+        for( q = p; q != NULL; q = q->next )
+        {
+          vMACBReadBuffer( q->payload, q->len );
+        }
+#else
         /* Let the driver know we are going to read a new packet. */
         vMACBRead( NULL, 0, len );
 
@@ -252,11 +311,13 @@ static struct pbuf *low_level_input(struct netif *netif)
           available data in the pbuf is given by the q->len variable. */
           vMACBRead( q->payload, q->len, len );
         }
+#endif
 
 #if ETH_PAD_SIZE
         pbuf_header( p, ETH_PAD_SIZE );     /* reclaim the padding word */
 #endif
         LINK_STATS_INC(link.recv);
+        traceAPP_EVENT( traceEVT_NET_RX, len );
       }
       else
       {
@@ -68,6 +68,16 @@ static struct TimeoutlistPerThread Threads_TimeoutsList[SYS_THREAD_MAX];
 // Number of active threads.
 static u16_t NbActiveThreads = 0;
 
+#if configSUPPORT_STATIC_ALLOCATION == 1
+// TCBs and stacks of the threads created by sys_thread_new(): the lwIP threads
+// are never deleted, so they are taken from static memory instead of the heap.
+static xStaticTask Threads_TCBs[SYS_THREAD_MAX];
+static portSTACK_TYPE Threads_StackPool[SYS_THREAD_STACK_POOL_SIZE];
+
+// Number of words of Threads_StackPool[] already handed out.
+static u32_t ThreadsStackPoolUsed = 0;
+#endif
+
 //----------- INIT -------------------------------------------------------------
 
 // Initialize the sys_arch layer.
@@ -86,6 +96,9 @@ void sys_init(void)
 
   // keep track of how many threads have been created
   NbActiveThreads = 0;
+#if configSUPPORT_STATIC_ALLOCATION == 1
+  ThreadsStackPoolUsed = 0;
+#endif
 }
 
 
@@ -371,9 +384,18 @@ struct sys_timeouts *sys_arch_timeouts(void)
   }
 
   // If we're here, this means the scheduler gave the focus to the task as it was
-  // being created(because of a higher priority). Since Threads_TimeoutsList[]
-  // update is done just after the task creation, the array is not up-to-date.
-  // => the last array entry must be the one of the current task.
+  // being created(because of a higher priority). Since the task handle (pid) is
+  // stored just after the task creation, its entry is the latest one reserved
+  // by sys_thread_new() without a pid.
+  for(i = NbActiveThreads - 1; i >= 0; i--)
+  {
+    if(Threads_TimeoutsList[i].pid == NULL)
+    {
+      return &(Threads_TimeoutsList[i].timeouts);
+    }
+  }
+
+  // Not an lwIP thread: same as before, the first free entry.
   return( &(Threads_TimeoutsList[NbActiveThreads].timeouts) );
 }
 
@@ -389,9 +411,44 @@ sys_thread_t sys_thread_new(char *name, void (* thread)(void *arg), void *arg, i
 {
   sys_thread_t    newthread;
   portBASE_TYPE   result;
+  u16_t           index;
   SYS_ARCH_DECL_PROTECT(protectionLevel);
+#if configSUPPORT_STATIC_ALLOCATION == 1
+  portSTACK_TYPE *stack = NULL;
+  xStaticTask    *tcb = NULL;
+#endif
+
+  // Reserve the entry of the thread, and with static allocation its TCB and
+  // its stack, all at once: two concurrent callers never get the same ones.
+  // Once the stack arena is exhausted, the heap is used.
+  SYS_ARCH_PROTECT(protectionLevel);
+  if( NbActiveThreads >= SYS_THREAD_MAX )
+  {
+    SYS_ARCH_UNPROTECT(protectionLevel);
+    return( NULL );
+  }
+  index = NbActiveThreads++;
+  Threads_TimeoutsList[index].pid = NULL;
+#if configSUPPORT_STATIC_ALLOCATION == 1
+  if( ThreadsStackPoolUsed + stacksize <= SYS_THREAD_STACK_POOL_SIZE )
+  {
+    tcb = &Threads_TCBs[index];
+    stack = &Threads_StackPool[ThreadsStackPoolUsed];
+    ThreadsStackPoolUsed += stacksize;
+  }
+#endif
+  SYS_ARCH_UNPROTECT(protectionLevel);
 
-  result = xTaskCreate( thread, (signed portCHAR *)name, stacksize, arg, prio, &newthread );
+#if configSUPPORT_STATIC_ALLOCATION == 1
+  if( tcb != NULL )
+  {
+    result = xTaskCreateStatic( thread, (signed portCHAR *)name, stacksize, arg, prio, &newthread, stack, tcb );
+  }
+  else
+#endif
+  {
+    result = xTaskCreate( thread, (signed portCHAR *)name, stacksize, arg, prio, &newthread );
+  }
 
   // Need to protect this -- preemption here could be a problem!
   SYS_ARCH_PROTECT(protectionLevel);
@@ -399,11 +456,23 @@ sys_thread_t sys_thread_new(char *name, void (* thread)(void *arg), void *arg, i
   {
     // For each task created, store the task handle (pid) in the timers array.
     // This scheme doesn't allow for threads to be deleted
-    Threads_TimeoutsList[NbActiveThreads++].pid = newthread;
+    Threads_TimeoutsList[index].pid = newthread;
   }
   else
   {
     newthread = NULL;
+    // Give back what was reserved, unless another thread reserved after it:
+    // then the entry, or the stack, stays unused.
+    if( index == NbActiveThreads - 1 )
+    {
+      NbActiveThreads--;
+    }
+#if configSUPPORT_STATIC_ALLOCATION == 1
+    if( ( stack != NULL ) && ( stack + stacksize == &Threads_StackPool[ThreadsStackPoolUsed] ) )
+    {
+      ThreadsStackPoolUsed -= stacksize;
+    }
+#endif
   }
   SYS_ARCH_UNPROTECT(protectionLevel);
 
@@ -436,3 +505,13 @@ void sys_arch_unprotect(sys_prot_t pval)
 {
   vPortExitCritical();
 }
+
+
+//----------- TIME -------------------------------------------------------------
+
+// Returns the current time in milliseconds, used by the TCP round-trip time
+// measurement and the timestamp option.
+u32_t sys_now(void)
+{
+  return( xTaskGetTickCount() * portTICK_RATE_MS );
+}
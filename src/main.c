@@ -76,6 +76,16 @@
 the demo application is not unexpectedly resetting. */
 #define mainRESET_COUNT_ADDRESS     ( ( void * ) 0xC0000000 )
 
+/* Serial bridge task stack size. */
+#define mainSERIAL_TASK_STACK_SIZE  ( 512 )
+
+#if configSUPPORT_STATIC_ALLOCATION == 1
+/* The serial bridge task lives as long as the application: its TCB and stack
+are not taken from the heap. */
+static portSTACK_TYPE puxSerialTaskStack[ mainSERIAL_TASK_STACK_SIZE ];
+static xStaticTask xSerialTaskBuffer;
+#endif
+
 
 //!
 //! \fn     main
@@ -131,7 +141,12 @@ volatile avr32_pm_t* pm = &AVR32_PM;
 	/* 2) Start the ethernet tasks launcher. */
 	vStartEthernetTaskLauncher( configMAX_PRIORITIES );
 
-	xTaskCreate(vBasicSerialServer, ( signed char * ) "LEDx", 512, NULL, 1, ( xTaskHandle * ) NULL);
+#if configSUPPORT_STATIC_ALLOCATION == 1
+	xTaskCreateStatic(vBasicSerialServer, ( signed char * ) "LEDx", mainSERIAL_TASK_STACK_SIZE, NULL, 1, ( xTaskHandle * ) NULL,
+	                  puxSerialTaskStack, &xSerialTaskBuffer);
+#else
+	xTaskCreate(vBasicSerialServer, ( signed char * ) "LEDx", mainSERIAL_TASK_STACK_SIZE, NULL, 1, ( xTaskHandle * ) NULL);
+#endif
 
 	/* 3) Start FreeRTOS. */
 	vTaskStartScheduler();